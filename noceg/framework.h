@@ -10,9 +10,16 @@
 #include <fstream>
 #include <filesystem>
 #include <cstdint>
+#include <charconv>
 #include <atomic>
 #include <memory>
 #include <optional>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <map>
+#include <bit>
 #include <span>
 #include <ranges>
 #include <expected>
@@ -21,6 +21,48 @@ LONG CALLBACK CEGExceptionHandler(
 
 class EntryProcessorManager;
 
+// Resolution state owned by a single thread, the debug registers and the CPU context are per thread.
+struct ResolverState
+{
+    // Memory address of the targeted CEG protected function.
+    std::uintptr_t m_TargetAddress { 0 };
+
+    // Entry point to which execution will be redirected.
+    std::uintptr_t m_EipAddress { 0 };
+
+    // Index inside the JSON configuration array of the entry being resolved.
+    std::size_t m_CurrentIndex { 0 };
+
+    // Copy of the CPU context saved by the custom exception handler, restored once the entry is resolved.
+    std::optional<CONTEXT> m_Context {};
+
+    // Information block of the thread and head of its SEH chain ('FS:[0]') saved along with the context,
+    // the CEG functions register their frames on the reserved stack and the chain must not point there once they are abandoned.
+    NT_TIB * m_Tib { nullptr };
+    _EXCEPTION_REGISTRATION_RECORD * m_ExceptionList { nullptr };
+
+    // Top of the stack area reserved by the driver loop for running the CEG functions.
+    std::uintptr_t m_StackTop { 0 };
+
+    // Index and value of the entry resolved by the last breakpoint hit.
+    std::optional<std::pair<std::size_t, std::uint32_t>> m_Result {};
+
+    // Hardware breakpoints loaded into the debug registers of this thread.
+    HardwareBreakpointManager m_HardwareBreakpoints {};
+
+    // The thread is one of the workers of the concurrent resolution.
+    bool m_IsWorker { false };
+
+    // Handle of the resolving thread opened for the watchdog, kept until the process exits.
+    HANDLE m_Thread { nullptr };
+
+    // QPC deadline of the entry being run, '0' while the thread is in the driver loop.
+    std::atomic<std::int64_t> m_Deadline { 0 };
+
+    // The watchdog moved the thread back to the driver loop, the entry being run has failed.
+    std::atomic_bool m_TimedOut { false };
+};
+
 // The global application state manager.
 class ApplicationManager
 {
@@ -29,17 +71,29 @@ private:
     // Manages the lifecycle of the vectored exception handler.
     std::unique_ptr<void, decltype(&RemoveVectoredExceptionHandler)> m_ExceptionHandler;
 
-    // Memory address of the targeted CEG protected function.
-    std::atomic<std::uintptr_t> m_TargetAddress { 0 };
+    // Serializes the exception handler registration.
+    std::mutex m_ExceptionHandlerMutex;
 
     // Manages software breakpoints.
     std::unique_ptr<BreakpointManager> m_BreakpointManager;
 
-    // Entry point to which execution will be redirected.
-    std::uintptr_t m_EipAddress { 0 };
+    // Use the debug registers instead of software breakpoints.
+    bool m_UseHardwareBreakpoints { false };
 
-    // Current index inside the JSON configuration array.
-    std::size_t m_CurrentIndex { 0 };
+    // Resolution state of the thread which loaded the library.
+    ResolverState m_MainState {};
+
+    // Resolution state of every worker thread.
+    std::vector<std::unique_ptr<ResolverState>> m_WorkerStates {};
+
+    // Number of the threads resolving entries at once.
+    std::uint32_t m_WorkerCount { 1 };
+
+    // Index of the next entry to be claimed by a resolving thread.
+    std::atomic<std::size_t> m_NextIndex { 0 };
+
+    // Serializes the updates of the JSON configuration.
+    std::mutex m_JsonMutex;
 
     // Address of the CEG register thread function.
     std::uintptr_t m_RegisterThreadAddress { 0 };
@@ -53,17 +107,23 @@ private:
     // Restart application flag.
     std::atomic_bool m_ShouldRestart { false };
 
-    // Optional saved CPU context from the custom exception handler.
-    std::optional<CONTEXT *> m_Context {};
+    // Timestamps of the resolution phases of every entry.
+    MetricsRecorder m_Metrics {};
+
+    // Binary trace of the exceptions seen by the handler.
+    EventTracer m_Tracer {};
 
     static inline ApplicationManager * m_Instance { nullptr };
 
+    // Resolution state bound to the current thread, the main state is used when none is bound.
+    static inline thread_local ResolverState * m_ThreadState { nullptr };
+
 public:
 
     /**
     * @brief Constructor initializes all managers and sets up singleton instance.
     *
-    * Initializes the exception handler, creates the breakpoint manager,
+    * Initializes the exception handler, creates the breakpoint managers,
     * loads JSON configuration and registers this instance as the singleton.
     * 
     * @param json_file A full path to 'noceg.json'.
@@ -105,24 +165,128 @@ public:
         PVECTORED_EXCEPTION_HANDLER handler
     ) noexcept
     {
+        std::scoped_lock lock( m_ExceptionHandlerMutex );
+
         if (auto * eh = AddVectoredExceptionHandler( 1, handler ))
             m_ExceptionHandler.reset( eh );
     }
 
 
     /**
-     * @brief Get for the target CEG function address.
+     * @brief Binds a resolution state to the current thread.
+     *
+     * @param state The state of the thread, or 'nullptr' to use the main state.
+     */
+    static void BindThreadState(
+        ResolverState * state
+    ) noexcept
+    {
+        m_ThreadState = state;
+    }
+
+
+    /**
+     * @brief Gets the resolution state of the current thread.
+     *
+     * @return Reference to the state bound to the current thread, or the main state.
+     */
+    [[nodiscard]] ResolverState & GetThreadState() noexcept
+    {
+        return m_ThreadState ? *m_ThreadState : m_MainState;
+    }
+
+
+    /**
+     * @brief Creates the resolution state of a new worker thread.
+     *
+     * @return Reference to the state, it stays valid as long as the application state does.
+     */
+    [[nodiscard]] ResolverState & AddWorkerState()
+    {
+        auto & state = *m_WorkerStates.emplace_back( std::make_unique<ResolverState>() );
+        state.m_IsWorker = true;
+
+        return state;
+    }
+
+
+    /**
+     * @brief Gets the resolution state of every thread.
+     *
+     * @return Pointers to the main state and to the state of every worker.
+     */
+    [[nodiscard]] std::vector<ResolverState *> GetResolverStates()
+    {
+        std::vector<ResolverState *> states { &m_MainState };
+
+        for (const auto & state : m_WorkerStates)
+            states.push_back( state.get() );
+
+        return states;
+    }
+
+
+    /**
+     * @brief Gets the number of the threads resolving entries at once.
+     *
+     * @return Number of the worker threads, '1' resolves every entry on the loader thread.
+     */
+    [[nodiscard]] std::uint32_t GetWorkerCount() const noexcept
+    {
+        return m_WorkerCount;
+    }
+
+
+    /**
+     * @brief Sets the number of the threads resolving entries at once.
+     *
+     * @param count Number of the worker threads.
+     */
+    void SetWorkerCount(
+        std::uint32_t count
+    ) noexcept
+    {
+        m_WorkerCount = count;
+    }
+
+
+    /**
+     * @brief Claims the next entry for the current thread.
+     *
+     * Every entry is claimed by exactly one thread.
+     *
+     * @return Index of the claimed entry in the "ConstantOrStolen" array.
+     */
+    [[nodiscard]] std::size_t ClaimIndex() noexcept
+    {
+        return m_NextIndex.fetch_add( 1 );
+    }
+
+
+    /**
+     * @brief Gets the mutex serializing the updates of the JSON configuration.
+     *
+     * @return Reference to the mutex.
+     */
+    [[nodiscard]] std::mutex & GetJSONMutex() noexcept
+    {
+        return m_JsonMutex;
+    }
+
+
+    /**
+     * @brief Get for the target CEG function address of the current thread.
      *
      * @return Target CEG function address.
      */
-    [[nodiscard]] std::uintptr_t GetTargetAddress() const noexcept
+    [[nodiscard]] std::uintptr_t GetTargetAddress() noexcept
     {
-        return m_TargetAddress.load();
+        return GetThreadState().m_TargetAddress;
     }
     
 
     /**
-     * @brief Setter for the target CEG function address.
+     * @brief Setter for the target CEG function address of the current thread.
      *
      * @param address Memory address of the target CEG function.
      */
@@ -130,7 +294,7 @@ public:
         std::uintptr_t address
     ) noexcept
     {
-        m_TargetAddress.store( address );
+        GetThreadState().m_TargetAddress = address;
     }
 
 
@@ -145,6 +309,63 @@ public:
     }
 
 
+    /**
+     * @brief Gets reference to the resolution metrics.
+     *
+     * @return Reference to the 'MetricsRecorder' instance.
+     */
+    [[nodiscard]] MetricsRecorder & GetMetrics() noexcept
+    {
+        return m_Metrics;
+    }
+
+
+    /**
+     * @brief Gets reference to the exception tracer.
+     *
+     * @return Reference to the 'EventTracer' instance.
+     */
+    [[nodiscard]] EventTracer & GetTracer() noexcept
+    {
+        return m_Tracer;
+    }
+
+
+    /**
+     * @brief Gets reference to the hardware breakpoint manager of the current thread.
+     *
+     * @return Reference to the 'HardwareBreakpointManager' instance.
+     */
+    [[nodiscard]] HardwareBreakpointManager & GetHardwareBreakpointManager() noexcept
+    {
+        return GetThreadState().m_HardwareBreakpoints;
+    }
+
+
+    /**
+     * @brief Checks if the debug registers are used instead of software breakpoints.
+     *
+     * @return true if hardware breakpoints are used, false otherwise.
+     */
+    [[nodiscard]] bool UseHardwareBreakpoints() const noexcept
+    {
+        return m_UseHardwareBreakpoints;
+    }
+
+
+    /**
+     * @brief Selects the breakpoint backend.
+     *
+     * @param enable Use the debug registers instead of software breakpoints.
+     */
+    void SetUseHardwareBreakpoints(
+        bool enable
+    ) noexcept
+    {
+        m_UseHardwareBreakpoints = enable;
+    }
+
+
     /**
      * @brief Gets reference to the JSON configuration reader.
      *
@@ -172,9 +393,9 @@ public:
      *
      * @return The current entry point address.
      */
-    [[nodiscard]] std::uintptr_t GetEipAddress() const noexcept
+    [[nodiscard]] std::uintptr_t GetEipAddress() noexcept
     {
-        return m_EipAddress;
+        return GetThreadState().m_EipAddress;
     }
 
 
@@ -187,18 +408,18 @@ public:
         std::uintptr_t address
     ) noexcept
     {
-        m_EipAddress = address;
+        GetThreadState().m_EipAddress = address;
     }
 
 
     /**
-     * @brief Gets the current processing index in the JSON configuration array.
+     * @brief Gets the processing index of the current thread in the JSON configuration array.
      *
      * @return Current index being processed in the "ConstantOrStolen" array.
      */
-    [[nodiscard]] std::size_t GetCurrentIndex() const noexcept
+    [[nodiscard]] std::size_t GetCurrentIndex() noexcept
     {
-        return m_CurrentIndex;
+        return GetThreadState().m_CurrentIndex;
     }
 
 
@@ -211,7 +432,7 @@ public:
         std::size_t index
     ) noexcept
     {
-        m_CurrentIndex = index;
+        GetThreadState().m_CurrentIndex = index;
     }
 
 
@@ -258,25 +479,97 @@ public:
     
     
     /**
-    * @brief Saves the current context.
+    * @brief Saves a copy of the context of the current thread, along with the head of its SEH chain.
     *
-    * @param ctx Pointer to 'CONTEXT' structure to store.
+    * @param ctx Pointer to 'CONTEXT' structure to copy.
     */
     void SetContext(
-        CONTEXT * ctx
+        const CONTEXT * ctx
     ) noexcept
     {
-        m_Context = std::make_optional( ctx );
+        auto & thread = GetThreadState();
+
+        // Saved first, the watchdog restores them once it sees the context.
+        thread.m_Tib = reinterpret_cast<NT_TIB *>(NtCurrentTeb());
+        thread.m_ExceptionList = thread.m_Tib->ExceptionList;
+        thread.m_Context = *ctx;
+    }
+
+
+    // Restores the head of the SEH chain of the current thread saved by 'SetContext', 'CONTEXT' does not hold it.
+    void RestoreExceptionList() noexcept
+    {
+        auto & thread = GetThreadState();
+
+        if (thread.m_Tib)
+            thread.m_Tib->ExceptionList = thread.m_ExceptionList;
+    }
+
+
+    // Drops the saved context of the current thread before the next entry is run.
+    void ClearContext() noexcept
+    {
+        GetThreadState().m_Context.reset();
     }
     
     
     /**
-    * @brief Retrieves the previously saved context.
+    * @brief Retrieves the previously saved context of the current thread.
     *
-    * @return Pointer to 'CONTEXT' structure.
+    * @return Pointer to the saved 'CONTEXT' structure.
     */
-    CONTEXT * GetContext() const noexcept
+    const CONTEXT * GetContext() noexcept
+    {
+        return &GetThreadState().m_Context.value();
+    }
+
+
+    /**
+     * @brief Gets the top of the stack area the CEG functions of the current thread run on.
+     *
+     * @return Address of the stack top.
+     */
+    [[nodiscard]] std::uintptr_t GetStackTop() noexcept
+    {
+        return GetThreadState().m_StackTop;
+    }
+
+
+    /**
+     * @brief Sets the top of the stack area the CEG functions of the current thread run on.
+     *
+     * @param address Address of the stack top.
+     */
+    void SetStackTop(
+        std::uintptr_t address
+    ) noexcept
+    {
+        GetThreadState().m_StackTop = address;
+    }
+
+
+    /**
+     * @brief Records the value of the entry resolved on the current thread.
+     *
+     * @param index Index of the entry in the "ConstantOrStolen" array.
+     * @param value The resolved value.
+     */
+    void SetResult(
+        std::size_t index,
+        std::uint32_t value
+    ) noexcept
+    {
+        GetThreadState().m_Result = std::make_pair( index, value );
+    }
+
+
+    /**
+     * @brief Takes the value recorded by 'SetResult' on the current thread.
+     *
+     * @return Index and value of the resolved entry, or 'std::nullopt' if nothing has been resolved.
+     */
+    [[nodiscard]] std::optional<std::pair<std::size_t, std::uint32_t>> TakeResult() noexcept
     {
-        return m_Context.value();
+        return std::exchange( GetThreadState().m_Result, std::nullopt );
     }
 };
\ No newline at end of file
@@ -0,0 +1,316 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "reader.h"
+
+// Local cache of the resolved values shared by every title, keyed by the bytes of the protected functions.
+class ValueCache
+{
+private:
+
+    // Magic value of the cache header, 'NCC1'.
+    static constexpr std::uint32_t CACHE_MAGIC = 0x3143434E;
+
+    // Longest function body which is hashed, longer ones are not cached.
+    static constexpr std::size_t MAX_FUNCTION_SIZE = 0x10000;
+
+    // A single cached value.
+    struct Record
+    {
+        std::uint64_t m_Key { 0 };
+        std::uint32_t m_Value { 0 };
+        std::uint32_t m_Reserved { 0 };
+    };
+
+    // Path to the cache file.
+    fs::path m_Path {};
+
+    // The cached values, sorted by key.
+    std::vector<Record> m_Records {};
+
+    // The cache file exists and has a valid header, the new records are appended to it.
+    bool m_Valid { false };
+
+    // Hash of the machine the values are bound to.
+    std::uint64_t m_Machine { 0 };
+
+
+    /**
+     * @brief Mixes bytes into a FNV-1a hash.
+     *
+     * @param hash [in, out] The hash.
+     * @param bytes The bytes to mix.
+     */
+    static void Mix(
+        std::uint64_t & hash,
+        std::span<const std::byte> bytes
+    ) noexcept
+    {
+        for (const auto byte : bytes)
+        {
+            hash ^= static_cast<std::uint64_t>(byte);
+            hash *= 0x100000001B3ull;
+        }
+    }
+
+
+    /**
+     * @brief Hashes the machine the values are bound to.
+     *
+     * Covers the computer name and the serial number of the system volume.
+     *
+     * @return FNV-1a hash of the machine.
+     */
+    [[nodiscard]] static std::uint64_t Fingerprint() noexcept
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+
+        std::array<wchar_t, MAX_COMPUTERNAME_LENGTH + 1> name {};
+        DWORD name_size = static_cast<DWORD>(name.size());
+
+        if (GetComputerNameW( name.data(), &name_size ))
+            Mix( hash, std::as_bytes( std::span { name.data(), name_size } ) );
+
+        std::array<wchar_t, MAX_PATH> windows {};
+        DWORD serial = 0;
+
+        if (GetWindowsDirectoryW( windows.data(), static_cast<unsigned>(windows.size()) ) >= 3)
+        {
+            const std::array<wchar_t, 4> root { windows[0], L':', L'\\', L'\0' };
+
+            if (GetVolumeInformationW( root.data(), nullptr, 0, &serial, nullptr, nullptr, nullptr, 0 ))
+                Mix( hash, std::as_bytes( std::span { &serial, 1 } ) );
+        }
+
+        return hash;
+    }
+
+
+    /**
+     * @brief Gets the image of the game executable.
+     *
+     * @return View of the mapped image.
+     */
+    [[nodiscard]] static std::span<const std::byte> MainImage() noexcept
+    {
+        const auto * base = reinterpret_cast<const std::byte *>(GetModuleHandleA( nullptr ));
+        if (!base)
+            return {};
+
+        const auto * dos = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+        const auto * nt = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dos->e_lfanew);
+
+        return { base, nt->OptionalHeader.SizeOfImage };
+    }
+
+
+    /**
+     * @brief Computes the key of an entry.
+     *
+     * @param entry The entry.
+     * @param image The image of the game executable.
+     * @return Hash of the function bytes between 'Prologue' and 'BP', of the entry layout and of the machine,
+     * '0' if the entry cannot be cached.
+     */
+    [[nodiscard]] std::uint64_t Key(
+        const CEGEntry & entry,
+        std::span<const std::byte> image
+    ) const noexcept
+    {
+        const auto base = reinterpret_cast<std::uintptr_t>(image.data());
+
+        if (!entry.m_Type || !entry.m_Prologue || entry.m_Bp <= entry.m_Prologue ||
+            entry.m_Bp - entry.m_Prologue > MAX_FUNCTION_SIZE || entry.m_Prologue < base || entry.m_Bp > base + image.size())
+            return 0;
+
+        auto hash = m_Machine;
+
+        const std::array<std::uint64_t, 3> layout {
+            entry.m_Type,
+            static_cast<std::uint64_t>(entry.m_Eip - entry.m_Prologue),
+            static_cast<std::uint64_t>(entry.m_Bp - entry.m_Prologue)
+        };
+
+        Mix( hash, std::as_bytes( std::span { layout } ) );
+        Mix( hash, image.subspan( entry.m_Prologue - base, entry.m_Bp - entry.m_Prologue ) );
+
+        return hash ? hash : 1;
+    }
+
+public:
+
+    /**
+     * @brief Gets the default path of the cache, shared by every title of the current user.
+     *
+     * @param fallback The path used if the local application data folder is unknown.
+     * @return Path to 'noceg.cache' inside '%LOCALAPPDATA%\NoCEG'.
+     */
+    [[nodiscard]] static fs::path DefaultPath(
+        const fs::path & fallback
+    )
+    {
+        std::array<wchar_t, MAX_PATH> local {};
+        const auto length = GetEnvironmentVariableW( L"LOCALAPPDATA", local.data(), static_cast<DWORD>(local.size()) );
+
+        if (!length || length >= local.size())
+            return fallback;
+
+        return fs::path( std::wstring( local.data(), length ) ) / "NoCEG" / "noceg.cache";
+    }
+
+
+    /**
+     * @brief Reads the cache, a missing file is an empty cache.
+     *
+     * @param path Path to the cache file.
+     * @return 'std::expected<std::size_t, Error>' Either the number of the cached values or an error.
+     * @retval 'CacheReadFailed' if the cache cannot be read.
+     */
+    [[nodiscard]] std::expected<std::size_t, Error> Load(
+        const fs::path & path
+    ) noexcept
+    {
+        try
+        {
+            m_Path = path;
+            m_Records.clear();
+            m_Valid = false;
+            m_Machine = Fingerprint();
+
+            std::ifstream in { path, std::ios::binary };
+            if (!in.is_open())
+                return 0;
+
+            std::uint32_t magic = 0;
+            if (!in.read( reinterpret_cast<char *>(&magic), sizeof( magic ) ) || magic != CACHE_MAGIC)
+                return 0;
+
+            m_Valid = true;
+
+            // A record torn by a crash is dropped.
+            for (Record record {}; in.read( reinterpret_cast<char *>(&record), sizeof( record ) ); )
+                m_Records.push_back( record );
+
+            std::ranges::stable_sort( m_Records, {}, &Record::m_Key );
+
+            const auto [first, last] = std::ranges::unique( m_Records, {}, &Record::m_Key );
+            m_Records.erase( first, last );
+
+            return m_Records.size();
+        }
+        catch (const std::exception &)
+        {
+            return std::unexpected { Error::CacheReadFailed };
+        }
+    }
+
+
+    /**
+     * @brief Computes the key of every entry.
+     *
+     * @param entries The entry table.
+     * @return The keys, index-aligned with the entry table, '0' for the entries which cannot be cached.
+     */
+    [[nodiscard]] std::vector<std::uint64_t> Keys(
+        std::span<const CEGEntry> entries
+    ) const
+    {
+        const auto image = MainImage();
+        std::vector<std::uint64_t> keys( entries.size() );
+
+        if (!image.empty())
+        {
+            for (std::size_t i = 0; i < entries.size(); ++i)
+                keys[i] = Key( entries[i], image );
+        }
+
+        return keys;
+    }
+
+
+    /**
+     * @brief Looks up a cached value.
+     *
+     * @param key The key of the entry.
+     * @return The cached value, or 'std::nullopt' if none.
+     */
+    [[nodiscard]] std::optional<std::uint32_t> Find(
+        std::uint64_t key
+    ) const noexcept
+    {
+        if (!key)
+            return std::nullopt;
+
+        const auto it = std::ranges::lower_bound( m_Records, key, {}, &Record::m_Key );
+        if (it == m_Records.end() || it->m_Key != key)
+            return std::nullopt;
+
+        return it->m_Value;
+    }
+
+
+    /**
+     * @brief Appends the resolved values which are not cached yet.
+     *
+     * @param keys The keys of the entries, see 'Keys'.
+     * @param entries The entry table.
+     * @return 'std::expected<std::size_t, Error>' Either the number of the appended values or an error.
+     * @retval 'CacheWriteFailed' if the cache cannot be written.
+     */
+    [[nodiscard]] std::expected<std::size_t, Error> Store(
+        std::span<const std::uint64_t> keys,
+        std::span<const CEGEntry> entries
+    ) noexcept
+    {
+        try
+        {
+            std::vector<Record> records {};
+
+            for (std::size_t i = 0; i < keys.size() && i < entries.size(); ++i)
+            {
+                // A zero value cannot be told apart from an unresolved one.
+                if (keys[i] && entries[i].m_Resolved && entries[i].m_Value && !Find( keys[i] ))
+                    records.push_back( Record { keys[i], entries[i].m_Value } );
+            }
+
+            if (records.empty())
+                return 0;
+
+            std::error_code ec {};
+            fs::create_directories( m_Path.parent_path(), ec );
+
+            // Another title may have written the cache in the meantime, the duplicates are dropped on load.
+            std::ofstream out { m_Path, std::ios::binary | (m_Valid ? std::ios::app : std::ios::trunc) };
+            if (!out.is_open())
+                return std::unexpected { Error::CacheWriteFailed };
+
+            if (!m_Valid)
+                out.write( reinterpret_cast<const char *>(&CACHE_MAGIC), sizeof( CACHE_MAGIC ) );
+
+            out.write( reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(records.size() * sizeof( Record )) );
+
+            if (!out)
+                return std::unexpected { Error::CacheWriteFailed };
+
+            m_Valid = true;
+            return records.size();
+        }
+        catch (const std::exception &)
+        {
+            return std::unexpected { Error::CacheWriteFailed };
+        }
+    }
+};
\ No newline at end of file
@@ -24,182 +24,583 @@ private:
     // Custom exception code.
     std::uint32_t m_CustomExceptionCode { 0xDEADDEAD };
 
-    // A unique pointer to the main application manager.
-    std::unique_ptr<ApplicationManager> m_AppManager;
+    // The main application manager, it owns this processor.
+    ApplicationManager * m_AppManager;
 
-public:
+    // Address of the CEG initialization function.
+    std::uintptr_t m_InitAddress { 0 };
+
+    // The "ConstantOrStolen" entries, converted once by 'Initialize'.
+    std::vector<CEGEntry> m_Entries {};
+
+    // Journal of the resolved values, 'noceg.json' is only written once every entry is done.
+    ResultJournal m_Journal {};
+
+    // Values resolved by any title on this machine, with the cache key of every entry, empty if disabled.
+    ValueCache m_Cache {};
+    std::vector<std::uint64_t> m_CacheKeys {};
+
+    // When the process is restarted between the entries.
+    enum class RestartStrategy : std::uint8_t
+    {
+        // Every entry is resolved in the same process.
+        Never,
+
+        // The process is restarted after every resolved entry.
+        Always,
+
+        // The process is restarted once an entry changed the result of a reference entry.
+        Poisoned
+    };
+
+    RestartStrategy m_RestartStrategy { RestartStrategy::Never };
+
+    // Order the entries are claimed in, empty for the table order.
+    std::vector<std::size_t> m_Order {};
+
+    // Index and value of the first entry resolved by this launch, run again after every entry to detect a poisoned state.
+    std::optional<std::pair<std::size_t, std::uint32_t>> m_Reference {};
+
+    // Time an entry may run before the watchdog skips it, in milliseconds and in QPC ticks, '0' disables the watchdog.
+    std::uint32_t m_TimeoutMs { 0 };
+    std::int64_t m_Timeout { 0 };
+
+    // Size of the stack area the CEG functions run on.
+    static constexpr std::size_t RESOLVE_STACK_SIZE = 0x40000;
+
+    // Part of the area left above the stack pointer, functions entered halfway read their frame from there.
+    static constexpr std::size_t RESOLVE_STACK_FRAME = 0x1000;
 
-    explicit EntryProcessorManager( ApplicationManager * app )
-        : m_AppManager( app )
-    {}
-    
 
     /**
-    * @brief Main loop to process the current JSON entry containing CEG function info.
+    * @brief Entry point of a worker thread of the concurrent resolution.
     *
-    * Iterates over function entries in the 'ConstantOrStolen' array of the loaded JSON.
-    * Applies breakpoints and raises custom exception to trigger further handling.
+    * @param param Pointer to the 'ResolverState' of the worker.
+    * @return Always '0' once every entry is claimed.
     */
-    void ProcessEntry()
+    static DWORD WINAPI WorkerThread(
+        void * param
+    ) noexcept
     {
-        auto & config = m_AppManager->GetJSON();
-        const auto & json = config.ReadData();
+        auto * state = ApplicationManager::GetInstance();
+        ApplicationManager::BindThreadState( static_cast<ResolverState *>(param) );
 
-        // Check if 'ConstantOrStolen' key exists.
-        if (!json.contains( "ConstantOrStolen" ) || !json["ConstantOrStolen"].is_array())
+        try
         {
-            LOG_WARNING( "'ConstantOrStolen' key missing or not an array." );
-            return;
+            state->GetEntryProcessorManager().ProcessEntry();
         }
+        catch (const std::exception & e)
+        {
+            LOG_ERROR( "Worker thread failed ('{}').", e.what() );
+        }
+
+        return 0;
+    }
+
+
+    /**
+    * @brief Entry point of the watchdog thread.
+    *
+    * @param param Pointer to the 'EntryProcessorManager'.
+    * @return Never returns, the thread ends with the process.
+    */
+    static DWORD WINAPI WatchdogThread(
+        void * param
+    ) noexcept
+    {
+        static_cast<EntryProcessorManager *>(param)->Watch();
+        return 0;
+    }
+
+
+    // Reads the performance counter.
+    [[nodiscard]] static std::int64_t Now() noexcept
+    {
+        LARGE_INTEGER counter {};
+        QueryPerformanceCounter( &counter );
+
+        return counter.QuadPart;
+    }
+
+
+    /**
+    * @brief Restarts the application and ends the current process.
+    */
+    [[noreturn]] void Restart()
+    {
+        LOG_INFO( "Setting the restart flag." );
+        m_AppManager->SetShouldRestart();
 
-        const auto & constant_or_stolen_funcs = json["ConstantOrStolen"];
+        // Attempt to restart the application.
+        if (auto res = ProcessManager::SelfRestart(); !res)
+            LOG_ERROR( "Error restarting app '0x{:08X}'", static_cast<int>(res.error()) );
 
-        for (std::size_t i = m_AppManager->GetCurrentIndex(); i < constant_or_stolen_funcs.size(); ++i)
+        std::exit( 1 );
+    }
+
+
+    /**
+    * @brief Runs the CEG function of an entry until its breakpoint is hit.
+    *
+    * The exception handler restores the context of the raised exception once the breakpoint is hit,
+    * so every entry returns here and costs the same stack depth.
+    *
+    * @param index Index of the entry in the "ConstantOrStolen" array.
+    * @return The value from EAX at the breakpoint, or 'std::nullopt' if it was not hit.
+    */
+    [[nodiscard]] std::optional<std::uint32_t> RunEntry(
+        std::size_t index
+    )
+    {
+        const auto & entry = m_Entries[index];
+        auto & state = m_AppManager->GetThreadState();
+        auto & metrics = m_AppManager->GetMetrics();
+
+        metrics.Stamp( index, ResolvePhase::Start );
+
+        // Save the current index for resuming or tracking progress.
+        m_AppManager->SetCurrentIndex( index );
+        m_AppManager->ClearContext();
+
+        // The watchdog moves the thread back here once the deadline passes.
+        if (m_Timeout)
+            state.m_Deadline.store( Now() + m_Timeout, std::memory_order_release );
+
+        m_AppManager->SetTargetAddress( entry.m_Func );
+        m_AppManager->SetEipAddress( entry.m_Eip );
+
+        if (m_AppManager->UseHardwareBreakpoints())
         {
-            const auto & entry = constant_or_stolen_funcs[i];
+            // The debug registers are loaded by the exception handler.
+            if (!m_AppManager->GetHardwareBreakpointManager().SetBreakpoint( entry.m_Bp, index ))
+            {
+                LOG_WARNING( "No free debug register for the entry at index '{}'.", index );
 
-            // Check if entry is valid and has at least one key value pair.
-            if (entry.empty() || !entry.is_object())
+                state.m_Deadline.store( 0, std::memory_order_release );
+                return std::nullopt;
+            }
+        }
+        else
+            m_AppManager->GetBreakpointManager().SetBreakpoint( entry.m_Bp, index );
+
+        // Handle various CEG functions.
+        // '1' - CEG constant functions.
+        // '2' - Older CEG stolen/masked functions.
+        // '3', '4' - CEG stolen/masked functions.
+        if (entry.m_Type == 2)
+            m_AppManager->SetExceptionHandler( CEGExceptionHandler );
+        else
+        {
+            // Attempt to call the CEG register thread function before proceeding with the exception.
+            const auto ceg_registerthread_addr = m_AppManager->GetRegisterThreadAddress();
+            if (ceg_registerthread_addr)
             {
-                LOG_WARNING( "Skipping invalid entry at index '{}'.", i );
-                continue;
+                using CEG_RegisterThread_t = bool(*)();
+                const auto register_thread = reinterpret_cast<CEG_RegisterThread_t>(ceg_registerthread_addr);
+                register_thread();
             }
+        }
+
+        metrics.Stamp( index, ResolvePhase::RegisterThread );
+
+        RaiseException( m_CustomExceptionCode, 0, 0, nullptr );
+
+        // 'RaiseException' returns once the handler restored the saved context.
+        state.m_Deadline.store( 0, std::memory_order_release );
+
+        if (state.m_TimedOut.exchange( false, std::memory_order_acq_rel ))
+        {
+            // The watchdog restored the breakpoint and recorded the failure already.
+            // The function was left halfway, only a restart gets a clean state for the next entry.
+            if (m_RestartStrategy == RestartStrategy::Always)
+                Restart();
+
+            return std::nullopt;
+        }
+
+        const auto result = m_AppManager->TakeResult();
+        if (!result || result->first != index)
+        {
+            LOG_WARNING( "Entry '0x{:08X}' returned without hitting its breakpoint.", entry.m_Func );
+
+            // Do not leave the breakpoint behind for the next entries.
+            if (m_AppManager->UseHardwareBreakpoints())
+                static_cast<void>(m_AppManager->GetHardwareBreakpointManager().RemoveBreakpoint( entry.m_Bp ));
+            else
+                static_cast<void>(m_AppManager->GetBreakpointManager().RemoveBreakpoint( entry.m_Bp ));
+
+            return std::nullopt;
+        }
+
+        return result->second;
+    }
+
+
+    /**
+    * @brief Saves the resolved value of an entry.
+    *
+    * @param index Index of the entry in the "ConstantOrStolen" array.
+    * @param value The value from EAX at the breakpoint.
+    * @return true if the value is saved, false otherwise.
+    */
+    bool SaveResult(
+        std::size_t index,
+        std::uint32_t value
+    )
+    {
+        auto & resolved = m_Entries[index];
+        resolved.m_Value = value;
+        resolved.m_Resolved = true;
+
+        auto & config = m_AppManager->GetJSON();
+
+        try
+        {
+            // Other threads may be saving their own entries.
+            std::scoped_lock lock( m_AppManager->GetJSONMutex() );
 
-            const auto & data = entry.begin().value();
+            // Update the JSON entry with the result value from EAX.
+            config.UpdateEntry( index, value );
 
-            // Check if data is an object.
-            if (!data.is_object())
+            // Without the journal every value is saved to 'noceg.json' at once.
+            if (!m_Journal.Append( index, value ))
             {
-                LOG_WARNING( "Skipping entry at index '{}', data is not an object.", i );
-                continue;
+                if (auto res = config.SaveJSON(); !res)
+                {
+                    LOG_WARNING( "Failed to update an entry inside 'noceg.json'." );
+                    return false;
+                }
             }
+        }
+        catch (const std::exception & e)
+        {
+            LOG_ERROR( "Failed to update an entry inside 'noceg.json' ('{}').", e.what() );
+            return false;
+        }
+
+        m_AppManager->GetMetrics().Stamp( index, ResolvePhase::Saved );
+        return true;
+    }
+
+
+    /**
+    * @brief Saves a value resolved with the 'Poisoned' restart strategy, restarts once the process state is poisoned.
+    *
+    * The first entry of a launch runs on a fresh process, its value is trusted and it becomes the reference entry.
+    * Every following entry is trusted only if the reference entry still returns the same value afterwards.
+    * Otherwise the entry is recorded as poisoning, its value is dropped and the next launch resolves it first.
+    *
+    * @param index Index of the entry in the "ConstantOrStolen" array.
+    * @param value The value from EAX at the breakpoint.
+    */
+    void SavePoisonChecked(
+        std::size_t index,
+        std::uint32_t value
+    )
+    {
+        if (!m_Reference)
+        {
+            SaveResult( index, value );
 
-            // Safe check for 'Value' field.
-            if (!data.contains( "Value" ) || !data["Value"].is_string())
+            // The reference entry has to leave its own result untouched as well.
+            if (m_Entries[index].m_Poisons || RunEntry( index ) != value)
             {
-                LOG_WARNING( "Skipping entry at index '{}', value field missing or invalid.", i );
-                continue;
+                if (!m_Entries[index].m_Poisons)
+                {
+                    LOG_INFO( "Entry at index '{}' poisons the process state.", index );
+                    m_Journal.AppendPoisoned( index );
+                }
+
+                Restart();
             }
 
-            // Only handle entries where the function hasn't been processed.
-            if (data["Value"].get<std::string>() == "0x00000000")
+            m_Reference.emplace( index, value );
+            return;
+        }
+
+        if (RunEntry( m_Reference->first ) != m_Reference->second)
+        {
+            LOG_INFO( "Entry at index '{}' poisons the process state.", index );
+
+            m_Entries[index].m_Poisons = true;
+            m_Journal.AppendPoisoned( index );
+
+            Restart();
+        }
+
+        SaveResult( index, value );
+    }
+
+
+    /**
+    * @brief Records an entry which did not resolve in time.
+    *
+    * @param index Index of the entry in the "ConstantOrStolen" array.
+    */
+    void RecordFailure(
+        std::size_t index
+    ) noexcept
+    {
+        m_Entries[index].m_Failed = true;
+
+        try
+        {
+            std::scoped_lock lock( m_AppManager->GetJSONMutex() );
+            m_Journal.AppendFailed( index );
+        }
+        catch (const std::exception & e)
+        {
+            LOG_ERROR( "Failed to record the entry at index '{}' ('{}').", index, e.what() );
+        }
+    }
+
+
+    /**
+    * @brief Moves a thread whose entry timed out back to its driver loop.
+    *
+    * The thread is suspended and gets the context saved by the custom exception, as if the breakpoint
+    * had been hit without a value. A thread which timed out before the custom exception, or which does not
+    * get back to its driver loop in time either, leaves the process in an unknown state, which is restarted.
+    * The head of the SEH chain of the thread is restored along with the context, its frames on the reserved stack
+    * are dropped. Any lock the CEG function took on the reserved stack is abandoned, and never released.
+    *
+    * @param state The resolution state of the thread.
+    * @param deadline The deadline which has passed.
+    */
+    void Recover(
+        ResolverState & state,
+        std::int64_t deadline
+    ) noexcept
+    {
+        const auto index = state.m_CurrentIndex;
+
+        if (state.m_TimedOut.load( std::memory_order_acquire ))
+        {
+            LOG_ERROR( "The thread resolving the entry at index '{}' did not get back in time, restarting.", index );
+            Restart();
+        }
+
+        if (SuspendThread( state.m_Thread ) == static_cast<DWORD>(-1))
+            return;
+
+        // 'SuspendThread' is asynchronous, reading the context waits for the thread to stop.
+        CONTEXT current {};
+        current.ContextFlags = CONTEXT_FULL;
+
+        // The entry may have been resolved in the meantime.
+        if (!GetThreadContext( state.m_Thread, &current ) ||
+            state.m_Deadline.load( std::memory_order_acquire ) != deadline || state.m_Result)
+        {
+            ResumeThread( state.m_Thread );
+            return;
+        }
+
+        const auto & entry = m_Entries[index];
+
+        if (!state.m_Context)
+        {
+            ResumeThread( state.m_Thread );
+
+            LOG_ERROR( "Entry '0x{:08X}' timed out before reaching its function, restarting.", entry.m_Func );
+            RecordFailure( index );
+            Restart();
+        }
+
+        // Back to the 'RaiseException' call of the driver loop.
+        auto ctx = *state.m_Context;
+        ctx.ContextFlags = CONTEXT_FULL | CONTEXT_DEBUG_REGISTERS;
+        ctx.EFlags &= ~0x100;
+
+        // Restore the breakpoint byte, or free the debug register of the entry.
+        if (m_AppManager->UseHardwareBreakpoints())
+        {
+            static_cast<void>(state.m_HardwareBreakpoints.RemoveBreakpoint( entry.m_Bp ));
+            state.m_HardwareBreakpoints.Apply( ctx );
+        }
+        else
+            static_cast<void>(m_AppManager->GetBreakpointManager().RemoveBreakpoint( entry.m_Bp ));
+
+        state.m_TimedOut.store( true, std::memory_order_release );
+        state.m_Deadline.store( Now() + m_Timeout, std::memory_order_release );
+
+        const auto moved = SetThreadContext( state.m_Thread, &ctx );
+
+        // 'FS:[0]' still points into the frames on the reserved stack, the information block was saved by the thread itself.
+        if (moved && state.m_Tib)
+            state.m_Tib->ExceptionList = state.m_ExceptionList;
+
+        ResumeThread( state.m_Thread );
+
+        // Nothing is logged while the thread is suspended, it may hold the log.
+        LOG_WARNING( "Entry '0x{:08X}' did not hit its breakpoint within '{}' ms, skipping it.", entry.m_Func, m_TimeoutMs );
+        RecordFailure( index );
+
+        if (!moved)
+        {
+            LOG_ERROR( "Failed to move the thread back to its driver loop. Last error is '{}'.", GetLastError() );
+            Restart();
+        }
+    }
+
+
+    // Checks the deadline of every resolving thread until the process exits.
+    void Watch() noexcept
+    {
+        std::vector<ResolverState *> states {};
+
+        try
+        {
+            states = m_AppManager->GetResolverStates();
+        }
+        catch (const std::exception & e)
+        {
+            LOG_ERROR( "Watchdog thread failed ('{}').", e.what() );
+            return;
+        }
+
+        const auto interval = std::clamp<std::uint32_t>( m_TimeoutMs / 4, 10, 1000 );
+
+        for (;;)
+        {
+            Sleep( interval );
+
+            const auto now = Now();
+
+            for (auto * state : states)
             {
-                // Save the current index for resuming or tracking progress.
-                m_AppManager->SetCurrentIndex( i );
+                if (const auto deadline = state->m_Deadline.load( std::memory_order_acquire ); deadline && now >= deadline)
+                    Recover( *state, deadline );
+            }
+        }
+    }
 
-                try
-                {
-                    // Check if the function address is valid.
-                    const auto func_key = entry.begin().key();
-                    if (func_key.empty())
-                    {
-                        LOG_WARNING( "Entry at index '{}' has empty key.", i );
-                        continue;
-                    }
 
-                    if (!data.contains( "BP" ) || !data["BP"].is_string())
-                    {
-                        LOG_WARNING( "'BP' field missing or invalid at index '{}'.", i );
-                        continue;
-                    }
+    // Starts the watchdog once every resolving thread has its state.
+    void StartWatchdog() noexcept
+    {
+        HandleManager watchdog { CreateThread( nullptr, 0, WatchdogThread, this, 0, nullptr ) };
 
-                    if (!data.contains( "EIP" ) || !data["EIP"].is_string())
-                    {
-                        LOG_WARNING( "'EIP' field missing or invalid at index '{}'.", i );
-                        continue;
-                    }
+        if (!watchdog.IsValid())
+            LOG_WARNING( "Failed to start the watchdog thread. Last error is '{}'.", GetLastError() );
+    }
 
-                    if (!data.contains( "Type" ) || !data["Type"].is_number_integer())
-                    {
-                        LOG_WARNING( "'Type' field missing or invalid at index '{}'.", i );
-                        continue;
-                    }
 
-                    // Extract the required addresses from the JSON fields.
-                    const auto func_addr = std::stoull( func_key, nullptr, 16 );
-                    const auto bp_addr = std::stoull( data["BP"].get<std::string>(), nullptr, 16 );
-                    const auto eip_addr = std::stoull( data["EIP"].get<std::string>(), nullptr, 16 );
+    // Saves every value to 'noceg.json' and ends the process once every entry is done.
+    [[noreturn]] void Finish()
+    {
+        if (auto res = m_AppManager->GetJSON().SaveJSON(); !res)
+        {
+            LOG_ERROR( "Failed to save 'noceg.json', the values are kept in the journal." );
+            ExitProcess( 1 );
+        }
 
-                    // Validate addresses are not zero.
-                    if (func_addr == 0 || bp_addr == 0 || eip_addr == 0)
-                    {
-                        LOG_WARNING( "One or more addresses are zero at index '{}'.", i );
-                        continue;
-                    }
+        m_Journal.Remove();
 
-                    m_AppManager->SetTargetAddress( static_cast<std::uintptr_t>(func_addr) );
-                    m_AppManager->SetEipAddress( static_cast<std::uintptr_t>(eip_addr) );
+        if (!m_CacheKeys.empty())
+        {
+            if (auto stored = m_Cache.Store( m_CacheKeys, m_Entries ))
+                LOG_INFO( "Cached '{}' new values.", *stored );
+            else
+                LOG_WARNING( "Failed to update the value cache ('{}').", static_cast<int>(stored.error()) );
+        }
 
-                    m_AppManager->GetBreakpointManager().SetBreakpoint( static_cast<std::uintptr_t>(bp_addr) );
+        if (const auto failed = std::ranges::count_if( m_Entries, &CEGEntry::m_Failed ))
+            LOG_WARNING( "'{}' entries timed out and keep their previous value.", failed );
 
-                    const auto type = data["Type"].get<int>();
+        if (const auto & metrics = m_AppManager->GetMetrics(); metrics.IsEnabled())
+        {
+            const auto metrics_path = m_AppManager->GetJSON().GetPath().parent_path() / "noceg_metrics.json";
 
-                    // Handle various CEG functions.
-                    // '1' - CEG constant functions.
-                    // '2' - Older CEG stolen/masked functions.
-                    // '3', '4' - CEG stolen/masked functions.
-                    switch (type)
-                    {
-                        case 2:
-                        {
-                            m_AppManager->SetExceptionHandler( CEGExceptionHandler );
-                            RaiseException( m_CustomExceptionCode, 0, 0, nullptr );
-                            break;
-                        }
-
-                        case 1:
-                        case 3:
-                        case 4:
-                        {
-                            // Attempt to call the CEG register thread function before proceeding with the exception.
-                            const auto ceg_registerthread_addr = m_AppManager->GetRegisterThreadAddress();
-                            if (ceg_registerthread_addr)
-                            {
-                                using CEG_RegisterThread_t = bool(*)();
-                                const auto register_thread = reinterpret_cast<CEG_RegisterThread_t>(ceg_registerthread_addr);
-                                register_thread();
-                            }
-
-                            RaiseException( m_CustomExceptionCode, 0, 0, nullptr );
-                            break;
-                        }
-                    }
-                }
-                catch (const std::invalid_argument & e)
-                {
-                    LOG_ERROR( "Failed to parse address at index '{}' ('{}').", i, e.what() );
-                    continue;
-                }
-                catch (const std::out_of_range & e)
-                {
-                    LOG_ERROR( "Address out of range at index '{}' ('{}').", i, e.what() );
-                    continue;
-                }
-                catch (const nlohmann::json::exception & e)
-                {
-                    LOG_ERROR( "JSON error at index '{}' ('{}').", i, e.what() );
-                    continue;
-                }
-                catch (const std::exception & e)
-                {
-                    LOG_ERROR( "Unexpected error at index '{}' ('{}').", i, e.what() );
-                    continue;
-                }
+            if (auto res = metrics.Save( metrics_path, m_Entries ); !res)
+                LOG_WARNING( "Failed to save '{}'.", metrics_path.filename().string() );
+        }
 
-                continue;
+        // Run by 'noceg_patcher --run', which patches the game from 'noceg.bin' once the event is signaled.
+        std::array<wchar_t, MAX_PATH> pipeline_event {};
+
+        if (const auto length = GetEnvironmentVariableW( CEG::PIPELINE_EVENT_VARIABLE, pipeline_event.data(), static_cast<DWORD>(pipeline_event.size()) );
+            length && length < pipeline_event.size())
+        {
+            if (!m_AppManager->GetJSON().UsesBinary())
+                LOG_ERROR( "The values are not in 'noceg.bin', the patcher cannot use them." );
+            else if (const auto event = OpenEventW( EVENT_MODIFY_STATE, FALSE, pipeline_event.data() ))
+            {
+                SetEvent( event );
+                CloseHandle( event );
+                ExitProcess( 0 );
             }
+            else
+                LOG_ERROR( "Failed to open the pipeline event. Last error is '{}'.", GetLastError() );
         }
 
         MessageBoxA( nullptr, "Successfully finished the task!", "NoCEG", MB_OK | MB_ICONINFORMATION );
         ExitProcess( 1 );
     }
 
+public:
+
+    explicit EntryProcessorManager( ApplicationManager * app )
+        : m_AppManager( app )
+    {}
+    
+
+    /**
+    * @brief Main loop to process the entries containing CEG function info.
+    *
+    * Iterates over the entry table converted from the 'ConstantOrStolen' array of the loaded JSON.
+    * Applies breakpoints and raises custom exception to trigger further handling, see 'RunEntry'.
+    * Every entry is claimed once, so several threads may process the entries at the same time.
+    */
+    void ProcessEntry()
+    {
+        // The CEG functions run on this area instead of the frames below the 'RaiseException' call.
+        std::array<std::byte, RESOLVE_STACK_SIZE> stack;
+        m_AppManager->SetStackTop( (reinterpret_cast<std::uintptr_t>(stack.data()) + stack.size() - RESOLVE_STACK_FRAME) & ~std::uintptr_t { 0xF } );
+
+        // The watchdog suspends and moves this thread through its handle.
+        if (auto & state = m_AppManager->GetThreadState(); m_Timeout && !state.m_Thread)
+        {
+            state.m_Thread = OpenThread( THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_SET_CONTEXT, FALSE, GetCurrentThreadId() );
+
+            if (!state.m_Thread)
+                LOG_WARNING( "Failed to open the resolving thread for the watchdog. Last error is '{}'.", GetLastError() );
+        }
+
+        for (auto claimed = m_AppManager->ClaimIndex(); claimed < m_Entries.size(); claimed = m_AppManager->ClaimIndex())
+        {
+            const auto i = m_Order.empty() ? claimed : m_Order[claimed];
+            const auto & entry = m_Entries[i];
+
+            // Only handle valid entries where the function hasn't been processed or has timed out.
+            if (!entry.m_Type || entry.m_Resolved || entry.m_Failed)
+                continue;
+
+            const auto value = RunEntry( i );
+            if (!value)
+                continue;
+
+            if (m_RestartStrategy == RestartStrategy::Poisoned)
+                SavePoisonChecked( i, *value );
+            else if (SaveResult( i, *value ) && m_RestartStrategy == RestartStrategy::Always)
+            {
+                // The journal already holds the value for the next launch.
+                Restart();
+            }
+        }
+
+        // The workers return to their thread function, the last one to exit ends the process.
+        if (!m_AppManager->GetThreadState().m_IsWorker)
+            Finish();
+    }
+
 
     /**
     * @brief Initializes the necessary state and begins entry processing.
     *
     * Loads JSON configuration, extracts function pointers, sets up exception handler,
     * and begins processing entries if core CEG function addresses were found.
+    * With more than one worker thread nothing is processed yet, 'Run' has to be called
+    * from a thread which does not hold the loader lock.
     *
     * @return 'std::expected<void, Error>' Either success or error.
     */
@@ -215,13 +616,21 @@ public:
 
         const auto & json = config.ReadData();
 
+        // Write the log from a background thread, the resolution mostly logs from the exception handler.
+        if (const auto async_log = json.value( "AsyncLog", std::string { "Off" } ); async_log == "Drop")
+            Log::Logger::StartAsync( Log::OverflowPolicy::DROP );
+        else if (async_log == "Block")
+            Log::Logger::StartAsync( Log::OverflowPolicy::BLOCK );
+        else if (async_log != "Off")
+            LOG_WARNING( "Unknown 'AsyncLog' '{}', logging on the calling thread.", async_log );
+
         // Safe check for 'Init' field.
         if (!json.contains( "Init" ) || !json["Init"].is_string())
         {
             return std::unexpected { Error::CEGInitFunctionNotFound };
         }
 
-        const auto ceg_init_addr = std::stoull( json["Init"].get<std::string>(), nullptr, 16 );
+        m_InitAddress = static_cast<std::uintptr_t>(std::stoull( json["Init"].get<std::string>(), nullptr, 16 ));
 
         // Safe check for 'RegisterThread' field.
         if (!json.contains( "RegisterThread" ) || !json["RegisterThread"].is_string())
@@ -232,25 +641,230 @@ public:
         const auto ceg_registerthread_addr = std::stoull( json["RegisterThread"].get<std::string>(), nullptr, 16 );
 
         m_AppManager->SetRegisterThreadAddress( static_cast<std::uintptr_t>(ceg_registerthread_addr) );
+
+        if (json.value( "ShouldRestart", false ))
+        {
+            const auto strategy = json.value( "RestartStrategy", std::string { "Always" } );
+
+            if (strategy == "Poisoned")
+                m_RestartStrategy = RestartStrategy::Poisoned;
+            else
+            {
+                if (strategy != "Always")
+                    LOG_WARNING( "Unknown 'RestartStrategy' '{}', restarting after every entry.", strategy );
+
+                m_RestartStrategy = RestartStrategy::Always;
+            }
+        }
+
+        // One worker per thread, a restart between the entries leaves nothing to run concurrently.
+        auto workers = std::clamp<std::uint32_t>( json.value( "Threads", 1u ), 1, MAXIMUM_WAIT_OBJECTS );
+
+        if (workers > 1 && m_RestartStrategy != RestartStrategy::Never)
+        {
+            LOG_WARNING( "'Threads' is ignored with 'ShouldRestart' enabled." );
+            workers = 1;
+        }
+
+        m_AppManager->SetWorkerCount( workers );
+
+        // Hardware breakpoints leave the code untouched, which keeps CEG integrity checks quiet.
+        // The workers always use them, the debug registers are private to each thread.
+        m_AppManager->SetUseHardwareBreakpoints( workers > 1 || json.value( "HardwareBreakpoints", false ) );
+
+        if (m_AppManager->UseHardwareBreakpoints())
+            LOG_INFO( "Using hardware breakpoints." );
+
+        // The tables of 'noceg.bin' are mapped instead of converting the JSON array.
+        if (config.OpenBinary())
+            LOG_INFO( "Reading the entries from the binary configuration." );
+
+        // Validate and convert the entries once, the JSON is only touched again to save the values.
+        auto entries = config.ReadEntries();
+        if (!entries)
+            return std::unexpected { entries.error() };
+
+        m_Entries = std::move( *entries );
+
+        // Timestamp the resolution phases of every entry for 'noceg_metrics.json'.
+        if (json.value( "Metrics", false ))
+            m_AppManager->GetMetrics().Enable( m_Entries.size() );
+
+        // Trace every exception to 'noceg_trace_<pid>_<tid>.bin', holding up to "Trace" records per thread.
+        if (const auto trace = json.value( "Trace", 0u ))
+        {
+            if (m_AppManager->GetTracer().Enable( config.GetPath().parent_path(), trace ))
+                LOG_INFO( "Tracing up to '{}' exceptions per thread.", trace );
+            else
+                LOG_ERROR( "The trace capacity '{}' exceeds the limit of '{}' records, tracing is disabled.", trace, EventTracer::GetMaxCapacity() );
+        }
+
+        // Resume from the values resolved by a previous launch.
+        auto journal_path = config.GetPath();
+        journal_path.replace_extension( ".journal" );
+
+        if (auto replayed = m_Journal.Open( journal_path, m_Entries, json.value( "JournalFlush", 0u ) ))
+        {
+            for (const auto index : *replayed)
+                config.UpdateEntry( index, m_Entries[index].m_Value );
+
+            if (!replayed->empty())
+                LOG_INFO( "Replayed '{}' values from '{}'.", replayed->size(), journal_path.filename().string() );
+        }
+        else
+        {
+            LOG_WARNING( "Failed to open '{}', saving 'noceg.json' after every entry.", journal_path.filename().string() );
+
+            // The poisoning entries would be forgotten by the next launch.
+            if (m_RestartStrategy == RestartStrategy::Poisoned)
+            {
+                LOG_WARNING( "'RestartStrategy' 'Poisoned' needs the journal, restarting after every entry." );
+                m_RestartStrategy = RestartStrategy::Always;
+            }
+        }
+
+        // Take the values of the functions another title already resolved on this machine.
+        if (json.value( "Cache", false ))
+        {
+            const auto cache_path = ValueCache::DefaultPath( config.GetPath().parent_path() / "noceg.cache" );
+
+            if (auto cached = m_Cache.Load( cache_path ))
+            {
+                m_CacheKeys = m_Cache.Keys( m_Entries );
+
+                std::size_t hits = 0;
+
+                for (std::size_t i = 0; i < m_Entries.size(); ++i)
+                {
+                    auto & entry = m_Entries[i];
+                    if (!entry.m_Type || entry.m_Resolved)
+                        continue;
+
+                    if (const auto value = m_Cache.Find( m_CacheKeys[i] ))
+                    {
+                        entry.m_Value = *value;
+                        entry.m_Resolved = true;
+
+                        config.UpdateEntry( i, *value );
+                        ++hits;
+                    }
+                }
+
+                LOG_INFO( "Took '{}' of '{}' cached values from '{}'.", hits, *cached, cache_path.string() );
+            }
+            else
+                LOG_WARNING( "Failed to read '{}'.", cache_path.string() );
+        }
+
+        // The known poisoning entries are resolved first, each of them right after a restart.
+        if (m_RestartStrategy == RestartStrategy::Poisoned)
+        {
+            m_Order.resize( m_Entries.size() );
+            std::iota( m_Order.begin(), m_Order.end(), std::size_t { 0 } );
+
+            std::ranges::stable_partition( m_Order, [this]( std::size_t index )
+            {
+                return m_Entries[index].m_Poisons;
+            } );
+        }
+
+        // Room for a breakpoint per entry, so setting them does not allocate later.
+        m_AppManager->GetBreakpointManager().Reserve( m_Entries.size() );
+
         m_AppManager->SetExceptionHandler( CEGExceptionHandler );
 
+        // Skip the entries which do not hit their breakpoint in time.
+        if (m_TimeoutMs = json.value( "Timeout", 0u ); m_TimeoutMs)
+        {
+            LARGE_INTEGER frequency {};
+            QueryPerformanceFrequency( &frequency );
+
+            m_Timeout = frequency.QuadPart * m_TimeoutMs / 1000;
+            LOG_INFO( "Skipping the entries which take longer than '{}' ms.", m_TimeoutMs );
+        }
+
+        if (IsDetached())
+        {
+            if (workers > 1)
+                LOG_INFO( "Resolving entries on '{}' threads.", workers );
+
+            return {};
+        }
+
+        return Run();
+    }
+
+
+    /**
+    * @brief Checks if the resolution has to run outside of the loader lock.
+    *
+    * The worker threads and the watchdog cannot start before the loader lock is released,
+    * 'Run' has to be called from another thread then.
+    *
+    * @return true if 'Initialize' left the resolution to 'Run', false otherwise.
+    */
+    [[nodiscard]] bool IsDetached() const noexcept
+    {
+        return m_AppManager->GetWorkerCount() > 1 || m_Timeout;
+    }
+
+
+    /**
+    * @brief Initializes CEG and resolves every entry.
+    *
+    * Runs on the current thread with a single worker. Otherwise the worker threads are started
+    * and waited for, which would deadlock under the loader lock. So would the watchdog, see 'IsDetached'.
+    *
+    * @return 'std::expected<void, Error>' Error, the process ends once every entry is resolved.
+    * Returns success if the CEG init function failed.
+    */
+    [[nodiscard]] std::expected<void, Error> Run()
+    {
         using CEG_Init_t = bool(*)();
-        const auto ceg_init = reinterpret_cast<CEG_Init_t>(ceg_init_addr);
+        const auto ceg_init = reinterpret_cast<CEG_Init_t>(m_InitAddress);
 
         // If the CEG init function is valid and returns true, begin processing.
-        if (ceg_init && ceg_init())
-        {
-            /*
-            const auto ceg_version = json["Version"].get<std::uint32_t>();
+        if (!ceg_init || !ceg_init())
+            return {};
+
+        /*
+        const auto ceg_version = json["Version"].get<std::uint32_t>();
 
-            // Apply the slight delay for the newer CEG version.
-            if (ceg_version > 1)
-               Sleep( 100 );
-            */
+        // Apply the slight delay for the newer CEG version.
+        if (ceg_version > 1)
+           Sleep( 100 );
+        */
+
+        if (m_AppManager->GetWorkerCount() == 1)
+        {
+            if (m_Timeout)
+                StartWatchdog();
 
             ProcessEntry();
+            return {};
+        }
+
+        std::vector<HANDLE> threads {};
+
+        for (std::uint32_t i = 0; i < m_AppManager->GetWorkerCount(); ++i)
+        {
+            if (auto * thread = CreateThread( nullptr, 0, WorkerThread, &m_AppManager->AddWorkerState(), 0, nullptr ))
+                threads.push_back( thread );
+            else
+                LOG_WARNING( "Failed to start worker thread '{}'. Last error is '{}'.", i, GetLastError() );
         }
 
-        return {};
+        if (threads.empty())
+            return std::unexpected { Error::ThreadCreateFailed };
+
+        if (m_Timeout)
+            StartWatchdog();
+
+        WaitForMultipleObjects( static_cast<DWORD>(threads.size()), threads.data(), TRUE, INFINITE );
+
+        for (auto * thread : threads)
+            CloseHandle( thread );
+
+        Finish();
     }
-};
+};
\ No newline at end of file
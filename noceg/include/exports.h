@@ -14,6 +14,64 @@
 
 #pragma once
 
+// Names of the forwarded SteamAPI exports, resolved at once by 'SteamAPIWrapper::Initialize'.
+inline constexpr std::array<std::string_view, 35> STEAM_EXPORTS =
+{
+    "SteamAPI_GetHSteamPipe",
+    "SteamAPI_GetHSteamUser",
+    "SteamAPI_Init",
+    "SteamAPI_InitSafe",
+    "SteamAPI_IsSteamRunning",
+    "SteamAPI_Shutdown",
+    "SteamAPI_RunCallbacks",
+    "SteamAPI_RestartAppIfNecessary",
+    "SteamAPI_SetMiniDumpComment",
+    "SteamAPI_WriteMiniDump",
+    "SteamAPI_RegisterCallback",
+    "SteamAPI_UnregisterCallback",
+    "SteamAPI_RegisterCallResult",
+    "SteamAPI_UnregisterCallResult",
+    "SteamClient",
+    "SteamUser",
+    "SteamFriends",
+    "SteamUtils",
+    "SteamMasterServerUpdater",
+    "SteamMatchmaking",
+    "SteamMatchmakingServers",
+    "SteamUserStats",
+    "SteamApps",
+    "SteamNetworking",
+    "SteamRemoteStorage",
+    "SteamScreenshots",
+    "SteamGameServer",
+    "SteamGameServerNetworking",
+    "SteamGameServerUtils",
+    "SteamGameServer_BSecure",
+    "SteamGameServer_GetSteamID",
+    "SteamGameServer_Init",
+    "SteamGameServer_Shutdown",
+    "SteamGameServer_RunCallbacks",
+    "SteamGameServerStats"
+};
+
+
+/**
+* @brief Gets the index of a forwarded export inside 'STEAM_EXPORTS'.
+*
+* @param name The name of the export.
+* @return The index of the export, a name missing from the list fails to compile.
+*/
+consteval std::size_t SteamExportIndex(
+    std::string_view name
+)
+{
+    const auto it = std::ranges::find( STEAM_EXPORTS, name );
+    if (it == STEAM_EXPORTS.end())
+        throw "The export is missing from 'STEAM_EXPORTS'.";
+
+    return static_cast<std::size_t>(it - STEAM_EXPORTS.begin());
+}
+
 // Forwarded SteamAPI exports.
 FORWARD_EXPORT_SIMPLE( std::uint32_t, SteamAPI_GetHSteamPipe )
 FORWARD_EXPORT_SIMPLE( std::uint32_t, SteamAPI_GetHSteamUser )
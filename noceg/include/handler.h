@@ -14,16 +14,38 @@
 
 #pragma once
 
-// Automatically restarts the current application if the restart flag is set.
-static void RestartApp()
+/**
+ * @brief Records the value of the entry whose breakpoint has just been hit and returns to the driver loop.
+ *
+ * The context saved by the custom exception is restored, so the 'RaiseException' call
+ * of 'EntryProcessorManager::ProcessEntry' returns and the next entry starts from a flat stack.
+ *
+ * @param state The application state.
+ * @param ctx The context of the breakpoint exception.
+ * @param code The code of the breakpoint exception.
+ * @param index Index of the resolved entry in the "ConstantOrStolen" array.
+ */
+static void ResolveEntry(
+    ApplicationManager * state,
+    CONTEXT * ctx,
+    DWORD code,
+    std::size_t index
+) noexcept
 {
-    auto * state = ApplicationManager::GetInstance();
-    if (state->GetShouldRestart())
-    {
-        // Attempt to restart the application.
-        if (auto res = ProcessManager::SelfRestart(); !res)
-            LOG_ERROR( "Error restarting app '0x{:08X}'", static_cast<int>(res.error()) );
-    }
+    state->GetMetrics().Stamp( index, ResolvePhase::BreakpointHit );
+    state->GetTracer().Emit( code, ctx->Eip, ctx->Eax, index, TRACE_RESOLVED );
+
+    LOG_INFO( "Breakpoint just being hit, EAX value is '0x{:08X}'.", ctx->Eax );
+
+    state->SetResult( index, ctx->Eax );
+
+    // Restore the previously saved context, and the SEH chain which still points into the frames on the reserved stack.
+    *ctx = *state->GetContext();
+    state->RestoreExceptionList();
+
+    // The hit breakpoint is gone, so are the debug registers it used.
+    if (state->UseHardwareBreakpoints())
+        state->GetHardwareBreakpointManager().Apply( *ctx );
 }
 
 
@@ -45,13 +67,23 @@ LONG CALLBACK CEGExceptionHandler(
         case 0xCEADDEAD:
         {
             LOG_INFO( "Custom exception reached '0xCEADDEAD'." );
+            state->GetTracer().Emit( code, ctx->Eip, ctx->Eax, state->GetCurrentIndex() );
 
-            // Save the current CPU context for future use.
+            // Save the current CPU context, it is restored once the breakpoint is hit.
             state->SetContext( ctx );
             ctx->Eip = static_cast<DWORD>(state->GetEipAddress());
+            state->GetMetrics().Stamp( state->GetCurrentIndex(), ResolvePhase::Redirect );
 
             LOG_INFO( "Changing EIP to '0x{:08X}'.", ctx->Eip );
 
+            // Run the function on the area reserved by the driver loop, so the saved context stays intact.
+            ctx->Esp = static_cast<DWORD>(state->GetStackTop());
+            ctx->Ebp = ctx->Esp;
+
+            // Load the hardware breakpoints into the debug registers of this thread.
+            if (state->UseHardwareBreakpoints())
+                state->GetHardwareBreakpointManager().Apply( *ctx );
+
             // Set trap flag to trigger a single-step exception after the next instruction.
             ctx->EFlags |= 0x100;
 
@@ -60,8 +92,23 @@ LONG CALLBACK CEGExceptionHandler(
 
         case EXCEPTION_SINGLE_STEP:
         {
-            if (ctx->Eip == state->GetTargetAddress())
+            // 'Dr6' tells which hardware breakpoint has been hit.
+            if (state->UseHardwareBreakpoints())
             {
+                if (const auto entry = state->GetHardwareBreakpointManager().Hit( *ctx ))
+                {
+                    ResolveEntry( state, ctx, code, *entry );
+                    return EXCEPTION_CONTINUE_EXECUTION;
+                }
+            }
+
+            const auto reached = ctx->Eip == state->GetTargetAddress();
+            state->GetTracer().Emit( code, ctx->Eip, ctx->Eax, state->GetCurrentIndex(), reached ? TRACE_TARGET : 0 );
+
+            if (reached)
+            {
+                state->GetMetrics().Stamp( state->GetCurrentIndex(), ResolvePhase::TargetReached );
+
                 LOG_INFO( "Target CEG function reached '0x{:08X}'.", ctx->Eip );
 
                 // Clear trap flag.
@@ -73,45 +120,10 @@ LONG CALLBACK CEGExceptionHandler(
 
         case EXCEPTION_BREAKPOINT:
         {
-            auto & bp = state->GetBreakpointManager();
-            if (ctx->Eip == bp.GetAddress())
+            // The breakpoint at 'EIP' tells which entry has just been resolved.
+            if (const auto entry = state->GetBreakpointManager().RemoveBreakpoint( ctx->Eip ))
             {
-                bp.RemoveBreakpoint();
-                LOG_INFO( "Breakpoint just being hit, EAX value is '0x{:08X}'.", ctx->Eax );
-
-                auto & config = state->GetJSON();
-                const auto & json = config.ReadData();
-                const auto index = state->GetCurrentIndex();
-
-                if (index < json["ConstantOrStolen"].size())
-                {
-                    // Update the JSON entry with the result value from EAX.
-                    config.UpdateEntry( index, ctx->Eax );
-
-                    if (auto res = config.SaveJSON(); !res)
-                        LOG_WARNING( "Failed to update an entry inside 'noceg.json'." );
-                    else
-                    {
-                        if (json.value( "ShouldRestart", false ))
-                        {
-                            LOG_INFO( "Setting the restart flag." );
-                            state->SetShouldRestart();
-
-                            // Change EIP to point to the restart function.
-                            ctx->Eip = reinterpret_cast<DWORD>(RestartApp);
-                        }
-                        else
-                        {
-                            // Restore the previously saved context.
-                            ctx = state->GetContext();
-                            state->SetCurrentIndex( index + 1 );
-
-                            // Continue to next entry.
-                            state->GetEntryProcessorManager().ProcessEntry();
-                        }
-                    }
-                }
-
+                ResolveEntry( state, ctx, code, *entry );
                 return EXCEPTION_CONTINUE_EXECUTION;
             }
 
@@ -122,6 +134,8 @@ LONG CALLBACK CEGExceptionHandler(
         case EXCEPTION_ILLEGAL_INSTRUCTION:
         {
             auto * state = ApplicationManager::GetInstance();
+            state->GetTracer().Emit( code, ctx->Eip, ctx->Eax, state->GetCurrentIndex() );
+
             if (state->GetShouldRestart())
             {
                 LOG_WARNING( "Caught some illegal instruction, forcing exit." );
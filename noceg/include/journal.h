@@ -0,0 +1,344 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "reader.h"
+
+// Append-only log of the resolved values, replayed after a crash or a restart.
+class ResultJournal
+{
+private:
+
+    // Magic value of the journal header, 'NCJ1'.
+    static constexpr std::uint32_t JOURNAL_MAGIC = 0x314A434E;
+
+    // Header identifying the entry table the journal belongs to.
+    struct Header
+    {
+        std::uint32_t m_Magic { JOURNAL_MAGIC };
+
+        // Number of the entries in the table.
+        std::uint32_t m_Count { 0 };
+
+        // FNV-1a hash of the addresses and types of every entry.
+        std::uint64_t m_Hash { 0 };
+    };
+
+    // Index flag of a record marking an entry which poisons the process state, the value is unused.
+    static constexpr std::uint32_t POISONED_FLAG = 0x80000000;
+
+    // Index flag of a record marking an entry which did not resolve in time, the value is unused.
+    static constexpr std::uint32_t FAILED_FLAG = 0x40000000;
+
+    // A single resolved value.
+    struct Record
+    {
+        std::uint32_t m_Index { 0 };
+        std::uint32_t m_Value { 0 };
+    };
+
+    // Handle to the journal file.
+    HANDLE m_File { INVALID_HANDLE_VALUE };
+
+    // Path to the journal file.
+    fs::path m_Path {};
+
+    // Number of the appended records between two 'FlushFileBuffers' calls, '0' leaves it to the system.
+    std::uint32_t m_FlushInterval { 0 };
+
+    // Number of the records appended since the last flush.
+    std::uint32_t m_Pending { 0 };
+
+
+    /**
+     * @brief Hashes the part of the entry table which identifies it.
+     *
+     * @param entries The entry table.
+     * @return FNV-1a hash of the addresses and types of every entry.
+     */
+    [[nodiscard]] static std::uint64_t HashEntries(
+        std::span<const CEGEntry> entries
+    ) noexcept
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+
+        // Lambda function to mix a value into the hash.
+        auto mix = [&hash]( std::uint64_t value )
+        {
+            for (std::size_t i = 0; i < sizeof( value ); ++i)
+            {
+                hash ^= (value >> (i * 8)) & 0xFF;
+                hash *= 0x100000001B3ull;
+            }
+        };
+
+        for (const auto & entry : entries)
+        {
+            mix( entry.m_Func );
+            mix( entry.m_Eip );
+            mix( entry.m_Bp );
+            mix( entry.m_Type );
+        }
+
+        return hash;
+    }
+
+
+    /**
+     * @brief Reads the records of an existing journal.
+     *
+     * @param header The header expected for the current entry table.
+     * @param records [out] The records of the journal.
+     * @return true if the journal belongs to the entry table, false otherwise.
+     */
+    [[nodiscard]] bool ReadRecords(
+        const Header & header,
+        std::vector<Record> & records
+    ) noexcept
+    {
+        LARGE_INTEGER size {};
+        if (!GetFileSizeEx( m_File, &size ) || size.QuadPart < static_cast<LONGLONG>(sizeof( Header )))
+            return false;
+
+        Header stored {};
+        DWORD read = 0;
+
+        if (!ReadFile( m_File, &stored, sizeof( stored ), &read, nullptr ) || read != sizeof( stored ) ||
+            stored.m_Magic != header.m_Magic || stored.m_Count != header.m_Count || stored.m_Hash != header.m_Hash)
+            return false;
+
+        // A record torn by a crash is dropped.
+        const auto count = static_cast<std::size_t>((size.QuadPart - sizeof( Header )) / sizeof( Record ));
+
+        try
+        {
+            records.resize( count );
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        const auto bytes = static_cast<DWORD>(count * sizeof( Record ));
+        if (bytes && (!ReadFile( m_File, records.data(), bytes, &read, nullptr ) || read != bytes))
+            return false;
+
+        // The next records are appended right behind the last complete one.
+        LARGE_INTEGER end {};
+        end.QuadPart = static_cast<LONGLONG>(sizeof( Header ) + bytes);
+
+        return SetFilePointerEx( m_File, end, nullptr, FILE_BEGIN ) && SetEndOfFile( m_File );
+    }
+
+
+    /**
+     * @brief Appends a single record.
+     *
+     * @param record The record to append.
+     * @return true if the record is written, false otherwise.
+     */
+    bool Write(
+        const Record & record
+    ) noexcept
+    {
+        if (m_File == INVALID_HANDLE_VALUE)
+            return false;
+
+        DWORD written = 0;
+
+        if (!WriteFile( m_File, &record, sizeof( record ), &written, nullptr ) || written != sizeof( record ))
+            return false;
+
+        if (m_FlushInterval && ++m_Pending >= m_FlushInterval)
+        {
+            FlushFileBuffers( m_File );
+            m_Pending = 0;
+        }
+
+        return true;
+    }
+
+public:
+
+    ResultJournal() = default;
+
+    ResultJournal( const ResultJournal & ) = delete;
+    ResultJournal & operator=( const ResultJournal & ) = delete;
+
+    ~ResultJournal() noexcept
+    {
+        Close();
+    }
+
+
+    /**
+     * @brief Opens the journal of an entry table and replays its records.
+     *
+     * A journal written for another entry table is discarded and started over.
+     *
+     * @param path Path to the journal file.
+     * @param entries [in, out] The entry table, the replayed values are marked as resolved
+     * and the recorded poisoning and failed entries are flagged.
+     * @param flush_interval Number of the appended records between two 'FlushFileBuffers' calls, '0' never flushes.
+     * @return 'std::expected<std::vector<std::size_t>, Error>' Either the indices of the replayed entries or an error.
+     * @retval 'JournalOpenFailed' if the journal cannot be opened or created.
+     */
+    [[nodiscard]] std::expected<std::vector<std::size_t>, Error> Open(
+        const fs::path & path,
+        std::span<CEGEntry> entries,
+        std::uint32_t flush_interval
+    ) noexcept
+    {
+        Close();
+
+        m_Path = path;
+        m_FlushInterval = flush_interval;
+        m_File = CreateFileW( path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+
+        if (m_File == INVALID_HANDLE_VALUE)
+            return std::unexpected { Error::JournalOpenFailed };
+
+        const Header header { JOURNAL_MAGIC, static_cast<std::uint32_t>(entries.size()), HashEntries( entries ) };
+
+        std::vector<Record> records {};
+        std::vector<std::size_t> replayed {};
+
+        if (ReadRecords( header, records ))
+        {
+            for (const auto & record : records)
+            {
+                if (record.m_Index & (POISONED_FLAG | FAILED_FLAG))
+                {
+                    if (const auto index = record.m_Index & ~(POISONED_FLAG | FAILED_FLAG); index < entries.size())
+                    {
+                        entries[index].m_Poisons |= (record.m_Index & POISONED_FLAG) != 0;
+                        entries[index].m_Failed |= (record.m_Index & FAILED_FLAG) != 0;
+                    }
+
+                    continue;
+                }
+
+                if (record.m_Index >= entries.size() || entries[record.m_Index].m_Resolved)
+                    continue;
+
+                entries[record.m_Index].m_Value = record.m_Value;
+                entries[record.m_Index].m_Resolved = true;
+
+                try
+                {
+                    replayed.push_back( record.m_Index );
+                }
+                catch (...)
+                {
+                    return std::unexpected { Error::JournalOpenFailed };
+                }
+            }
+
+            return replayed;
+        }
+
+        // Start over with an empty journal.
+        LARGE_INTEGER start {};
+        DWORD written = 0;
+
+        if (!SetFilePointerEx( m_File, start, nullptr, FILE_BEGIN ) || !SetEndOfFile( m_File ) ||
+            !WriteFile( m_File, &header, sizeof( header ), &written, nullptr ) || written != sizeof( header ))
+        {
+            Close();
+            return std::unexpected { Error::JournalOpenFailed };
+        }
+
+        return replayed;
+    }
+
+
+    /**
+     * @brief Appends a resolved value.
+     *
+     * The record reaches the system cache at once, so it survives a crash or a restart of the process.
+     *
+     * @param index Index of the entry in the "ConstantOrStolen" array.
+     * @param value The resolved value.
+     * @return true if the record is written, false otherwise.
+     */
+    bool Append(
+        std::size_t index,
+        std::uint32_t value
+    ) noexcept
+    {
+        return Write( Record { static_cast<std::uint32_t>(index), value } );
+    }
+
+
+    /**
+     * @brief Records an entry which poisons the process state, the next launches resolve it first.
+     *
+     * @param index Index of the entry in the "ConstantOrStolen" array.
+     * @return true if the record is written, false otherwise.
+     */
+    bool AppendPoisoned(
+        std::size_t index
+    ) noexcept
+    {
+        return Write( Record { static_cast<std::uint32_t>(index) | POISONED_FLAG, 0 } );
+    }
+
+
+    /**
+     * @brief Records an entry which did not resolve in time, the next launches skip it.
+     *
+     * @param index Index of the entry in the "ConstantOrStolen" array.
+     * @return true if the record is written, false otherwise.
+     */
+    bool AppendFailed(
+        std::size_t index
+    ) noexcept
+    {
+        return Write( Record { static_cast<std::uint32_t>(index) | FAILED_FLAG, 0 } );
+    }
+
+
+    /**
+     * @brief Checks if the journal is open.
+     *
+     * @return true if the records can be appended, false otherwise.
+     */
+    [[nodiscard]] bool IsOpen() const noexcept
+    {
+        return m_File != INVALID_HANDLE_VALUE;
+    }
+
+
+    // Closes the journal file.
+    void Close() noexcept
+    {
+        if (m_File != INVALID_HANDLE_VALUE)
+            CloseHandle( m_File );
+
+        m_File = INVALID_HANDLE_VALUE;
+        m_Pending = 0;
+    }
+
+
+    // Closes and deletes the journal once its values are saved in the configuration.
+    void Remove() noexcept
+    {
+        Close();
+
+        std::error_code ec {};
+        fs::remove( m_Path, ec );
+    }
+};
\ No newline at end of file
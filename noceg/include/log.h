@@ -14,20 +14,37 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <format>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <ostream>
 #include <syncstream>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 
 namespace fs = std::filesystem;
 
+// Minimum log level compiled in, '0' - debug, '1' - info, '2' - warning, '3' - error.
+// Calls below it are removed together with the evaluation of their arguments.
+#ifndef NOCEG_LOG_MIN_LEVEL
+    #ifdef _DEBUG
+        #define NOCEG_LOG_MIN_LEVEL 0
+    #else
+        #define NOCEG_LOG_MIN_LEVEL 1
+    #endif
+#endif
+
 namespace Log
 {
     // Supported log levels.
@@ -64,6 +81,29 @@ namespace Log
         return '?';
     }
 
+    /**
+    * @brief Checks if the messages of a log level are compiled in, see 'NOCEG_LOG_MIN_LEVEL'.
+    *
+    * @param lvl The log level to check.
+    * @return true if the messages are kept, false if they are removed.
+    */
+    constexpr bool IsCompiled(
+        LogLevel lvl
+    ) noexcept
+    {
+        return static_cast<int>(lvl) >= NOCEG_LOG_MIN_LEVEL;
+    }
+
+    // Behavior of the asynchronous mode once its ring buffer is full.
+    enum class OverflowPolicy : std::uint8_t
+    {
+        // The message is dropped and counted, the count is logged with the next written messages.
+        DROP = 0,
+
+        // The producer writes the queued messages itself until there is room again.
+        BLOCK
+    };
+
     // A simple thread safe logger class.
     class Logger
     {
@@ -84,6 +124,266 @@ namespace Log
         // Pointer to the active log output stream.
         inline static std::ostream * m_LogStream = nullptr;
 
+        // Number of the messages the ring buffer of the asynchronous mode holds, a power of two.
+        static constexpr std::size_t RING_SIZE = 1024;
+
+        // Room for the captured arguments of a message.
+        static constexpr std::size_t ARGUMENT_SIZE = 128;
+
+        // A message queued by the asynchronous mode, formatted once it is written.
+        struct Message
+        {
+            // Position of the ring buffer the slot is ready for, producers publish a message by advancing it.
+            std::atomic<std::size_t> m_Sequence { 0 };
+
+            LogLevel m_Level { LogLevel::INFO };
+
+            // Time the message was logged at.
+            std::chrono::system_clock::time_point m_Time {};
+
+            // The format string, a literal outliving the message.
+            std::string_view m_Format {};
+
+            // Formats the captured arguments and destroys them.
+            void (*m_Render)( Message &, std::string & ) { nullptr };
+
+            // Storage of the captured arguments.
+            alignas(std::max_align_t) std::array<std::byte, ARGUMENT_SIZE> m_Arguments {};
+        };
+
+        // Type an argument is captured as, views of strings are copied since the message outlives them.
+        template<typename T>
+        using Captured = std::conditional_t<std::is_convertible_v<const std::decay_t<T> &, std::string_view>,
+            std::string, std::decay_t<T>>;
+
+        // Indicates whether the messages are queued for the writer thread.
+        inline static std::atomic_bool m_Async = false;
+
+        // Policy applied once the ring buffer is full.
+        inline static std::atomic<OverflowPolicy> m_Policy = OverflowPolicy::DROP;
+
+        // Ring buffer of the queued messages.
+        inline static std::unique_ptr<Message[]> m_Ring;
+
+        // Next position claimed by a producer.
+        inline static std::atomic<std::size_t> m_Head = 0;
+
+        // Next position written, only touched by the holder of 'm_Draining'.
+        inline static std::size_t m_Tail = 0;
+
+        // Held by the thread writing the queued messages.
+        inline static std::atomic_flag m_Draining;
+
+        // Number of the messages dropped since the last written one.
+        inline static std::atomic<std::size_t> m_Dropped = 0;
+
+        // Bumped for every queued message, the writer thread waits on it.
+        inline static std::atomic<std::uint32_t> m_Signal = 0;
+
+        // Indicates whether the writer thread keeps running, and whether it has stopped.
+        inline static std::atomic_bool m_WriterRunning = false;
+        inline static std::atomic_bool m_WriterStopped = false;
+
+
+        /**
+        * @brief Writes a single line to the log stream.
+        *
+        * @param lvl The level of the message.
+        * @param time Time the message was logged at.
+        * @param msg The formatted message.
+        */
+        static void WriteLine(
+            LogLevel lvl,
+            std::chrono::system_clock::time_point time,
+            std::string_view msg
+        )
+        {
+            *m_LogStream << std::format( "{:%Y-%m-%d %H:%M:%S}", time )
+                << " [" << LogLevelToString( lvl ) << "] "
+                << msg << '\n';
+        }
+
+
+        /**
+        * @brief Formats a queued message and destroys its captured arguments.
+        *
+        * @tparam Tuple Type of the captured arguments.
+        * @param message The queued message.
+        * @param out [out] The formatted message.
+        */
+        template<typename Tuple>
+        static void Render(
+            Message & message,
+            std::string & out
+        ) noexcept
+        {
+            auto * args = std::launder( reinterpret_cast<Tuple *>(message.m_Arguments.data()) );
+
+            try
+            {
+                out = std::apply( [&message]( auto &... values )
+                {
+                    return std::vformat( message.m_Format, std::make_format_args( values... ) );
+                }, *args );
+            }
+            catch (...)
+            {
+                out.assign( message.m_Format );
+            }
+
+            std::destroy_at( args );
+        }
+
+
+        /**
+        * @brief Writes every queued message.
+        *
+        * @param force If true, the messages are written even if another thread holds the ring buffer.
+        * Only used once the process is exiting and its other threads are gone.
+        */
+        static void Drain(
+            bool force
+        ) noexcept
+        {
+            if (m_Draining.test_and_set( std::memory_order_acquire ) && !force)
+                return;
+
+            // The holder of the mutex may be gone as well.
+            std::unique_lock lock { m_LogMutex, std::defer_lock };
+            if (!force)
+                lock.lock();
+
+            std::string msg {};
+            bool written = false;
+
+            try
+            {
+                if (const auto dropped = m_Dropped.exchange( 0, std::memory_order_relaxed ))
+                {
+                    WriteLine( LogLevel::WARNING, std::chrono::system_clock::now(),
+                        std::format( "Dropped '{}' log messages, the ring buffer was full.", dropped ) );
+
+                    written = true;
+                }
+
+                for (;; ++m_Tail)
+                {
+                    auto & message = m_Ring[m_Tail & (RING_SIZE - 1)];
+
+                    if (message.m_Sequence.load( std::memory_order_acquire ) != m_Tail + 1)
+                        break;
+
+                    message.m_Render( message, msg );
+                    WriteLine( message.m_Level, message.m_Time, msg );
+
+                    // The slot is free for the producers of the next round.
+                    message.m_Sequence.store( m_Tail + RING_SIZE, std::memory_order_release );
+                    written = true;
+                }
+
+                if (written)
+                    m_LogStream->flush();
+            }
+            catch (...)
+            {
+            }
+
+            m_Draining.clear( std::memory_order_release );
+        }
+
+
+        // Writes the queued messages in the background until the asynchronous mode is left.
+        static void WriterThread() noexcept
+        {
+            while (m_WriterRunning.load( std::memory_order_acquire ))
+            {
+                const auto signal = m_Signal.load( std::memory_order_acquire );
+
+                Drain( false );
+
+                // Returns at once if a message was queued after the load.
+                m_Signal.wait( signal, std::memory_order_acquire );
+            }
+
+            m_WriterStopped.store( true, std::memory_order_release );
+            m_WriterStopped.notify_all();
+        }
+
+
+        /**
+        * @brief Queues a message for the writer thread.
+        *
+        * Arguments which do not fit into a slot are formatted right away.
+        *
+        * @tparam Args Argument types for formatting.
+        * @param lvl The level of the message.
+        * @param fmt The format string.
+        * @param args The arguments to format.
+        */
+        template<typename... Args>
+        static void Push(
+            LogLevel lvl,
+            std::string_view fmt,
+            Args&&... args
+        )
+        {
+            using Tuple = std::tuple<Captured<Args>...>;
+
+            if constexpr (sizeof( Tuple ) > ARGUMENT_SIZE || alignof(Tuple) > alignof(std::max_align_t) ||
+                !std::is_nothrow_move_constructible_v<Tuple>)
+            {
+                Push( lvl, "{}", std::vformat( fmt, std::make_format_args( args... ) ) );
+            }
+            else
+            {
+                // Captured before a slot is claimed, a claimed slot has to be published.
+                Tuple captured( std::forward<Args>( args )... );
+                const auto time = std::chrono::system_clock::now();
+
+                auto pos = m_Head.load( std::memory_order_relaxed );
+
+                for (;;)
+                {
+                    auto & message = m_Ring[pos & (RING_SIZE - 1)];
+                    const auto diff = static_cast<std::ptrdiff_t>(message.m_Sequence.load( std::memory_order_acquire ) - pos);
+
+                    if (diff == 0)
+                    {
+                        if (!m_Head.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ))
+                            continue;
+
+                        message.m_Level = lvl;
+                        message.m_Time = time;
+                        message.m_Format = fmt;
+                        message.m_Render = &Render<Tuple>;
+                        std::construct_at( reinterpret_cast<Tuple *>(message.m_Arguments.data()), std::move( captured ) );
+
+                        message.m_Sequence.store( pos + 1, std::memory_order_release );
+
+                        m_Signal.fetch_add( 1, std::memory_order_release );
+                        m_Signal.notify_one();
+                        return;
+                    }
+
+                    if (diff < 0)
+                    {
+                        // The ring buffer is full.
+                        if (m_Policy.load( std::memory_order_relaxed ) == OverflowPolicy::DROP)
+                        {
+                            m_Dropped.fetch_add( 1, std::memory_order_relaxed );
+                            return;
+                        }
+
+                        // The writer thread may not run yet, e.g. under the loader lock.
+                        Drain( false );
+                        std::this_thread::yield();
+                    }
+
+                    pos = m_Head.load( std::memory_order_relaxed );
+                }
+            }
+        }
+
     public:
         
         /**
@@ -129,18 +429,80 @@ namespace Log
         }
         
         
+        /**
+        * @brief Queues the messages for a background writer thread from now on.
+        *
+        * The logging thread only captures the arguments into a lock-free ring buffer,
+        * the writer thread formats and writes them.
+        * Does nothing if logging is disabled or the mode is already active.
+        *
+        * @param policy Policy applied once the ring buffer is full.
+        */
+        static void StartAsync(
+            OverflowPolicy policy = OverflowPolicy::DROP
+        ) noexcept
+        {
+            if (!m_LogEnabled.load( std::memory_order_relaxed ) || m_Async.load( std::memory_order_acquire ))
+                return;
+
+            try
+            {
+                m_Ring = std::make_unique<Message[]>( RING_SIZE );
+
+                for (std::size_t i = 0; i < RING_SIZE; ++i)
+                    m_Ring[i].m_Sequence.store( i, std::memory_order_relaxed );
+
+                m_Policy.store( policy, std::memory_order_relaxed );
+                m_WriterRunning.store( true, std::memory_order_release );
+
+                std::thread( WriterThread ).detach();
+            }
+            catch (...)
+            {
+                m_WriterRunning.store( false, std::memory_order_release );
+                return;
+            }
+
+            m_Async.store( true, std::memory_order_release );
+        }
+
+
+        /**
+        * @brief Writes every queued message and leaves the asynchronous mode.
+        *
+        * @param terminating If true, the process is exiting and the writer thread is already gone.
+        */
+        static void Shutdown(
+            bool terminating
+        ) noexcept
+        {
+            if (!m_Async.exchange( false, std::memory_order_acq_rel ))
+                return;
+
+            m_WriterRunning.store( false, std::memory_order_release );
+
+            m_Signal.fetch_add( 1, std::memory_order_release );
+            m_Signal.notify_all();
+
+            if (!terminating)
+                m_WriterStopped.wait( false, std::memory_order_acquire );
+
+            Drain( terminating );
+        }
+
+
         /**
         * @brief Logs a formatted message if logging is enabled and the log level is sufficient.
         * 
         * @tparam Args Argument types for formatting.
         * @param lvl The level of the message.
-        * @param fmt The format string.
+        * @param fmt The format string, checked against the arguments at compile time.
         * @param args The arguments to format.
         */
         template<typename... Args>
         static void Log(
             LogLevel lvl,
-            std::string_view fmt,
+            std::format_string<Args...> fmt,
             Args&&... args
         )
         {
@@ -148,12 +510,19 @@ namespace Log
                 lvl < m_LogLevel.load( std::memory_order_relaxed ))
                 return;
 
+            // Formatted and written by the writer thread.
+            if (m_Async.load( std::memory_order_acquire ))
+            {
+                Push( lvl, fmt.get(), std::forward<Args>( args )... );
+                return;
+            }
+
             // Get the current timestamp.
             auto now = std::chrono::system_clock::now();
             auto ts = std::format( "{:%Y-%m-%d %H:%M:%S}", now );
 
             // Format the message string.
-            auto msg = std::vformat( fmt, std::make_format_args( args... ) );
+            auto msg = std::vformat( fmt.get(), std::make_format_args( args... ) );
 
             std::scoped_lock lock { m_LogMutex };
             std::osyncstream oss { *m_LogStream };
@@ -164,9 +533,12 @@ namespace Log
     };
 
 
+    // Removed at compile time below 'NOCEG_LOG_MIN_LEVEL', the format string is still checked.
+    #define NOCEG_LOG(lvl, ...) do { if constexpr (Log::IsCompiled(lvl)) Log::Logger::Log(lvl, __VA_ARGS__); } while (false)
+
     // Easy to access macros.
-    #define LOG_DEBUG(...) Log::Logger::Log(Log::LogLevel::DEBUG, __VA_ARGS__)
-    #define LOG_INFO(...) Log::Logger::Log(Log::LogLevel::INFO, __VA_ARGS__)
-    #define LOG_WARNING(...) Log::Logger::Log(Log::LogLevel::WARNING, __VA_ARGS__)
-    #define LOG_ERROR(...) Log::Logger::Log(Log::LogLevel::ERR, __VA_ARGS__)
+    #define LOG_DEBUG(...) NOCEG_LOG(Log::LogLevel::DEBUG, __VA_ARGS__)
+    #define LOG_INFO(...) NOCEG_LOG(Log::LogLevel::INFO, __VA_ARGS__)
+    #define LOG_WARNING(...) NOCEG_LOG(Log::LogLevel::WARNING, __VA_ARGS__)
+    #define LOG_ERROR(...) NOCEG_LOG(Log::LogLevel::ERR, __VA_ARGS__)
 }
@@ -69,94 +69,639 @@ public:
 };
 
 
-// Software breakpoint manager.
+// Software breakpoint manager, any number of breakpoints may be set at once.
 class BreakpointManager
 {
+public:
+
+    // A software breakpoint placed into the code.
+    struct Breakpoint
+    {
+        // Memory address where the breakpoint is set, '0' marks a free slot.
+        std::uintptr_t m_Address { 0 };
+
+        // Index of the "ConstantOrStolen" entry resolved once the breakpoint is hit.
+        std::size_t m_Index { 0 };
+
+        // Original byte value at the breakpoint address.
+        std::uint8_t m_BackupByte { 0 };
+    };
+
 private:
 
-    // Memory address where the breakpoint is set.
-    std::uintptr_t m_Address { 0 };
+    // Granularity of the protection changes.
+    static constexpr std::uintptr_t CODE_PAGE_SIZE = 0x1000;
+
+    // The 'int 3' opcode.
+    static constexpr std::uint8_t INT3 = 0xCC;
+
+    // Open addressing table with linear probing, its size is a power of two and at most half of it is used.
+    std::vector<Breakpoint> m_Slots {};
+
+    // Number of the breakpoints currently set.
+    std::size_t m_Count { 0 };
+
+
+    /**
+     * @brief Gets the home slot of an address.
+     *
+     * @param address The breakpoint address.
+     * @return Index of the first slot probed for the address.
+     */
+    [[nodiscard]] std::size_t HomeSlot(
+        std::uintptr_t address
+    ) const noexcept
+    {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(address) * 0x9E3779B97F4A7C15ull) >> 32) & (m_Slots.size() - 1);
+    }
+
+
+    /**
+     * @brief Gets the slot holding an address.
+     *
+     * @param address The breakpoint address.
+     * @return Index of the slot holding the address, or the free slot where it would be inserted.
+     */
+    [[nodiscard]] std::size_t FindSlot(
+        std::uintptr_t address
+    ) const noexcept
+    {
+        const auto mask = m_Slots.size() - 1;
+        auto slot = HomeSlot( address );
+
+        while (m_Slots[slot].m_Address && m_Slots[slot].m_Address != address)
+            slot = (slot + 1) & mask;
+
+        return slot;
+    }
+
+
+    /**
+     * @brief Rebuilds the table with a new size.
+     *
+     * @param size The new number of slots, a power of two.
+     */
+    void Rehash(
+        std::size_t size
+    )
+    {
+        auto slots = std::exchange( m_Slots, std::vector<Breakpoint>( size ) );
+
+        for (const auto & breakpoint : slots)
+        {
+            if (breakpoint.m_Address)
+                m_Slots[FindSlot( breakpoint.m_Address )] = breakpoint;
+        }
+    }
+
+
+    /**
+     * @brief Frees a slot and moves back the following entries of its probe sequence.
+     *
+     * @param slot Index of the slot to free.
+     */
+    void Erase(
+        std::size_t slot
+    ) noexcept
+    {
+        const auto mask = m_Slots.size() - 1;
+
+        for (auto next = (slot + 1) & mask; m_Slots[next].m_Address; next = (next + 1) & mask)
+        {
+            // An entry may only move back if the freed slot lies between its home slot and itself.
+            if (((next - HomeSlot( m_Slots[next].m_Address )) & mask) >= ((next - slot) & mask))
+            {
+                m_Slots[slot] = m_Slots[next];
+                slot = next;
+            }
+        }
+
+        m_Slots[slot] = Breakpoint {};
+        --m_Count;
+    }
+
+
+    /**
+     * @brief Restores the original byte of a breakpoint and frees its slot.
+     *
+     * @param address The breakpoint address.
+     * @param code Reference to the code byte at the address.
+     */
+    void Restore(
+        std::uintptr_t address,
+        std::uint8_t & code
+    ) noexcept
+    {
+        const auto slot = FindSlot( address );
+
+        code = m_Slots[slot].m_BackupByte;
+        Erase( slot );
+    }
+
+
+    /**
+     * @brief Makes the code writable once per page and patches every address on it.
+     *
+     * @param addresses The addresses to patch, sorted in ascending order.
+     * @param patch Called for every address on a writable page, 'void( std::uintptr_t, std::uint8_t & )'.
+     * @return Number of the patched addresses.
+     */
+    template<typename F>
+    std::size_t PatchPages(
+        std::span<const std::uintptr_t> addresses,
+        F && patch
+    ) noexcept
+    {
+        std::size_t patched = 0;
+
+        for (std::size_t first = 0, last = 0; first < addresses.size(); first = last)
+        {
+            const auto page = addresses[first] & ~(CODE_PAGE_SIZE - 1);
+
+            while (last < addresses.size() && (addresses[last] & ~(CODE_PAGE_SIZE - 1)) == page)
+                ++last;
 
-    // Original byte value at the breakpoint address.
-    std::uint8_t m_BackupByte { 0 };
+            const auto begin = addresses[first];
+            const auto length = static_cast<std::size_t>(addresses[last - 1] - begin + 1);
 
-    // Flag indicating if a breakpoint is currently active.
-    bool m_IsSet { false };
+            auto memory = MemoryManager { reinterpret_cast<void *>(begin), length, PAGE_EXECUTE_READWRITE };
+            if (!memory.IsValid())
+                continue;
+
+            for (auto i = first; i < last; ++i)
+                patch( addresses[i], *reinterpret_cast<std::uint8_t *>(addresses[i]) );
+
+            FlushInstructionCache( GetCurrentProcess(), reinterpret_cast<void *>(begin), length );
+            patched += last - first;
+        }
+
+        return patched;
+    }
 
 public:
 
+    BreakpointManager() = default;
+
+    BreakpointManager( const BreakpointManager & ) = delete;
+    BreakpointManager & operator=( const BreakpointManager & ) = delete;
+
+
+    /**
+     * @brief Reserves room for the breakpoints, so setting them later does not allocate.
+     *
+     * @param count Number of the breakpoints expected to be set at once.
+     */
+    void Reserve(
+        std::size_t count
+    )
+    {
+        auto size = std::max<std::size_t>( m_Slots.size(), 16 );
+
+        while (size < count * 2)
+            size *= 2;
+
+        if (size != m_Slots.size())
+            Rehash( size );
+    }
+
+
+    /**
+     * @brief Sets software breakpoints, the protection of every code page is changed only once.
+     *
+     * An address which already holds a breakpoint only takes the new entry index.
+     *
+     * @param breakpoints Pairs of the breakpoint address and the index of the entry it resolves.
+     * @return Number of the breakpoints set, the addresses on pages which cannot be made writable are skipped.
+     */
+    std::size_t SetBreakpoints(
+        std::span<const std::pair<std::uintptr_t, std::size_t>> breakpoints
+    ) noexcept
+    {
+        try
+        {
+            Reserve( m_Count + breakpoints.size() );
+
+            std::vector<std::pair<std::uintptr_t, std::size_t>> pending {};
+            std::size_t count = 0;
+
+            for (const auto & [address, index] : breakpoints)
+            {
+                if (!address)
+                    continue;
+
+                if (auto & breakpoint = m_Slots[FindSlot( address )]; breakpoint.m_Address)
+                {
+                    breakpoint.m_Index = index;
+                    ++count;
+                }
+                else
+                    pending.emplace_back( address, index );
+            }
+
+            std::ranges::sort( pending );
+
+            // The same address requested twice takes the last index.
+            std::vector<std::uintptr_t> addresses {};
+            std::vector<std::size_t> indices {};
+
+            for (const auto & [address, index] : pending)
+            {
+                if (!addresses.empty() && addresses.back() == address)
+                    indices.back() = index;
+                else
+                {
+                    addresses.push_back( address );
+                    indices.push_back( index );
+                }
+            }
+
+            std::size_t next = 0;
+
+            return count + PatchPages( addresses, [&]( std::uintptr_t address, std::uint8_t & code )
+            {
+                while (addresses[next] != address)
+                    ++next;
+
+                m_Slots[FindSlot( address )] = Breakpoint { address, indices[next], code };
+                code = INT3;
+                ++m_Count;
+            } );
+        }
+        catch (...)
+        {
+            return 0;
+        }
+    }
+
 
     /**
      * @brief Sets a software breakpoint at the specified memory address.
      *
      * @param address The memory address where to place the breakpoint.
+     * @param index Index of the entry resolved once the breakpoint is hit.
+     * @return true if the breakpoint is set, false otherwise.
      */
-    [[nodiscard]] void SetBreakpoint(
-        std::uintptr_t address
+    bool SetBreakpoint(
+        std::uintptr_t address,
+        std::size_t index
     ) noexcept
     {
-        if (m_IsSet)
-            return;
+        const std::pair<std::uintptr_t, std::size_t> breakpoint { address, index };
+        return SetBreakpoints( { &breakpoint, 1 } ) == 1;
+    }
 
-        auto memory = MemoryManager { reinterpret_cast<void *>(address), 1, PAGE_EXECUTE_READWRITE };
-        if (!memory.IsValid())
-            return;
 
-        m_Address = address;
-        m_BackupByte = *reinterpret_cast<std::uint8_t *>(address);
-        *reinterpret_cast<std::uint8_t *>(address) = 0xCC;
+    /**
+     * @brief Removes software breakpoints and restores the original code, the protection of every code page is changed only once.
+     *
+     * @param addresses The breakpoint addresses, the ones without a breakpoint are ignored.
+     * @return Number of the breakpoints removed.
+     */
+    std::size_t RemoveBreakpoints(
+        std::span<const std::uintptr_t> addresses
+    ) noexcept
+    {
+        try
+        {
+            std::vector<std::uintptr_t> present {};
+
+            for (const auto address : addresses)
+            {
+                if (Find( address ))
+                    present.push_back( address );
+            }
+
+            std::ranges::sort( present );
+            present.erase( std::ranges::unique( present ).begin(), present.end() );
+
+            return PatchPages( present, [this]( std::uintptr_t address, std::uint8_t & code )
+            {
+                Restore( address, code );
+            } );
+        }
+        catch (...)
+        {
+            return 0;
+        }
+    }
 
-        FlushInstructionCache( GetCurrentProcess(), reinterpret_cast<void *>(address), 1 );
 
-        m_IsSet = true;
+    /**
+     * @brief Removes the breakpoint at the specified address and restores the original code.
+     *
+     * Does not allocate, so it is safe to call from the exception handler.
+     *
+     * @param address The breakpoint address, usually the 'EIP' of the breakpoint exception.
+     * @return Index of the entry the breakpoint was set for, or 'std::nullopt' if no breakpoint was removed.
+     */
+    [[nodiscard]] std::optional<std::size_t> RemoveBreakpoint(
+        std::uintptr_t address
+    ) noexcept
+    {
+        const auto * breakpoint = Find( address );
+        if (!breakpoint)
+            return std::nullopt;
+
+        const auto index = breakpoint->m_Index;
+        const auto removed = PatchPages( { &address, 1 }, [this]( std::uintptr_t address, std::uint8_t & code )
+        {
+            Restore( address, code );
+        } );
+
+        if (!removed)
+            return std::nullopt;
+
+        return index;
     }
 
 
-    // Removes the currently set breakpoint and restores original code.
-    [[nodiscard]] void RemoveBreakpoint() noexcept
+    // Removes every breakpoint and restores the original code.
+    void RemoveAll() noexcept
     {
-        if (!m_IsSet)
-            return;
+        try
+        {
+            std::vector<std::uintptr_t> addresses {};
+
+            for (const auto & breakpoint : m_Slots)
+            {
+                if (breakpoint.m_Address)
+                    addresses.push_back( breakpoint.m_Address );
+            }
+
+            RemoveBreakpoints( addresses );
+        }
+        catch (...)
+        {
+        }
+    }
 
-        auto memory = MemoryManager { reinterpret_cast<void *>(m_Address), 1, PAGE_EXECUTE_READWRITE };
-        if (!memory.IsValid())
-            return;
 
-        *reinterpret_cast<std::uint8_t *>(m_Address) = m_BackupByte;
-        FlushInstructionCache( GetCurrentProcess(), reinterpret_cast<void *>(m_Address), 1 );
+    /**
+     * @brief Looks up the breakpoint set at an address in constant time.
+     *
+     * @param address The memory address to look up.
+     * @return Pointer to the breakpoint, or 'nullptr' if there is no breakpoint at the address.
+     */
+    [[nodiscard]] const Breakpoint * Find(
+        std::uintptr_t address
+    ) const noexcept
+    {
+        if (!address || m_Slots.empty())
+            return nullptr;
 
-        m_IsSet = false;
+        const auto & breakpoint = m_Slots[FindSlot( address )];
+        return breakpoint.m_Address ? &breakpoint : nullptr;
     }
 
 
     /**
-     * @brief Gets the memory address where the breakpoint is set.
+     * @brief Checks if a breakpoint is set at an address.
      *
-     * @return The memory address of the breakpoint, or '0' if no breakpoint is set.
+     * @param address The memory address to check.
+     * @return true if a breakpoint is set, false otherwise.
      */
-    [[nodiscard]] std::uintptr_t GetAddress() const noexcept
+    [[nodiscard]] bool IsSet(
+        std::uintptr_t address
+    ) const noexcept
     {
-        return m_Address;
+        return Find( address ) != nullptr;
     }
 
 
     /**
-    * @brief Checks if a breakpoint is currently active.
-    *
-    * @return true if a breakpoint is set, false otherwise.
-    */
-    [[nodiscard]] bool IsSet() const noexcept
+     * @brief Gets the number of the breakpoints currently set.
+     *
+     * @return Number of the active breakpoints.
+     */
+    [[nodiscard]] std::size_t Count() const noexcept
     {
-        return m_IsSet;
+        return m_Count;
     }
 
 
     /**
-     * @brief Destructor that automatically removes any active breakpoint.
+     * @brief Destructor that automatically removes every active breakpoint.
      */
     ~BreakpointManager() noexcept
     {
-        if (m_IsSet)
-            RemoveBreakpoint();
+        if (m_Count)
+            RemoveAll();
+    }
+};
+
+// Hardware breakpoint manager, uses the debug registers of the resolving thread so the code is never patched.
+class HardwareBreakpointManager
+{
+public:
+
+    // Number of the debug address registers, 'Dr0' to 'Dr3'.
+    static constexpr std::size_t SLOT_COUNT = 4;
+
+private:
+
+    // A breakpoint bound to one of the debug address registers.
+    struct Slot
+    {
+        // Memory address where the breakpoint is set, '0' marks a free register.
+        std::uintptr_t m_Address { 0 };
+
+        // Index of the "ConstantOrStolen" entry resolved once the breakpoint is hit.
+        std::size_t m_Index { 0 };
+    };
+
+    std::array<Slot, SLOT_COUNT> m_Slots {};
+
+
+    /**
+     * @brief Gets the 'Dr7' bits owned by a debug address register.
+     *
+     * Covers the local and global enable bits as well as the condition and length fields.
+     *
+     * @param slot Index of the debug address register.
+     * @return Mask of the bits.
+     */
+    [[nodiscard]] static constexpr DWORD ControlMask(
+        std::size_t slot
+    ) noexcept
+    {
+        return (0x3ul << (slot * 2)) | (0xFul << (16 + slot * 4));
+    }
+
+
+    /**
+     * @brief Gets a debug address register of a context.
+     *
+     * @param ctx The thread context.
+     * @param slot Index of the debug address register.
+     * @return Reference to the register.
+     */
+    [[nodiscard]] static DWORD & AddressRegister(
+        CONTEXT & ctx,
+        std::size_t slot
+    ) noexcept
+    {
+        switch (slot)
+        {
+            case 0: return ctx.Dr0;
+            case 1: return ctx.Dr1;
+            case 2: return ctx.Dr2;
+            default: return ctx.Dr3;
+        }
     }
-};
\ No newline at end of file
+
+public:
+
+    /**
+     * @brief Sets a hardware breakpoint at the specified memory address.
+     *
+     * Only the bookkeeping is changed, the debug registers take it once 'Apply' is called for a context.
+     * An address which already holds a breakpoint only takes the new entry index.
+     *
+     * @param address The memory address where to place the breakpoint.
+     * @param index Index of the entry resolved once the breakpoint is hit.
+     * @return true if the breakpoint is set, false if every debug register is taken.
+     */
+    bool SetBreakpoint(
+        std::uintptr_t address,
+        std::size_t index
+    ) noexcept
+    {
+        if (!address)
+            return false;
+
+        auto it = std::ranges::find( m_Slots, address, &Slot::m_Address );
+        if (it == m_Slots.end())
+            it = std::ranges::find( m_Slots, std::uintptr_t { 0 }, &Slot::m_Address );
+
+        if (it == m_Slots.end())
+            return false;
+
+        *it = Slot { address, index };
+        return true;
+    }
+
+
+    /**
+     * @brief Removes the breakpoint at the specified address.
+     *
+     * @param address The breakpoint address.
+     * @return Index of the entry the breakpoint was set for, or 'std::nullopt' if there is no breakpoint at the address.
+     */
+    [[nodiscard]] std::optional<std::size_t> RemoveBreakpoint(
+        std::uintptr_t address
+    ) noexcept
+    {
+        const auto it = address ? std::ranges::find( m_Slots, address, &Slot::m_Address ) : m_Slots.end();
+        if (it == m_Slots.end())
+            return std::nullopt;
+
+        return std::exchange( *it, Slot {} ).m_Index;
+    }
+
+
+    // Removes every breakpoint.
+    void RemoveAll() noexcept
+    {
+        m_Slots.fill( Slot {} );
+    }
+
+
+    /**
+     * @brief Writes the breakpoints into the debug registers of a context.
+     *
+     * Called from the exception handler, the registers are loaded once the execution continues.
+     *
+     * @param ctx The thread context to update.
+     */
+    void Apply(
+        CONTEXT & ctx
+    ) const noexcept
+    {
+        for (std::size_t i = 0; i < SLOT_COUNT; ++i)
+        {
+            // Execution breakpoints, the condition and length fields stay zero.
+            ctx.Dr7 &= ~ControlMask( i );
+            AddressRegister( ctx, i ) = static_cast<DWORD>(m_Slots[i].m_Address);
+
+            if (m_Slots[i].m_Address)
+                ctx.Dr7 |= 0x1ul << (i * 2);
+        }
+    }
+
+
+    /**
+     * @brief Writes the breakpoints into the debug registers of another thread.
+     *
+     * The thread has to be suspended, the current thread has to use 'Apply' from the exception handler instead.
+     *
+     * @param thread Handle to the thread with 'THREAD_GET_CONTEXT' and 'THREAD_SET_CONTEXT' access.
+     * @return true if the debug registers are updated, false otherwise.
+     */
+    [[nodiscard]] bool ApplyToThread(
+        HANDLE thread
+    ) const noexcept
+    {
+        CONTEXT ctx {};
+        ctx.ContextFlags = CONTEXT_DEBUG_REGISTERS;
+
+        if (!GetThreadContext( thread, &ctx ))
+            return false;
+
+        Apply( ctx );
+        return SetThreadContext( thread, &ctx ) != FALSE;
+    }
+
+
+    /**
+     * @brief Checks if a single-step exception comes from one of the breakpoints and removes it.
+     *
+     * 'Dr6' tells which debug register fired, the hit breakpoint is cleared from the context.
+     *
+     * @param ctx The context of the single-step exception.
+     * @return Index of the entry the breakpoint was set for, or 'std::nullopt' if no breakpoint was hit.
+     */
+    [[nodiscard]] std::optional<std::size_t> Hit(
+        CONTEXT & ctx
+    ) noexcept
+    {
+        for (std::size_t i = 0; i < SLOT_COUNT; ++i)
+        {
+            if (!(ctx.Dr6 & (0x1ul << i)) || !m_Slots[i].m_Address || m_Slots[i].m_Address != ctx.Eip)
+                continue;
+
+            const auto index = std::exchange( m_Slots[i], Slot {} ).m_Index;
+
+            ctx.Dr6 = 0;
+            Apply( ctx );
+
+            return index;
+        }
+
+        return std::nullopt;
+    }
+
+
+    /**
+     * @brief Checks if a breakpoint is set at an address.
+     *
+     * @param address The memory address to check.
+     * @return true if a breakpoint is set, false otherwise.
+     */
+    [[nodiscard]] bool IsSet(
+        std::uintptr_t address
+    ) const noexcept
+    {
+        return address && std::ranges::find( m_Slots, address, &Slot::m_Address ) != m_Slots.end();
+    }
+
+
+    /**
+     * @brief Gets the number of the breakpoints currently set.
+     *
+     * @return Number of the taken debug registers.
+     */
+    [[nodiscard]] std::size_t Count() const noexcept
+    {
+        return static_cast<std::size_t>(std::ranges::count_if( m_Slots, []( const Slot & slot ) { return slot.m_Address != 0; } ));
+    }
+};
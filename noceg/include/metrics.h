@@ -0,0 +1,283 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "reader.h"
+
+// Transitions of the resolution of an entry, in the order they happen.
+enum class ResolvePhase : std::uint8_t
+{
+    // The driver loop starts the entry.
+    Start = 0,
+
+    // The breakpoint is set and the CEG register thread function has returned.
+    RegisterThread,
+
+    // The custom exception reached the handler, which redirected 'EIP'.
+    Redirect,
+
+    // The single-step stopped at the targeted CEG function.
+    TargetReached,
+
+    // The breakpoint of the entry has been hit.
+    BreakpointHit,
+
+    // The value is saved.
+    Saved,
+
+    Count
+};
+
+// Collects the timestamps of every resolved entry and writes them to 'noceg_metrics.json'.
+class MetricsRecorder
+{
+private:
+
+    static constexpr std::size_t PHASE_COUNT = static_cast<std::size_t>(ResolvePhase::Count);
+
+    // Names of the phases inside the report.
+    static constexpr std::array<std::string_view, PHASE_COUNT> PHASE_NAMES =
+    {
+        "Start", "RegisterThread", "Redirect", "TargetReached", "BreakpointHit", "Saved"
+    };
+
+    // Number of the histogram buckets, bucket 'i' counts the entries which took less than '2^i' microseconds.
+    static constexpr std::size_t BUCKET_COUNT = 32;
+
+    // Timestamps of a single entry, only written by the thread which claimed it.
+    struct Timing
+    {
+        // QPC timestamp of every phase of the last run, '0' if the phase was not reached.
+        std::array<std::int64_t, PHASE_COUNT> m_Stamps {};
+
+        // Number of times the entry has been run.
+        std::uint32_t m_Runs { 0 };
+    };
+
+    // Timestamps of every entry, empty while the metrics are disabled.
+    std::vector<Timing> m_Timings {};
+
+    // QPC frequency, in ticks per second.
+    std::int64_t m_Frequency { 1 };
+
+    // QPC timestamp of 'Enable'.
+    std::int64_t m_Begin { 0 };
+
+
+    // Reads the performance counter.
+    [[nodiscard]] static std::int64_t Now() noexcept
+    {
+        LARGE_INTEGER counter {};
+        QueryPerformanceCounter( &counter );
+
+        return counter.QuadPart;
+    }
+
+
+    /**
+    * @brief Converts a number of QPC ticks to microseconds.
+    *
+    * @param ticks The number of ticks.
+    * @return The duration in microseconds.
+    */
+    [[nodiscard]] double ToMicroseconds(
+        std::int64_t ticks
+    ) const noexcept
+    {
+        return static_cast<double>(ticks) * 1000000.0 / static_cast<double>(m_Frequency);
+    }
+
+public:
+
+    /**
+    * @brief Starts collecting the timestamps.
+    *
+    * @param count Number of the entries in the "ConstantOrStolen" array.
+    */
+    void Enable(
+        std::size_t count
+    )
+    {
+        LARGE_INTEGER frequency {};
+        QueryPerformanceFrequency( &frequency );
+
+        m_Frequency = frequency.QuadPart ? frequency.QuadPart : 1;
+        m_Timings.assign( count, Timing {} );
+        m_Begin = Now();
+    }
+
+
+    /**
+    * @brief Checks if the timestamps are collected.
+    *
+    * @return true if the metrics are enabled, false otherwise.
+    */
+    [[nodiscard]] bool IsEnabled() const noexcept
+    {
+        return !m_Timings.empty();
+    }
+
+
+    /**
+    * @brief Records the time an entry reached a phase, starting a phase over discards the previous run.
+    *
+    * @param index Index of the entry in the "ConstantOrStolen" array.
+    * @param phase The reached phase.
+    */
+    void Stamp(
+        std::size_t index,
+        ResolvePhase phase
+    ) noexcept
+    {
+        if (index >= m_Timings.size())
+            return;
+
+        auto & timing = m_Timings[index];
+
+        if (phase == ResolvePhase::Start)
+        {
+            timing.m_Stamps.fill( 0 );
+            ++timing.m_Runs;
+        }
+
+        timing.m_Stamps[static_cast<std::size_t>(phase)] = Now();
+    }
+
+
+    /**
+    * @brief Writes the timings of every run entry, with per-type totals and histograms.
+    *
+    * Every phase is reported as the time since the previous reached phase.
+    *
+    * @param path Path to the report.
+    * @param entries The entry table.
+    * @return 'std::expected<void, Error>' Either success or error.
+    * @retval 'JsonWriteFailed' if the report cannot be written.
+    */
+    [[nodiscard]] std::expected<void, Error> Save(
+        const fs::path & path,
+        std::span<const CEGEntry> entries
+    ) const noexcept
+    {
+        // Totals of the entries sharing a CEG function type.
+        struct TypeTotals
+        {
+            std::size_t m_Count { 0 };
+            double m_Total { 0.0 };
+            double m_Min { 0.0 };
+            double m_Max { 0.0 };
+            std::array<double, PHASE_COUNT> m_Phases {};
+            std::array<std::size_t, BUCKET_COUNT> m_Histogram {};
+        };
+
+        try
+        {
+            std::map<std::uint8_t, TypeTotals> types {};
+            auto j_entries = json::array();
+
+            for (std::size_t i = 0; i < m_Timings.size() && i < entries.size(); ++i)
+            {
+                const auto & timing = m_Timings[i];
+                const auto start = timing.m_Stamps[static_cast<std::size_t>(ResolvePhase::Start)];
+
+                if (!timing.m_Runs || !start)
+                    continue;
+
+                auto & totals = types[entries[i].m_Type];
+                auto j_phases = json::object();
+                auto last = start;
+
+                for (std::size_t phase = 1; phase < PHASE_COUNT; ++phase)
+                {
+                    if (!timing.m_Stamps[phase])
+                        continue;
+
+                    const auto duration = ToMicroseconds( timing.m_Stamps[phase] - last );
+
+                    j_phases[PHASE_NAMES[phase]] = duration;
+                    totals.m_Phases[phase] += duration;
+                    last = timing.m_Stamps[phase];
+                }
+
+                const auto total = ToMicroseconds( last - start );
+
+                totals.m_Total += total;
+                totals.m_Min = totals.m_Count ? std::min( totals.m_Min, total ) : total;
+                totals.m_Max = std::max( totals.m_Max, total );
+                ++totals.m_Count;
+
+                const auto micros = static_cast<std::uint64_t>(total);
+                const auto bucket = std::min<std::size_t>( std::bit_width( micros ), BUCKET_COUNT - 1 );
+                ++totals.m_Histogram[bucket];
+
+                j_entries.push_back( {
+                    { "Index", i },
+                    { "Function", std::format( "0x{:08X}", entries[i].m_Func ) },
+                    { "Type", entries[i].m_Type },
+                    { "Runs", timing.m_Runs },
+                    { "Resolved", entries[i].m_Resolved },
+                    { "Phases", std::move( j_phases ) },
+                    { "Total", total }
+                    } );
+            }
+
+            auto j_types = json::object();
+
+            for (const auto & [type, totals] : types)
+            {
+                auto j_phases = json::object();
+                auto j_histogram = json::array();
+
+                for (std::size_t phase = 1; phase < PHASE_COUNT; ++phase)
+                    j_phases[PHASE_NAMES[phase]] = totals.m_Phases[phase];
+
+                for (std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+                {
+                    if (totals.m_Histogram[bucket])
+                        j_histogram.push_back( { { "Below", std::uint64_t { 1 } << bucket }, { "Count", totals.m_Histogram[bucket] } } );
+                }
+
+                j_types[std::to_string( type )] = {
+                    { "Count", totals.m_Count },
+                    { "Total", totals.m_Total },
+                    { "Mean", totals.m_Total / static_cast<double>(totals.m_Count) },
+                    { "Min", totals.m_Min },
+                    { "Max", totals.m_Max },
+                    { "Phases", std::move( j_phases ) },
+                    { "Histogram", std::move( j_histogram ) }
+                };
+            }
+
+            // Every duration is in microseconds.
+            json j_root = {
+                { "Unit", "us" },
+                { "Elapsed", ToMicroseconds( Now() - m_Begin ) },
+                { "Entries", std::move( j_entries ) },
+                { "Types", std::move( j_types ) }
+            };
+
+            std::ofstream out { path };
+            if (!out.is_open())
+                return std::unexpected { Error::JsonWriteFailed };
+
+            out << std::setw( 4 ) << j_root;
+            return {};
+        }
+        catch (const std::exception &)
+        {
+            return std::unexpected { Error::JsonWriteFailed };
+        }
+    }
+};
\ No newline at end of file
@@ -28,7 +28,12 @@ enum class Error
     JsonWriteFailed, // Failed to write JSON data.
     MutexCreateFailed, // Failed to create or acquire a mutex.
     CEGInitFunctionNotFound, // CEG init function not found inside JSON.
-    CEGRegisterThreadFunctionNotFound // CEG register thread function not found inside JSON.
+    CEGRegisterThreadFunctionNotFound, // CEG register thread function not found inside JSON.
+    CEGEntriesNotFound, // 'ConstantOrStolen' array not found inside JSON.
+    JournalOpenFailed, // Failed to open or create the result journal.
+    CacheReadFailed, // Failed to read the value cache.
+    CacheWriteFailed, // Failed to write the value cache.
+    ThreadCreateFailed // Failed to start the resolution threads.
 };
 
 // The handle manager.
@@ -52,6 +57,17 @@ public:
 
     HandleManager( const HandleManager & ) = delete;
     HandleManager & operator=( const HandleManager & ) = delete;
+
+
+    /**
+     * @brief Checks if the managed handle is valid.
+     *
+     * @return true if the handle is valid, false otherwise.
+     */
+    [[nodiscard]] bool IsValid() const noexcept
+    {
+        return m_Handle != INVALID_HANDLE_VALUE && m_Handle != nullptr;
+    }
 };
 
 
@@ -22,9 +22,6 @@ private:
     // Handle to the original dynamic library.
     HMODULE m_OriginalDll;
 
-    // Cache of exported function names and their resolved addresses.
-    std::unordered_map<std::string, FARPROC> m_ExportCache;
-
     // Path to the original dynamic library on disk.
     std::string m_OriginalDllPath;
 
@@ -73,37 +70,60 @@ public:
     
 
     /**
-    * @brief Retrieves a function pointer from the original dynamic library by name.
+    * @brief Resolves a set of exports with a single walk of the export directory of the original dynamic library.
     * 
-    * @tparam FuncType The expected function type.
-    * @param name The name of the exported function.
-    * @return A function pointer of the requested type, or nullptr if not found.
+    * @param names The names of the exports.
+    * @param table [out] Receives the address of every export at the index of its name, nullptr if not found.
     */
-    template<typename FuncType>
-    FuncType GetFunction( 
-        const std::string & name
-    )
+    void ResolveExports(
+        std::span<const std::string_view> names,
+        std::span<FARPROC> table
+    ) const noexcept
     {
+        std::ranges::fill( table, nullptr );
+
         if (!m_OriginalDll)
         {
             LOG_ERROR( "Original library ('{}') is not loaded.", m_OriginalDllPath );
-            return nullptr;
+            return;
         }
 
-        // Check the export cache first.
-        auto it = m_ExportCache.find( name );
-        if (it != m_ExportCache.end())
-            return reinterpret_cast<FuncType>(it->second);
+        const auto * base = reinterpret_cast<const std::byte *>(m_OriginalDll);
+        const auto * dos = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+        const auto * nt = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dos->e_lfanew);
+        const auto & directory = nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+
+        if (directory.VirtualAddress && directory.Size)
+        {
+            const auto * exports = reinterpret_cast<const IMAGE_EXPORT_DIRECTORY *>(base + directory.VirtualAddress);
+            const auto * name_rvas = reinterpret_cast<const DWORD *>(base + exports->AddressOfNames);
+            const auto * ordinals = reinterpret_cast<const WORD *>(base + exports->AddressOfNameOrdinals);
+            const auto * functions = reinterpret_cast<const DWORD *>(base + exports->AddressOfFunctions);
+
+            for (DWORD i = 0; i < exports->NumberOfNames; ++i)
+            {
+                const std::string_view name { reinterpret_cast<const char *>(base + name_rvas[i]) };
 
-        // Resolve the function from the dynamic library.
-        const FARPROC proc = GetProcAddress( m_OriginalDll, name.c_str() );
+                const auto it = std::ranges::find( names, name );
+                if (it == names.end() || ordinals[i] >= exports->NumberOfFunctions)
+                    continue;
 
-        if (!proc)
-            LOG_WARNING( "Function '{}' not found in '{}'.", name, m_OriginalDllPath );
+                const auto index = static_cast<std::size_t>(it - names.begin());
+                const auto rva = functions[ordinals[i]];
 
-        // Cache the result for future lookups.
-        m_ExportCache[name] = proc;
-        return reinterpret_cast<FuncType>(proc);
+                // A forwarded export points to the name of its target, which the loader has to resolve.
+                if (rva >= directory.VirtualAddress && rva < directory.VirtualAddress + directory.Size)
+                    table[index] = GetProcAddress( m_OriginalDll, name.data() );
+                else
+                    table[index] = reinterpret_cast<FARPROC>(const_cast<std::byte *>(base + rva));
+            }
+        }
+
+        for (std::size_t i = 0; i < names.size(); ++i)
+        {
+            if (!table[i])
+                LOG_WARNING( "Function '{}' not found in '{}'.", names[i], m_OriginalDllPath );
+        }
     }
 };
 
@@ -115,6 +135,15 @@ private:
 
     static inline std::unique_ptr<DllWrapper> m_DllWrapper = nullptr;
 
+    // Maximum number of the forwarded exports.
+    static constexpr std::size_t MAX_EXPORTS = 64;
+
+    // Addresses of the forwarded exports, resolved once by 'Initialize'.
+    static inline std::array<FARPROC, MAX_EXPORTS> m_Exports {};
+
+    // Identifier of the thread which waits inside the forwarded exports, '0' if none.
+    static inline std::atomic<DWORD> m_HeldThread = 0;
+
 public:
     
     /**
@@ -132,11 +161,57 @@ public:
     }
 
 
-    // Initializes the global wrapper instance with default dynamic library paths.
-    static void Initialize()
+    /**
+    * @brief Initializes the global wrapper instance with default dynamic library paths and resolves the forwarded exports.
+    * 
+    * @param exports The names of the forwarded exports, their index is passed to 'GetExport'.
+    */
+    static void Initialize(
+        std::span<const std::string_view> exports = {}
+    )
     {
         if (!m_DllWrapper)
             m_DllWrapper = std::make_unique<DllWrapper>( "steam_api_org.dll", "steam_api.dll" );
+
+        if (!exports.empty())
+            m_DllWrapper->ResolveExports( exports.first( std::min( exports.size(), MAX_EXPORTS ) ), m_Exports );
+    }
+
+
+    /**
+    * @brief Retrieves the address of a forwarded export.
+    * 
+    * @tparam Index Index of the export name passed to 'Initialize'.
+    * @return The address of the export, nullptr if not found.
+    */
+    template<std::size_t Index>
+    [[nodiscard]] static FARPROC GetExport() noexcept
+    {
+        static_assert(Index < MAX_EXPORTS, "Too many forwarded exports.");
+        return m_Exports[Index];
+    }
+
+
+    // Makes the current thread wait inside the forwarded exports until 'Release' is called.
+    static void Hold() noexcept
+    {
+        m_HeldThread.store( GetCurrentThreadId() );
+    }
+
+
+    // Lets the held thread continue.
+    static void Release() noexcept
+    {
+        m_HeldThread.store( 0 );
+        m_HeldThread.notify_all();
+    }
+
+
+    // Waits if the current thread is held, the resolution threads always pass.
+    static void Wait() noexcept
+    {
+        if (const auto thread = m_HeldThread.load(); thread && thread == GetCurrentThreadId())
+            m_HeldThread.wait( thread );
     }
 
 
@@ -164,30 +239,31 @@ public:
 
 
 // Easy to access macros.
+// The forwarders jump through the resolved table, 'SteamExportIndex' is defined next to the export list.
 #define FORWARD_EXPORT(ret, name, params, args) \
     extern "C" __declspec(dllexport) ret name params { \
         using func_t = ret(*) params; \
-        static func_t func = SteamAPIWrapper::GetInstance().GetFunction<func_t>(#name); \
-        return func args; \
+        SteamAPIWrapper::Wait(); \
+        return reinterpret_cast<func_t>(SteamAPIWrapper::GetExport<SteamExportIndex(#name)>()) args; \
     }
 
 #define FORWARD_EXPORT_VOID(name, params, args) \
     extern "C" __declspec(dllexport) void name params { \
         using func_t = void(*) params; \
-        static func_t func = SteamAPIWrapper::GetInstance().GetFunction<func_t>(#name); \
-        func args; \
+        SteamAPIWrapper::Wait(); \
+        reinterpret_cast<func_t>(SteamAPIWrapper::GetExport<SteamExportIndex(#name)>()) args; \
     }
 
 #define FORWARD_EXPORT_SIMPLE(ret, name) \
     extern "C" __declspec(dllexport) ret name() { \
         using func_t = ret(*)(); \
-        static func_t func = SteamAPIWrapper::GetInstance().GetFunction<func_t>(#name); \
-        return func(); \
+        SteamAPIWrapper::Wait(); \
+        return reinterpret_cast<func_t>(SteamAPIWrapper::GetExport<SteamExportIndex(#name)>())(); \
     }
 
 #define FORWARD_EXPORT_VOID_SIMPLE(name) \
     extern "C" __declspec(dllexport) void name() { \
         using func_t = void(*)(); \
-        static func_t func = SteamAPIWrapper::GetInstance().GetFunction<func_t>(#name); \
-        func(); \
+        SteamAPIWrapper::Wait(); \
+        reinterpret_cast<func_t>(SteamAPIWrapper::GetExport<SteamExportIndex(#name)>())(); \
     }
\ No newline at end of file
@@ -16,6 +16,40 @@
 
 #include "process.h"
 
+#include <binary_config.h>
+
+// A validated "ConstantOrStolen" entry, converted once from the JSON configuration.
+struct CEGEntry
+{
+    // Address of the CEG protected function.
+    std::uintptr_t m_Func { 0 };
+
+    // Entry point to which execution is redirected.
+    std::uintptr_t m_Eip { 0 };
+
+    // Breakpoint address, 'EAX' holds the value once it is hit.
+    std::uintptr_t m_Bp { 0 };
+
+    // Function prologue address, '0' if the configuration has none.
+    std::uintptr_t m_Prologue { 0 };
+
+    // The resolved value.
+    std::uint32_t m_Value { 0 };
+
+    // CEG function type, '0' marks an invalid entry which is skipped.
+    std::uint8_t m_Type { 0 };
+
+    // The value is known, either from the configuration or from the resolution.
+    bool m_Resolved { false };
+
+    // Running the function changed the results of the next ones, it is only resolved right after a restart.
+    bool m_Poisons { false };
+
+    // The breakpoint was not hit in time, the entry is skipped.
+    bool m_Failed { false };
+};
+
+
 // JSON file reader/writer.
 class JsonReader
 {
@@ -27,6 +61,32 @@ private:
     // Path to the JSON configuration file.
     fs::path m_JSONPath;
 
+    // The mapped 'noceg.bin' next to the JSON, its tables replace the ones of the JSON once it is open.
+    CEG::BinaryConfig m_Binary {};
+
+
+    /**
+    * @brief Parses a hexadecimal address string of the JSON.
+    *
+    * @param value The JSON value.
+    * @return The address, or '0' if the value is not an address.
+    */
+    [[nodiscard]] static std::uint32_t ParseAddress(
+        const json & value
+    ) noexcept
+    {
+        if (!value.is_string())
+            return 0;
+
+        auto digits = std::string_view( value.get_ref<const std::string &>() );
+        if (digits.starts_with( "0x" ))
+            digits.remove_prefix( 2 );
+
+        std::uint32_t address = 0;
+        std::from_chars( digits.data(), digits.data() + digits.size(), address, 16 );
+        return address;
+    }
+
 public:
     
     /**
@@ -87,6 +147,93 @@ public:
     }
 
 
+    /**
+    * @brief Maps 'noceg.bin' next to the JSON configuration, 'ReadEntries' then converts its records instead of the JSON.
+    *
+    * A binary configuration written for another JSON is ignored. The values resolved in only one of both are copied
+    * to the other, so the JSON stays a complete export of the binary configuration.
+    *
+    * @return true if the binary configuration is used, false otherwise.
+    */
+    [[nodiscard]] bool OpenBinary() noexcept
+    {
+        try
+        {
+            auto path = m_JSONPath;
+            path.replace_extension( ".bin" );
+
+            std::error_code ec {};
+            if (!fs::exists( path, ec ))
+                return false;
+
+            if (!m_Binary.Open( path, true ))
+            {
+                LOG_WARNING( "Ignoring '{}', it is not a valid binary configuration.", path.filename().string() );
+                return false;
+            }
+
+            const auto & header = m_Binary.Header();
+            const auto count = m_JSON.contains( "ConstantOrStolen" ) && m_JSON["ConstantOrStolen"].is_array() ?
+                m_JSON["ConstantOrStolen"].size() : 0;
+
+            if (header.m_EntryCount != count || header.m_Init != ParseAddress( m_JSON.value( "Init", json {} ) ) ||
+                header.m_RegisterThread != ParseAddress( m_JSON.value( "RegisterThread", json {} ) ))
+            {
+                LOG_WARNING( "Ignoring '{}', it was written for another '{}'.", path.filename().string(), m_JSONPath.filename().string() );
+                m_Binary.Close();
+                return false;
+            }
+
+            const auto records = m_Binary.Entries();
+            auto & constant_or_stolen_funcs = m_JSON["ConstantOrStolen"];
+
+            for (std::size_t i = 0; i < records.size(); ++i)
+            {
+                auto & entry = constant_or_stolen_funcs[i];
+                if (entry.empty() || !entry.is_object() || !entry.begin().value().is_object())
+                    continue;
+
+                const auto & data = entry.begin().value();
+                const auto value = data.contains( "Value" ) ? ParseAddress( data["Value"] ) : 0;
+
+                if (records[i].m_Value && records[i].m_Value != value)
+                    UpdateEntry( i, records[i].m_Value );
+                else if (!records[i].m_Value && value)
+                    m_Binary.SetValue( i, value );
+            }
+
+            return true;
+        }
+        catch (const std::exception &)
+        {
+            m_Binary.Close();
+            return false;
+        }
+    }
+
+
+    /**
+    * @brief Checks if the tables are read from 'noceg.bin'.
+    *
+    * @return true if the binary configuration is mapped, false otherwise.
+    */
+    [[nodiscard]] bool UsesBinary() const noexcept
+    {
+        return m_Binary.IsOpen();
+    }
+
+
+    /**
+    * @brief Gets the path to the JSON configuration file.
+    *
+    * @return Reference to the path.
+    */
+    [[nodiscard]] const fs::path & GetPath() const noexcept
+    {
+        return m_JSONPath;
+    }
+
+
     /**
     * @brief Provides non-const access to the JSON object.
     *
@@ -108,6 +255,180 @@ public:
         return m_JSON;
     }
     
+    /**
+    * @brief Validates and converts the 'ConstantOrStolen' array.
+    *
+    * The returned table has one record per array element, invalid elements are reported
+    * and kept with a zero type, so the indices of both stay the same.
+    *
+    * @return 'std::expected<std::vector<CEGEntry>, Error>' Either the entry table or an error.
+    * @retval 'CEGEntriesNotFound' if the array is missing.
+    * @retval 'JsonParseFailed' if the conversion fails.
+    */
+    [[nodiscard]] std::expected<std::vector<CEGEntry>, Error> ReadEntries() const noexcept
+    {
+        try
+        {
+            // The records of the binary configuration are already validated addresses.
+            if (m_Binary.IsOpen())
+            {
+                const auto records = m_Binary.Entries();
+                std::vector<CEGEntry> entries( records.size() );
+
+                for (std::size_t i = 0; i < records.size(); ++i)
+                {
+                    const auto & record = records[i];
+
+                    // Every field is decoded, the resolved ones included, so the journal hash of the table stays the same
+                    // while the values are saved in place.
+                    entries[i] = CEGEntry {
+                        record.m_Func,
+                        record.m_Eip,
+                        record.m_Bp,
+                        record.m_Prologue,
+                        record.m_Value,
+                        static_cast<std::uint8_t>(record.m_Type),
+                        record.m_Value != 0
+                    };
+
+                    if (!entries[i].m_Resolved && (record.m_Type < 1 || record.m_Type > 4 || !record.m_Func || !record.m_Bp || !record.m_Eip))
+                    {
+                        LOG_WARNING( "Skipping invalid record at index '{}'.", i );
+                        entries[i] = CEGEntry {};
+                    }
+                }
+
+                return entries;
+            }
+
+            // Check if 'ConstantOrStolen' key exists.
+            if (!m_JSON.contains( "ConstantOrStolen" ) || !m_JSON["ConstantOrStolen"].is_array())
+                return std::unexpected { Error::CEGEntriesNotFound };
+
+            const auto & constant_or_stolen_funcs = m_JSON["ConstantOrStolen"];
+            std::vector<CEGEntry> entries( constant_or_stolen_funcs.size() );
+
+            for (std::size_t i = 0; i < constant_or_stolen_funcs.size(); ++i)
+            {
+                const auto & entry = constant_or_stolen_funcs[i];
+
+                // Check if entry is valid and has at least one key value pair.
+                if (entry.empty() || !entry.is_object())
+                {
+                    LOG_WARNING( "Skipping invalid entry at index '{}'.", i );
+                    continue;
+                }
+
+                const auto & func_key = entry.begin().key();
+                const auto & data = entry.begin().value();
+
+                // Check if data is an object.
+                if (!data.is_object())
+                {
+                    LOG_WARNING( "Skipping entry at index '{}', data is not an object.", i );
+                    continue;
+                }
+
+                // Safe check for 'Value' field.
+                if (!data.contains( "Value" ) || !data["Value"].is_string())
+                {
+                    LOG_WARNING( "Skipping entry at index '{}', value field missing or invalid.", i );
+                    continue;
+                }
+
+                // Only the entries where the function hasn't been processed have to be complete.
+                const auto & value = data["Value"].get_ref<const std::string &>();
+                if (value != "0x00000000")
+                {
+                    const auto digits = std::string_view( value ).substr( value.starts_with( "0x" ) ? 2 : 0 );
+                    std::from_chars( digits.data(), digits.data() + digits.size(), entries[i].m_Value, 16 );
+
+                    entries[i].m_Resolved = true;
+                    continue;
+                }
+
+                // Check if the function address is valid.
+                if (func_key.empty())
+                {
+                    LOG_WARNING( "Entry at index '{}' has empty key.", i );
+                    continue;
+                }
+
+                if (!data.contains( "BP" ) || !data["BP"].is_string())
+                {
+                    LOG_WARNING( "'BP' field missing or invalid at index '{}'.", i );
+                    continue;
+                }
+
+                if (!data.contains( "EIP" ) || !data["EIP"].is_string())
+                {
+                    LOG_WARNING( "'EIP' field missing or invalid at index '{}'.", i );
+                    continue;
+                }
+
+                if (!data.contains( "Type" ) || !data["Type"].is_number_integer())
+                {
+                    LOG_WARNING( "'Type' field missing or invalid at index '{}'.", i );
+                    continue;
+                }
+
+                // '1' - CEG constant functions.
+                // '2' - Older CEG stolen/masked functions.
+                // '3', '4' - CEG stolen/masked functions.
+                const auto type = data["Type"].get<int>();
+                if (type < 1 || type > 4)
+                {
+                    LOG_WARNING( "Unknown type '{}' at index '{}'.", type, i );
+                    continue;
+                }
+
+                try
+                {
+                    // Extract the required addresses from the JSON fields.
+                    const auto func_addr = std::stoull( func_key, nullptr, 16 );
+                    const auto bp_addr = std::stoull( data["BP"].get_ref<const std::string &>(), nullptr, 16 );
+                    const auto eip_addr = std::stoull( data["EIP"].get_ref<const std::string &>(), nullptr, 16 );
+
+                    // Only used to identify the function, older configurations have none.
+                    const auto prologue_addr = data.contains( "Prologue" ) && data["Prologue"].is_string() ?
+                        std::stoull( data["Prologue"].get_ref<const std::string &>(), nullptr, 16 ) : 0;
+
+                    // Validate addresses are not zero.
+                    if (func_addr == 0 || bp_addr == 0 || eip_addr == 0)
+                    {
+                        LOG_WARNING( "One or more addresses are zero at index '{}'.", i );
+                        continue;
+                    }
+
+                    entries[i] = CEGEntry {
+                        static_cast<std::uintptr_t>(func_addr),
+                        static_cast<std::uintptr_t>(eip_addr),
+                        static_cast<std::uintptr_t>(bp_addr),
+                        static_cast<std::uintptr_t>(prologue_addr),
+                        0,
+                        static_cast<std::uint8_t>(type),
+                        false
+                    };
+                }
+                catch (const std::invalid_argument & e)
+                {
+                    LOG_ERROR( "Failed to parse address at index '{}' ('{}').", i, e.what() );
+                }
+                catch (const std::out_of_range & e)
+                {
+                    LOG_ERROR( "Address out of range at index '{}' ('{}').", i, e.what() );
+                }
+            }
+
+            return entries;
+        }
+        catch (const std::exception &)
+        {
+            return std::unexpected { Error::JsonParseFailed };
+        }
+    }
+
+
     /**
     * @brief Updates a specific entry in the 'ConstantOrStolen' array with a new value.
     *
@@ -127,5 +448,7 @@ public:
             auto & data = entry.begin().value();
             data["Value"] = std::format( "0x{:08X}", eax );
         }
+
+        m_Binary.SetValue( index, eax );
     }
 };
\ No newline at end of file
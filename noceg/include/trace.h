@@ -0,0 +1,240 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+// Flags of a traced exception.
+enum TraceFlags : std::uint32_t
+{
+    // The exception hit the breakpoint of the entry and resolved it.
+    TRACE_RESOLVED = 1 << 0,
+
+    // The single-step reached the targeted CEG function.
+    TRACE_TARGET = 1 << 1
+};
+
+// Writes the exceptions seen by the handler to a memory-mapped 'noceg_trace_<pid>_<tid>.bin' per thread.
+class EventTracer
+{
+private:
+
+    // Magic value of the trace header, 'NCT1'.
+    static constexpr std::uint32_t TRACE_MAGIC = 0x3154434E;
+
+    // Header of a trace file, followed by its records.
+    struct Header
+    {
+        std::uint32_t m_Magic { TRACE_MAGIC };
+        std::uint32_t m_RecordSize { 0 };
+        std::uint32_t m_ProcessId { 0 };
+        std::uint32_t m_ThreadId { 0 };
+
+        // QPC frequency, in ticks per second.
+        std::int64_t m_Frequency { 0 };
+
+        // Number of the records the file has room for.
+        std::uint32_t m_Capacity { 0 };
+
+        // Number of the written records, published after each record.
+        std::uint32_t m_Count { 0 };
+
+        // Number of the events dropped once the file was full.
+        std::uint32_t m_Dropped { 0 };
+
+        std::array<std::uint32_t, 7> m_Reserved {};
+    };
+
+    // A single traced exception.
+    struct Record
+    {
+        // QPC timestamp.
+        std::int64_t m_Time { 0 };
+
+        std::uint32_t m_ThreadId { 0 };
+        std::uint32_t m_Code { 0 };
+        std::uint32_t m_Eip { 0 };
+        std::uint32_t m_Eax { 0 };
+
+        // Index of the entry being resolved by the thread.
+        std::uint32_t m_Index { 0 };
+
+        // See 'TraceFlags'.
+        std::uint32_t m_Flags { 0 };
+    };
+
+    static_assert(sizeof( Header ) == 64 && sizeof( Record ) == 32);
+
+    // Largest capacity whose trace file size still fits the 'DWORD' of the mapping.
+    static constexpr std::uint32_t MAX_CAPACITY = (MAXDWORD - sizeof( Header )) / sizeof( Record );
+
+    // Directory receiving the trace files, empty while the tracing is disabled.
+    fs::path m_Directory {};
+
+    // Number of the records of every trace file.
+    std::uint32_t m_Capacity { 0 };
+
+    // QPC frequency, in ticks per second.
+    std::int64_t m_Frequency { 0 };
+
+    // Mapped trace file of the current thread, the views stay mapped until the process exits.
+    static inline thread_local Header * m_ThreadHeader { nullptr };
+
+    // The current thread already tried to map its trace file.
+    static inline thread_local bool m_ThreadAttached { false };
+
+
+    /**
+     * @brief Creates and maps the trace file of the current thread.
+     *
+     * @return Pointer to the mapped header, or 'nullptr' if the file cannot be mapped.
+     */
+    [[nodiscard]] Header * Attach() noexcept
+    {
+        m_ThreadAttached = true;
+
+        try
+        {
+            const auto process_id = GetCurrentProcessId();
+            const auto thread_id = GetCurrentThreadId();
+            const auto path = m_Directory / std::format( "noceg_trace_{}_{}.bin", process_id, thread_id );
+            const auto size = static_cast<DWORD>(sizeof( Header ) + static_cast<std::size_t>(m_Capacity) * sizeof( Record ));
+
+            const auto file = CreateFileW( path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+            if (file == INVALID_HANDLE_VALUE)
+                return nullptr;
+
+            // The view keeps the mapping and the file alive.
+            const auto mapping = CreateFileMappingW( file, nullptr, PAGE_READWRITE, 0, size, nullptr );
+            CloseHandle( file );
+
+            if (!mapping)
+                return nullptr;
+
+            auto * view = MapViewOfFile( mapping, FILE_MAP_WRITE, 0, 0, size );
+            CloseHandle( mapping );
+
+            if (!view)
+                return nullptr;
+
+            // Touch every page now, so the events do not take the page faults.
+            std::memset( view, 0, size );
+
+            auto * header = ::new (view) Header {};
+            header->m_RecordSize = sizeof( Record );
+            header->m_ProcessId = process_id;
+            header->m_ThreadId = thread_id;
+            header->m_Frequency = m_Frequency;
+            header->m_Capacity = m_Capacity;
+
+            m_ThreadHeader = header;
+            return header;
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+public:
+
+    /**
+     * @brief Starts tracing the exceptions.
+     *
+     * @param directory Directory receiving the trace files.
+     * @param capacity Number of the records of every trace file, the later events are dropped.
+     * @return true if the tracing is enabled, false if the capacity exceeds 'GetMaxCapacity'.
+     */
+    [[nodiscard]] bool Enable(
+        const fs::path & directory,
+        std::uint32_t capacity
+    )
+    {
+        if (capacity > MAX_CAPACITY)
+            return false;
+
+        LARGE_INTEGER frequency {};
+        QueryPerformanceFrequency( &frequency );
+
+        m_Frequency = frequency.QuadPart;
+        m_Capacity = capacity;
+        m_Directory = directory;
+
+        return true;
+    }
+
+
+    // Largest number of the records of a trace file, see 'Enable'.
+    [[nodiscard]] static constexpr std::uint32_t GetMaxCapacity() noexcept
+    {
+        return MAX_CAPACITY;
+    }
+
+
+    /**
+     * @brief Checks if the exceptions are traced.
+     *
+     * @return true if the tracing is enabled, false otherwise.
+     */
+    [[nodiscard]] bool IsEnabled() const noexcept
+    {
+        return m_Capacity != 0;
+    }
+
+
+    /**
+     * @brief Appends an event to the trace file of the current thread.
+     *
+     * @param code The exception code.
+     * @param eip The 'EIP' of the exception.
+     * @param eax The 'EAX' of the exception.
+     * @param index Index of the entry in the "ConstantOrStolen" array.
+     * @param flags See 'TraceFlags'.
+     */
+    void Emit(
+        std::uint32_t code,
+        std::uint32_t eip,
+        std::uint32_t eax,
+        std::size_t index,
+        std::uint32_t flags = 0
+    ) noexcept
+    {
+        auto * header = m_ThreadHeader;
+
+        if (!header)
+        {
+            if (!m_Capacity || m_ThreadAttached || !(header = Attach()))
+                return;
+        }
+
+        // Only the owning thread writes the file.
+        const auto count = header->m_Count;
+
+        if (count >= header->m_Capacity)
+        {
+            ++header->m_Dropped;
+            return;
+        }
+
+        LARGE_INTEGER now {};
+        QueryPerformanceCounter( &now );
+
+        reinterpret_cast<Record *>(header + 1)[count] = Record {
+            now.QuadPart, header->m_ThreadId, code, eip, eax, static_cast<std::uint32_t>(index), flags };
+
+        // A reader of a live file never sees a partial record.
+        std::atomic_ref( header->m_Count ).store( count + 1, std::memory_order_release );
+    }
+};
\ No newline at end of file
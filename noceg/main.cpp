@@ -16,6 +16,10 @@
 
 #include <reader.h>
 #include <process.h>
+#include <journal.h>
+#include <metrics.h>
+#include <trace.h>
+#include <cache.h>
 #include <memory.h>
 #include <app.h>
 #include <entry.h>
@@ -23,18 +27,22 @@
 #include <exports.h>
 #include <handler.h>
 
-// Optional dedicated thread for initializing and running the whole logic.
-// Disabled for now.
-/*DWORD WINAPI NoCEGThread(void *) noexcept
+// Dedicated thread running the detached resolution, the worker threads and the watchdog cannot start under the loader lock.
+DWORD WINAPI NoCEGThread( void * param ) noexcept
 {
-    auto state = std::make_unique<ApplicationManager>();
+    auto * state = static_cast<ApplicationManager *>(param);
 
     auto & processor = state->GetEntryProcessorManager();
-    if (auto res = processor.Initialize(); !res)
-        return static_cast<DWORD>(res.error());
+    const auto res = processor.Run();
 
-    return static_cast<DWORD>(Error::Success);
-}*/
+    if (!res)
+        LOG_ERROR( "Failed to resolve entries '0x{:08X}'.", static_cast<int>(res.error()) );
+
+    // Nothing has been resolved, let the game continue.
+    SteamAPIWrapper::Release();
+
+    return static_cast<DWORD>(res ? Error::Success : res.error());
+}
 
 BOOL APIENTRY DllMain( 
     HMODULE hModule,
@@ -55,7 +63,7 @@ BOOL APIENTRY DllMain(
 
             // Always perform once attached.
             ProcessManager::GetCEGMutex();
-            SteamAPIWrapper::Initialize();
+            SteamAPIWrapper::Initialize( STEAM_EXPORTS );
 
             std::call_once( once, [hModule]
             {
@@ -75,10 +83,21 @@ BOOL APIENTRY DllMain(
                     std::exit( 1 );
                 }
 
-                /*
-                * // Optional CEG worker thread initialization. Disabled for now.
-                HandleManager handle {CreateThread(nullptr, 0, NoCEGThread, nullptr, 0, nullptr)};
-                */
+                if (processor.IsDetached())
+                {
+                    // The game thread waits inside its first Steam API call until the resolution ends the process.
+                    SteamAPIWrapper::Hold();
+
+                    HandleManager handle { CreateThread( nullptr, 0, NoCEGThread, state.get(), 0, nullptr ) };
+                    if (!handle.IsValid())
+                    {
+                        LOG_ERROR( "Failed to start the resolution thread. Last error is '0x{:08X}'.", GetLastError() );
+                        std::exit( 1 );
+                    }
+
+                    // The resolution thread uses the state until the process exits.
+                    static_cast<void>(state.release());
+                }
             } );
 
             break;
@@ -87,6 +106,9 @@ BOOL APIENTRY DllMain(
         case DLL_PROCESS_DETACH:
         {
             SteamAPIWrapper::Shutdown();
+
+            // Once the process exits, the writer thread of the log is gone already.
+            Log::Logger::Shutdown( lpReserved != nullptr );
             break;
         }
     }
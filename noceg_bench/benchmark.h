@@ -0,0 +1,209 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include <utils.h>
+
+#include <chrono>
+#include <cmath>
+
+namespace CEG
+{
+    // Timed repetitions of a single benchmark.
+    struct BenchResult
+    {
+        // Name of the benchmark, '<image>/<benchmark>'.
+        std::string m_Name {};
+
+        // Number of bytes processed by a single repetition, the code size for the scans and the analysis.
+        std::uint64_t m_Bytes { 0 };
+
+        // Wall time of every repetition in milliseconds, sorted.
+        std::vector<double> m_Samples {};
+
+
+        /**
+        * @brief Gets a percentile of the repetitions using the nearest rank.
+        *
+        * @param percent The percentile in the range [0, 100].
+        * @return The repetition time in milliseconds.
+        */
+        [[nodiscard]] double Percentile(
+            double percent
+        ) const noexcept
+        {
+            if (m_Samples.empty())
+                return 0.0;
+
+            const auto rank = static_cast<std::size_t>(std::ceil( percent / 100.0 * m_Samples.size() ));
+            return m_Samples[std::clamp<std::size_t>( rank, 1, m_Samples.size() ) - 1];
+        }
+
+
+        // Gets the throughput at the median repetition time in MB/s.
+        [[nodiscard]] double Throughput() const noexcept
+        {
+            const auto median = Percentile( 50.0 );
+            return median > 0.0 ? (m_Bytes / (1024.0 * 1024.0)) / (median / 1000.0) : 0.0;
+        }
+    };
+
+
+    // Runs the benchmarks with a fixed number of repetitions and collects the results.
+    class BenchSuite
+    {
+    private:
+
+        std::vector<BenchResult> m_Results {};
+
+        // Correctness checks of the runs, as '{ name, missing, unexpected }'.
+        std::vector<std::tuple<std::string, std::size_t, std::size_t>> m_Checks {};
+
+        // Number of timed repetitions, each benchmark runs once more untimed to warm the caches.
+        std::uint32_t m_Repetitions { 0 };
+
+    public:
+
+        explicit BenchSuite(
+            std::uint32_t repetitions
+        ) : m_Repetitions( std::max<std::uint32_t>( repetitions, 1 ) )
+        {
+        }
+
+
+        /**
+        * @brief Runs a benchmark and prints its percentiles.
+        *
+        * @param name Name of the benchmark.
+        * @param bytes Number of bytes processed by a single repetition.
+        * @param body The work of a single repetition.
+        */
+        template<typename F>
+        void Run(
+            std::string name,
+            std::uint64_t bytes,
+            F && body
+        )
+        {
+            BenchResult result { std::move( name ), bytes };
+            result.m_Samples.reserve( m_Repetitions );
+
+            body();
+
+            for (std::uint32_t i = 0; i < m_Repetitions; ++i)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                body();
+                const auto elapsed = std::chrono::steady_clock::now() - start;
+
+                result.m_Samples.push_back( std::chrono::duration<double, std::milli>( elapsed ).count() );
+            }
+
+            std::ranges::sort( result.m_Samples );
+
+            std::cout << std::format( "[BENCH] {:<48} p50 '{:.3f}' ms, p90 '{:.3f}' ms, p99 '{:.3f}' ms, '{:.1f}' MB/s.",
+                result.m_Name, result.Percentile( 50.0 ), result.Percentile( 90.0 ), result.Percentile( 99.0 ),
+                result.Throughput() ) << std::endl;
+
+            m_Results.push_back( std::move( result ) );
+        }
+
+
+        /**
+        * @brief Records and prints a correctness check of a run.
+        *
+        * @param name Name of the checked run.
+        * @param missing Number of expected results that were not reported.
+        * @param unexpected Number of reported results that were not expected.
+        */
+        void Check(
+            std::string name,
+            std::size_t missing,
+            std::size_t unexpected
+        )
+        {
+            if (missing || unexpected)
+                std::cout << std::format( "[ERROR] {}: '{}' results missing, '{}' unexpected.", name, missing, unexpected ) << std::endl;
+            else
+                std::cout << std::format( "[SUCCESS] {}: results match the manifest.", name ) << std::endl;
+
+            m_Checks.emplace_back( std::move( name ), missing, unexpected );
+        }
+
+
+        // Checks if every correctness check passed.
+        [[nodiscard]] bool Passed() const noexcept
+        {
+            return std::ranges::all_of( m_Checks, []( const auto & check )
+            {
+                return !std::get<1>( check ) && !std::get<2>( check );
+            } );
+        }
+
+
+        /**
+        * @brief Saves the results to a JSON file.
+        *
+        * @param path Path to the results file.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'OutputFileCreateError' if file cannot be created.
+        * @retval 'FileWriteError' if writing fails.
+        */
+        [[nodiscard]] std::expected<void, Error> Save(
+            const fs::path & path
+        ) const noexcept try
+        {
+            json j_root = json::object();
+            json j_results = json::array();
+            json j_checks = json::array();
+
+            for (const auto & result : m_Results)
+            {
+                j_results.push_back( {
+                    { "Name", result.m_Name },
+                    { "Bytes", result.m_Bytes },
+                    { "Min", result.m_Samples.front() },
+                    { "P50", result.Percentile( 50.0 ) },
+                    { "P90", result.Percentile( 90.0 ) },
+                    { "P99", result.Percentile( 99.0 ) },
+                    { "Max", result.m_Samples.back() },
+                    { "MBps", result.Throughput() }
+                    } );
+            }
+
+            for (const auto & [name, missing, unexpected] : m_Checks)
+                j_checks.push_back( { { "Name", name }, { "Missing", missing }, { "Unexpected", unexpected } } );
+
+            j_root["Repetitions"] = m_Repetitions;
+            j_root["Benchmarks"] = std::move( j_results );
+            j_root["Checks"] = std::move( j_checks );
+
+            std::ofstream out( path, std::ios::trunc );
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            out << j_root.dump( 4 );
+
+            if (out.fail())
+                return std::unexpected( Error::FileWriteError );
+
+            return {};
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+    };
+}
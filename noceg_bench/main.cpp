@@ -0,0 +1,518 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#include <iostream>
+
+// https://github.com/0x1F9F1/mem
+#include <mem/pattern.h>
+#include <mem/pattern_cache.h>
+#include <mem/boyer_moore_scanner.h>
+
+// https://github.com/zyantific/zydis
+#include <Zydis.h>
+
+// https://github.com/nlohmann/json
+#include <json/json.hpp>
+using json = nlohmann::json;
+
+// Custom hash specialization for 'mem::pointer' to enable usage in 'std::unordered_set'.
+namespace std
+{
+    template<>
+    struct hash<mem::pointer>
+    {
+        std::size_t operator()( const mem::pointer & p ) const noexcept
+        {
+            return std::hash<std::uint32_t>{}(p.as<std::uint32_t>());
+        }
+    };
+}
+
+#include <analyzer.h>
+#include <binary_config.h>
+#include <hash.h>
+#include <mapped_file.h>
+#include <scanner.h>
+#include <writer.h>
+#include <patterns.h>
+
+#include "benchmark.h"
+#include "synthetic.h"
+
+using namespace CEG;
+
+
+/**
+* @brief Registers every CEG signature group with the scanner.
+*
+* @param scanner The scanner receiving the groups.
+*/
+void AddPatternGroups(
+    MultiPatternScanner & scanner
+)
+{
+    scanner.AddGroup( PatternGroup::Init, CEG_INIT_LIBRARY_FUNC_PATTERNS );
+    scanner.AddGroup( PatternGroup::Terminate, CEG_TERM_LIBRARY_FUNC_PATTERNS );
+    scanner.AddGroup( PatternGroup::RegisterThread, CEG_REGISTER_THREAD_FUNC_PATTERNS );
+    scanner.AddGroup( PatternGroup::Protect, CEG_PROTECT_PATTERNS );
+    scanner.AddGroup( PatternGroup::Integrity, CEG_INTEGRITY_PATTERNS );
+    scanner.AddGroup( PatternGroup::TestSecret, CEG_TESTSECRET_PATTERNS );
+}
+
+
+/**
+* @brief Runs the linear sweep analysis of the CEG protected functions over every executable section.
+*
+* @param context The analysis context receiving the protected functions.
+* @param content The binary content.
+* @param hits The scan matches of all groups.
+* @return true if every section was analyzed, false otherwise.
+*/
+bool AnalyzeProtected(
+    AnalysisContext & context,
+    std::span<const std::byte> content,
+    const ScanResults & hits
+)
+{
+    std::vector<mem::pointer> ceg_protect;
+    hits.All( PatternGroup::Protect, ceg_protect );
+
+    if (ceg_protect.empty())
+        return false;
+
+    auto analyzer = std::make_unique<InstructionAnalyzer>( context );
+    bool analyzed = true;
+
+    for (const auto & section : context.m_Sections)
+    {
+        analyzed &= analyzer->AnalyzeCEGProtectedFunctions( content.subspan( section.m_RawDataPointer, section.m_Size ),
+            SectionAddress( context, section ), ceg_protect );
+    }
+
+    return analyzed;
+}
+
+
+/**
+* @brief Runs the default single sweep pipeline of the signatures finder on a binary, without the cache.
+*
+* @param binary Path to the CEG binary.
+* @param output Path to the JSON output.
+* @param context [out] The analysis context receiving the results, with real addresses.
+* @return 'std::expected<void, Error>' Either success or specific error.
+*/
+[[nodiscard]] std::expected<void, Error> RunPipeline(
+    const fs::path & binary,
+    const fs::path & output,
+    AnalysisContext & context
+)
+{
+    auto map_res = MappedFile::Open( binary );
+    if (!map_res)
+        return std::unexpected( map_res.error() );
+
+    const auto content = map_res->bytes();
+
+    // Hashed like the signatures finder does for its cache key.
+    [[maybe_unused]] const volatile auto image_hash = Hash::Xxh64( content );
+
+    context = AnalysisContext {};
+    void * address = nullptr;
+    std::uint32_t size = 0;
+
+    if (auto load_res = LoadBinaryImage( context, content, address, size ); !load_res)
+        return std::unexpected( load_res.error() );
+
+    FindFunction( CEG_OLD_VERSION_PATTERN, address, 0x20, context.m_OldVersion );
+
+    MultiPatternScanner scanner;
+    AddPatternGroups( scanner );
+    scanner.Compile();
+
+    const auto hits = scanner.Scan( context );
+
+    hits.All( PatternGroup::RegisterThread, context.m_RegisterThreadFuncs );
+
+    if (AnalyzeProtected( context, content, hits ))
+    {
+        if (context.m_OldVersion)
+            context.m_ProtectedFuncs.RemoveShadowed( ProtectedType::StolenV2, { ProtectedType::StolenV1 } );
+        else
+            context.m_ProtectedFuncs.RemoveShadowed( ProtectedType::StolenV2, { ProtectedType::Constant, ProtectedType::StolenV3 } );
+
+        if (context.m_RegisterThreadFunc)
+            context.m_RegisterThreadFunc = TransformToRealAddress( context, address, context.m_RegisterThreadFunc );
+    }
+
+    context.m_InitLibraryFunc = hits.First( PatternGroup::Init );
+    context.m_TermLibraryFunc = hits.First( PatternGroup::Terminate );
+
+    if (context.m_InitLibraryFunc)
+        context.m_InitLibraryFunc = TransformToRealAddress( context, address, context.m_InitLibraryFunc );
+
+    if (context.m_TermLibraryFunc)
+        context.m_TermLibraryFunc = TransformToRealAddress( context, address, context.m_TermLibraryFunc );
+
+    hits.All( PatternGroup::Integrity, context.m_IntegrityFuncs );
+    TransformToRealAddress( context, address, context.m_IntegrityFuncs );
+
+    hits.All( PatternGroup::TestSecret, context.m_TestSecretFuncs );
+    TransformToRealAddress( context, address, context.m_TestSecretFuncs );
+
+    auto writer = std::make_unique<JsonWriter>( output );
+    writer->WriteJSON( context );
+
+    return {};
+}
+
+
+/**
+* @brief Benchmarks the mem scanners and the precompiled patterns of a signature group.
+*
+* @param suite The suite collecting the results.
+* @param prefix Name prefix of the benchmarks.
+* @param group Name of the signature group.
+* @param patterns Container of precompiled patterns.
+* @param context The analysis context holding the executable sections.
+* @param code_size Total size of the executable sections.
+*/
+void BenchmarkGroup(
+    BenchSuite & suite,
+    std::string_view prefix,
+    std::string_view group,
+    const auto & patterns,
+    const AnalysisContext & context,
+    std::uint64_t code_size
+)
+{
+    std::vector<mem::region> regions {};
+    for (const auto & section : context.m_Sections)
+        regions.emplace_back( SectionAddress( context, section ), section.m_Size );
+
+    // The mem scanners keep a pointer to their pattern, so the patterns are never moved once scanners exist.
+    std::vector<mem::pattern> mem_patterns {};
+    mem_patterns.reserve( patterns.size() );
+
+    for (const auto & pattern : patterns)
+        mem_patterns.emplace_back( pattern.bytes(), pattern.masks(), pattern.size() );
+
+    std::vector<mem::simd_scanner> simd_scanners( mem_patterns.begin(), mem_patterns.end() );
+    std::vector<mem::boyer_moore_scanner> boyer_moore_scanners( mem_patterns.begin(), mem_patterns.end() );
+
+    std::size_t simd_matches = 0;
+    std::size_t boyer_moore_matches = 0;
+    std::size_t static_matches = 0;
+
+    suite.Run( std::format( "{}/simd_scanner/{}", prefix, group ), code_size, [&]()
+    {
+        simd_matches = 0;
+
+        for (const auto & scanner : simd_scanners)
+        {
+            for (const auto & region : regions)
+                simd_matches += scanner.scan_all( region ).size();
+        }
+    } );
+
+    suite.Run( std::format( "{}/boyer_moore_scanner/{}", prefix, group ), code_size, [&]()
+    {
+        boyer_moore_matches = 0;
+
+        for (const auto & scanner : boyer_moore_scanners)
+        {
+            for (const auto & region : regions)
+                boyer_moore_matches += scanner.scan_all( region ).size();
+        }
+    } );
+
+    suite.Run( std::format( "{}/StaticPattern/{}", prefix, group ), code_size, [&]()
+    {
+        std::vector<mem::pointer> res {};
+
+        for (const auto & pattern : patterns)
+        {
+            for (const auto & region : regions)
+                pattern.ScanAll( region, res );
+        }
+
+        static_matches = res.size();
+    } );
+
+    if (simd_matches != boyer_moore_matches || simd_matches != static_matches)
+    {
+        std::cout << std::format( "[WARNING] {} group '{}': scanners disagree ('{}', '{}' and '{}' matches).",
+            prefix, group, simd_matches, boyer_moore_matches, static_matches ) << std::endl;
+    }
+}
+
+
+/**
+* @brief Runs the micro-benchmarks of a single binary.
+*
+* @param suite The suite collecting the results.
+* @param binary Path to the CEG binary.
+* @param output Path to the temporary JSON output.
+* @return 'std::expected<std::uint64_t, Error>' The total size of the executable sections or specific error.
+*/
+[[nodiscard]] std::expected<std::uint64_t, Error> BenchmarkImage(
+    BenchSuite & suite,
+    const fs::path & binary,
+    const fs::path & output
+)
+{
+    auto map_res = MappedFile::Open( binary );
+    if (!map_res)
+        return std::unexpected( map_res.error() );
+
+    const auto content = map_res->bytes();
+
+    AnalysisContext context {};
+    void * address = nullptr;
+    std::uint32_t size = 0;
+
+    if (auto load_res = LoadBinaryImage( context, content, address, size ); !load_res)
+        return std::unexpected( load_res.error() );
+
+    std::uint64_t code_size = 0;
+    for (const auto & section : context.m_Sections)
+        code_size += section.m_Size;
+
+    const auto prefix = binary.filename().string();
+
+    suite.Run( std::format( "{}/Hash", prefix ), content.size(), [&]()
+    {
+        [[maybe_unused]] const volatile auto image_hash = Hash::Xxh64( content );
+    } );
+
+    BenchmarkGroup( suite, prefix, "Init", CEG_INIT_LIBRARY_FUNC_PATTERNS, context, code_size );
+    BenchmarkGroup( suite, prefix, "Terminate", CEG_TERM_LIBRARY_FUNC_PATTERNS, context, code_size );
+    BenchmarkGroup( suite, prefix, "RegisterThread", CEG_REGISTER_THREAD_FUNC_PATTERNS, context, code_size );
+    BenchmarkGroup( suite, prefix, "Protect", CEG_PROTECT_PATTERNS, context, code_size );
+    BenchmarkGroup( suite, prefix, "Integrity", CEG_INTEGRITY_PATTERNS, context, code_size );
+    BenchmarkGroup( suite, prefix, "TestSecret", CEG_TESTSECRET_PATTERNS, context, code_size );
+
+    MultiPatternScanner scanner;
+    AddPatternGroups( scanner );
+    scanner.Compile();
+
+    ScanResults hits {};
+    suite.Run( std::format( "{}/MultiPatternScanner", prefix ), code_size, [&]() { hits = scanner.Scan( context ); } );
+
+    // Every repetition analyzes into a fresh copy, the analyzer appends to the context.
+    AnalysisContext analyzed {};
+
+    suite.Run( std::format( "{}/InstructionAnalyzer", prefix ), code_size, [&]()
+    {
+        analyzed = context;
+        AnalyzeProtected( analyzed, content, hits );
+    } );
+
+    hits.All( PatternGroup::Integrity, analyzed.m_IntegrityFuncs );
+    hits.All( PatternGroup::TestSecret, analyzed.m_TestSecretFuncs );
+
+    suite.Run( std::format( "{}/JsonWriter", prefix ), analyzed.m_ProtectedFuncs.size() * sizeof( ProtectedEntry ), [&]()
+    {
+        auto writer = std::make_unique<JsonWriter>( output );
+        writer->WriteJSON( analyzed );
+    } );
+
+    return code_size;
+}
+
+
+int main(
+    int argc,
+    char * argv[]
+)
+{
+    std::cout << "CEG signatures benchmark by iArtorias (https://github.com/iArtorias)" << std::endl << std::endl;
+
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << std::format( "Usage: '{}' <ceg_binary_or_directory> [--repetitions <count>] [--output <path>].", argv[0] ) << std::endl;
+            std::cerr << std::format( "       '{}' --generate <image> [--size <MiB>] [--seed <seed>].", argv[0] ) << std::endl;
+            return 1;
+        }
+
+        // Lambda function to parse a numeric option value.
+        auto parse_value = []( std::string_view value, std::uint32_t & res ) -> bool
+        {
+            const auto [ptr, ec] = std::from_chars( value.data(), value.data() + value.size(), res );
+            return ec == std::errc {} && ptr == value.data() + value.size();
+        };
+
+        if (std::string_view( argv[1] ) == "--generate")
+        {
+            if (argc < 3)
+            {
+                std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( Error::InvalidOptionValue ) ) << std::endl;
+                return 1;
+            }
+
+            const fs::path image_path = argv[2];
+            std::uint32_t size_mib = 10;
+            std::uint32_t seed = 1;
+
+            for (int i = 3; i < argc; ++i)
+            {
+                const std::string_view option = argv[i];
+                bool valid = i + 1 < argc;
+
+                if (valid && option == "--size")
+                    valid = parse_value( argv[++i], size_mib ) && size_mib && size_mib <= 2048;
+                else if (valid && option == "--seed")
+                    valid = parse_value( argv[++i], seed );
+                else
+                {
+                    std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( Error::UnknownOption ) ) << std::endl;
+                    return 1;
+                }
+
+                if (!valid)
+                {
+                    std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( Error::InvalidOptionValue ) ) << std::endl;
+                    return 1;
+                }
+            }
+
+            const auto image = SyntheticImage::Generate( size_mib * 0x100000, seed );
+
+            if (auto save_res = image->Save( image_path ); !save_res)
+            {
+                std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( save_res.error() ) ) << std::endl;
+                return 1;
+            }
+
+            const auto & manifest = image->Manifest();
+            std::cout << std::format( "[SUCCESS] Generated '{}': '{}' bytes of code, '{}' protected call sites, '{}' integrity and '{}' test secret functions.",
+                image_path.string(), manifest.m_CodeSize, manifest.m_Protected.size(), manifest.m_Integrity.size(),
+                manifest.m_TestSecret.size() ) << std::endl;
+            return 0;
+        }
+
+        const fs::path samples = argv[1];
+        std::uint32_t repetitions = 20;
+        fs::path benchmark_path = fs::path( argv[0] ).parent_path() / "noceg_bench.json";
+
+        for (int i = 2; i < argc; ++i)
+        {
+            const std::string_view option = argv[i];
+
+            if (option == "--repetitions" && i + 1 < argc)
+            {
+                if (!parse_value( argv[++i], repetitions ) || !repetitions)
+                {
+                    std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( Error::InvalidOptionValue ) ) << std::endl;
+                    return 1;
+                }
+            }
+            else if (option == "--output" && i + 1 < argc)
+                benchmark_path = argv[++i];
+            else
+            {
+                std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( Error::UnknownOption ) ) << std::endl;
+                return 1;
+            }
+        }
+
+        // A directory replays every binary inside of it, sorted so the runs are comparable.
+        std::vector<fs::path> images {};
+
+        if (fs::is_directory( samples ))
+        {
+            for (const auto & entry : fs::directory_iterator( samples ))
+            {
+                const auto extension = entry.path().extension();
+
+                if (entry.is_regular_file() && (extension == ".exe" || extension == ".dll"))
+                    images.push_back( entry.path() );
+            }
+
+            std::ranges::sort( images );
+        }
+        else
+            images.push_back( samples );
+
+        if (images.empty())
+        {
+            std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( Error::FileNotFound ) ) << std::endl;
+            return 1;
+        }
+
+        BenchSuite suite( repetitions );
+        const auto output = fs::temp_directory_path() / "noceg_bench_output.json";
+
+        std::vector<fs::path> replay {};
+        std::uint64_t replay_size = 0;
+
+        for (const auto & image : images)
+        {
+            auto image_res = BenchmarkImage( suite, image, output );
+
+            if (!image_res)
+            {
+                std::cout << std::format( "[WARNING] Skipping '{}': '{}'.", image.filename().string(), ErrorToString( image_res.error() ) ) << std::endl;
+                continue;
+            }
+
+            AnalysisContext context {};
+
+            suite.Run( std::format( "{}/EndToEnd", image.filename().string() ), image_res.value(), [&]()
+            {
+                [[maybe_unused]] const auto pipeline_res = RunPipeline( image, output, context );
+            } );
+
+            // Synthetic images are checked against the results they were generated with.
+            if (SyntheticManifest manifest {}; SyntheticImage::LoadManifest( SyntheticImage::ManifestPath( image ), manifest ))
+            {
+                const auto mismatch = SyntheticImage::Verify( manifest, context );
+                suite.Check( image.filename().string(), mismatch.m_Missing, mismatch.m_Unexpected );
+            }
+
+            replay.push_back( image );
+            replay_size += image_res.value();
+        }
+
+        // Replay the whole set in order, as a batch of runs of the signatures finder would.
+        if (replay.size() > 1)
+        {
+            AnalysisContext context {};
+
+            suite.Run( "Replay", replay_size, [&]()
+            {
+                for (const auto & image : replay)
+                    [[maybe_unused]] const auto pipeline_res = RunPipeline( image, output, context );
+            } );
+        }
+
+        std::error_code ec {};
+        fs::remove( output, ec );
+
+        if (auto save_res = suite.Save( benchmark_path ); !save_res)
+        {
+            std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( save_res.error() ) ) << std::endl;
+            return 1;
+        }
+
+        std::cout << std::format( "[SUCCESS] Benchmark results saved to '{}'.", benchmark_path.string() ) << std::endl;
+        return suite.Passed() ? 0 : 1;
+    }
+    catch (const std::exception & ex)
+    {
+        std::cerr << std::format( "[ERROR] '{}'.", ex.what() ) << std::endl;
+        return 1;
+    }
+}
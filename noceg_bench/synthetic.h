@@ -0,0 +1,889 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include <utils.h>
+
+#include <random>
+
+namespace CEG
+{
+    // Ground truth of a synthetic image, every address is a virtual address.
+    struct SyntheticManifest
+    {
+        // Seed the image was generated from.
+        std::uint32_t m_Seed { 0 };
+
+        // Size of the code section.
+        std::uint32_t m_CodeSize { 0 };
+
+        // Planted CEG init, terminate and register thread functions.
+        std::uint32_t m_Init { 0 };
+        std::uint32_t m_Terminate { 0 };
+        std::uint32_t m_RegisterThread { 0 };
+
+        // Planted CEG integrity and test secret functions in ascending order.
+        std::vector<std::uint32_t> m_Integrity {};
+        std::vector<std::uint32_t> m_TestSecret {};
+
+        // One row per planted call site of a CEG protected function.
+        std::vector<ProtectedEntry> m_Protected {};
+    };
+
+
+    // Differences between the analysis results and the manifest of a synthetic image.
+    struct SyntheticMismatch
+    {
+        // Planted results the analysis did not report.
+        std::size_t m_Missing { 0 };
+
+        // Reported results that were not planted.
+        std::size_t m_Unexpected { 0 };
+    };
+
+
+    // Generates 32-bit PE images with the CEG signatures planted at known positions among filler code.
+    class SyntheticImage
+    {
+    private:
+
+        // Bumped whenever the manifest layout changes.
+        static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+        static constexpr std::uint32_t IMAGE_BASE = 0x00400000;
+        static constexpr std::uint32_t SECTION_ALIGNMENT = 0x1000;
+        static constexpr std::uint32_t FILE_ALIGNMENT = 0x200;
+        static constexpr std::uint32_t HEADERS_SIZE = 0x400;
+        static constexpr std::uint32_t CODE_RVA = 0x1000;
+
+        // Displacements, immediates and wildcards are drawn from these bytes.
+        // None of them is a prefix or an opcode the scanners and the analyzer look for.
+        static constexpr std::array<std::uint8_t, 15> FILL_BYTES =
+        {
+            0x04, 0x08, 0x0C, 0x10, 0x14, 0x18, 0x1C, 0x20, 0x24, 0x28, 0x2C, 0x30, 0x34, 0x38, 0x3C
+        };
+
+        // Instructions of the filler functions, none of them is a call or completes a CEG signature.
+        static constexpr std::array<StaticPattern, 18> FILLER_INSTRUCTIONS =
+        {
+            "8B 45 ??",
+            "89 45 ??",
+            "8B 4D ??",
+            "89 4D ??",
+            "8B 55 ??",
+            "8D 45 ??",
+            "C7 45 ?? ?? ?? ?? ??",
+            "83 C4 ??",
+            "6A ??",
+            "74 ??",
+            "75 ??",
+            "03 C1",
+            "2B C2",
+            "85 C0",
+            "33 C0",
+            "0F B6 C0",
+            "50",
+            "40"
+        };
+
+        // One instance of every finalize CRC call shape the analyzer recognizes, tried in the same order.
+        static constexpr std::array<StaticPattern, 6> FINALIZE_CRC_SHAPES =
+        {
+            "E8 ?? ?? ?? ?? 8D 8D ?? ?? FF FF E8 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 8B 45 ??",
+            "E8 ?? ?? ?? ?? 8D 4D ?? E8 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 8B 45 ??",
+            "E8 ?? ?? ?? ?? 8D 4C 24 ?? E8 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 8B 44 24 ??",
+            "E8 ?? ?? ?? ?? 8D 4D ?? E8 ?? ?? ?? ?? 5F",
+            "E8 ?? ?? ?? ?? 8D 8D ?? ?? FF FF E8 ?? ?? ?? ?? 5F",
+            "E8 ?? ?? ?? ?? 8D 4C 24 ?? E8 ?? ?? ?? ?? 5F"
+        };
+
+        // Offset of the instruction following the finalize CRC call in every shape.
+        static constexpr std::array<std::uint32_t, 6> FINALIZE_CRC_BREAKPOINTS = { 16, 13, 14, 13, 16, 14 };
+
+        // Upper bound of a filler function, so the planted results keep their spacing.
+        static constexpr std::uint32_t MAX_FILLER_SIZE = 0x100;
+
+
+        // A call whose target is only known once the whole code is laid out.
+        struct Fixup
+        {
+            // Code offset of the 'E8' opcode.
+            std::uint32_t m_Site { 0 };
+
+            // Index of the target protected function, or 'UINT32_MAX' for the register thread function.
+            std::uint32_t m_Target { 0 };
+        };
+
+
+        // A planted CEG protected function and the call sites reaching it.
+        struct ProtectedPlant
+        {
+            std::uint32_t m_Function { 0 };
+            std::uint32_t m_Breakpoint { 0 };
+            ProtectedType m_Type { ProtectedType::Constant };
+
+            // Code offsets of the call sites and of the prologues of their functions, only used by 'StolenV3'.
+            std::vector<std::uint32_t> m_Sites {};
+            std::vector<std::uint32_t> m_Prologues {};
+        };
+
+
+        std::vector<std::byte> m_Code {};
+        std::vector<std::uint32_t> m_Functions {};
+        std::vector<Fixup> m_Fixups {};
+        std::vector<ProtectedPlant> m_Plants {};
+        SyntheticManifest m_Manifest {};
+
+        // Only the raw generator output is used, the distributions differ between standard libraries.
+        std::mt19937 m_Random {};
+
+
+        // Gets a pseudo random number in the range [0, bound).
+        [[nodiscard]] std::uint32_t Next(
+            std::uint32_t bound
+        ) noexcept
+        {
+            return static_cast<std::uint32_t>(m_Random() % bound);
+        }
+
+
+        // Gets the current code offset.
+        [[nodiscard]] std::uint32_t Here() const noexcept
+        {
+            return static_cast<std::uint32_t>(m_Code.size());
+        }
+
+
+        // Converts a code offset to its virtual address.
+        [[nodiscard]] static constexpr std::uint32_t ToVa(
+            std::uint32_t offset
+        ) noexcept
+        {
+            return IMAGE_BASE + CODE_RVA + offset;
+        }
+
+
+        // Appends raw bytes.
+        void Emit(
+            std::initializer_list<std::uint8_t> bytes
+        )
+        {
+            for (const auto value : bytes)
+                m_Code.push_back( static_cast<std::byte>(value) );
+        }
+
+
+        // Appends the given number of fill bytes.
+        void Fill(
+            std::size_t count
+        )
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                m_Code.push_back( static_cast<std::byte>(FILL_BYTES[Next( FILL_BYTES.size() )]) );
+        }
+
+
+        // Appends an instance of a pattern, its wildcards receive fill bytes and its calls a filler function.
+        void Plant(
+            const StaticPattern & pattern
+        )
+        {
+            for (std::size_t i = 0; i < pattern.size(); ++i)
+            {
+                const auto call = pattern.masks()[i] && pattern.bytes()[i] == 0xE8 && i + 4 < pattern.size() &&
+                    std::none_of( pattern.masks() + i + 1, pattern.masks() + i + 5, []( auto mask ) { return mask; } );
+
+                if (call)
+                {
+                    // A fill byte displacement can reach a protected function in a large image.
+                    std::uint32_t target = Here() + 5;
+                    static_cast<void>(PickCallee( target ));
+                    EmitCall( target );
+                    i += 4;
+                }
+                else if (pattern.masks()[i])
+                    m_Code.push_back( static_cast<std::byte>(pattern.bytes()[i]) );
+                else
+                    Fill( 1 );
+            }
+        }
+
+
+        // Pads the code with 'int3' to the next 16 byte boundary.
+        void Align()
+        {
+            while (m_Code.size() % 16)
+                m_Code.push_back( std::byte { 0xCC } );
+        }
+
+
+        // Appends a direct call.
+        void EmitCall(
+            std::uint32_t target
+        )
+        {
+            const auto rel = target - (Here() + 5);
+            Emit( { 0xE8, static_cast<std::uint8_t>(rel), static_cast<std::uint8_t>(rel >> 8),
+                static_cast<std::uint8_t>(rel >> 16), static_cast<std::uint8_t>(rel >> 24) } );
+        }
+
+
+        /**
+        * @brief Picks an earlier filler function to call from the current position.
+        *
+        * The analyzer decodes at every byte, so a displacement containing one of the opcodes
+        * it follows would add a reference that was not planted.
+        *
+        * @param target [out] Code offset of the picked function, left untouched if none was found.
+        * @return True if a function with an inert displacement was found.
+        */
+        [[nodiscard]] bool PickCallee(
+            std::uint32_t & target
+        ) noexcept
+        {
+            if (m_Functions.empty())
+                return false;
+
+            for (std::uint32_t attempt = 0; attempt < 4; ++attempt)
+            {
+                const auto callee = m_Functions[Next( static_cast<std::uint32_t>(m_Functions.size()) )];
+                const auto rel = callee - (Here() + 5);
+
+                const auto inert = std::ranges::none_of( std::array { rel, rel >> 8, rel >> 16, rel >> 24 }, []( std::uint32_t value )
+                {
+                    value &= 0xFF;
+                    return value == 0xE8 || value == 0xE9 || value == 0xEB || value == 0xB8 || value == 0xC7;
+                } );
+
+                if (inert)
+                {
+                    target = callee;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+
+        // Appends a call resolved once the code is laid out.
+        void EmitFixup(
+            std::uint32_t target
+        )
+        {
+            m_Fixups.push_back( Fixup { Here(), target } );
+            Emit( { 0xE8, 0x00, 0x00, 0x00, 0x00 } );
+        }
+
+
+        // Appends a few filler instructions without calls.
+        void EmitBody(
+            std::uint32_t count
+        )
+        {
+            for (std::uint32_t i = 0; i < count; ++i)
+                Plant( FILLER_INSTRUCTIONS[Next( FILLER_INSTRUCTIONS.size() )] );
+        }
+
+
+        // Appends a filler function calling back into the earlier ones.
+        void EmitFiller()
+        {
+            const auto start = Here();
+            const bool frame = Next( 2 );
+            const bool saved = Next( 2 );
+
+            Emit( { 0x55, 0x8B, 0xEC } );
+
+            if (frame)
+                Plant( "83 EC ??" );
+
+            if (saved)
+                Emit( { 0x53, 0x56 } );
+
+            const auto count = 4 + Next( 24 );
+
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                std::uint32_t callee = 0;
+
+                if (!Next( 8 ) && PickCallee( callee ))
+                    EmitCall( callee );
+                else
+                    EmitBody( 1 );
+            }
+
+            if (saved)
+                Emit( { 0x5E, 0x5B } );
+
+            if (frame)
+                Emit( { 0x8B, 0xE5 } );
+
+            Emit( { 0x5D, 0xC3 } );
+            Align();
+
+            m_Functions.push_back( start );
+        }
+
+
+        // Appends a CEG protected function ending in one of the finalize CRC call shapes.
+        void EmitProtected(
+            ProtectedPlant & plant
+        )
+        {
+            plant.m_Function = Here();
+
+            Plant( CEG_PROTECT_PATTERNS[Next( CEG_PROTECT_PATTERNS.size() )] );
+            Fill( 4 );
+            EmitBody( 2 + Next( 6 ) );
+
+            const auto shape = Next( FINALIZE_CRC_SHAPES.size() );
+            plant.m_Breakpoint = Here() + FINALIZE_CRC_BREAKPOINTS[shape];
+
+            Plant( FINALIZE_CRC_SHAPES[shape] );
+            Emit( { 0x5E, 0x5B, 0x8B, 0xE5, 0x5D, 0xC3 } );
+            Align();
+        }
+
+
+        // Appends a call site of a CEG protected function in the layout matching its type.
+        void EmitCallSite(
+            std::uint32_t index
+        )
+        {
+            auto & plant = m_Plants[index];
+            const auto start = Here();
+
+            switch (plant.m_Type)
+            {
+                // A stolen function ends with a 'jmp eax' to the restored code.
+                case ProtectedType::StolenV2:
+                    plant.m_Sites.push_back( Here() );
+                    plant.m_Prologues.push_back( 0 );
+                    EmitFixup( index );
+                    Emit( { 0xFF, 0xE0 } );
+                    break;
+
+                // A stolen function called from within the body of a regular function.
+                case ProtectedType::StolenV3:
+                    Emit( { 0x55, 0x8B, 0xEC } );
+                    Plant( "83 EC ??" );
+                    EmitBody( 1 + Next( 8 ) );
+                    plant.m_Sites.push_back( Here() );
+                    plant.m_Prologues.push_back( start );
+                    EmitFixup( index );
+                    Emit( { 0x83, 0xC4, 0x04 } );
+                    EmitBody( Next( 4 ) );
+                    Emit( { 0x8B, 0xE5, 0x5D, 0xC3 } );
+                    break;
+
+                // A constant is either returned right away or stored.
+                default:
+                    plant.m_Sites.push_back( Here() );
+                    plant.m_Prologues.push_back( 0 );
+                    EmitFixup( index );
+
+                    if (Next( 2 ))
+                        Emit( { 0xC3 } );
+                    else
+                    {
+                        Plant( "89 45 ??" );
+                        Emit( { 0xC3 } );
+                    }
+                    break;
+            }
+
+            Align();
+        }
+
+
+        /**
+        * @brief Appends an instance of a random pattern of a group.
+        *
+        * @param patterns The patterns of the group.
+        * @param res [out] Virtual addresses of every match of the group within the instance,
+        * some patterns also match a part of a longer sibling.
+        * @return Code offset of the instance.
+        */
+        std::uint32_t EmitSignature(
+            const auto & patterns,
+            std::vector<std::uint32_t> & res
+        )
+        {
+            const auto start = Here();
+
+            Plant( patterns[Next( static_cast<std::uint32_t>(patterns.size()) )] );
+            Fill( 4 );
+            Emit( { 0xC3 } );
+            Align();
+
+            const auto * base = m_Code.data();
+            const mem::region range( base + start, Here() - start );
+            std::vector<mem::pointer> matches {};
+
+            for (const auto & pattern : patterns)
+                pattern.ScanAll( range, matches );
+
+            for (const auto & match : matches)
+                res.push_back( ToVa( static_cast<std::uint32_t>(match.as<const std::byte *>() - base) ) );
+
+            return start;
+        }
+
+
+        // Resolves the calls to the protected and register thread functions.
+        void ResolveFixups()
+        {
+            for (const auto & fixup : m_Fixups)
+            {
+                const auto target = fixup.m_Target == UINT32_MAX ?
+                    m_Manifest.m_RegisterThread - ToVa( 0 ) : m_Plants[fixup.m_Target].m_Function;
+
+                const auto rel = target - (fixup.m_Site + 5);
+                std::memcpy( m_Code.data() + fixup.m_Site + 1, &rel, sizeof( rel ) );
+            }
+        }
+
+
+        // Fills in the protected function rows, ordered like a finalized 'ResultTable'.
+        void BuildManifest()
+        {
+            auto & rows = m_Manifest.m_Protected;
+
+            for (const auto & plant : m_Plants)
+            {
+                for (std::size_t i = 0; i < plant.m_Sites.size(); ++i)
+                {
+                    // Only the stolen functions called from a regular function report its prologue.
+                    const auto prologue = plant.m_Type == ProtectedType::StolenV3 ? plant.m_Prologues[i] : plant.m_Function;
+
+                    rows.push_back( ProtectedEntry { ToVa( plant.m_Function ), ToVa( prologue ),
+                        ToVa( plant.m_Sites[i] ), ToVa( plant.m_Breakpoint ), plant.m_Type } );
+                }
+            }
+
+            std::ranges::sort( rows, []( const ProtectedEntry & lhs, const ProtectedEntry & rhs )
+            {
+                return std::tie( lhs.m_Type, lhs.m_Func, lhs.m_Eip, lhs.m_Bp, lhs.m_Prologue ) <
+                    std::tie( rhs.m_Type, rhs.m_Func, rhs.m_Eip, rhs.m_Bp, rhs.m_Prologue );
+            } );
+
+            for (auto * addresses : { &m_Manifest.m_Integrity, &m_Manifest.m_TestSecret })
+            {
+                std::ranges::sort( *addresses );
+                addresses->erase( std::ranges::unique( *addresses ).begin(), addresses->end() );
+            }
+        }
+
+
+        // Counts the elements of a sorted range missing from another one.
+        [[nodiscard]] static std::size_t CountMissing(
+            const auto & expected,
+            const auto & actual,
+            auto less
+        )
+        {
+            std::size_t missing = 0;
+
+            for (const auto & value : expected)
+            {
+                if (!std::ranges::binary_search( actual, value, less ))
+                    ++missing;
+            }
+
+            return missing;
+        }
+
+
+        // Compares the planted and the reported addresses of a group.
+        static void CompareAddresses(
+            std::vector<std::uint32_t> expected,
+            const std::vector<mem::pointer> & reported,
+            SyntheticMismatch & res
+        )
+        {
+            std::vector<std::uint32_t> actual {};
+            for (const auto & address : reported)
+                actual.push_back( address.as<std::uint32_t>() );
+
+            std::ranges::sort( expected );
+            std::ranges::sort( actual );
+            actual.erase( std::ranges::unique( actual ).begin(), actual.end() );
+
+            res.m_Missing += CountMissing( expected, actual, std::ranges::less {} );
+            res.m_Unexpected += CountMissing( actual, expected, std::ranges::less {} );
+        }
+
+
+        // Compares a planted and a reported single address.
+        static void CompareAddress(
+            std::uint32_t expected,
+            mem::pointer reported,
+            SyntheticMismatch & res
+        )
+        {
+            const auto actual = reported.as<std::uint32_t>();
+
+            if (expected == actual)
+                return;
+
+            if (expected)
+                ++res.m_Missing;
+
+            if (actual)
+                ++res.m_Unexpected;
+        }
+
+    public:
+
+        // Smallest supported code section size.
+        static constexpr std::uint32_t MIN_CODE_SIZE = 0x100000;
+
+
+        /**
+        * @brief Generates the code section of a synthetic image.
+        *
+        * Every 32 KiB of code gets a protected function with one to three call sites, every 512 KiB a test secret
+        * and every 1 MiB an integrity function. A single init, terminate and register thread function is planted.
+        *
+        * @param code_size Requested size of the code section, at least 'MIN_CODE_SIZE'.
+        * @param seed Seed of the layout, the same seed and size always give the same image.
+        * @return The generated image.
+        */
+        [[nodiscard]] static std::unique_ptr<SyntheticImage> Generate(
+            std::uint32_t code_size,
+            std::uint32_t seed
+        )
+        {
+            auto image = std::make_unique<SyntheticImage>();
+            image->m_Random.seed( seed );
+            image->m_Manifest.m_Seed = seed;
+
+            code_size = std::max( code_size, MIN_CODE_SIZE );
+            image->m_Code.reserve( code_size + MAX_FILLER_SIZE );
+
+            // Kinds of the planted results, shuffled so every kind is spread over the whole section.
+            enum class Unit : std::uint8_t { Protected, CallSite, Integrity, TestSecret, Init, Terminate, RegisterThread, RegisterThreadCall };
+
+            std::vector<std::pair<Unit, std::uint32_t>> units {};
+            const std::uint32_t protected_count = code_size / 0x8000;
+
+            image->m_Plants.resize( protected_count );
+
+            for (std::uint32_t i = 0; i < protected_count; ++i)
+            {
+                constexpr std::array<ProtectedType, 3> TYPES = { ProtectedType::Constant, ProtectedType::StolenV2, ProtectedType::StolenV3 };
+                image->m_Plants[i].m_Type = TYPES[image->Next( TYPES.size() )];
+
+                units.emplace_back( Unit::Protected, i );
+
+                for (std::uint32_t sites = 1 + image->Next( 3 ); sites; --sites)
+                    units.emplace_back( Unit::CallSite, i );
+            }
+
+            for (std::uint32_t i = 0; i < code_size / 0x100000; ++i)
+                units.emplace_back( Unit::Integrity, 0 );
+
+            for (std::uint32_t i = 0; i < code_size / 0x80000; ++i)
+                units.emplace_back( Unit::TestSecret, 0 );
+
+            units.emplace_back( Unit::Init, 0 );
+            units.emplace_back( Unit::Terminate, 0 );
+            units.emplace_back( Unit::RegisterThread, 0 );
+            units.emplace_back( Unit::RegisterThreadCall, 0 );
+
+            // Fisher-Yates on the raw generator output.
+            for (auto i = static_cast<std::uint32_t>(units.size()); i > 1; --i)
+                std::swap( units[i - 1], units[image->Next( i )] );
+
+            for (std::size_t i = 0; i < units.size(); ++i)
+            {
+                const auto target = static_cast<std::uint32_t>((i + 1) * std::uint64_t { code_size } / (units.size() + 1));
+
+                do
+                    image->EmitFiller();
+                while (image->Here() + MAX_FILLER_SIZE < target);
+
+                const auto [unit, index] = units[i];
+                auto & manifest = image->m_Manifest;
+                std::vector<std::uint32_t> matches {};
+
+                switch (unit)
+                {
+                    case Unit::Protected:
+                        image->EmitProtected( image->m_Plants[index] );
+                        break;
+
+                    case Unit::CallSite:
+                        image->EmitCallSite( index );
+                        break;
+
+                    case Unit::Integrity:
+                        image->EmitSignature( CEG_INTEGRITY_PATTERNS, manifest.m_Integrity );
+                        break;
+
+                    case Unit::TestSecret:
+                        image->EmitSignature( CEG_TESTSECRET_PATTERNS, manifest.m_TestSecret );
+                        break;
+
+                    // The analysis takes the first match, which is the instance itself.
+                    case Unit::Init:
+                        manifest.m_Init = ToVa( image->EmitSignature( CEG_INIT_LIBRARY_FUNC_PATTERNS, matches ) );
+                        break;
+
+                    case Unit::Terminate:
+                        manifest.m_Terminate = ToVa( image->EmitSignature( CEG_TERM_LIBRARY_FUNC_PATTERNS, matches ) );
+                        break;
+
+                    case Unit::RegisterThread:
+                        manifest.m_RegisterThread = ToVa( image->EmitSignature( CEG_REGISTER_THREAD_FUNC_PATTERNS, matches ) );
+                        break;
+
+                    case Unit::RegisterThreadCall:
+                        image->Emit( { 0x55, 0x8B, 0xEC } );
+                        image->EmitFixup( UINT32_MAX );
+                        image->Emit( { 0x5D, 0xC3 } );
+                        image->Align();
+                        break;
+                }
+            }
+
+            while (image->Here() + MAX_FILLER_SIZE < code_size)
+                image->EmitFiller();
+
+            image->m_Code.resize( (image->m_Code.size() + FILE_ALIGNMENT - 1) & ~(FILE_ALIGNMENT - 1), std::byte { 0xCC } );
+            image->m_Manifest.m_CodeSize = image->Here();
+
+            image->ResolveFixups();
+            image->BuildManifest();
+
+            return image;
+        }
+
+
+        // Gets the ground truth of the image.
+        [[nodiscard]] const SyntheticManifest & Manifest() const noexcept
+        {
+            return m_Manifest;
+        }
+
+
+        /**
+        * @brief Gets the manifest path of a synthetic image.
+        *
+        * @param image Path to the image.
+        * @return Path to the '<image>.manifest.json' file.
+        */
+        [[nodiscard]] static fs::path ManifestPath(
+            const fs::path & image
+        )
+        {
+            auto path = image;
+            path.replace_extension( ".manifest.json" );
+            return path;
+        }
+
+
+        /**
+        * @brief Saves the image as a PE file with a single code section and its manifest next to it.
+        *
+        * @param path Path to the image.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'OutputFileCreateError' if a file cannot be created.
+        * @retval 'FileWriteError' if writing fails.
+        */
+        [[nodiscard]] std::expected<void, Error> Save(
+            const fs::path & path
+        ) const noexcept try
+        {
+            std::vector<std::byte> headers( HEADERS_SIZE );
+
+            auto * dos_header = reinterpret_cast<IMAGE_DOS_HEADER *>(headers.data());
+            dos_header->e_magic = IMAGE_DOS_SIGNATURE;
+            dos_header->e_lfanew = 0x80;
+
+            auto * nt_headers = reinterpret_cast<IMAGE_NT_HEADERS32 *>(headers.data() + dos_header->e_lfanew);
+            nt_headers->Signature = IMAGE_NT_SIGNATURE;
+
+            auto & file_header = nt_headers->FileHeader;
+            file_header.Machine = IMAGE_FILE_MACHINE_I386;
+            file_header.NumberOfSections = 1;
+            file_header.SizeOfOptionalHeader = sizeof( IMAGE_OPTIONAL_HEADER32 );
+            file_header.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE | IMAGE_FILE_32BIT_MACHINE;
+
+            const auto code_size = static_cast<std::uint32_t>(m_Code.size());
+
+            auto & optional_header = nt_headers->OptionalHeader;
+            optional_header.Magic = IMAGE_NT_OPTIONAL_HDR32_MAGIC;
+            optional_header.SizeOfCode = code_size;
+            optional_header.AddressOfEntryPoint = m_Functions.empty() ? 0 : CODE_RVA + m_Functions.front();
+            optional_header.BaseOfCode = CODE_RVA;
+            optional_header.ImageBase = IMAGE_BASE;
+            optional_header.SectionAlignment = SECTION_ALIGNMENT;
+            optional_header.FileAlignment = FILE_ALIGNMENT;
+            optional_header.MajorOperatingSystemVersion = 5;
+            optional_header.MajorSubsystemVersion = 5;
+            optional_header.SizeOfImage = CODE_RVA + ((code_size + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1));
+            optional_header.SizeOfHeaders = HEADERS_SIZE;
+            optional_header.Subsystem = IMAGE_SUBSYSTEM_WINDOWS_CUI;
+            optional_header.DllCharacteristics = IMAGE_DLLCHARACTERISTICS_NX_COMPAT;
+            optional_header.SizeOfStackReserve = 0x100000;
+            optional_header.SizeOfStackCommit = 0x1000;
+            optional_header.SizeOfHeapReserve = 0x100000;
+            optional_header.SizeOfHeapCommit = 0x1000;
+            optional_header.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+
+            auto * section = IMAGE_FIRST_SECTION( nt_headers );
+            std::memcpy( section->Name, ".text", 5 );
+            section->Misc.VirtualSize = code_size;
+            section->VirtualAddress = CODE_RVA;
+            section->SizeOfRawData = code_size;
+            section->PointerToRawData = HEADERS_SIZE;
+            section->Characteristics = IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_MEM_READ;
+
+            {
+                std::ofstream out( path, std::ios::binary | std::ios::trunc );
+                if (!out.is_open())
+                    return std::unexpected( Error::OutputFileCreateError );
+
+                out.write( reinterpret_cast<const char *>(headers.data()), headers.size() );
+                out.write( reinterpret_cast<const char *>(m_Code.data()), m_Code.size() );
+
+                if (out.fail())
+                    return std::unexpected( Error::FileWriteError );
+            }
+
+            json j_root = json::object();
+            json j_protected = json::array();
+
+            // Rows are stored as '[func, prologue, eip, bp, type]', like the analysis cache.
+            for (const auto & row : m_Manifest.m_Protected)
+                j_protected.push_back( { row.m_Func, row.m_Prologue, row.m_Eip, row.m_Bp, static_cast<std::uint32_t>(row.m_Type) } );
+
+            j_root["Format"] = FORMAT_VERSION;
+            j_root["Seed"] = m_Manifest.m_Seed;
+            j_root["CodeSize"] = m_Manifest.m_CodeSize;
+            j_root["Init"] = m_Manifest.m_Init;
+            j_root["Terminate"] = m_Manifest.m_Terminate;
+            j_root["RegisterThread"] = m_Manifest.m_RegisterThread;
+            j_root["Integrity"] = m_Manifest.m_Integrity;
+            j_root["TestSecret"] = m_Manifest.m_TestSecret;
+            j_root["ProtectedFuncs"] = std::move( j_protected );
+
+            std::ofstream out( ManifestPath( path ), std::ios::trunc );
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            out << j_root.dump( 4 );
+
+            if (out.fail())
+                return std::unexpected( Error::FileWriteError );
+
+            return {};
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+
+
+        /**
+        * @brief Loads the manifest of a synthetic image.
+        *
+        * @param path Path to the manifest.
+        * @param manifest [out] The loaded ground truth.
+        * @return true if the manifest exists and is valid, false otherwise.
+        */
+        [[nodiscard]] static bool LoadManifest(
+            const fs::path & path,
+            SyntheticManifest & manifest
+        ) noexcept try
+        {
+            std::ifstream in( path );
+            if (!in.is_open())
+                return false;
+
+            const auto j_root = json::parse( in, nullptr, false );
+            if (!j_root.is_object() || j_root.value( "Format", 0u ) != FORMAT_VERSION)
+                return false;
+
+            SyntheticManifest res {};
+            res.m_Seed = j_root.at( "Seed" ).get<std::uint32_t>();
+            res.m_CodeSize = j_root.at( "CodeSize" ).get<std::uint32_t>();
+            res.m_Init = j_root.at( "Init" ).get<std::uint32_t>();
+            res.m_Terminate = j_root.at( "Terminate" ).get<std::uint32_t>();
+            res.m_RegisterThread = j_root.at( "RegisterThread" ).get<std::uint32_t>();
+            res.m_Integrity = j_root.at( "Integrity" ).get<std::vector<std::uint32_t>>();
+            res.m_TestSecret = j_root.at( "TestSecret" ).get<std::vector<std::uint32_t>>();
+
+            for (const auto & j_row : j_root.at( "ProtectedFuncs" ))
+            {
+                if (!j_row.is_array() || j_row.size() != 5)
+                    return false;
+
+                res.m_Protected.push_back( ProtectedEntry { j_row[0].get<std::uint32_t>(), j_row[1].get<std::uint32_t>(),
+                    j_row[2].get<std::uint32_t>(), j_row[3].get<std::uint32_t>(), static_cast<ProtectedType>(j_row[4].get<std::uint32_t>()) } );
+            }
+
+            manifest = std::move( res );
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+
+        /**
+        * @brief Compares the analysis results of a synthetic image with its manifest.
+        *
+        * @param manifest The ground truth of the image.
+        * @param context The analysis context holding the results, with real addresses.
+        * @return The number of missing and unexpected results.
+        */
+        [[nodiscard]] static SyntheticMismatch Verify(
+            const SyntheticManifest & manifest,
+            const AnalysisContext & context
+        )
+        {
+            SyntheticMismatch res {};
+
+            CompareAddress( manifest.m_Init, context.m_InitLibraryFunc, res );
+            CompareAddress( manifest.m_Terminate, context.m_TermLibraryFunc, res );
+            CompareAddress( manifest.m_RegisterThread, context.m_RegisterThreadFunc, res );
+            CompareAddresses( manifest.m_Integrity, context.m_IntegrityFuncs, res );
+            CompareAddresses( manifest.m_TestSecret, context.m_TestSecretFuncs, res );
+
+            const auto less = []( const ProtectedEntry & lhs, const ProtectedEntry & rhs )
+            {
+                return std::tie( lhs.m_Type, lhs.m_Func, lhs.m_Eip, lhs.m_Bp, lhs.m_Prologue ) <
+                    std::tie( rhs.m_Type, rhs.m_Func, rhs.m_Eip, rhs.m_Bp, rhs.m_Prologue );
+            };
+
+            const auto & table = context.m_ProtectedFuncs;
+
+            std::vector<ProtectedEntry> actual {};
+            for (std::size_t i = 0; i < table.size(); ++i)
+                actual.push_back( table.Row( i ) );
+
+            std::ranges::sort( actual, less );
+
+            res.m_Missing += CountMissing( manifest.m_Protected, actual, less );
+            res.m_Unexpected += CountMissing( actual, manifest.m_Protected, less );
+
+            return res;
+        }
+    };
+}
@@ -15,18 +15,32 @@
 #include <windows.h>
 #include <iostream>
 #include <cstdint>
+#include <array>
 #include <fstream>
 #include <vector>
+#include <span>
 #include <string>
 #include <filesystem>
-#include <map>
+#include <algorithm>
 #include <iomanip>
 #include <charconv>
 #include <format>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
 
 // JSON for Modern C++ (https://github.com/nlohmann/json)
 #include "json.hpp"
 
+// Section interval table and block cloning shared with 'noceg_signatures'.
+#include <pe_layout.h>
+#include <file_clone.h>
+#include <hash.h>
+#include <binary_config.h>
+
 namespace fs = std::filesystem;
 
 using json = nlohmann::json;
@@ -34,25 +48,93 @@ using json = nlohmann::json;
 // Structure to hold CEG patch information.
 struct PatchInfo
 {
+    // Address the patch is listed under in the JSON.
+    std::uintptr_t m_Address { 0 };
+
     // The memory address where the patch should be applied.
-    std::string m_Prologue;
+    std::uintptr_t m_Prologue { 0 };
 
     // Type of patch to apply.
     int m_Type { 0 };
 
-    // Type of the CEG function.
-    std::string m_Value;
+    // The returned value or the jump destination of the CEG function.
+    std::uint32_t m_Value { 0 };
+
+    // File offset of the prologue, set once the patch table is built.
+    std::uint32_t m_Offset { 0 };
+};
+
+// Header of a delta patch, followed by its records sorted by file offset.
+struct DeltaHeader
+{
+    // Magic value of the delta, 'NCD1'.
+    std::uint32_t m_Magic { 0x3144434E };
+    std::uint32_t m_Version { 1 };
+
+    // Size and XXH64 hash of the original binary the delta applies to.
+    std::uint64_t m_SourceSize { 0 };
+    std::uint64_t m_SourceHash { 0 };
+
+    std::uint32_t m_Count { 0 };
+    std::uint32_t m_Reserved { 0 };
+};
+
+// A record of a delta patch, followed by its bytes.
+struct DeltaRecord
+{
+    std::uint32_t m_Offset { 0 };
+    std::uint32_t m_Length { 0 };
 };
 
 class Patcher
 {
 private:
 
-    // Raw binary data of the loaded PE file.
+    // Longest patch in bytes.
+    static constexpr std::uint32_t MAX_PATCH_SIZE = 6;
+
+    // Size of a chunk of the original streamed by 'ApplyDelta'.
+    static constexpr std::size_t STREAM_CHUNK_SIZE = 0x400000;
+
+    // Number of the leading bytes read for the headers in the mapped mode.
+    static constexpr std::size_t HEADERS_SIZE = 0x10000;
+
+    // Size of a view of the output in the mapped mode, the patches sorted by offset walk the views in order.
+    static constexpr std::uint64_t VIEW_SIZE = 0x400000;
+
+    // Raw binary data of the loaded PE file, only its headers in the mapped mode.
     std::vector<std::uint8_t> m_FileData {};
 
+    // Size of the PE file.
+    std::uint64_t m_FileSize { 0 };
+
+    // Path to the cloned output in the mapped mode, empty otherwise.
+    fs::path m_Output {};
+
+    // File mapping of the output in the mapped mode.
+    HANDLE m_Mapping { nullptr };
+
+    // The mapped view of the output, its file offset and its size.
+    std::uint8_t * m_View { nullptr };
+    std::uint64_t m_ViewOffset { 0 };
+    std::uint64_t m_ViewSize { 0 };
+
+    // The mapped output is complete and is kept.
+    bool m_Saved { false };
+
     // Base address where the PE image is loaded in memory.
     std::uintptr_t m_ImageBase { 0 };
+
+    // Section table of the loaded PE file, used for every address translation.
+    CEG::PeLayout m_Layout {};
+
+    // Streams receiving the progress and the errors, both are the log of the title in the batch mode.
+    std::ostream * m_Out { &std::cout };
+    std::ostream * m_Err { &std::cerr };
+
+    // Number of the patches skipped while loading and of the applied ones.
+    std::size_t m_Skipped { 0 };
+    std::size_t m_Applied { 0 };
     
     /**
     * @brief Converts a hexadecimal string to a numeric value
@@ -110,30 +192,155 @@ private:
     
     
     /**
-    * @brief Converts RVA to a file offset.
+    * @brief Gets the number of bytes written by a patch type.
     *
-    * @param rva The relative virtual address to convert.
-    * @return The corresponding file offset, or 0 if the RVA is invalid.
+    * @param type The patch type.
+    * @return The size of the patch.
     */
-    [[nodiscard]] std::uint32_t RvaToOffset( 
-        std::uint32_t rva
-    ) const noexcept
+    [[nodiscard]] static constexpr std::uint32_t PatchSize(
+        int type
+    ) noexcept
     {
-        const auto * dos = reinterpret_cast<const IMAGE_DOS_HEADER *>(m_FileData.data());
-        const auto * nt_headers = reinterpret_cast<const IMAGE_NT_HEADERS *>(m_FileData.data() + dos->e_lfanew);
+        switch (type)
+        {
+            case 0:
+                return 3;
+
+            case 4:
+                return 5;
+        }
+
+        return 6;
+    }
 
-        const auto * section = IMAGE_FIRST_SECTION( nt_headers );
-        for (unsigned i = 0; i < nt_headers->FileHeader.NumberOfSections; ++i)
+
+    /**
+    * @brief Encodes the bytes written by a patch.
+    *
+    * @param info The patch.
+    * @param patch [out] The patched bytes, at least 'MAX_PATCH_SIZE' long.
+    * @return The number of the written bytes, see 'PatchSize'.
+    */
+    static std::uint32_t EncodePatch(
+        const PatchInfo & info,
+        std::uint8_t * patch
+    ) noexcept
+    {
+        switch (info.m_Type)
         {
-            if (rva >= section[i].VirtualAddress &&
-                rva < section[i].VirtualAddress + section[i].Misc.VirtualSize)
-                return rva - section[i].VirtualAddress + section[i].PointerToRawData;
+            case 0:
+            {
+                patch[0] = 0xB0;
+                patch[1] = 0x01;
+                patch[2] = 0xC3;
+                break;
+            }
+
+            case 1:
+            case 2:
+            case 3:
+            {
+                patch[0] = 0xB8;
+                std::memcpy( patch + 1, &info.m_Value, sizeof( info.m_Value ) );
+                patch[5] = 0xC3;
+                break;
+            }
+
+            case 4:
+            {
+                patch[0] = 0xE9;
+                const auto rel = static_cast<std::int32_t>(info.m_Value - static_cast<std::uint32_t>(info.m_Prologue + 5));
+                std::memcpy( patch + 1, &rel, sizeof( rel ) );
+                break;
+            }
         }
 
-        return 0;
+        return PatchSize( info.m_Type );
+    }
+
+
+    /**
+    * @brief Gets the path of the patched binary, '<name>_noceg' inside the current directory.
+    *
+    * @param original Path to the original CEG protected binary.
+    * @return Path to the patched binary.
+    */
+    [[nodiscard]] static fs::path PatchedPath(
+        const fs::path & original
+    )
+    {
+        return original.stem().string() + "_noceg" + original.extension().string();
+    }
+
+
+    /**
+    * @brief Gets the bytes of the binary written by a patch.
+    *
+    * In the mapped mode, the view of the output is moved to cover the patch.
+    *
+    * @param offset File offset of the patch.
+    * @param size Size of the patch.
+    * @return Pointer to the patched bytes, or 'nullptr' if they cannot be mapped.
+    */
+    [[nodiscard]] std::uint8_t * PatchBytes(
+        std::uint32_t offset,
+        std::uint32_t size
+    ) noexcept
+    {
+        if (!m_Mapping)
+            return m_FileData.data() + offset;
+
+        if (offset < m_ViewOffset || offset + size > m_ViewOffset + m_ViewSize)
+        {
+            if (m_View)
+                UnmapViewOfFile( m_View );
+
+            SYSTEM_INFO info {};
+            GetSystemInfo( &info );
+
+            // The view starts at the allocation granularity, which leaves room for the patch behind it.
+            m_ViewOffset = offset - offset % info.dwAllocationGranularity;
+            m_ViewSize = std::min( VIEW_SIZE, m_FileSize - m_ViewOffset );
+            m_View = static_cast<std::uint8_t *>(MapViewOfFile( m_Mapping, FILE_MAP_WRITE, static_cast<DWORD>(m_ViewOffset >> 32),
+                static_cast<DWORD>(m_ViewOffset), static_cast<SIZE_T>(m_ViewSize) ));
+
+            if (!m_View)
+            {
+                m_ViewSize = 0;
+                return nullptr;
+            }
+        }
+
+        return m_View + (offset - m_ViewOffset);
     }
 
 public:
+
+    Patcher() = default;
+
+    explicit Patcher( std::ostream & log ) noexcept : m_Out( &log ), m_Err( &log )
+    {
+    }
+
+    Patcher( const Patcher & ) = delete;
+    Patcher & operator=( const Patcher & ) = delete;
+
+    ~Patcher() noexcept
+    {
+        if (m_View)
+            UnmapViewOfFile( m_View );
+
+        if (m_Mapping)
+            CloseHandle( m_Mapping );
+
+        // An output which was not fully patched is removed.
+        if (!m_Output.empty() && !m_Saved)
+        {
+            std::error_code ec {};
+            fs::remove( m_Output, ec );
+        }
+    }
+
     
     /**
     * @brief Loads a PE file from disk.
@@ -148,17 +355,86 @@ public:
         std::ifstream in( file, std::ios::binary | std::ios::ate );
         if (!in)
         {
-            std::cerr << std::format( "[ERROR] Unable to open '{}'.", file.string() ) << std::endl;
+            *m_Err << std::format( "[ERROR] Unable to open '{}'.", file.string() ) << std::endl;
             return false;
         }
 
         const auto size = static_cast<std::size_t>(in.tellg());
         m_FileData.resize( size );
+        m_FileSize = size;
 
         in.seekg( 0, std::ios::beg );
         in.read( reinterpret_cast<char *>(m_FileData.data()), m_FileData.size() );
         return true;
     }
+
+
+    /**
+    * @brief Clones a PE file to '<name>_noceg' and maps the clone, the patches are written straight into it.
+    *
+    * The original is block cloned where the file system supports it, or copied otherwise.
+    * Only the headers are read, so the memory use and the I/O follow the size of the patches.
+    *
+    * @param file Path to the PE file to patch.
+    * @param patched Path to the output, empty for '<name>_noceg' inside the current directory.
+    * @return true if the clone was mapped, false otherwise.
+    */
+    [[nodiscard]] bool MapPatchedFile(
+        const fs::path & file,
+        const fs::path & patched = {}
+    ) noexcept
+    {
+        try
+        {
+            const auto output = patched.empty() ? PatchedPath( file ) : patched;
+
+            if (!CEG::CloneFile( file, output ) && !CopyFileExW( file.c_str(), output.c_str(), nullptr, nullptr, nullptr, 0 ))
+            {
+                *m_Err << std::format( "[ERROR] Cannot create '{}'.", output.string() ) << std::endl;
+                return false;
+            }
+
+            m_Output = output;
+
+            const auto handle = CreateFileW( output.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+            if (handle == INVALID_HANDLE_VALUE)
+            {
+                *m_Err << std::format( "[ERROR] Unable to open '{}'.", output.string() ) << std::endl;
+                return false;
+            }
+
+            LARGE_INTEGER size {};
+            DWORD read = 0;
+
+            m_FileData.resize( HEADERS_SIZE );
+
+            const bool success = GetFileSizeEx( handle, &size ) && size.QuadPart > 0 &&
+                ReadFile( handle, m_FileData.data(), static_cast<DWORD>(m_FileData.size()), &read, nullptr );
+
+            // The mapping keeps the file open.
+            if (success)
+                m_Mapping = CreateFileMappingW( handle, nullptr, PAGE_READWRITE, 0, 0, nullptr );
+
+            CloseHandle( handle );
+
+            if (!success || !m_Mapping)
+            {
+                *m_Err << std::format( "[ERROR] Unable to map '{}'.", output.string() ) << std::endl;
+                return false;
+            }
+
+            m_FileData.resize( read );
+            m_FileSize = static_cast<std::uint64_t>(size.QuadPart);
+            return true;
+        }
+        catch (const std::exception & e)
+        {
+            *m_Err << std::format( "[ERROR] Unable to map the patched file ('{}').", e.what() ) << std::endl;
+            return false;
+        }
+    }
     
     
     /**
@@ -170,38 +446,47 @@ public:
     {
         if (!IsValidPe())
         {
-            std::cerr << "[ERROR] Not a valid PE file.";
+            *m_Err << "[ERROR] Not a valid PE file.";
             return false;
         }
 
         if (!GetImageBase())
         {
-            std::cerr << "[ERROR] Unable to get image base." << std::endl;
+            *m_Err << "[ERROR] Unable to get image base." << std::endl;
             return false;
         }
 
+        auto layout = CEG::PeLayout::FromImage( std::as_bytes( std::span { m_FileData } ), 0, m_FileSize );
+        if (!layout)
+        {
+            *m_Err << "[ERROR] Unable to read the section table." << std::endl;
+            return false;
+        }
+
+        m_Layout = std::move( *layout );
+
         return true;
     }
     
     
     /**
-     * @brief Load patch information from a JSON file.
+     * @brief Reads the patches of a JSON file.
      *
      * @param json_file Path to the JSON configuration file.
-     * @return Map of address strings and the patch information.
+     * @param patches [out] The patches in the JSON order.
+     * @return true if the JSON was read, false otherwise.
      */
-    [[nodiscard]] std::map<std::string, PatchInfo> LoadPatches( 
-        const fs::path & json_file
-    ) const
+    [[nodiscard]] bool ReadJsonPatches(
+        const fs::path & json_file,
+        std::vector<PatchInfo> & patches
+    )
     {
-        std::map<std::string, PatchInfo> patches {};
-
         // Open and validate JSON file.
         std::ifstream in( json_file );
         if (!in)
         {
-            std::cerr << std::format( "[ERROR] Cannot open '{}'.", json_file.string() ) << std::endl;
-            return patches;
+            *m_Err << std::format( "[ERROR] Cannot open '{}'.", json_file.string() ) << std::endl;
+            return false;
         }
 
         json j;
@@ -212,33 +497,48 @@ public:
         }
         catch (const json::parse_error & e)
         {
-            std::cerr << std::format( "[ERROR] JSON parse error in '{}': '{}'.", json_file.string(), e.what() ) << std::endl;
-            return patches;
+            *m_Err << std::format( "[ERROR] JSON parse error in '{}': '{}'.", json_file.string(), e.what() ) << std::endl;
+            return false;
         }
 
         // Ensure the root is an object.
         if (!j.is_object())
         {
-            std::cerr << "[ERROR] JSON root must be an object." << std::endl;
-            return patches;
+            *m_Err << "[ERROR] JSON root must be an object." << std::endl;
+            return false;
         }
 
+        // Lambda to add a patch returning 'true', which is applied at its own address.
+        const auto add_simple = [&]( const std::string & addr_str ) -> bool
+        {
+            const auto address = StringToNumber( addr_str );
+            if (!address)
+            {
+                *m_Err << std::format( "[WARNING] Invalid address '{}', skipping.", addr_str ) << std::endl;
+                ++m_Skipped;
+                return false;
+            }
+
+            patches.push_back( PatchInfo { address, address, 0, 0 } );
+            return true;
+        };
+
         // Safe check for 'Init' field.
         if (j.contains( "Init" ) && j["Init"].is_string())
         {
             const std::string init_addr = j["Init"].get<std::string>();
-            patches.try_emplace( init_addr, PatchInfo { init_addr, 0, {} } );
 
-            std::cout << std::format( "[SUCCESS] Loaded CEG init patch at '{}'.", init_addr ) << std::endl;
+            if (add_simple( init_addr ))
+                *m_Out << std::format( "[SUCCESS] Loaded CEG init patch at '{}'.", init_addr ) << std::endl;
         }
 
         // Safe check for 'Terminate' field
         if (j.contains( "Terminate" ) && j["Terminate"].is_string())
         {
             const std::string term_addr = j["Terminate"].get<std::string>();
-            patches.try_emplace( term_addr, PatchInfo { term_addr, 0, {} } );
 
-            std::cout << std::format( "[SUCCESS] Loaded CEG terminate patch at '{}'.", term_addr ) << std::endl;
+            if (add_simple( term_addr ))
+                *m_Out << std::format( "[SUCCESS] Loaded CEG terminate patch at '{}'.", term_addr ) << std::endl;
         }
 
         // Lambda to parse a group of patches with detailed configuration.
@@ -246,7 +546,7 @@ public:
         {
             if (!group.is_object())
             {
-                std::cerr << "[WARNING] Patch group is not an object, skipping." << std::endl;
+                *m_Err << "[WARNING] Patch group is not an object, skipping." << std::endl;
                 return;
             }
 
@@ -254,18 +554,22 @@ public:
             {
                 if (!data.is_object())
                 {
-                    std::cerr << std::format( "[WARNING] Patch data for '{}' is not an object, skipping.", address ) << std::endl;
+                    *m_Err << std::format( "[WARNING] Patch data for '{}' is not an object, skipping.", address ) << std::endl;
+                    ++m_Skipped;
                     continue;
                 }
 
                 PatchInfo info {};
+                info.m_Address = StringToNumber( address );
 
                 // Extract the CEG function prologue address.
                 if (data.contains( "Prologue" ) && data["Prologue"].is_string())
-                    info.m_Prologue = data["Prologue"].get<std::string>();
-                else
+                    info.m_Prologue = StringToNumber( data["Prologue"].get<std::string>() );
+
+                if (!info.m_Prologue)
                 {
-                    std::cerr << std::format( "[WARNING] Missing or invalid 'Prologue' for patch '{}'.", address ) << std::endl;
+                    *m_Err << std::format( "[WARNING] Missing or invalid 'Prologue' for patch '{}'.", address ) << std::endl;
+                    ++m_Skipped;
                     continue;
                 }
 
@@ -277,8 +581,9 @@ public:
                     // Validate patch type.
                     if (info.m_Type < 0 || info.m_Type > 4)
                     {
-                        std::cerr << std::format( "[WARNING] Invalid patch type '{}' for address '{}'. Valid types: '0', '1', '2', '3', '4'.",
+                        *m_Err << std::format( "[WARNING] Invalid patch type '{}' for address '{}'. Valid types: '0', '1', '2', '3', '4'.",
                             info.m_Type, address ) << std::endl;
+                        ++m_Skipped;
                         continue;
                     }
                 }
@@ -286,17 +591,13 @@ public:
                 // Extract the value.
                 if (data.contains( "Value" ) && data["Value"].is_string())
                 {
-                    info.m_Value = data["Value"].get<std::string>();
+                    info.m_Value = static_cast<std::uint32_t>(StringToNumber( data["Value"].get<std::string>() ));
                 }
 
-                // Only add patch if prologue is valid.
-                if (!info.m_Prologue.empty())
-                {
-                    std::cout << std::format( "[SUCCESS] Loaded patch at '{}' (CEG function type: '{}').",
-                        address, info.m_Type ) << std::endl;
+                *m_Out << std::format( "[SUCCESS] Loaded patch at '{}' (CEG function type: '{}').",
+                    address, info.m_Type ) << std::endl;
 
-                    patches.try_emplace( address, std::move( info ) );
-                }
+                patches.push_back( info );
             }
         };
 
@@ -309,7 +610,7 @@ public:
                     parse_group( group );
             }
             else
-                std::cerr << "[WARNING] 'ConstantOrStolen' field exists but is not an array." << std::endl;
+                *m_Err << "[WARNING] 'ConstantOrStolen' field exists but is not an array." << std::endl;
         }
 
         // Lambda to parse array based patches ('Integrity' and 'TestSecret').
@@ -322,18 +623,14 @@ public:
                     std::size_t count = 0;
                     for (const auto & addr : j[key])
                     {
-                        if (addr.is_string())
-                        {
-                            const std::string addr_str = addr.get<std::string>();
-                            patches.try_emplace( addr_str, PatchInfo { addr_str, 0, {} } );
+                        if (addr.is_string() && add_simple( addr.get<std::string>() ))
                             ++count;
-                        }
                     }
 
-                    std::cout << std::format( "[SUCCESS] Loaded '{}' '{}' patches.", count, description ) << std::endl;
+                    *m_Out << std::format( "[SUCCESS] Loaded '{}' '{}' patches.", count, description ) << std::endl;
                 }
                 else
-                    std::cerr << std::format( "[WARNING] '{}' field exists but is not an array.", key ) << std::endl;
+                    *m_Err << std::format( "[WARNING] '{}' field exists but is not an array.", key ) << std::endl;
             }
         };
 
@@ -343,94 +640,177 @@ public:
         // Load 'Integrity' patches.  
         parse_simple_array( "Integrity", "CEG integrity functions." );
 
-        std::cout << std::format( "[SUCCESS] Total patches loaded: '{}'.", patches.size() ) << std::endl;
-        return patches;
+        return true;
     }
 
 
     /**
-     * @brief Applies the loaded CEG patches to the file buffer.
+     * @brief Reads the patches of a binary configuration, see 'CEG::BinaryConfig'.
      *
-     * Supports different patch types:
-     * 
-     * '0' - mov al, 1
-     * '1', '2', '3' - Return fixed value (mov eax, <value>)
-     * '4' - Jump to the real address (jmp <address>)
+     * The patches are listed in the same order as the ones of the JSON it was written with.
      *
-     * @param patches Map of patches to apply.
-     * @return true if at least one patch was applied, false otherwise.
+     * @param bin_file Path to the binary configuration.
+     * @param patches [out] The patches.
+     * @return true if the binary configuration was read, false otherwise.
      */
-    [[nodiscard]] bool ApplyPatches( 
-        const std::map<std::string, PatchInfo> & patches
-    ) noexcept
+    [[nodiscard]] bool ReadBinaryPatches(
+        const fs::path & bin_file,
+        std::vector<PatchInfo> & patches
+    )
     {
-        // The counter for applied patches.
-        std::size_t num_applied { 0 };
+        CEG::BinaryConfig config {};
+        if (!config.Open( bin_file ))
+        {
+            *m_Err << std::format( "[ERROR] '{}' is not a valid binary configuration.", bin_file.string() ) << std::endl;
+            return false;
+        }
 
-        for (const auto & [address, info] : patches)
+        const auto & header = config.Header();
+
+        // Lambda to add a patch returning 'true', which is applied at its own address.
+        const auto add_simple = [&]( std::uint32_t address )
         {
-            const auto prologue = StringToNumber( info.m_Prologue );
-            if (prologue < m_ImageBase) 
-                continue;
+            if (address)
+                patches.push_back( PatchInfo { address, address, 0, 0 } );
+            else
+                ++m_Skipped;
+        };
 
-            const auto rva = static_cast<std::uint32_t>( prologue - m_ImageBase );
-            const auto offset = RvaToOffset( rva );
+        add_simple( header.m_Init );
+        add_simple( header.m_Terminate );
 
-            if (offset == 0 || offset >= m_FileData.size() - 5)
+        for (const auto & entry : config.Entries())
+        {
+            if (!entry.m_Prologue || entry.m_Type > 4)
+            {
+                *m_Err << std::format( "[WARNING] Invalid patch '0x{:08X}', skipping.", entry.m_Func ) << std::endl;
+                ++m_Skipped;
                 continue;
+            }
 
-            try
+            patches.push_back( PatchInfo { entry.m_Func, entry.m_Prologue, static_cast<int>(entry.m_Type), entry.m_Value } );
+        }
+
+        for (const auto address : config.TestSecret())
+            add_simple( address );
+
+        for (const auto address : config.Integrity())
+            add_simple( address );
+
+        *m_Out << std::format( "[SUCCESS] Loaded '{}' patches from the binary configuration.", patches.size() ) << std::endl;
+        return true;
+    }
+
+
+    /**
+     * @brief Load patch information from a JSON file or a binary configuration.
+     *
+     * The addresses are parsed once and the patches are sorted by their file offset.
+     * Duplicate patches are dropped, a patch overlapping a previous one is skipped.
+     *
+     * @param config_file Path to the JSON configuration file, or to a '.bin' binary configuration.
+     * @return The patch table sorted by file offset.
+     */
+    [[nodiscard]] std::vector<PatchInfo> LoadPatches( 
+        const fs::path & config_file
+    )
+    {
+        std::vector<PatchInfo> patches {};
+
+        const bool read = config_file.extension() == ".bin" ? ReadBinaryPatches( config_file, patches ) : ReadJsonPatches( config_file, patches );
+        if (!read)
+            return {};
+
+        // Resolve the file offsets, the patches outside of the file are dropped.
+        std::vector<PatchInfo> located {};
+        located.reserve( patches.size() );
+
+        for (auto info : patches)
+        {
+            if (info.m_Prologue >= m_ImageBase)
+                info.m_Offset = m_Layout.RvaToOffset( static_cast<std::uint32_t>(info.m_Prologue - m_ImageBase) );
+
+            if (info.m_Offset != 0 && info.m_Offset + PatchSize( info.m_Type ) <= m_FileSize)
+                located.push_back( info );
+            else
+                ++m_Skipped;
+        }
+
+        // The first loaded patch of an offset wins, as the JSON order lists 'Init' and 'Terminate' first.
+        std::ranges::stable_sort( located, {}, &PatchInfo::m_Offset );
+
+        patches.clear();
+        std::size_t duplicates = 0;
+
+        for (const auto & info : located)
+        {
+            if (!patches.empty())
             {
-                switch (info.m_Type)
+                const auto & previous = patches.back();
+
+                if (info.m_Offset < previous.m_Offset + PatchSize( previous.m_Type ))
                 {
-                    case 0:
+                    // The same function listed twice.
+                    if (info.m_Offset == previous.m_Offset && info.m_Type == previous.m_Type && info.m_Value == previous.m_Value)
+                        ++duplicates;
+                    else
                     {
-                        m_FileData[offset] = 0xB0;
-                        m_FileData[offset + 1] = 0x01;
-                        m_FileData[offset + 2] = 0xC3;
+                        *m_Err << std::format( "[WARNING] Patch at '0x{:08X}' overlaps the patch at '0x{:08X}', skipping.",
+                            info.m_Address, previous.m_Address ) << std::endl;
 
-                        ++num_applied;
-                        break;
+                        ++m_Skipped;
                     }
-             
-                    case 1:
-                    case 2:
-                    case 3:
-                    {
-                        const auto val = static_cast<std::uint32_t>(StringToNumber( info.m_Value ));
 
-                        m_FileData[offset] = 0xB8;
-                        std::memcpy( &m_FileData[offset + 1], &val, sizeof( val ) );
-                        m_FileData[offset + 5] = 0xC3;
+                    continue;
+                }
+            }
 
-                        ++num_applied;
-                        break;
-                    }
+            patches.push_back( info );
+        }
 
-                    case 4:
-                    {
-                        const auto dest = static_cast<std::uint32_t>(StringToNumber( info.m_Value ));
+        if (duplicates)
+            *m_Out << std::format( "[SUCCESS] Dropped '{}' duplicate patches.", duplicates ) << std::endl;
 
-                        m_FileData[offset] = 0xE9;
-                        const auto rel = static_cast<std::int32_t>(dest - (prologue + 5));
-                        std::memcpy( &m_FileData[offset + 1], &rel, sizeof( rel ) );
+        *m_Out << std::format( "[SUCCESS] Total patches loaded: '{}'.", patches.size() ) << std::endl;
+        return patches;
+    }
 
-                        ++num_applied;
-                        break;
-                    }
-                }
-            }
-            catch (const std::exception & e)
-            {
-                std::cerr << std::format( "[ERROR] Exception during the patch process for '{}' ('{}').", address, e.what() ) << std::endl;
-            }
-            catch (...)
+
+    /**
+     * @brief Applies the loaded CEG patches to the file buffer.
+     *
+     * Supports different patch types:
+     * 
+     * '0' - mov al, 1
+     * '1', '2', '3' - Return fixed value (mov eax, <value>)
+     * '4' - Jump to the real address (jmp <address>)
+     *
+     * @param patches The patch table sorted by file offset, see 'LoadPatches'.
+     * @return true if at least one patch was applied, false otherwise.
+     */
+    [[nodiscard]] bool ApplyPatches( 
+        std::span<const PatchInfo> patches
+    ) noexcept
+    {
+        // The counter for applied patches.
+        std::size_t num_applied { 0 };
+
+        for (const auto & info : patches)
+        {
+            auto * patch = PatchBytes( info.m_Offset, PatchSize( info.m_Type ) );
+            if (!patch)
             {
-                std::cerr << std::format( "[ERROR] Exception during the patch process for '{}'.", address ) << std::endl;
+                *m_Err << std::format( "[ERROR] Unable to map the patch at '0x{:08X}'.", info.m_Address ) << std::endl;
+                return false;
             }
+
+            EncodePatch( info, patch );
+            ++num_applied;
         }
 
-        std::cout << std::format( "[SUCCESS] Total patches applied '{}'.", num_applied ) << std::endl;
+        m_Applied = num_applied;
+
+        *m_Out << std::format( "[SUCCESS] Total patches applied '{}'.", num_applied ) << std::endl;
         return num_applied != 0;
     }
     
@@ -438,35 +818,641 @@ public:
     /**
     * @brief Saves the patched CEG binary to disk.
     *
+    * In the mapped mode, the patches are already in the output and only the written views are flushed.
+    *
     * @param original Path to the original CEG protected binary.
+    * @param output Path to the patched binary, empty for '<name>_noceg' inside the current directory.
     * @return true if file was successfully saved, false otherwise.
     */
     [[nodiscard]] bool SavePatchedFile( 
-        const fs::path & original
-    ) const noexcept
+        const fs::path & original,
+        const fs::path & output = {}
+    ) noexcept
     {
-        const auto patched = original.stem().string() + "_noceg" + original.extension().string();
+        const auto patched = (output.empty() ? PatchedPath( original ) : output).string();
+
+        if (m_Mapping)
+        {
+            if (m_View && !FlushViewOfFile( m_View, 0 ))
+            {
+                *m_Err << std::format( "[ERROR] Cannot write the patched file '{}'.", patched ) << std::endl;
+                return false;
+            }
+
+            m_Saved = true;
+            *m_Out << std::format( "[SUCCESS] Saved the patched file as '{}'.", patched ) << std::endl;
+            return true;
+        }
+
         std::ofstream out( patched, std::ios::binary );
 
         if (!out)
         {
-            std::cerr << std::format( "[ERROR] Cannot create '{}'.", patched ) << std::endl;
+            *m_Err << std::format( "[ERROR] Cannot create '{}'.", patched ) << std::endl;
             return false;
         }
 
         out.write( reinterpret_cast<const char *>(m_FileData.data()), m_FileData.size() );
         if (out.fail())
         {
-            std::cerr << std::format( "[ERROR] Cannot write the patched file '{}'.", patched ) << std::endl;
+            *m_Err << std::format( "[ERROR] Cannot write the patched file '{}'.", patched ) << std::endl;
             return false;
         }
 
-        std::cout << std::format( "[SUCCESS] Saved the patched file as '{}'.", patched ) << std::endl;
+        *m_Out << std::format( "[SUCCESS] Saved the patched file as '{}'.", patched ) << std::endl;
         return true;
     }
+
+
+    // Number of the patches skipped while loading, see 'LoadPatches'.
+    [[nodiscard]] std::size_t SkippedPatches() const noexcept
+    {
+        return m_Skipped;
+    }
+
+
+    // Number of the applied patches, see 'ApplyPatches'.
+    [[nodiscard]] std::size_t AppliedPatches() const noexcept
+    {
+        return m_Applied;
+    }
+
+
+    /**
+    * @brief Saves the patches as a delta of the original binary, '<name>_noceg.delta' inside the current directory.
+    *
+    * @param original Path to the original CEG protected binary.
+    * @param patches The patch table sorted by file offset, see 'LoadPatches'.
+    * @return true if the delta was saved, false otherwise.
+    */
+    [[nodiscard]] bool SaveDelta(
+        const fs::path & original,
+        std::span<const PatchInfo> patches
+    ) const noexcept
+    {
+        try
+        {
+            const auto path = original.stem().string() + "_noceg.delta";
+
+            std::ofstream out( path, std::ios::binary );
+            if (!out)
+            {
+                *m_Err << std::format( "[ERROR] Cannot create '{}'.", path ) << std::endl;
+                return false;
+            }
+
+            DeltaHeader header {};
+            header.m_SourceSize = m_FileData.size();
+            header.m_SourceHash = CEG::Hash::Xxh64( std::as_bytes( std::span { m_FileData } ) );
+            header.m_Count = static_cast<std::uint32_t>(patches.size());
+
+            out.write( reinterpret_cast<const char *>(&header), sizeof( header ) );
+
+            for (const auto & info : patches)
+            {
+                std::array<std::uint8_t, MAX_PATCH_SIZE> bytes {};
+                const DeltaRecord record { info.m_Offset, EncodePatch( info, bytes.data() ) };
+
+                out.write( reinterpret_cast<const char *>(&record), sizeof( record ) );
+                out.write( reinterpret_cast<const char *>(bytes.data()), record.m_Length );
+            }
+
+            if (out.fail())
+            {
+                *m_Err << std::format( "[ERROR] Cannot write the delta '{}'.", path ) << std::endl;
+                return false;
+            }
+
+            *m_Out << std::format( "[SUCCESS] Saved '{}' patches as '{}' ('{}' bytes).",
+                patches.size(), path, static_cast<std::uint64_t>(out.tellp()) ) << std::endl;
+
+            return true;
+        }
+        catch (const std::exception & e)
+        {
+            *m_Err << std::format( "[ERROR] Cannot write the delta ('{}').", e.what() ) << std::endl;
+            return false;
+        }
+    }
+
+
+    /**
+    * @brief Writes the patched binary from the original and a delta in a single sequential pass.
+    *
+    * The original is hashed while it is streamed, a delta made for another binary removes the output again.
+    *
+    * @param original Path to the original CEG protected binary.
+    * @param delta Path to the delta, see 'SaveDelta'.
+    * @return true if the patched binary was saved, false otherwise.
+    */
+    [[nodiscard]] static bool ApplyDelta(
+        const fs::path & original,
+        const fs::path & delta
+    ) noexcept
+    {
+        try
+        {
+            std::ifstream delta_in( delta, std::ios::binary );
+            DeltaHeader header {};
+
+            if (!delta_in.read( reinterpret_cast<char *>(&header), sizeof( header ) ) || header.m_Magic != DeltaHeader {}.m_Magic ||
+                header.m_Version != DeltaHeader {}.m_Version)
+            {
+                std::cerr << std::format( "[ERROR] '{}' is not a valid delta.", delta.string() ) << std::endl;
+                return false;
+            }
+
+            std::ifstream in( original, std::ios::binary );
+            if (!in)
+            {
+                std::cerr << std::format( "[ERROR] Unable to open '{}'.", original.string() ) << std::endl;
+                return false;
+            }
+
+            const auto patched = PatchedPath( original );
+
+            std::ofstream out( patched, std::ios::binary );
+            if (!out)
+            {
+                std::cerr << std::format( "[ERROR] Cannot create '{}'.", patched.string() ) << std::endl;
+                return false;
+            }
+
+            DeltaRecord record {};
+            std::array<std::uint8_t, MAX_PATCH_SIZE> bytes {};
+            std::uint32_t remaining = header.m_Count;
+            std::uint64_t record_end = 0;
+            bool corrupt = false;
+
+            // Lambda function to read the next record, false once every record is read.
+            auto next_record = [&]() -> bool
+            {
+                if (!remaining)
+                    return false;
+
+                --remaining;
+
+                // The records are sorted and never overlap.
+                if (!delta_in.read( reinterpret_cast<char *>(&record), sizeof( record ) ) || record.m_Length > bytes.size() ||
+                    record.m_Offset < record_end || !delta_in.read( reinterpret_cast<char *>(bytes.data()), record.m_Length ))
+                {
+                    corrupt = true;
+                    return false;
+                }
+
+                record_end = static_cast<std::uint64_t>(record.m_Offset) + record.m_Length;
+                return true;
+            };
+
+            CEG::Hash::Xxh64Stream hash {};
+            std::vector<std::uint8_t> chunk( STREAM_CHUNK_SIZE );
+            std::uint64_t position = 0;
+            bool pending = next_record();
+
+            while (in.read( reinterpret_cast<char *>(chunk.data()), chunk.size() ) || in.gcount())
+            {
+                const auto count = static_cast<std::size_t>(in.gcount());
+                const auto chunk_end = position + count;
+
+                hash.Update( std::as_bytes( std::span { chunk.data(), count } ) );
+
+                // A record crossing the end of the chunk is finished with the next one.
+                while (pending && record.m_Offset < chunk_end)
+                {
+                    const auto begin = std::max<std::uint64_t>( record.m_Offset, position );
+                    const auto end = std::min( record_end, chunk_end );
+
+                    std::memcpy( chunk.data() + (begin - position), bytes.data() + (begin - record.m_Offset), static_cast<std::size_t>(end - begin) );
+
+                    if (record_end > chunk_end)
+                        break;
+
+                    pending = next_record();
+                }
+
+                out.write( reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(count) );
+                position = chunk_end;
+            }
+
+            out.close();
+
+            const bool matches = position == header.m_SourceSize && hash.Digest() == header.m_SourceHash;
+
+            if (!matches || corrupt || pending || remaining || out.fail())
+            {
+                std::error_code ec {};
+                fs::remove( patched, ec );
+
+                if (!matches)
+                    std::cerr << std::format( "[ERROR] '{}' was made for another binary.", delta.string() ) << std::endl;
+                else if (out.fail())
+                    std::cerr << std::format( "[ERROR] Cannot write the patched file '{}'.", patched.string() ) << std::endl;
+                else
+                    std::cerr << std::format( "[ERROR] '{}' is corrupted.", delta.string() ) << std::endl;
+
+                return false;
+            }
+
+            std::cout << std::format( "[SUCCESS] Applied '{}' patches, saved the patched file as '{}'.", header.m_Count, patched.string() ) << std::endl;
+            return true;
+        }
+        catch (const std::exception & e)
+        {
+            std::cerr << std::format( "[ERROR] Cannot apply the delta ('{}').", e.what() ) << std::endl;
+            return false;
+        }
+    }
 };
 
 
+// A title of a batch manifest.
+struct BatchTitle
+{
+    // Path to the CEG binary.
+    fs::path m_Binary {};
+
+    // Path to its 'noceg.json'.
+    fs::path m_Json {};
+
+    // Path to the patched binary.
+    fs::path m_Output {};
+
+    // File size, the queue starts with the largest binaries.
+    std::uintmax_t m_Size { 0 };
+};
+
+
+// Outcome of the patching of a single title.
+struct TitleReport
+{
+    bool m_Success { false };
+
+    std::size_t m_Applied { 0 };
+    std::size_t m_Skipped { 0 };
+
+    // Wall time of the patching in seconds.
+    double m_Seconds { 0.0 };
+};
+
+
+/**
+* @brief Reads a batch manifest.
+*
+* Every line names a title as 'binary | json [| output]', relative to the manifest. Empty lines and lines
+* starting with '#' are skipped. The output defaults to '<name>_noceg' next to the binary.
+*
+* @param manifest Path to the manifest.
+* @return The titles, largest binaries first, or an empty queue if the manifest cannot be read.
+*/
+[[nodiscard]] std::vector<BatchTitle> LoadManifest(
+    const fs::path & manifest
+)
+{
+    std::vector<BatchTitle> titles {};
+
+    std::ifstream in( manifest );
+    if (!in)
+    {
+        std::cerr << std::format( "[ERROR] Cannot open '{}'.", manifest.string() ) << std::endl;
+        return titles;
+    }
+
+    // Lambda function to trim the spaces and the quotes of a field.
+    const auto trim = []( std::string_view field ) -> std::string_view
+    {
+        const auto first = field.find_first_not_of( " \t\"" );
+        if (first == std::string_view::npos)
+            return {};
+
+        const auto last = field.find_last_not_of( " \t\r\"" );
+        return field.substr( first, last - first + 1 );
+    };
+
+    // Two titles writing the same output would overwrite each other.
+    std::set<fs::path> outputs {};
+    std::size_t number = 0;
+
+    for (std::string line; std::getline( in, line ); )
+    {
+        ++number;
+
+        const auto first = line.find_first_not_of( " \t\r" );
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        std::vector<std::string_view> fields {};
+
+        for (std::string_view rest = line; ; )
+        {
+            const auto separator = rest.find( '|' );
+            fields.push_back( trim( rest.substr( 0, separator ) ) );
+
+            if (separator == std::string_view::npos)
+                break;
+
+            rest.remove_prefix( separator + 1 );
+        }
+
+        if (fields.size() < 2 || fields.size() > 3 || fields[0].empty() || fields[1].empty())
+        {
+            std::cerr << std::format( "[WARNING] Invalid manifest line '{}', skipping.", number ) << std::endl;
+            continue;
+        }
+
+        BatchTitle title {};
+        title.m_Binary = manifest.parent_path() / fs::path( fields[0] );
+        title.m_Json = manifest.parent_path() / fs::path( fields[1] );
+
+        if (fields.size() == 3 && !fields[2].empty())
+            title.m_Output = manifest.parent_path() / fs::path( fields[2] );
+        else
+            title.m_Output = title.m_Binary.parent_path() / (title.m_Binary.stem().string() + "_noceg" + title.m_Binary.extension().string());
+
+        std::error_code ec {};
+        auto output = fs::weakly_canonical( title.m_Output, ec );
+
+        if (!outputs.insert( ec ? title.m_Output : output ).second)
+        {
+            std::cerr << std::format( "[WARNING] Output '{}' of manifest line '{}' is already written, skipping.",
+                title.m_Output.string(), number ) << std::endl;
+            continue;
+        }
+
+        const auto size = fs::file_size( title.m_Binary, ec );
+        title.m_Size = ec ? 0 : size;
+
+        titles.push_back( std::move( title ) );
+    }
+
+    std::ranges::stable_sort( titles, std::ranges::greater {}, &BatchTitle::m_Size );
+    return titles;
+}
+
+
+/**
+* @brief Patches a single title of a batch.
+*
+* @param title The title.
+* @param mapped Patch a mapped clone of the binary, see 'Patcher::MapPatchedFile'.
+* @param log Stream receiving the log of the title.
+* @return The report of the title.
+*/
+[[nodiscard]] TitleReport PatchTitle(
+    const BatchTitle & title,
+    bool mapped,
+    std::ostream & log
+)
+{
+    TitleReport report {};
+    Patcher patcher( log );
+
+    if (!(mapped ? patcher.MapPatchedFile( title.m_Binary, title.m_Output ) : patcher.LoadFile( title.m_Binary )) || !patcher.ValidatePe())
+        return report;
+
+    const auto patches = patcher.LoadPatches( title.m_Json );
+    report.m_Skipped = patcher.SkippedPatches();
+
+    if (patches.empty())
+    {
+        log << std::format( "[ERROR] No patches found in '{}'.", title.m_Json.string() ) << std::endl;
+        return report;
+    }
+
+    const bool applied = patcher.ApplyPatches( patches );
+    report.m_Applied = patcher.AppliedPatches();
+
+    if (!applied)
+    {
+        log << "[ERROR] No patches applied." << std::endl;
+        return report;
+    }
+
+    report.m_Success = patcher.SavePatchedFile( title.m_Binary, title.m_Output );
+    return report;
+}
+
+
+/**
+* @brief Patches every title of a batch manifest on a bounded worker pool.
+*
+* Every worker takes the next title of the queue, so the reads and writes of one title overlap the
+* patching of the others. The log of a title is buffered and printed at once when it finishes.
+*
+* @param manifest Path to the manifest, see 'LoadManifest'.
+* @param jobs Maximum number of titles patched at once, zero picks one per hardware thread.
+* @param mapped Patch a mapped clone of every binary.
+* @return The exit code, non-zero if any title failed.
+*/
+[[nodiscard]] int PatchBatch(
+    const fs::path & manifest,
+    std::uint32_t jobs,
+    bool mapped
+)
+{
+    const auto titles = LoadManifest( manifest );
+    if (titles.empty())
+    {
+        std::cerr << std::format( "[ERROR] No titles found in '{}'.", manifest.string() ) << std::endl;
+        return 1;
+    }
+
+    if (!jobs)
+        jobs = std::max( 1u, std::thread::hardware_concurrency() );
+
+    const auto workers = std::min<std::uint32_t>( jobs, static_cast<std::uint32_t>(titles.size()) );
+
+    std::cout << std::format( "[BATCH] Patching '{}' titles on '{}' workers.", titles.size(), workers ) << std::endl << std::endl;
+
+    std::vector<TitleReport> reports( titles.size() );
+    std::atomic<std::size_t> next { 0 };
+    std::atomic<std::size_t> finished { 0 };
+    std::mutex console {};
+
+    const auto start = std::chrono::steady_clock::now();
+
+    auto work = [&]()
+    {
+        for (auto i = next++; i < titles.size(); i = next++)
+        {
+            std::ostringstream log {};
+            const auto title_start = std::chrono::steady_clock::now();
+
+            auto & report = reports[i];
+
+            try
+            {
+                report = PatchTitle( titles[i], mapped, log );
+            }
+            catch (const std::exception & e)
+            {
+                log << std::format( "[ERROR] '{}'.", e.what() ) << std::endl;
+                report.m_Success = false;
+            }
+
+            report.m_Seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - title_start ).count();
+
+            std::scoped_lock lock( console );
+
+            std::cout << std::format( "[BATCH] [{}/{}] '{}' ({:.2f} s): {}", ++finished, titles.size(), titles[i].m_Binary.string(),
+                report.m_Seconds, report.m_Success ? "Success." : "Failed." ) << std::endl;
+            std::cout << log.str() << std::endl;
+        }
+    };
+
+    std::vector<std::thread> threads {};
+
+    for (std::uint32_t i = 1; i < workers; ++i)
+        threads.emplace_back( work );
+
+    work();
+
+    for (auto & thread : threads)
+        thread.join();
+
+    const auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    std::size_t failed = 0;
+
+    std::cout << "[BATCH] Summary:" << std::endl;
+
+    for (std::size_t i = 0; i < titles.size(); ++i)
+    {
+        const auto & report = reports[i];
+        failed += !report.m_Success;
+
+        std::cout << std::format( "  {} '{}': '{}' applied, '{}' skipped patches -> '{}'.", report.m_Success ? "[SUCCESS]" : "[ERROR]",
+            titles[i].m_Binary.string(), report.m_Applied, report.m_Skipped, titles[i].m_Output.string() ) << std::endl;
+    }
+
+    std::cout << std::format( "[BATCH] '{}' titles patched, '{}' failed in {:.2f} s.", titles.size() - failed, failed, seconds ) << std::endl;
+    return failed ? 1 : 0;
+}
+
+
+/**
+* @brief Runs the game with the runtime library, then patches it from the values the library saved in 'noceg.bin'.
+*
+* The game and its restarts run in a job object. The runtime library maps 'noceg.bin' next to the game and saves every
+* value straight into it, then signals the pipeline event instead of showing its message box. The patches are then
+* read from the same table and written into a mapped clone of the game, without going through 'noceg.json'.
+*
+* @param ceg_binary Path to the game executable, with 'noceg.bin' and the runtime library next to it.
+* @return The exit code, non-zero if the game did not finish or the patching failed.
+*/
+[[nodiscard]] int RunPipeline(
+    const fs::path & ceg_binary
+)
+{
+    const auto directory = ceg_binary.parent_path();
+    const auto config = directory / "noceg.bin";
+
+    if (CEG::BinaryConfig check {}; !check.Open( config ))
+    {
+        std::cerr << std::format( "[ERROR] '{}' is missing or not a valid binary configuration.", config.string() ) << std::endl;
+        return 1;
+    }
+
+    const auto event_name = std::format( L"Local\\NoCEG_Pipeline_{}", GetCurrentProcessId() );
+    const auto event = CreateEventW( nullptr, TRUE, FALSE, event_name.c_str() );
+
+    // The game processes are killed along with the job if the patcher exits first.
+    const auto job = CreateJobObjectW( nullptr, nullptr );
+
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits {};
+    limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+
+    // Lambda function to close the handles of the pipeline.
+    const auto close = [&]()
+    {
+        if (job)
+            CloseHandle( job );
+
+        if (event)
+            CloseHandle( event );
+    };
+
+    if (!event || !job || !SetInformationJobObject( job, JobObjectExtendedLimitInformation, &limits, sizeof( limits ) ) ||
+        !SetEnvironmentVariableW( CEG::PIPELINE_EVENT_VARIABLE, event_name.c_str() ))
+    {
+        std::cerr << std::format( "[ERROR] Unable to set up the pipeline. Last error is '{}'.", GetLastError() ) << std::endl;
+        close();
+        return 1;
+    }
+
+    STARTUPINFOW si {};
+    PROCESS_INFORMATION pi {};
+    si.cb = sizeof( si );
+
+    // The process joins the job before it runs, the restarted processes join it as well.
+    if (!CreateProcessW( ceg_binary.c_str(), nullptr, nullptr, nullptr, FALSE, CREATE_SUSPENDED, nullptr, directory.c_str(), &si, &pi ))
+    {
+        std::cerr << std::format( "[ERROR] Unable to start '{}'. Last error is '{}'.", ceg_binary.string(), GetLastError() ) << std::endl;
+        close();
+        return 1;
+    }
+
+    if (!AssignProcessToJobObject( job, pi.hProcess ))
+    {
+        std::cerr << std::format( "[ERROR] Unable to track '{}'. Last error is '{}'.", ceg_binary.string(), GetLastError() ) << std::endl;
+        TerminateProcess( pi.hProcess, 1 );
+    }
+    else
+        ResumeThread( pi.hThread );
+
+    CloseHandle( pi.hThread );
+    CloseHandle( pi.hProcess );
+
+    std::cout << std::format( "[SUCCESS] Started '{}', waiting for the runtime library.", ceg_binary.filename().string() ) << std::endl;
+
+    // Lambda function to count the running game processes.
+    const auto active = [&]() -> DWORD
+    {
+        JOBOBJECT_BASIC_ACCOUNTING_INFORMATION info {};
+        return QueryInformationJobObject( job, JobObjectBasicAccountingInformation, &info, sizeof( info ), nullptr ) ? info.ActiveProcesses : 0;
+    };
+
+    bool finished = false;
+
+    while (!finished)
+    {
+        finished = WaitForSingleObject( event, 500 ) == WAIT_OBJECT_0;
+
+        // The last check catches an event signaled right before the last process exited.
+        if (!finished && !active())
+        {
+            finished = WaitForSingleObject( event, 0 ) == WAIT_OBJECT_0;
+            break;
+        }
+    }
+
+    // 'noceg.bin' stays locked until the game has exited.
+    for (int i = 0; i < 100 && active(); ++i)
+        Sleep( 100 );
+
+    if (active())
+        TerminateJobObject( job, 1 );
+
+    close();
+
+    if (!finished)
+    {
+        std::cerr << "[ERROR] The game exited before every value was saved in 'noceg.bin', see 'noceg.log'." << std::endl;
+        return 1;
+    }
+
+    std::cout << "[SUCCESS] Every value is resolved, patching the game." << std::endl;
+
+    const BatchTitle title {
+        ceg_binary, config, directory / (ceg_binary.stem().string() + "_noceg" + ceg_binary.extension().string()) };
+
+    const auto report = PatchTitle( title, true, std::cout );
+
+    if (report.m_Success)
+        std::cout << std::format( "[SUCCESS] '{}' applied, '{}' skipped patches.", report.m_Applied, report.m_Skipped ) << std::endl;
+
+    return report.m_Success ? 0 : 1;
+}
+
+
 int main( 
     int argc,
     char * argv[]
@@ -474,19 +1460,77 @@ int main(
 {
     std::cout << "CEG patcher by iArtorias (https://github.com/iArtorias)." << std::endl << std::endl;
 
-    if (argc != 2)
+    // Patch every title of a manifest, the batch never waits for a key press.
+    if (argc >= 3 && std::string_view( argv[1] ) == "--batch")
     {
-        std::cerr << std::format( "Usage: '{}' <ceg_binary>.", argv[0] ) << std::endl;
+        std::uint32_t jobs = 0;
+        bool mapped = false;
+        bool valid = true;
+
+        for (int i = 3; i < argc && valid; ++i)
+        {
+            const std::string_view option = argv[i];
+
+            if (option == "--mapped")
+                mapped = true;
+            else if (option == "--jobs" && i + 1 < argc)
+            {
+                const std::string_view value = argv[++i];
+                valid = std::from_chars( value.data(), value.data() + value.size(), jobs ).ec == std::errc {};
+            }
+            else
+                valid = false;
+        }
+
+        if (valid)
+            return PatchBatch( argv[2], jobs, mapped );
+
+        std::cerr << std::format( "Usage: '{}' --batch <manifest> [--jobs <count>] [--mapped].", argv[0] ) << std::endl;
+        return 1;
+    }
+
+    // Resolve and patch the game in one unattended run.
+    if (argc == 3 && std::string_view( argv[1] ) == "--run")
+        return RunPipeline( argv[2] );
+
+    // Write the patched binary from the original and a delta made by '--delta'.
+    if (argc == 4 && std::string_view( argv[1] ) == "--apply")
+    {
+        const auto applied = Patcher::ApplyDelta( argv[2], argv[3] );
+
+        std::cout << std::endl << "Press 'ENTER' key to exit application." << std::endl;
+        std::cin.get();
+        return applied ? 0 : 1;
+    }
+
+    const std::string_view mode = argc == 3 ? argv[2] : "";
+
+    // Patch a mapped clone of the binary instead of reading and writing it whole.
+    const bool mapped = mode == "--mapped";
+
+    // Save the patches as a delta of the binary instead of the patched binary.
+    const bool delta = mode == "--delta";
+
+    if (argc != 2 && !mapped && !delta)
+    {
+        std::cerr << std::format( "Usage: '{}' <ceg_binary> [--mapped | --delta].", argv[0] ) << std::endl;
+        std::cerr << std::format( "       '{}' --apply <ceg_binary> <delta>.", argv[0] ) << std::endl;
+        std::cerr << std::format( "       '{}' --batch <manifest> [--jobs <count>] [--mapped].", argv[0] ) << std::endl;
+        std::cerr << std::format( "       '{}' --run <ceg_binary>.", argv[0] ) << std::endl;
         std::cin.get();
         return 1;
     }
 
     const fs::path ceg_binary = argv[1];
-    const fs::path json = fs::current_path() / "noceg.json";
+    // The binary configuration is only used without 'noceg.json', which may have been edited since.
+    fs::path json = fs::current_path() / "noceg.json";
+
+    if (std::error_code ec {}; !fs::exists( json, ec ) && fs::exists( fs::current_path() / "noceg.bin", ec ))
+        json = fs::current_path() / "noceg.bin";
 
     auto patcher = std::make_unique<Patcher>();
 
-    if (!patcher->LoadFile( ceg_binary ) || !patcher->ValidatePe())
+    if (!(mapped ? patcher->MapPatchedFile( ceg_binary ) : patcher->LoadFile( ceg_binary )) || !patcher->ValidatePe())
     {
         std::cin.get();
         return 1;
@@ -500,6 +1544,15 @@ int main(
         return 1;
     }
 
+    if (delta)
+    {
+        const auto saved = patcher->SaveDelta( ceg_binary, patches );
+
+        std::cout << std::endl << "Press 'ENTER' key to exit application." << std::endl;
+        std::cin.get();
+        return saved ? 0 : 1;
+    }
+
     if (!patcher->ApplyPatches( patches ))
     {
         std::cerr << "[ERROR] No patches applied." << std::endl;
@@ -0,0 +1,287 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+#include "hash.h"
+#include "mapped_file.h"
+
+namespace CEG
+{
+    // Analysis results keyed by the content hash of the binary, so repeated runs skip the scan and the analysis.
+    // Every build of the tool and every pattern set has its own directory, see 'Directory'.
+    class AnalysisCache
+    {
+    private:
+
+        // Bumped whenever the layout of an entry changes, older entries are ignored.
+        static constexpr std::uint32_t FORMAT_VERSION = 2;
+
+
+        // Gets the path of the executable, empty if it cannot be retrieved.
+        [[nodiscard]] static fs::path ModulePath()
+        {
+            std::wstring module( MAX_PATH, L'\0' );
+            const auto length = GetModuleFileNameW( nullptr, module.data(), static_cast<DWORD>(module.size()) );
+
+            if (length == 0 || length >= module.size())
+                return {};
+
+            module.resize( length );
+            return fs::path( module );
+        }
+
+
+        // Content hash of the executable, any rebuild of the tool may change the results.
+        [[nodiscard]] static std::uint64_t ToolHash()
+        {
+            static const auto hash = []()
+            {
+                if (const auto module = ModulePath(); !module.empty())
+                {
+                    if (const auto map_res = MappedFile::Open( module ))
+                        return Hash::Xxh64( map_res->bytes() );
+                }
+
+                // Falls back to the build time, which changes with every build as well.
+                constexpr std::string_view build = __DATE__ " " __TIME__;
+                return Hash::Xxh64( std::as_bytes( std::span( build ) ) );
+            }();
+
+            return hash;
+        }
+
+
+        // Reads an array of addresses.
+        template<typename T>
+        [[nodiscard]] static bool ReadAddresses(
+            const json & j_root,
+            std::string_view name,
+            T & res
+        )
+        {
+            const auto j_array = j_root.find( name );
+            if (j_array == j_root.end() || !j_array->is_array())
+                return false;
+
+            for (const auto & j_address : *j_array)
+            {
+                if (!j_address.is_number_unsigned())
+                    return false;
+
+                res.push_back( mem::pointer( j_address.get<std::uint32_t>() ) );
+            }
+
+            return true;
+        }
+
+
+        // Reads a single address.
+        [[nodiscard]] static bool ReadAddress(
+            const json & j_root,
+            std::string_view name,
+            mem::pointer & res
+        )
+        {
+            const auto j_address = j_root.find( name );
+            if (j_address == j_root.end() || !j_address->is_number_unsigned())
+                return false;
+
+            res = mem::pointer( j_address->get<std::uint32_t>() );
+            return true;
+        }
+
+    public:
+
+        /**
+        * @brief Gets the default cache directory, next to the executable.
+        *
+        * @return Path to the 'noceg_signatures.cache' directory.
+        */
+        [[nodiscard]] static fs::path DefaultDirectory()
+        {
+            const auto module = ModulePath();
+            return module.empty() ? fs::path( "noceg_signatures.cache" ) : module.parent_path() / "noceg_signatures.cache";
+        }
+
+
+        /**
+        * @brief Gets the cache directory of the current build of the tool and pattern set.
+        *
+        * The results of another build or of other patterns are never looked up, they may differ for the same binary.
+        *
+        * @param patterns Fingerprint of the pattern set, see 'MultiPatternScanner::Fingerprint'.
+        * @return Path to the '<fingerprint>' directory inside of 'DefaultDirectory'.
+        */
+        [[nodiscard]] static fs::path Directory(
+            std::uint64_t patterns
+        )
+        {
+            const std::array<std::uint64_t, 3> key { FORMAT_VERSION, ToolHash(), patterns };
+            return DefaultDirectory() / std::format( "{:016x}", Hash::Xxh64( std::as_bytes( std::span( key ) ) ) );
+        }
+
+
+        /**
+        * @brief Gets the cache entry path of a binary.
+        *
+        * @param directory The cache directory, see 'Directory'.
+        * @param hash Content hash of the binary, see 'Hash::Xxh64'.
+        * @param control_flow true if the results come from the control flow analysis, the only option changing them.
+        * @return Path to the cache entry.
+        */
+        [[nodiscard]] static fs::path EntryPath(
+            const fs::path & directory,
+            std::uint64_t hash,
+            bool control_flow
+        )
+        {
+            return directory / std::format( "{:016x}{}.json", hash, control_flow ? "_cfg" : "" );
+        }
+
+
+        /**
+        * @brief Restores the analysis results of a binary from its cache entry.
+        *
+        * @param path Path to the cache entry.
+        * @param context [out] The analysis context receiving the results.
+        * @return true if the entry exists and is valid, false otherwise.
+        */
+        [[nodiscard]] static bool Load(
+            const fs::path & path,
+            AnalysisContext & context
+        ) noexcept try
+        {
+            std::ifstream in( path );
+            if (!in.is_open())
+                return false;
+
+            const auto j_root = json::parse( in, nullptr, false );
+            if (!j_root.is_object() || j_root.value( "Format", 0u ) != FORMAT_VERSION)
+                return false;
+
+            const auto j_protected = j_root.find( "ProtectedFuncs" );
+            if (j_protected == j_root.end() || !j_protected->is_array())
+                return false;
+
+            ResultTable table {};
+            table.Reserve( j_protected->size() );
+
+            // Rows are stored as '[func, prologue, eip, bp, type]'.
+            for (const auto & j_row : *j_protected)
+            {
+                if (!j_row.is_array() || j_row.size() != 5)
+                    return false;
+
+                const auto type = j_row[4].get<std::uint32_t>();
+                if (type < static_cast<std::uint32_t>(ProtectedType::Constant) || type > static_cast<std::uint32_t>(ProtectedType::StolenV3))
+                    return false;
+
+                table.Append( ProtectedEntry { j_row[0].get<std::uint32_t>(), j_row[1].get<std::uint32_t>(),
+                    j_row[2].get<std::uint32_t>(), j_row[3].get<std::uint32_t>(), static_cast<ProtectedType>(type) } );
+            }
+
+            mem::pointer init { nullptr }, term { nullptr }, register_thread { nullptr };
+            std::vector<mem::pointer> integrity {}, test_secret {};
+
+            if (!ReadAddress( j_root, "Init", init ) ||
+                !ReadAddress( j_root, "Terminate", term ) ||
+                !ReadAddress( j_root, "RegisterThread", register_thread ) ||
+                !ReadAddresses( j_root, "Integrity", integrity ) ||
+                !ReadAddresses( j_root, "TestSecret", test_secret ))
+                return false;
+
+            context.m_ProtectedFuncs = std::move( table );
+            context.m_InitLibraryFunc = init;
+            context.m_TermLibraryFunc = term;
+            context.m_RegisterThreadFunc = register_thread;
+            context.m_IntegrityFuncs = std::move( integrity );
+            context.m_TestSecretFuncs = std::move( test_secret );
+
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+
+        /**
+        * @brief Saves the analysis results of a binary to its cache entry.
+        *
+        * @param path Path to the cache entry, the directory is created if needed.
+        * @param context The analysis context holding the results.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'OutputFileCreateError' if file cannot be created.
+        * @retval 'FileWriteError' if writing fails.
+        */
+        [[nodiscard]] static std::expected<void, Error> Save(
+            const fs::path & path,
+            const AnalysisContext & context
+        ) noexcept try
+        {
+            json j_root = json::object();
+            json j_protected = json::array();
+
+            const auto & table = context.m_ProtectedFuncs;
+
+            for (std::size_t i = 0; i < table.size(); ++i)
+            {
+                j_protected.push_back( { table.Funcs()[i], table.Prologues()[i], table.Eips()[i], table.Bps()[i],
+                    static_cast<std::uint32_t>(table.Types()[i]) } );
+            }
+
+            // Lambda function to store an array of addresses.
+            auto add_funcs = [&j_root]( const auto & container, std::string_view name )
+            {
+                json j_array = json::array();
+
+                for (const auto & address : container)
+                    j_array.push_back( address.as<std::uint32_t>() );
+
+                j_root[name] = std::move( j_array );
+            };
+
+            j_root["Format"] = FORMAT_VERSION;
+            j_root["ProtectedFuncs"] = std::move( j_protected );
+            j_root["Init"] = context.m_InitLibraryFunc.as<std::uint32_t>();
+            j_root["Terminate"] = context.m_TermLibraryFunc.as<std::uint32_t>();
+            j_root["RegisterThread"] = context.m_RegisterThreadFunc.as<std::uint32_t>();
+            add_funcs( context.m_IntegrityFuncs, "Integrity" );
+            add_funcs( context.m_TestSecretFuncs, "TestSecret" );
+
+            fs::create_directories( path.parent_path() );
+
+            std::ofstream out( path, std::ios::trunc );
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            out << j_root.dump();
+
+            if (out.fail())
+                return std::unexpected( Error::FileWriteError );
+
+            return {};
+        }
+        catch (const fs::filesystem_error &)
+        {
+            return std::unexpected( Error::OutputFileCreateError );
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+    };
+}
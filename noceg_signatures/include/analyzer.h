@@ -15,17 +15,71 @@
 #pragma once
 
 #include "utils.h"
+#include "xref.h"
+#include "cfg.h"
+#include "function_index.h"
+#include "decoder.h"
 using namespace CEG;
 
+// Work counters of 'InstructionAnalyzer', reported by '--profile'.
+struct AnalyzerCounters
+{
+    // Instructions decoded by the linear sweep.
+    std::uint64_t m_Decoded { 0 };
+
+    // Instructions referencing a known CEG protected function.
+    std::uint64_t m_TargetHits { 0 };
+
+    // Protected functions searched for their finalize CRC call.
+    std::uint64_t m_FinalizeCrcScans { 0 };
+
+    // References indexed by the linear sweep.
+    std::uint64_t m_References { 0 };
+
+    AnalyzerCounters & operator+=( const AnalyzerCounters & other ) noexcept
+    {
+        m_Decoded += other.m_Decoded;
+        m_TargetHits += other.m_TargetHits;
+        m_FinalizeCrcScans += other.m_FinalizeCrcScans;
+        m_References += other.m_References;
+        return *this;
+    }
+};
+
+
 // Analyzes instructions to identify and categorize CEG protected functions.
 class InstructionAnalyzer
 {
 private:
 
-    ZydisDecoder m_Decoder;
+    InstructionDecoder m_Decoder {};
+
+    // Context receiving the analysis results.
+    AnalysisContext & m_Context;
+
+    // Call/jmp/mov reference index of the analyzed code section.
+    XrefIndex m_Xrefs {};
+
+    // Function starts of the analyzed code section.
+    FunctionIndex m_Functions {};
+
+    // Sorted addresses of the known CEG protected functions.
+    std::vector<std::uint32_t> m_ProtectFuncs {};
+
+    // A classified CEG protected function, buffered until the analysis is complete.
+    struct ProtectedRecord
+    {
+        // Offset of the call site the record originates from.
+        std::uint32_t m_Offset;
+
+        ProtectedEntry m_Entry;
+    };
+
+    // Records in ascending call site order.
+    std::vector<ProtectedRecord> m_Records {};
 
     // Patterns used to identify the finalize CRC function.
-    static constexpr std::array<std::string_view, 6> FINALIZE_CRC_PATTERNS =
+    static constexpr std::array<StaticPattern, 6> FINALIZE_CRC_PATTERNS =
     {
         "E8 ?? ?? ?? ?? 8D ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 8B",
         "E8 ?? ?? ?? ?? 8D ?? ?? E8 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 8B",
@@ -39,149 +93,299 @@ private:
     // Used to set a breakpoint right after the function execution.
     static constexpr std::array<std::uint32_t, 6> FINALIZE_CRC_OFFSETS = { 16, 13, 14, 13, 16, 14 };
 
+    // Finalize CRC breakpoint address per protected function, 0 if no pattern matched.
+    std::unordered_map<std::uint32_t, std::uint32_t> m_FinalizeCrcBreakpoints {};
+
+    // Work done by the analyses so far.
+    AnalyzerCounters m_Counters {};
+
 private:
     
     /**
-    * @brief Processes a single instruction at the given offset.
+    * @brief Buffers a classified CEG protected function.
+    *
+    * @param type The type of the protected function.
+    * @param call_offset Offset of the call site.
+    * @param func Key of the protected function.
+    * @param prologue The function prologue, or the function itself.
+    * @param eip The EIP address.
+    * @param bp The breakpoint address.
+    */
+    void AddRecord(
+        ProtectedType type,
+        std::uint32_t call_offset,
+        mem::pointer func,
+        mem::pointer prologue,
+        mem::pointer eip,
+        mem::pointer bp
+    )
+    {
+        m_Records.push_back( ProtectedRecord { call_offset, ProtectedEntry { func.as<std::uint32_t>(), prologue.as<std::uint32_t>(),
+            eip.as<std::uint32_t>(), bp.as<std::uint32_t>(), type } } );
+    }
+
+
+    /**
+    * @brief Moves the buffered records into the 'AnalysisContext::m_ProtectedFuncs' table and finalizes it.
+    *
+    * Records of the same call site are only committed once.
+    */
+    void CommitRecords()
+    {
+        const auto [first, last] = std::ranges::unique( m_Records, {}, &ProtectedRecord::m_Offset );
+        m_Records.erase( first, last );
+
+        auto & table = m_Context.m_ProtectedFuncs;
+        table.Reserve( table.size() + m_Records.size() );
+
+        for (const auto & record : m_Records)
+            table.Append( record.m_Entry );
+
+        table.Finalize();
+        m_Records.clear();
+    }
+
+
+    /**
+    * @brief Stores the sorted addresses of the known CEG protected functions.
+    *
+    * @param funcs List of known protected function addresses.
+    */
+    void SetProtectedFunctions(
+        std::span<const mem::pointer> funcs
+    )
+    {
+        m_ProtectFuncs.clear();
+        m_ProtectFuncs.reserve( funcs.size() );
+
+        for (const auto & func : funcs)
+            m_ProtectFuncs.push_back( func.as<std::uint32_t>() );
+
+        std::ranges::sort( m_ProtectFuncs );
+    }
+
+
+    /**
+    * @brief Decodes the given call sites and the prefixed forms in front of them, in ascending order.
     *
     * @param data The binary data to analyze.
     * @param address Base address of the data in memory.
-    * @param offset Current offset within the data.
-    * @param protect_funcs List of known CEG protected function addresses.
-    * @return true if instruction was processed successfully, false otherwise.
+    * @param sites Ascending offsets of the call sites.
     */
-    bool ProcessInstruction(
+    void ProcessSites(
         std::span<const std::byte> data,
         const void * address,
-        std::uint32_t & offset,
-        std::span<const mem::pointer> protect_funcs
+        std::span<const std::uint32_t> sites
+    )
+    {
+        const auto * bytes = reinterpret_cast<const mem::byte *>(data.data());
+
+        for (const auto site : sites)
+        {
+            for (auto offset = OpcodePrefilter::GetPrefixStart( bytes, site ); offset <= site; ++offset)
+                ProcessInstruction( data, address, offset );
+        }
+    }
+    
+    
+    /**
+    * @brief Decodes a single instruction and computes its call/jump target.
+    *
+    * @param data The binary data to analyze.
+    * @param address Base address of the data in memory.
+    * @param offset Offset of the instruction within the data.
+    * @param target [out] The target of the instruction.
+    * @return true if the instruction is of interest and was decoded successfully, false otherwise.
+    */
+    [[nodiscard]] bool DecodeTarget(
+        std::span<const std::byte> data,
+        const void * address,
+        std::uint32_t offset,
+        std::uint32_t & target
     ) noexcept
     {
         ZydisDecodedInstruction instruction;
-        ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT];
 
         if (offset + ZYDIS_MAX_INSTRUCTION_LENGTH > data.size())
             return false;
 
-        if (!ZYAN_SUCCESS( ZydisDecoderDecodeFull( &m_Decoder,
-            reinterpret_cast<const void *>(data.data() + offset),
-            ZYDIS_MAX_INSTRUCTION_LENGTH,
-            &instruction,
-            operands ) ))
+        const auto * buffer = reinterpret_cast<const void *>(data.data() + offset);
+
+        if (!m_Decoder.Decode( buffer, ZYDIS_MAX_INSTRUCTION_LENGTH, instruction ))
             return false;
 
-        if (IsTargetInstruction( instruction, operands ))
-            ProcessTargetInstruction( instruction, operands, address, offset, protect_funcs );
+        ++m_Counters.m_Decoded;
 
-        // Move to the next byte.
-        offset += 1;
-        return true;
+        if (!IsTargetInstruction( instruction ))
+            return false;
+
+        // Only the 'mov' candidates need their operands decoded.
+        if (instruction.mnemonic == ZYDIS_MNEMONIC_MOV)
+        {
+            std::uint32_t value = 0;
+
+            if (!m_Decoder.GetMoveEaxImmediate( buffer, ZYDIS_MAX_INSTRUCTION_LENGTH, value ))
+                return false;
+
+            target = VaToOffset( m_Context, value );
+            return true;
+        }
+
+        target = InstructionDecoder::RelativeTarget( m_Context, instruction, reinterpret_cast<std::uint32_t>(address) + offset );
+        return target != 0;
     }
     
     
     /**
-    * @brief Determines if an instruction is of interest for the further analysis.
+    * @brief Processes a single instruction at the given offset.
+    *
+    * @param data The binary data to analyze.
+    * @param address Base address of the data in memory.
+    * @param offset Offset of the instruction within the data.
+    */
+    void ProcessInstruction(
+        std::span<const std::byte> data,
+        const void * address,
+        std::uint32_t offset
+    ) noexcept
+    {
+        std::uint32_t call_target = 0;
+
+        if (!DecodeTarget( data, address, offset, call_target ))
+            return;
+
+        if (std::ranges::binary_search( m_ProtectFuncs, call_target ))
+        {
+            ++m_Counters.m_TargetHits;
+
+            const auto current_address = reinterpret_cast<std::uint32_t>(address) + offset;
+            ProcessProtectedFunction( current_address, call_target, address, offset, current_address + 5 );
+        }
+    }
+    
+    
+    /**
+    * @brief Determines if a minimally decoded instruction is of interest for the further analysis.
+    *
+    * Direct calls and jumps are final, 'mov' candidates are confirmed by 'InstructionDecoder::GetMoveEaxImmediate'.
     *
     * @param instruction The decoded instruction.
-    * @param operands Array of instruction operands.
     * @return true if the instruction should be analyzed further.
     */
     [[nodiscard]] static bool IsTargetInstruction(
-        const ZydisDecodedInstruction & instruction,
-        const ZydisDecodedOperand * operands
+        const ZydisDecodedInstruction & instruction
     ) noexcept
     {
-        return (instruction.mnemonic == ZYDIS_MNEMONIC_CALL &&
-            operands[0].type == ZYDIS_OPERAND_TYPE_IMMEDIATE) ||
-            (instruction.mnemonic == ZYDIS_MNEMONIC_JMP &&
-                operands[0].type == ZYDIS_OPERAND_TYPE_IMMEDIATE) ||
-            (instruction.mnemonic == ZYDIS_MNEMONIC_MOV &&
-                operands[0].type == ZYDIS_OPERAND_TYPE_REGISTER &&
-                operands[1].type == ZYDIS_OPERAND_TYPE_IMMEDIATE &&
-                operands[0].reg.value == ZYDIS_REGISTER_EAX);
+        return ((instruction.mnemonic == ZYDIS_MNEMONIC_CALL || instruction.mnemonic == ZYDIS_MNEMONIC_JMP) &&
+            InstructionDecoder::IsRelative( instruction )) ||
+            InstructionDecoder::IsMoveImmediate( instruction );
     }
     
     
     /**
-    * @brief Processes instructions that match our target.
+    * @brief Finds the first referenced CEG register thread function.
     *
-    * @param instruction The decoded instruction.
-    * @param operands Array of instruction operands.
+    * @param data The binary data to analyze.
     * @param address Base address of the data in memory.
-    * @param offset Current offset within the data.
-    * @param protect_funcs List of known CEG protected function addresses.
+    * @return 'mem::pointer' to the register thread function, or nullptr if none is referenced.
     */
-    void ProcessTargetInstruction(
-        const ZydisDecodedInstruction & instruction,
-        const ZydisDecodedOperand * operands,
-        const void * address,
-        std::uint32_t offset,
-        std::span<const mem::pointer> protect_funcs
+    [[nodiscard]] mem::pointer FindRegisterThreadFunction(
+        std::span<const std::byte> data,
+        const void * address
     ) noexcept
     {
-        const auto current_address = reinterpret_cast<std::uint32_t>(address) + offset;
+        std::vector<std::uint32_t> targets {};
 
-        std::uint32_t call_target = 0;
+        for (const auto & func : m_Context.m_RegisterThreadFuncs)
+            targets.push_back( func.as<std::uint32_t>() );
 
-        if (instruction.mnemonic == ZYDIS_MNEMONIC_MOV)
-            call_target = VaToOffset( static_cast<std::uint32_t>(operands[1].imm.value.s) );
-        else
-            call_target = current_address + static_cast<std::uint32_t>(operands[0].imm.value.s + instruction.length);
+        std::vector<std::uint32_t> sites {};
+        m_Xrefs.CallersOf( targets, sites );
 
-        auto call_target_ptr = mem::pointer( call_target );
+        const auto * bytes = reinterpret_cast<const mem::byte *>(data.data());
 
-        // Check for the first register thread CEG occurance.
-        if ((!Data::CEG_REGISTER_THREAD_FUNC && !Data::CEG_REGISTER_THREAD_FUNC_FUNCS.empty()))
+        // The lowest confirmed reference wins.
+        for (const auto site : sites)
         {
-            if (Data::CEG_REGISTER_THREAD_FUNC_FUNCS.contains( call_target_ptr ))
-                Data::CEG_REGISTER_THREAD_FUNC = call_target_ptr;
+            for (auto offset = OpcodePrefilter::GetPrefixStart( bytes, site ); offset <= site; ++offset)
+            {
+                std::uint32_t call_target = 0;
+
+                if (DecodeTarget( data, address, offset, call_target ) &&
+                    m_Context.m_RegisterThreadFuncs.contains( mem::pointer( call_target ) ))
+                    return mem::pointer( call_target );
+            }
         }
 
-        if (std::ranges::find( protect_funcs, call_target_ptr ) != protect_funcs.end())
-            ProcessProtectedFunction( current_address, call_target, address, offset );
+        return mem::pointer { nullptr };
     }
     
 
     /**
-    * @brief Analyzes a CEG protected function to determine its type.
+    * @brief Finds the breakpoint right after the finalize CRC call of a protected function.
+    *
+    * The patterns are only scanned the first time a function is seen, later call sites reuse the result.
     *
-    * @param current_address Address of the current instruction.
     * @param target_func Address of the target protected function.
-    * @param address Base address of the data in memory.
-    * @param call_offset Offset of the call instruction.
+    * @return The breakpoint address, or 0 if none of the patterns matched.
     */
-    void ProcessProtectedFunction(
-        std::uint32_t current_address,
-        std::uint32_t target_func,
-        const void * address,
-        std::uint32_t call_offset
+    [[nodiscard]] std::uint32_t FindFinalizeCrcBreakpoint(
+        std::uint32_t target_func
     ) noexcept
     {
-        const auto next_instruction_address = current_address + 5;
-        const auto * next_instruction_ptr = reinterpret_cast<const std::uint8_t *>(next_instruction_address);
+        const auto [it, inserted] = m_FinalizeCrcBreakpoints.try_emplace( target_func, 0 );
+
+        if (!inserted)
+            return it->second;
 
-        std::atomic_bool found = false;
+        ++m_Counters.m_FinalizeCrcScans;
 
         // Pattern match using ranges to find the finalize CRC function.
         for (const auto & [pattern, offset] : std::views::zip( FINALIZE_CRC_PATTERNS, FINALIZE_CRC_OFFSETS ))
         {
             if (auto finalize_crc = FindFunction( pattern,
                 reinterpret_cast<const void *>(target_func),
-                Data::CEG_SCAN_SIZE );
+                CEG_SCAN_SIZE );
                 finalize_crc.as<std::uint32_t>() != 0)
             {
                 // Calculate the breakpoint address using the pattern offset.
-                const auto bp = finalize_crc.as<std::uint32_t>() + offset;
-                auto func = CalculateRealAddress( address, target_func );
-                GetCEGFunctionType( current_address, bp, address, next_instruction_ptr, call_offset, func );
-
-                found.store( true );
+                it->second = finalize_crc.as<std::uint32_t>() + offset;
                 break;
             }
         }
 
+        return it->second;
+    }
+
+
+    /**
+    * @brief Analyzes a CEG protected function to determine its type.
+    *
+    * @param current_address Address of the current instruction.
+    * @param target_func Address of the target protected function.
+    * @param address Base address of the data in memory.
+    * @param call_offset Offset of the call instruction.
+    * @param next_instruction_address Address of the instruction following the current one.
+    */
+    void ProcessProtectedFunction(
+        std::uint32_t current_address,
+        std::uint32_t target_func,
+        const void * address,
+        std::uint32_t call_offset,
+        std::uint32_t next_instruction_address
+    ) noexcept
+    {
+        const auto * next_instruction_ptr = reinterpret_cast<const std::uint8_t *>(next_instruction_address);
+
+        const auto bp = FindFinalizeCrcBreakpoint( target_func );
+
+        if (bp)
+        {
+            auto func = CalculateRealAddress( m_Context, address, target_func );
+            GetCEGFunctionType( current_address, bp, address, next_instruction_ptr, call_offset, func );
+        }
         // Handle even older CEG versions that don't match the patterns.
-        if ((Data::CEG_OLD_VERSION && !found.load()))
+        else if (m_Context.m_OldVersion)
         {
             // Check for 'call eax' instruction.
             if (*next_instruction_ptr == 0xFF && *(next_instruction_ptr + 1) == 0xD0)
@@ -189,78 +393,40 @@ private:
                 const auto prev_instruction_address = current_address - 1;
                 const auto * prev_instruction_ptr = reinterpret_cast<const std::uint8_t *>(prev_instruction_address);
 
-                auto func = CalculateRealAddress( address, target_func );
-                auto eip = CalculateRealAddress( address, current_address - 1 );
-                auto bp = CalculateRealAddress( address, next_instruction_address + 2 );
+                auto func = CalculateRealAddress( m_Context, address, target_func );
+                auto eip = CalculateRealAddress( m_Context, address, current_address - 1 );
+                auto bp = CalculateRealAddress( m_Context, address, next_instruction_address + 2 );
 
                 // Check for 'push ecx' instruction.
                 if (*prev_instruction_ptr == 0x51)
-                    Data::CEG_PROTECTED_STOLEN_FUNCS_v1.emplace( func, std::make_tuple( func, eip, bp ) );
+                    AddRecord( ProtectedType::StolenV1, call_offset, func, func, eip, bp );
                 else
-                    Data::CEG_PROTECTED_STOLEN_FUNCS_v1.emplace( func, std::make_tuple( func, eip + 1, bp ) );
+                    AddRecord( ProtectedType::StolenV1, call_offset, func, func, eip + 1, bp );
             }
         }
     }
 
 
-    // Find the protected function prologue by scanning backwards from the call instruction.
+    /**
+    * @brief Finds the prologue of the function containing a call site.
+    *
+    * @param base_address Base address of the data in memory.
+    * @param call_offset Offset of the call instruction.
+    * @return The real address of the closest function start within 'CEG_SCAN_SIZE' bytes before the call,
+    * or a null pointer if there is none.
+    */
     [[nodiscard]] mem::pointer FindFunctionPrologue(
-        std::span<const std::byte> data,
         const void * base_address,
         std::uint32_t call_offset
-    ) noexcept
+    ) const noexcept
     {
-        // Start scanning backwards from the call instruction.
-        const std::uint32_t start_scan = (call_offset > Data::CEG_SCAN_SIZE) ?
-            call_offset - Data::CEG_SCAN_SIZE : 0;
-
-        // Scan backwards looking for the function prologue.
-        for (std::uint32_t offset = call_offset; offset > start_scan; --offset)
-        {
-            ZydisDecodedInstruction instruction;
-            ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT];
-
-            if (!ZYAN_SUCCESS( ZydisDecoderDecodeFull( &m_Decoder,
-                reinterpret_cast<const void *>(data.data() + offset),
-                ZYDIS_MAX_INSTRUCTION_LENGTH,
-                &instruction,
-                operands ) ))
-                continue;
-
-            // Look for the function prologue 'push ebp'.
-            if (instruction.mnemonic == ZYDIS_MNEMONIC_PUSH &&
-                operands[0].type == ZYDIS_OPERAND_TYPE_REGISTER &&
-                operands[0].reg.value == ZYDIS_REGISTER_EBP)
-            {
-                // Check if the next instruction is 'mov ebp, esp'.
-                const std::uint32_t next_offset = offset + instruction.length;
+        std::uint32_t offset = 0;
 
-                ZydisDecodedInstruction next_instruction;
-                ZydisDecodedOperand next_operands[ZYDIS_MAX_OPERAND_COUNT];
+        if (!m_Functions.FindStart( call_offset, CEG_SCAN_SIZE, offset ))
+            return mem::pointer { nullptr };
 
-                if (ZYAN_SUCCESS( ZydisDecoderDecodeFull( &m_Decoder,
-                    reinterpret_cast<const void *>(data.data() + next_offset),
-                    ZYDIS_MAX_INSTRUCTION_LENGTH,
-                    &next_instruction,
-                    next_operands ) ))
-                {
-                    // Verify this is 'mov ebp, esp'.
-                    if (next_instruction.mnemonic == ZYDIS_MNEMONIC_MOV &&
-                        next_operands[0].type == ZYDIS_OPERAND_TYPE_REGISTER &&
-                        next_operands[1].type == ZYDIS_OPERAND_TYPE_REGISTER &&
-                        next_operands[0].reg.value == ZYDIS_REGISTER_EBP &&
-                        next_operands[1].reg.value == ZYDIS_REGISTER_ESP)
-                    {
-                        // Found the function prologue!
-                        const auto start = reinterpret_cast<std::uint32_t>(base_address) + offset;
-                        return CalculateRealAddress( base_address, start );
-                    }
-                }
-            }
-        }
-
-        // Prologue not found.
-        return mem::pointer { nullptr };
+        const auto start = reinterpret_cast<std::uint32_t>(base_address) + offset;
+        return CalculateRealAddress( m_Context, base_address, start );
     }
     
     
@@ -283,10 +449,10 @@ private:
         mem::pointer target_func
     ) noexcept
     {
-        const auto eip = CalculateRealAddress( address, current_address );
-        const auto real_bp = CalculateRealAddress( address, bp );
+        const auto eip = CalculateRealAddress( m_Context, address, current_address );
+        const auto real_bp = CalculateRealAddress( m_Context, address, bp );
 
-        if (Data::CEG_OLD_VERSION)
+        if (m_Context.m_OldVersion)
         {
             // Handle old CEG version with 'call eax' instruction.
             if (*next_instruction_ptr == 0xFF && *(next_instruction_ptr + 1) == 0xD0)
@@ -296,13 +462,13 @@ private:
 
                 // Check for 'push ecx' instruction before the current call.
                 if (*prev_instruction_ptr == 0x51)
-                    Data::CEG_PROTECTED_STOLEN_FUNCS_v1.emplace( target_func, std::make_tuple( target_func, eip - 1, real_bp ) );
+                    AddRecord( ProtectedType::StolenV1, call_offset, target_func, target_func, eip - 1, real_bp );
                 else
-                    Data::CEG_PROTECTED_STOLEN_FUNCS_v1.emplace( target_func, std::make_tuple( target_func, eip, real_bp ) );
+                    AddRecord( ProtectedType::StolenV1, call_offset, target_func, target_func, eip, real_bp );
             }
             // Check for 'jmp eax' instruction.
             else if (*next_instruction_ptr == 0xFF && *(next_instruction_ptr + 1) == 0xE0)
-                Data::CEG_PROTECTED_STOLEN_FUNCS_v2.emplace( target_func, std::make_tuple( target_func, eip, real_bp ) );
+                AddRecord( ProtectedType::StolenV2, call_offset, target_func, target_func, eip, real_bp );
         }
         else
         {
@@ -310,69 +476,214 @@ private:
 
             // Check for 'ret' instruction or 'mov' instruction.
             if (*next_instruction_ptr == 0xC3 || *next_instruction_ptr == 0x89)
-                Data::CEG_PROTECTED_CONSTANT_FUNCS.emplace( target_func, std::make_tuple( target_func, eip, real_bp ) );
+                AddRecord( ProtectedType::Constant, call_offset, target_func, target_func, eip, real_bp );
             // Check for 'jmp eax' instruction.
             else if (*next_instruction_ptr == 0xFF && *(next_instruction_ptr + 1) == 0xE0)
-                Data::CEG_PROTECTED_STOLEN_FUNCS_v2.emplace( target_func, std::make_tuple( target_func, eip, real_bp ) );
+                AddRecord( ProtectedType::StolenV2, call_offset, target_func, target_func, eip, real_bp );
             // Check if the current instruction is the short jump.
             else if(*cur_instruction_ptr == 0xEB)
-                Data::CEG_PROTECTED_CONSTANT_FUNCS.emplace( target_func, std::make_tuple( target_func, eip, real_bp ) );
+                AddRecord( ProtectedType::Constant, call_offset, target_func, target_func, eip, real_bp );
             else
             {
                 // Attempt to find the function prologue.
-                const auto * base = reinterpret_cast<const std::byte *>(address);
-                std::span<const std::byte> data( base, Data::CEG_SCAN_SIZE );
-
-                auto prologue = FindFunctionPrologue( data, address, call_offset );
+                auto prologue = FindFunctionPrologue( address, call_offset );
 
                 if (prologue)
-                    Data::CEG_PROTECTED_STOLEN_FUNCS_v3.emplace( target_func, std::make_tuple( prologue, eip, real_bp ) );
+                    AddRecord( ProtectedType::StolenV3, call_offset, target_func, prologue, eip, real_bp );
                 else
-                    Data::CEG_PROTECTED_STOLEN_FUNCS_v3.emplace( target_func, std::make_tuple( target_func, eip, real_bp ) );
+                    AddRecord( ProtectedType::StolenV3, call_offset, target_func, target_func, eip, real_bp );
             }
         }
     }
 
 public:
 
-    InstructionAnalyzer()
+    explicit InstructionAnalyzer(
+        AnalysisContext & context
+    ) : m_Context( context )
     {
-        if (!ZYAN_SUCCESS( ZydisDecoderInit( &m_Decoder,
-            ZYDIS_MACHINE_MODE_LONG_COMPAT_32,
-            ZYDIS_STACK_WIDTH_32 ) ))
-        {
-            throw std::runtime_error( "Failed to initialize Zydis decoder." );
-        }
     }
     
     
     /**
     * @brief Analyzes binary data to identify CEG protected functions.
-     *
-     * @param data Binary data to analyze.
-     * @param address Base address of the data in memory.
-     * @param funcs List of known protected function addresses to look for.
-     * @return true if analysis completed successfully, false otherwise.
-     */
+    *
+    * With several threads the section is split into chunks, each analyzed by a worker with its
+    * own decoder and result buffer. The results are merged in chunk order, so they match the
+    * serial analysis.
+    *
+    * @param data Binary data to analyze.
+    * @param address Base address of the data in memory.
+    * @param funcs List of known protected function addresses to look for.
+    * @param threads Number of worker threads.
+    * @param reuse References of a previous analysis to reuse outside of its dirty ranges, or nullptr.
+    * @return true if analysis completed successfully, false otherwise.
+    */
     [[nodiscard]] bool AnalyzeCEGProtectedFunctions(
         std::span<const std::byte> data,
         const void * address,
-        std::span<const mem::pointer> funcs
-    ) noexcept
+        std::span<const mem::pointer> funcs,
+        std::uint32_t threads = 1,
+        const XrefReuse * reuse = nullptr
+    ) noexcept try
     {
-        std::uint32_t offset = 0;
-        const auto size = static_cast<std::uint32_t>(data.size());
+        // Index every reference once, the later queries only touch the sites of interest.
+        if (reuse)
+            m_Xrefs.Update( m_Context, data, address, *reuse );
+        else
+            m_Xrefs.Build( m_Context, data, address, threads );
+
+        m_Counters.m_References += m_Xrefs.size();
+        SetProtectedFunctions( funcs );
 
-        while (offset < size)
+        // Index the function starts from the prologues and the direct call targets.
+        std::vector<std::uint32_t> call_targets {};
+
+        for (const auto & xref : m_Xrefs.All())
         {
-            if (!ProcessInstruction( data, address, offset, funcs ))
+            if (static_cast<mem::byte>(data[xref.m_Offset]) == 0xE8)
+                call_targets.push_back( xref.m_Target );
+        }
+
+        m_Functions.Build( data, address, call_targets );
+
+        // Check for the first register thread CEG occurance.
+        if (!m_Context.m_RegisterThreadFunc && !m_Context.m_RegisterThreadFuncs.empty())
+            m_Context.m_RegisterThreadFunc = FindRegisterThreadFunction( data, address );
+
+        std::vector<std::uint32_t> sites {};
+        m_Xrefs.CallersOf( m_ProtectFuncs, sites );
+
+        if (threads <= 1)
+            ProcessSites( data, address, sites );
+        else
+        {
+            // Decoding a site reads up to 'ZYDIS_MAX_INSTRUCTION_LENGTH' bytes into the next chunk.
+            const auto size = static_cast<std::uint32_t>(data.size());
+            const auto chunk_size = (size + threads - 1) / threads;
+
+            std::vector<std::unique_ptr<InstructionAnalyzer>> analyzers {};
+
+            // A future waits for its task when destroyed, so a failed launch or worker never leaves one running.
+            std::vector<std::future<void>> workers {};
+
+            for (std::uint32_t i = 0; i < threads; ++i)
             {
-                // If instruction processing fails, move to the next byte.
-                offset++;
-                continue;
+                const auto begin = std::ranges::lower_bound( sites, std::min( size, i * chunk_size ) );
+                const auto end = std::ranges::lower_bound( sites, std::min( size, (i + 1) * chunk_size ) );
+                const std::span<const std::uint32_t> chunk( begin, end );
+
+                auto * analyzer = analyzers.emplace_back( std::make_unique<InstructionAnalyzer>( m_Context ) ).get();
+                analyzer->m_ProtectFuncs = m_ProtectFuncs;
+                analyzer->m_Functions = m_Functions;
+
+                workers.push_back( std::async( std::launch::async, [&data, address, chunk, analyzer]()
+                {
+                    analyzer->ProcessSites( data, address, chunk );
+                } ) );
+            }
+
+            // Rethrows the exception of a failed worker.
+            for (auto & worker : workers)
+                worker.get();
+
+            for (const auto & analyzer : analyzers)
+            {
+                m_Records.insert( m_Records.end(), analyzer->m_Records.begin(), analyzer->m_Records.end() );
+                m_Counters += analyzer->m_Counters;
             }
         }
 
+        CommitRecords();
         return true;
     }
+    catch (...)
+    {
+        return false;
+    }
+
+
+    /**
+    * @brief Analyzes the reachable instructions of a control flow graph to identify CEG protected functions.
+    *
+    * Unlike the linear sweep, every call site is a real instruction and the classification
+    * uses the actual following instruction.
+    *
+    * @param data Binary data the graph was built from.
+    * @param cfg The control flow graph of the code section.
+    * @param address Base address of the data in memory.
+    * @param funcs List of known protected function addresses to look for.
+    * @return true if analysis completed successfully, false otherwise.
+    */
+    [[nodiscard]] bool AnalyzeCEGProtectedFunctions(
+        std::span<const std::byte> data,
+        const ControlFlowGraph & cfg,
+        const void * address,
+        std::span<const mem::pointer> funcs
+    ) noexcept try
+    {
+        SetProtectedFunctions( funcs );
+
+        // Index the function starts from the prologues and the reachable call targets.
+        std::vector<std::uint32_t> call_targets {};
+
+        for (const auto & instruction : cfg.Instructions())
+        {
+            if (instruction.m_Flow == InstructionFlow::Call)
+                call_targets.push_back( instruction.m_Target );
+        }
+
+        m_Functions.Build( data, address, call_targets );
+
+        const auto base = reinterpret_cast<std::uint32_t>(address);
+
+        for (const auto & instruction : cfg.Instructions())
+        {
+            // Same instructions 'IsTargetInstruction' selects in the linear sweep.
+            if (instruction.m_Flow != InstructionFlow::Call &&
+                instruction.m_Flow != InstructionFlow::Jump &&
+                instruction.m_Flow != InstructionFlow::Reference)
+                continue;
+
+            const auto call_target_ptr = mem::pointer( instruction.m_Target );
+
+            // Check for the first register thread CEG occurance.
+            if (!m_Context.m_RegisterThreadFunc && m_Context.m_RegisterThreadFuncs.contains( call_target_ptr ))
+                m_Context.m_RegisterThreadFunc = call_target_ptr;
+
+            if (!std::ranges::binary_search( m_ProtectFuncs, instruction.m_Target ))
+                continue;
+
+            ++m_Counters.m_TargetHits;
+
+            const auto current_address = base + instruction.m_Offset;
+            ProcessProtectedFunction( current_address, instruction.m_Target, address, instruction.m_Offset,
+                current_address + instruction.m_Length );
+        }
+
+        CommitRecords();
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+
+    // Gets the work done by the analyses so far.
+    [[nodiscard]] const AnalyzerCounters & GetCounters() const noexcept
+    {
+        return m_Counters;
+    }
+
+
+    /**
+    * @brief Gets the reference index built by the last analysis.
+    *
+    * @return Reference to the 'XrefIndex'.
+    */
+    [[nodiscard]] const XrefIndex & GetXrefs() const noexcept
+    {
+        return m_Xrefs;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,201 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#    define CEG_AVX512_TARGET
+#else
+#    include <cpuid.h>
+#    define CEG_AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+#endif
+
+// AVX-512BW kernels of the full-section scans, selected at runtime so the binary still runs without AVX-512.
+namespace CEG::Avx512
+{
+    /**
+    * @brief Checks if the CPU and the OS support AVX-512BW.
+    *
+    * @return true if AVX-512F, AVX-512BW and the ZMM/opmask register state are available.
+    */
+    [[nodiscard]] inline bool Detect() noexcept
+    {
+        int info[4] {};
+
+#if defined(_MSC_VER)
+        __cpuid( info, 0 );
+        if (info[0] < 7)
+            return false;
+
+        __cpuid( info, 1 );
+#else
+        if (__get_cpuid_max( 0, nullptr ) < 7)
+            return false;
+
+        __cpuid( 1, info[0], info[1], info[2], info[3] );
+#endif
+
+        // 'OSXSAVE', the OS must save the extended register state.
+        if (!(info[2] & (1 << 27)))
+            return false;
+
+#if defined(_MSC_VER)
+        const auto xcr0 = _xgetbv( 0 );
+#else
+        std::uint32_t xcr0_low = 0, xcr0_high = 0;
+        __asm__( "xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0) );
+        const std::uint64_t xcr0 = (static_cast<std::uint64_t>(xcr0_high) << 32) | xcr0_low;
+#endif
+
+        // XMM, YMM, opmask, upper ZMM and high ZMM registers.
+        if ((xcr0 & 0xE6) != 0xE6)
+            return false;
+
+#if defined(_MSC_VER)
+        __cpuidex( info, 7, 0 );
+#else
+        __cpuid_count( 7, 0, info[0], info[1], info[2], info[3] );
+#endif
+
+        // 'AVX512F' and 'AVX512BW'.
+        return (info[1] & (1 << 16)) && (info[1] & (1 << 30));
+    }
+
+
+    // Cached result of 'Detect'.
+    [[nodiscard]] inline bool Supported() noexcept
+    {
+        static const bool supported = Detect();
+        return supported;
+    }
+
+
+    /**
+    * @brief Finds the first position where two bytes occur at a fixed distance.
+    *
+    * Compares 64 positions per iteration, the second comparison is masked by the first one.
+    *
+    * @param ptr Pointer to the first candidate position.
+    * @param num Number of candidate positions, 'ptr[num - 1 + distance]' must be readable.
+    * @param first Byte expected at the candidate position.
+    * @param second Byte expected 'distance' bytes after the candidate position.
+    * @param distance Distance between both bytes.
+    * @return Pointer to the first matching position, or 'ptr + num' if there is none.
+    */
+    [[nodiscard]] CEG_AVX512_TARGET inline const mem::byte * FindBytePair(
+        const mem::byte * ptr,
+        std::size_t num,
+        mem::byte first,
+        mem::byte second,
+        std::size_t distance
+    ) noexcept
+    {
+        const __m512i simd_first = _mm512_set1_epi8( static_cast<char>(first) );
+        const __m512i simd_second = _mm512_set1_epi8( static_cast<char>(second) );
+
+        for (; num >= 64; ptr += 64, num -= 64)
+        {
+            const __mmask64 mask = _mm512_cmpeq_epi8_mask( _mm512_loadu_si512( ptr ), simd_first );
+            const __mmask64 pair = _mm512_mask_cmpeq_epi8_mask( mask, _mm512_loadu_si512( ptr + distance ), simd_second );
+
+            if (pair)
+                return ptr + std::countr_zero( static_cast<std::uint64_t>(pair) );
+        }
+
+        for (; num; ++ptr, --num)
+        {
+            if (ptr[0] == first && ptr[distance] == second)
+                return ptr;
+        }
+
+        return ptr;
+    }
+
+
+    /**
+    * @brief Classifies 64 bytes against a nibble lookup byte set.
+    *
+    * A byte is reported if 'low[byte & 0xF] & high[byte >> 4]' is not zero.
+    *
+    * @param ptr Pointer to the 64 bytes to classify.
+    * @param low Lookup table indexed by the low nibble.
+    * @param high Lookup table indexed by the high nibble.
+    * @return Bit mask of the reported bytes.
+    */
+    [[nodiscard]] CEG_AVX512_TARGET inline std::uint64_t MatchByteClass(
+        const mem::byte * ptr,
+        const std::array<mem::byte, 16> & low,
+        const std::array<mem::byte, 16> & high
+    ) noexcept
+    {
+        const __m512i simd_low = _mm512_broadcast_i32x4( _mm_loadu_si128( reinterpret_cast<const __m128i *>(low.data()) ) );
+        const __m512i simd_high = _mm512_broadcast_i32x4( _mm_loadu_si128( reinterpret_cast<const __m128i *>(high.data()) ) );
+        const __m512i nibble = _mm512_set1_epi8( 0x0F );
+
+        const __m512i value = _mm512_loadu_si512( ptr );
+        const __m512i low_class = _mm512_shuffle_epi8( simd_low, _mm512_and_si512( value, nibble ) );
+        const __m512i high_class = _mm512_shuffle_epi8( simd_high, _mm512_and_si512( _mm512_srli_epi16( value, 4 ), nibble ) );
+
+        return _mm512_test_epi8_mask( low_class, high_class );
+    }
+
+
+    /**
+    * @brief Finds the offsets of the bytes acted on by 'InstructionAnalyzer' in 64 byte blocks.
+    *
+    * 'E8', 'E9', 'EB', 'B8' and 'C7', see 'OpcodePrefilter::IsOpcode'.
+    *
+    * @param data Pointer to the memory region.
+    * @param size Number of bytes to search.
+    * @param res [out] Reference to vector that will receive the opcode offsets in ascending order.
+    * @return Number of bytes processed, the remaining tail is left to the caller.
+    */
+    CEG_AVX512_TARGET inline std::size_t FindOpcodes(
+        const mem::byte * data,
+        std::size_t size,
+        std::vector<std::uint32_t> & res
+    )
+    {
+        const __m512i low_bit = _mm512_set1_epi8( static_cast<char>(0xFE) );
+        const __m512i rel32 = _mm512_set1_epi8( static_cast<char>(0xE8) );
+        const __m512i rel8 = _mm512_set1_epi8( static_cast<char>(0xEB) );
+        const __m512i mov_eax = _mm512_set1_epi8( static_cast<char>(0xB8) );
+        const __m512i mov_rm = _mm512_set1_epi8( static_cast<char>(0xC7) );
+
+        std::size_t offset = 0;
+
+        for (; offset + 64 <= size; offset += 64)
+        {
+            const __m512i value = _mm512_loadu_si512( data + offset );
+
+            // 'E8' and 'E9' only differ in the lowest bit.
+            auto mask = static_cast<std::uint64_t>(
+                _mm512_cmpeq_epi8_mask( _mm512_and_si512( value, low_bit ), rel32 ) |
+                _mm512_cmpeq_epi8_mask( value, rel8 ) |
+                _mm512_cmpeq_epi8_mask( value, mov_eax ) |
+                _mm512_cmpeq_epi8_mask( value, mov_rm ));
+
+            while (mask)
+            {
+                res.push_back( static_cast<std::uint32_t>(offset + std::countr_zero( mask )) );
+                mask &= mask - 1;
+            }
+        }
+
+        return offset;
+    }
+}
@@ -0,0 +1,352 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+namespace CEG
+{
+    // A binary queued for the batch analysis.
+    struct BatchJob
+    {
+        // Path to the CEG binary.
+        fs::path m_Binary {};
+
+        // Path to its JSON output inside the batch directory.
+        fs::path m_Output {};
+
+        // File size, the queue starts with the largest binaries.
+        std::uintmax_t m_Size { 0 };
+    };
+
+
+    // Outcome of the analysis of a single binary.
+    struct BinaryReport
+    {
+        fs::path m_Binary {};
+        fs::path m_Output {};
+
+        // Error which stopped the analysis, if any.
+        std::optional<Error> m_Error {};
+
+        // The results were loaded from the analysis cache.
+        bool m_Cached { false };
+
+        bool m_OldVersion { false };
+
+        // A copy of the binary with disabled ASLR was saved.
+        bool m_NoAslr { false };
+
+        // Indices of the matched init and terminate patterns, recorded in the pattern statistics.
+        std::optional<std::uint16_t> m_InitPattern {};
+        std::optional<std::uint16_t> m_TermPattern {};
+
+        std::size_t m_ProtectedEntries { 0 };
+        std::size_t m_IntegrityFuncs { 0 };
+        std::size_t m_TestSecretFuncs { 0 };
+
+        // Wall time of the analysis in seconds.
+        double m_Seconds { 0.0 };
+    };
+
+
+    // Finds the binaries of a batch, analyzes them on a bounded worker pool and summarizes the results.
+    class Batch
+    {
+    private:
+
+        // Suffixes of the binaries written by NoCEG itself.
+        static constexpr std::array<std::string_view, 2> OUTPUT_SUFFIXES = { "_noaslr", "_noceg" };
+
+
+        [[nodiscard]] static std::string Lower(
+            std::string value
+        )
+        {
+            std::ranges::transform( value, value.begin(), []( unsigned char c ) { return static_cast<char>(std::tolower( c )); } );
+            return value;
+        }
+
+
+        // Checks if a directory entry looks like a CEG executable.
+        [[nodiscard]] static bool IsCandidate(
+            const fs::path & path
+        )
+        {
+            if (Lower( path.extension().string() ) != ".exe")
+                return false;
+
+            const auto stem = Lower( path.stem().string() );
+
+            return std::ranges::none_of( OUTPUT_SUFFIXES, [&stem]( std::string_view suffix )
+            {
+                return stem.ends_with( suffix );
+            } );
+        }
+
+
+        // Appends every candidate executable below a directory.
+        static void CollectDirectory(
+            const fs::path & directory,
+            std::vector<fs::path> & res
+        )
+        {
+            std::error_code ec {};
+
+            for (fs::recursive_directory_iterator it( directory, fs::directory_options::skip_permission_denied, ec ), end; !ec && it != end; it.increment( ec ))
+            {
+                if (it->is_regular_file( ec ) && IsCandidate( it->path() ))
+                    res.push_back( it->path() );
+            }
+        }
+
+    public:
+
+        /**
+        * @brief Builds the queue of a batch, largest binaries first.
+        *
+        * A directory is searched recursively for executables. A list file names one binary
+        * or directory per line, relative to the list, empty lines and lines starting with '#' are skipped.
+        * Listed binaries are queued whatever their extension is.
+        *
+        * @param source Directory or list file.
+        * @param output_directory Directory receiving the JSON output of every binary.
+        * @return 'Result<std::vector<BatchJob>>' containing the queue or an error.
+        * @retval 'FileNotFound' if the source does not exist.
+        * @retval 'FileReadError' if the list file cannot be read.
+        * @retval 'NoBatchCandidates' if no binary was found.
+        */
+        [[nodiscard]] static Result<std::vector<BatchJob>> Collect(
+            const fs::path & source,
+            const fs::path & output_directory
+        ) noexcept try
+        {
+            std::error_code ec {};
+            std::vector<fs::path> binaries {};
+
+            if (fs::is_directory( source, ec ))
+                CollectDirectory( source, binaries );
+            else if (fs::is_regular_file( source, ec ))
+            {
+                std::ifstream list( source );
+                if (!list.is_open())
+                    return std::unexpected( Error::FileReadError );
+
+                for (std::string line; std::getline( list, line ); )
+                {
+                    const auto first = line.find_first_not_of( " \t\"" );
+                    if (first == std::string::npos || line[first] == '#')
+                        continue;
+
+                    const auto last = line.find_last_not_of( " \t\r\"" );
+                    const auto path = source.parent_path() / fs::path( line.substr( first, last - first + 1 ) );
+
+                    if (fs::is_directory( path, ec ))
+                        CollectDirectory( path, binaries );
+                    else
+                        binaries.push_back( path );
+                }
+            }
+            else
+                return std::unexpected( Error::FileNotFound );
+
+            // A binary listed twice or reached through two directories is only analyzed once.
+            std::set<fs::path> seen {};
+            std::vector<BatchJob> jobs {};
+
+            for (const auto & binary : binaries)
+            {
+                auto path = fs::weakly_canonical( binary, ec );
+                if (ec)
+                    path = binary;
+
+                if (!seen.insert( path ).second)
+                    continue;
+
+                const auto size = fs::file_size( path, ec );
+                jobs.push_back( BatchJob { path, {}, ec ? 0 : size } );
+            }
+
+            if (jobs.empty())
+                return std::unexpected( Error::NoBatchCandidates );
+
+            std::ranges::sort( jobs, []( const BatchJob & lhs, const BatchJob & rhs )
+            {
+                return lhs.m_Size != rhs.m_Size ? lhs.m_Size > rhs.m_Size : lhs.m_Binary < rhs.m_Binary;
+            } );
+
+            // Binaries sharing a name get a numbered output.
+            std::map<std::string, std::uint32_t> names {};
+
+            for (auto & job : jobs)
+            {
+                const auto stem = job.m_Binary.stem().string();
+                const auto count = ++names[Lower( stem )];
+
+                job.m_Output = output_directory / (count == 1 ? std::format( "{}.json", stem ) : std::format( "{}_{}.json", stem, count ));
+            }
+
+            return jobs;
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileReadError );
+        }
+
+
+        /**
+        * @brief Analyzes the queued binaries on a bounded worker pool.
+        *
+        * Every worker takes the next binary of the queue. The log of a binary is buffered
+        * and printed at once when its analysis finishes, so the logs do not interleave.
+        *
+        * @param jobs The queue, largest binaries first.
+        * @param workers Maximum number of binaries analyzed at once.
+        * @param analyze Analyzes a single binary, 'BinaryReport( const BatchJob &, std::ostream & )'.
+        * @return The reports in the queue order.
+        */
+        template<typename F>
+        [[nodiscard]] static std::vector<BinaryReport> Run(
+            const std::vector<BatchJob> & jobs,
+            std::uint32_t workers,
+            F && analyze
+        )
+        {
+            std::vector<BinaryReport> reports( jobs.size() );
+            std::atomic<std::size_t> next { 0 };
+            std::atomic<std::size_t> finished { 0 };
+            std::mutex console {};
+
+            workers = std::clamp<std::uint32_t>( workers, 1, static_cast<std::uint32_t>(jobs.size()) );
+
+            auto work = [&]()
+            {
+                for (auto i = next++; i < jobs.size(); i = next++)
+                {
+                    std::ostringstream log {};
+                    const auto start = std::chrono::steady_clock::now();
+
+                    auto & report = reports[i];
+
+                    try
+                    {
+                        report = analyze( jobs[i], log );
+                    }
+                    catch (const std::exception & ex)
+                    {
+                        log << std::format( "[ERROR] '{}'.", ex.what() ) << std::endl;
+                        report.m_Error = Error::FileReadError;
+                    }
+
+                    report.m_Binary = jobs[i].m_Binary;
+                    report.m_Output = jobs[i].m_Output;
+                    report.m_Seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+                    std::scoped_lock lock( console );
+
+                    std::cout << std::format( "[BATCH] [{}/{}] '{}' ({:.2f} s): {}", ++finished, jobs.size(), report.m_Binary.string(),
+                        report.m_Seconds, report.m_Error ? ErrorToString( *report.m_Error ) : "Success." ) << std::endl;
+                    std::cout << log.str() << std::endl;
+                }
+            };
+
+            std::vector<std::thread> threads {};
+
+            for (std::uint32_t i = 1; i < workers; ++i)
+                threads.emplace_back( work );
+
+            work();
+
+            for (auto & thread : threads)
+                thread.join();
+
+            return reports;
+        }
+
+
+        /**
+        * @brief Saves the summary of a batch to a JSON file.
+        *
+        * @param path Path to the summary file.
+        * @param source Directory or list file of the batch.
+        * @param reports The reports of every binary.
+        * @param workers Number of binaries analyzed at once.
+        * @param seconds Wall time of the whole batch.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'OutputFileCreateError' if file cannot be created.
+        * @retval 'FileWriteError' if writing fails.
+        */
+        [[nodiscard]] static std::expected<void, Error> SaveSummary(
+            const fs::path & path,
+            const fs::path & source,
+            const std::vector<BinaryReport> & reports,
+            std::uint32_t workers,
+            double seconds
+        ) noexcept try
+        {
+            json j_root = json::object();
+            json j_binaries = json::array();
+
+            std::size_t failed = 0;
+
+            for (const auto & report : reports)
+            {
+                failed += report.m_Error.has_value();
+
+                j_binaries.push_back( {
+                    { "Binary", report.m_Binary.string() },
+                    { "Output", report.m_Output.filename().string() },
+                    { "Result", report.m_Error ? ErrorToString( *report.m_Error ) : "Success." },
+                    { "Cached", report.m_Cached },
+                    { "OldVersion", report.m_OldVersion },
+                    { "NoASLR", report.m_NoAslr },
+                    { "ProtectedEntries", report.m_ProtectedEntries },
+                    { "IntegrityFuncs", report.m_IntegrityFuncs },
+                    { "TestSecretFuncs", report.m_TestSecretFuncs },
+                    { "Seconds", report.m_Seconds }
+                    } );
+            }
+
+            j_root["Source"] = source.string();
+            j_root["Jobs"] = workers;
+            j_root["Seconds"] = seconds;
+            j_root["Succeeded"] = reports.size() - failed;
+            j_root["Failed"] = failed;
+            j_root["Binaries"] = std::move( j_binaries );
+
+            std::ofstream out( path, std::ios::trunc );
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            out << j_root.dump( 4 );
+
+            if (out.fail())
+                return std::unexpected( Error::FileWriteError );
+
+            return {};
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+    };
+}
@@ -0,0 +1,292 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+
+namespace CEG
+{
+    // A 'ConstantOrStolen' record of 'noceg.bin'.
+    struct BinaryConfigEntry
+    {
+        // Address of the CEG protected function.
+        std::uint32_t m_Func { 0 };
+
+        // Function prologue address.
+        std::uint32_t m_Prologue { 0 };
+
+        // Entry point to which execution is redirected.
+        std::uint32_t m_Eip { 0 };
+
+        // Breakpoint address, 'EAX' holds the value once it is hit.
+        std::uint32_t m_Bp { 0 };
+
+        // The resolved value, '0' until it is known.
+        std::uint32_t m_Value { 0 };
+
+        // CEG function type.
+        std::uint32_t m_Type { 0 };
+    };
+
+
+    // Header of 'noceg.bin', followed by the 'ConstantOrStolen', 'Integrity' and 'TestSecret' tables in this order.
+    struct BinaryConfigHeader
+    {
+        // Magic value of the file, 'NCB1'.
+        std::uint32_t m_Magic { 0x3142434E };
+        std::uint32_t m_Version { 1 };
+
+        // Sizes of the header and of a 'ConstantOrStolen' record, checked against the ones of this version.
+        std::uint32_t m_HeaderSize { 48 };
+        std::uint32_t m_EntrySize { sizeof( BinaryConfigEntry ) };
+
+        // CEG version, '1' for the older ones.
+        std::uint32_t m_CegVersion { 2 };
+
+        // Core CEG function addresses.
+        std::uint32_t m_Init { 0 };
+        std::uint32_t m_Terminate { 0 };
+        std::uint32_t m_RegisterThread { 0 };
+
+        // Number of the records of each table.
+        std::uint32_t m_EntryCount { 0 };
+        std::uint32_t m_IntegrityCount { 0 };
+        std::uint32_t m_TestSecretCount { 0 };
+
+        std::uint32_t m_Reserved { 0 };
+    };
+
+    static_assert(sizeof( BinaryConfigHeader ) == 48 && sizeof( BinaryConfigEntry ) == 24);
+    static_assert(std::endian::native == std::endian::little, "'noceg.bin' is stored in the native byte order.");
+
+    // Environment variable naming the event the runtime library signals once every value is saved in 'noceg.bin',
+    // set by 'noceg_patcher --run' and inherited by the restarted game processes.
+    inline constexpr wchar_t PIPELINE_EVENT_VARIABLE[] = L"NOCEG_PIPELINE_EVENT";
+
+
+    // Memory-mapped 'noceg.bin', the fixed-record binary view of the tables of 'noceg.json'.
+    // The JSON stays the editable import and export view, the tools read the tables straight from the mapping.
+    class BinaryConfig
+    {
+    private:
+
+        // File mapping and its view.
+        HANDLE m_Mapping { nullptr };
+        std::byte * m_View { nullptr };
+
+        // Size of the mapped file.
+        std::uint64_t m_Size { 0 };
+
+        // The view is writable, see 'SetValue'.
+        bool m_Writable { false };
+
+
+        // Checks the header of the mapped file and that every table is inside of it.
+        [[nodiscard]] bool IsValid() const noexcept
+        {
+            if (m_Size < sizeof( BinaryConfigHeader ))
+                return false;
+
+            const auto & header = Header();
+            const BinaryConfigHeader expected {};
+
+            if (header.m_Magic != expected.m_Magic || header.m_Version != expected.m_Version ||
+                header.m_HeaderSize != expected.m_HeaderSize || header.m_EntrySize != expected.m_EntrySize)
+                return false;
+
+            const auto size = sizeof( BinaryConfigHeader ) + static_cast<std::uint64_t>(header.m_EntryCount) * sizeof( BinaryConfigEntry ) +
+                (static_cast<std::uint64_t>(header.m_IntegrityCount) + header.m_TestSecretCount) * sizeof( std::uint32_t );
+
+            return size <= m_Size;
+        }
+
+
+        // Pointer to the first record of the 'Integrity' table.
+        [[nodiscard]] const std::uint32_t * Addresses() const noexcept
+        {
+            return reinterpret_cast<const std::uint32_t *>(m_View + sizeof( BinaryConfigHeader ) +
+                static_cast<std::size_t>(Header().m_EntryCount) * sizeof( BinaryConfigEntry ));
+        }
+
+    public:
+
+        BinaryConfig() = default;
+
+        BinaryConfig( const BinaryConfig & ) = delete;
+        BinaryConfig & operator=( const BinaryConfig & ) = delete;
+
+        ~BinaryConfig() noexcept
+        {
+            Close();
+        }
+
+
+        /**
+        * @brief Maps a binary configuration.
+        *
+        * @param path Path to the binary configuration.
+        * @param writable Map the file for writing, so the resolved values can be saved in place.
+        * @return true if the file is mapped and valid, false otherwise.
+        */
+        [[nodiscard]] bool Open(
+            const std::filesystem::path & path,
+            bool writable = false
+        ) noexcept
+        {
+            Close();
+
+            const auto file = CreateFileW( path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ,
+                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER size {};
+
+            // An empty file cannot be mapped.
+            if (GetFileSizeEx( file, &size ) && size.QuadPart >= static_cast<LONGLONG>(sizeof( BinaryConfigHeader )))
+                m_Mapping = CreateFileMappingW( file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr );
+
+            // The mapping keeps the file open.
+            CloseHandle( file );
+
+            if (!m_Mapping)
+                return false;
+
+            m_View = static_cast<std::byte *>(MapViewOfFile( m_Mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0 ));
+            m_Size = static_cast<std::uint64_t>(size.QuadPart);
+            m_Writable = writable;
+
+            if (!m_View || !IsValid())
+            {
+                Close();
+                return false;
+            }
+
+            return true;
+        }
+
+
+        // Unmaps the binary configuration.
+        void Close() noexcept
+        {
+            if (m_View)
+                UnmapViewOfFile( m_View );
+
+            if (m_Mapping)
+                CloseHandle( m_Mapping );
+
+            m_View = nullptr;
+            m_Mapping = nullptr;
+            m_Size = 0;
+            m_Writable = false;
+        }
+
+
+        // Checks if a binary configuration is mapped.
+        [[nodiscard]] bool IsOpen() const noexcept
+        {
+            return m_View != nullptr;
+        }
+
+
+        // The header of the mapped file, see 'IsOpen'.
+        [[nodiscard]] const BinaryConfigHeader & Header() const noexcept
+        {
+            return *reinterpret_cast<const BinaryConfigHeader *>(m_View);
+        }
+
+
+        // The 'ConstantOrStolen' records.
+        [[nodiscard]] std::span<const BinaryConfigEntry> Entries() const noexcept
+        {
+            return { reinterpret_cast<const BinaryConfigEntry *>(m_View + sizeof( BinaryConfigHeader )), Header().m_EntryCount };
+        }
+
+
+        // Addresses of the CEG integrity functions.
+        [[nodiscard]] std::span<const std::uint32_t> Integrity() const noexcept
+        {
+            return { Addresses(), Header().m_IntegrityCount };
+        }
+
+
+        // Addresses of the CEG test secret functions.
+        [[nodiscard]] std::span<const std::uint32_t> TestSecret() const noexcept
+        {
+            return { Addresses() + Header().m_IntegrityCount, Header().m_TestSecretCount };
+        }
+
+
+        /**
+        * @brief Saves the resolved value of a 'ConstantOrStolen' record in place.
+        *
+        * @param index Index of the record.
+        * @param value The resolved value.
+        * @return true if the value is saved, false if the file is read-only or the index is out of range.
+        */
+        bool SetValue(
+            std::size_t index,
+            std::uint32_t value
+        ) noexcept
+        {
+            if (!m_Writable || index >= Header().m_EntryCount)
+                return false;
+
+            reinterpret_cast<BinaryConfigEntry *>(m_View + sizeof( BinaryConfigHeader ))[index].m_Value = value;
+            return true;
+        }
+
+
+        /**
+        * @brief Writes a binary configuration.
+        *
+        * @param path Path to the binary configuration.
+        * @param header The header, its counts are set from the tables.
+        * @param entries The 'ConstantOrStolen' records.
+        * @param integrity Addresses of the CEG integrity functions.
+        * @param test_secret Addresses of the CEG test secret functions.
+        * @return true if the file is written, false otherwise.
+        */
+        [[nodiscard]] static bool Write(
+            const std::filesystem::path & path,
+            BinaryConfigHeader header,
+            std::span<const BinaryConfigEntry> entries,
+            std::span<const std::uint32_t> integrity,
+            std::span<const std::uint32_t> test_secret
+        ) noexcept
+        {
+            header.m_EntryCount = static_cast<std::uint32_t>(entries.size());
+            header.m_IntegrityCount = static_cast<std::uint32_t>(integrity.size());
+            header.m_TestSecretCount = static_cast<std::uint32_t>(test_secret.size());
+
+            std::ofstream out( path, std::ios::binary | std::ios::trunc );
+            if (!out)
+                return false;
+
+            out.write( reinterpret_cast<const char *>(&header), sizeof( header ) );
+            out.write( reinterpret_cast<const char *>(entries.data()), static_cast<std::streamsize>(entries.size_bytes()) );
+            out.write( reinterpret_cast<const char *>(integrity.data()), static_cast<std::streamsize>(integrity.size_bytes()) );
+            out.write( reinterpret_cast<const char *>(test_secret.data()), static_cast<std::streamsize>(test_secret.size_bytes()) );
+
+            return !out.fail();
+        }
+    };
+}
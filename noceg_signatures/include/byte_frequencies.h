@@ -0,0 +1,100 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+#include <cmath>
+
+namespace CEG
+{
+    // Byte frequency table measured on the scanned code section, a drop-in for 'mem::simd_default_frequencies'.
+    class ByteFrequencies
+    {
+    private:
+
+        // Number of interleaved histograms, so consecutive equal bytes do not stall on the same counter.
+        static constexpr std::size_t LANES = 4;
+
+        // Scaled frequencies (lower values are rarer).
+        std::array<mem::byte, 0x100> m_Table {};
+
+    public:
+
+        /**
+        * @brief Builds the frequency table from a byte histogram of every executable section.
+        *
+        * The counts are scaled logarithmically to '0x00 - 0xFF', so the rare bytes the anchors
+        * are picked from keep their relative order.
+        *
+        * @param context The analysis context holding the executable sections.
+        * @return The frequency table.
+        */
+        [[nodiscard]] static ByteFrequencies Build(
+            const AnalysisContext & context
+        ) noexcept
+        {
+            std::array<std::array<std::uint32_t, 0x100>, LANES> lanes {};
+
+            for (const auto & section : context.m_Sections)
+            {
+                const auto * data = static_cast<const mem::byte *>(SectionAddress( context, section ));
+                const std::size_t size = section.m_Size;
+                std::size_t i = 0;
+
+                for (; i + LANES <= size; i += LANES)
+                {
+                    ++lanes[0][data[i]];
+                    ++lanes[1][data[i + 1]];
+                    ++lanes[2][data[i + 2]];
+                    ++lanes[3][data[i + 3]];
+                }
+
+                for (; i < size; ++i)
+                    ++lanes[0][data[i]];
+            }
+
+            std::array<std::uint32_t, 0x100> counts {};
+            std::uint32_t max = 0;
+
+            for (std::size_t value = 0; value < counts.size(); ++value)
+            {
+                for (const auto & lane : lanes)
+                    counts[value] += lane[value];
+
+                max = std::max( max, counts[value] );
+            }
+
+            ByteFrequencies frequencies {};
+
+            if (!max)
+                return frequencies;
+
+            const double scale = 255.0 / std::log2( static_cast<double>(max) + 1.0 );
+
+            for (std::size_t value = 0; value < counts.size(); ++value)
+                frequencies.m_Table[value] = static_cast<mem::byte>(std::lround( std::log2( static_cast<double>(counts[value]) + 1.0 ) * scale ));
+
+            return frequencies;
+        }
+
+
+        // Pointer to the frequency table.
+        [[nodiscard]] const mem::byte * data() const noexcept
+        {
+            return m_Table.data();
+        }
+    };
+}
@@ -0,0 +1,337 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+#include "decoder.h"
+
+namespace CEG
+{
+    // How an instruction transfers control.
+    enum class InstructionFlow : std::uint8_t
+    {
+        Sequential,
+        Reference,       // 'mov eax, imm32' referencing a code address
+        Call,
+        IndirectCall,
+        Jump,
+        IndirectJump,
+        ConditionalJump,
+        Return           // 'ret', 'int3', 'hlt' and 'ud2'
+    };
+
+
+    // A single decoded reachable instruction.
+    struct CodeInstruction
+    {
+        // Offset of the instruction within the analyzed data.
+        std::uint32_t m_Offset { 0 };
+
+        // Target of the direct branch or 'mov eax, imm32', as a memory address.
+        std::uint32_t m_Target { 0 };
+
+        // Length of the instruction.
+        std::uint8_t m_Length { 0 };
+
+        InstructionFlow m_Flow { InstructionFlow::Sequential };
+    };
+
+
+    // A straight-line run of instructions with a single entry.
+    struct BasicBlock
+    {
+        // Offset of the first instruction.
+        std::uint32_t m_Start { 0 };
+
+        // Offset right past the last instruction.
+        std::uint32_t m_End { 0 };
+
+        // Index of the first instruction inside 'ControlFlowGraph::Instructions'.
+        std::uint32_t m_FirstInstruction { 0 };
+
+        // Number of instructions in the block.
+        std::uint32_t m_InstructionCount { 0 };
+
+        // Offsets of the successor blocks.
+        std::vector<std::uint32_t> m_Successors {};
+
+        // Offsets of the directly called functions.
+        std::vector<std::uint32_t> m_Calls {};
+    };
+
+
+    // Recursive-descent disassembly of the code reachable from a set of roots.
+    class ControlFlowGraph
+    {
+    private:
+
+        InstructionDecoder m_Decoder {};
+
+        // Reachable instructions ordered by offset.
+        std::vector<CodeInstruction> m_Instructions {};
+
+        // Basic blocks ordered by start offset.
+        std::vector<BasicBlock> m_Blocks {};
+
+
+        /**
+        * @brief Classifies a decoded instruction and computes its target.
+        *
+        * @param context The analysis context.
+        * @param instruction The minimally decoded instruction.
+        * @param buffer Pointer to the instruction bytes, decoded again only for 'mov' candidates.
+        * @param length Number of readable bytes.
+        * @param current_address Memory address of the instruction.
+        * @param target [out] The direct target, or 0 if there is none.
+        * @return The control flow of the instruction.
+        */
+        [[nodiscard]] InstructionFlow Classify(
+            const AnalysisContext & context,
+            const ZydisDecodedInstruction & instruction,
+            const void * buffer,
+            std::size_t length,
+            std::uint32_t current_address,
+            std::uint32_t & target
+        ) const noexcept
+        {
+            target = 0;
+
+            const bool relative = InstructionDecoder::IsRelative( instruction );
+
+            if (relative)
+                target = InstructionDecoder::RelativeTarget( context, instruction, current_address );
+
+            switch (instruction.meta.category)
+            {
+                case ZYDIS_CATEGORY_CALL:
+                    return relative ? InstructionFlow::Call : InstructionFlow::IndirectCall;
+                case ZYDIS_CATEGORY_UNCOND_BR:
+                    return relative ? InstructionFlow::Jump : InstructionFlow::IndirectJump;
+                case ZYDIS_CATEGORY_COND_BR:
+                    return InstructionFlow::ConditionalJump;
+                case ZYDIS_CATEGORY_RET:
+                    return InstructionFlow::Return;
+                default:
+                    break;
+            }
+
+            target = 0;
+
+            if (instruction.mnemonic == ZYDIS_MNEMONIC_INT3 ||
+                instruction.mnemonic == ZYDIS_MNEMONIC_HLT ||
+                instruction.mnemonic == ZYDIS_MNEMONIC_UD2)
+                return InstructionFlow::Return;
+
+            std::uint32_t value = 0;
+
+            if (InstructionDecoder::IsMoveImmediate( instruction ) &&
+                m_Decoder.GetMoveEaxImmediate( buffer, length, value ))
+            {
+                target = VaToOffset( context, value );
+                return InstructionFlow::Reference;
+            }
+
+            return InstructionFlow::Sequential;
+        }
+
+
+        // Checks if the instruction ends its basic block.
+        [[nodiscard]] static constexpr bool IsTerminator(
+            InstructionFlow flow
+        ) noexcept
+        {
+            return flow == InstructionFlow::Jump ||
+                flow == InstructionFlow::IndirectJump ||
+                flow == InstructionFlow::ConditionalJump ||
+                flow == InstructionFlow::Return;
+        }
+
+
+        /**
+        * @brief Splits the decoded instructions into basic blocks.
+        *
+        * @param leaders Flags marking the offsets that start a block.
+        * @param base Memory address of the analyzed data.
+        */
+        void BuildBlocks(
+            const std::vector<bool> & leaders,
+            std::uint32_t base
+        )
+        {
+            m_Blocks.clear();
+
+            for (std::uint32_t i = 0; i < m_Instructions.size(); ++i)
+            {
+                const auto & instruction = m_Instructions[i];
+                const auto end = instruction.m_Offset + instruction.m_Length;
+
+                // Start a new block at leaders, gaps and overlapping instructions.
+                if (m_Blocks.empty() || leaders[instruction.m_Offset] || m_Blocks.back().m_End != instruction.m_Offset ||
+                    IsTerminator( m_Instructions[i - 1].m_Flow ))
+                {
+                    if (!m_Blocks.empty() && m_Blocks.back().m_End == instruction.m_Offset &&
+                        !IsTerminator( m_Instructions[i - 1].m_Flow ))
+                        m_Blocks.back().m_Successors.push_back( instruction.m_Offset );
+
+                    m_Blocks.push_back( BasicBlock { instruction.m_Offset, instruction.m_Offset, i, 0 } );
+                }
+
+                auto & block = m_Blocks.back();
+                block.m_End = end;
+                ++block.m_InstructionCount;
+
+                const auto target = instruction.m_Target - base;
+
+                switch (instruction.m_Flow)
+                {
+                    case InstructionFlow::Call:
+                        block.m_Calls.push_back( target );
+                        break;
+                    case InstructionFlow::Jump:
+                        block.m_Successors.push_back( target );
+                        break;
+                    case InstructionFlow::ConditionalJump:
+                        block.m_Successors.push_back( target );
+                        block.m_Successors.push_back( end );
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+    public:
+
+        /**
+        * @brief Decodes every instruction reachable from the roots and builds the basic blocks.
+        *
+        * Each reachable instruction is decoded once. Direct call and branch targets are
+        * followed, indirect ones end the path.
+        *
+        * @param context The analysis context.
+        * @param data Binary data to analyze.
+        * @param address Base address of the data in memory.
+        * @param code_size Size of the code section within the data.
+        * @param roots Memory addresses to start the descent from.
+        */
+        void Build(
+            const AnalysisContext & context,
+            std::span<const std::byte> data,
+            const void * address,
+            std::uint32_t code_size,
+            std::span<const std::uint32_t> roots
+        )
+        {
+            m_Instructions.clear();
+
+            const auto base = reinterpret_cast<std::uint32_t>(address);
+            const auto limit = static_cast<std::uint32_t>(std::min<std::size_t>( code_size, data.size() ));
+
+            std::vector<bool> visited( limit, false );
+            std::vector<bool> leaders( limit, false );
+            std::vector<std::uint32_t> worklist {};
+
+            auto add_root = [&]( std::uint32_t target )
+            {
+                const auto offset = target - base;
+
+                if (offset >= limit)
+                    return;
+
+                leaders[offset] = true;
+
+                if (!visited[offset])
+                    worklist.push_back( offset );
+            };
+
+            for (const auto root : roots)
+                add_root( root );
+
+            while (!worklist.empty())
+            {
+                auto offset = worklist.back();
+                worklist.pop_back();
+
+                while (offset < limit)
+                {
+                    // Joined an already decoded path.
+                    if (visited[offset])
+                    {
+                        leaders[offset] = true;
+                        break;
+                    }
+
+                    ZydisDecodedInstruction instruction;
+
+                    const auto * buffer = reinterpret_cast<const void *>(data.data() + offset);
+                    const auto length = std::min<std::size_t>( ZYDIS_MAX_INSTRUCTION_LENGTH, limit - offset );
+
+                    if (!m_Decoder.Decode( buffer, length, instruction ))
+                        break;
+
+                    visited[offset] = true;
+
+                    std::uint32_t target = 0;
+                    const auto flow = Classify( context, instruction, buffer, length, base + offset, target );
+
+                    m_Instructions.push_back( CodeInstruction { offset, target, instruction.length, flow } );
+
+                    if (flow == InstructionFlow::Call || flow == InstructionFlow::Jump || flow == InstructionFlow::ConditionalJump)
+                        add_root( target );
+
+                    offset += instruction.length;
+
+                    if (flow == InstructionFlow::ConditionalJump && offset < limit)
+                        leaders[offset] = true;
+
+                    if (IsTerminator( flow ) && flow != InstructionFlow::ConditionalJump)
+                        break;
+                }
+            }
+
+            std::ranges::sort( m_Instructions, {}, &CodeInstruction::m_Offset );
+            BuildBlocks( leaders, base );
+        }
+
+
+        // Reachable instructions ordered by offset.
+        [[nodiscard]] std::span<const CodeInstruction> Instructions() const noexcept
+        {
+            return m_Instructions;
+        }
+
+
+        // Basic blocks ordered by start offset.
+        [[nodiscard]] std::span<const BasicBlock> Blocks() const noexcept
+        {
+            return m_Blocks;
+        }
+
+
+        /**
+        * @brief Finds the basic block starting at the given offset.
+        *
+        * @param offset Offset of the block.
+        * @return Pointer to the block, or nullptr if no block starts there.
+        */
+        [[nodiscard]] const BasicBlock * FindBlock(
+            std::uint32_t offset
+        ) const noexcept
+        {
+            const auto it = std::ranges::lower_bound( m_Blocks, offset, {}, &BasicBlock::m_Start );
+            return (it != m_Blocks.end() && it->m_Start == offset) ? &*it : nullptr;
+        }
+    };
+}
@@ -0,0 +1,143 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+namespace CEG
+{
+    // Two step decoder, a minimal decode of every candidate and a full operand decode only for the confirmed ones.
+    class InstructionDecoder
+    {
+    private:
+
+        // Mnemonic, length, category, attributes and raw fields only.
+        ZydisDecoder m_Minimal;
+
+        // Full decoder including the operands.
+        ZydisDecoder m_Full;
+
+    public:
+
+        InstructionDecoder()
+        {
+            if (!ZYAN_SUCCESS( ZydisDecoderInit( &m_Minimal,
+                ZYDIS_MACHINE_MODE_LONG_COMPAT_32,
+                ZYDIS_STACK_WIDTH_32 ) ) ||
+                !ZYAN_SUCCESS( ZydisDecoderEnableMode( &m_Minimal, ZYDIS_DECODER_MODE_MINIMAL, ZYAN_TRUE ) ) ||
+                !ZYAN_SUCCESS( ZydisDecoderInit( &m_Full,
+                ZYDIS_MACHINE_MODE_LONG_COMPAT_32,
+                ZYDIS_STACK_WIDTH_32 ) ))
+            {
+                throw std::runtime_error( "Failed to initialize Zydis decoder." );
+            }
+        }
+
+
+        /**
+        * @brief Decodes a single instruction without its operands.
+        *
+        * @param buffer Pointer to the instruction bytes.
+        * @param length Number of readable bytes.
+        * @param instruction [out] The decoded instruction.
+        * @return true if the instruction was decoded successfully, false otherwise.
+        */
+        [[nodiscard]] bool Decode(
+            const void * buffer,
+            std::size_t length,
+            ZydisDecodedInstruction & instruction
+        ) const noexcept
+        {
+            return ZYAN_SUCCESS( ZydisDecoderDecodeInstruction( &m_Minimal, nullptr, buffer, length, &instruction ) );
+        }
+
+
+        /**
+        * @brief Checks if a decoded instruction has a relative immediate, e.g. 'call rel32' or 'jmp rel8'.
+        *
+        * @param instruction The decoded instruction.
+        * @return true if the instruction is relative.
+        */
+        [[nodiscard]] static bool IsRelative(
+            const ZydisDecodedInstruction & instruction
+        ) noexcept
+        {
+            return instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE;
+        }
+
+
+        /**
+        * @brief Computes the target of a relative instruction.
+        *
+        * @param context The analysis context.
+        * @param instruction The decoded instruction, see 'IsRelative'.
+        * @param current_address Memory address of the instruction.
+        * @return The target address, or 0 if it is outside of every executable section, see 'RelativeToOffset'.
+        */
+        [[nodiscard]] static std::uint32_t RelativeTarget(
+            const AnalysisContext & context,
+            const ZydisDecodedInstruction & instruction,
+            std::uint32_t current_address
+        ) noexcept
+        {
+            return RelativeToOffset( context, current_address, static_cast<std::int32_t>(instruction.raw.imm[0].value.s + instruction.length) );
+        }
+
+
+        /**
+        * @brief Checks if a decoded instruction is a 'mov' with an immediate, the candidates of 'GetMoveEaxImmediate'.
+        *
+        * @param instruction The decoded instruction.
+        * @return true if the instruction may be 'mov eax, imm32'.
+        */
+        [[nodiscard]] static bool IsMoveImmediate(
+            const ZydisDecodedInstruction & instruction
+        ) noexcept
+        {
+            return instruction.mnemonic == ZYDIS_MNEMONIC_MOV && instruction.raw.imm[0].size;
+        }
+
+
+        /**
+        * @brief Fully decodes a 'mov' candidate and gets its immediate if the destination is 'eax'.
+        *
+        * @param buffer Pointer to the instruction bytes.
+        * @param length Number of readable bytes.
+        * @param value [out] The immediate value.
+        * @return true if the instruction is 'mov eax, imm32', false otherwise.
+        */
+        [[nodiscard]] bool GetMoveEaxImmediate(
+            const void * buffer,
+            std::size_t length,
+            std::uint32_t & value
+        ) const noexcept
+        {
+            ZydisDecodedInstruction instruction;
+            ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT];
+
+            if (!ZYAN_SUCCESS( ZydisDecoderDecodeFull( &m_Full, buffer, length, &instruction, operands ) ))
+                return false;
+
+            if (instruction.mnemonic != ZYDIS_MNEMONIC_MOV ||
+                operands[0].type != ZYDIS_OPERAND_TYPE_REGISTER ||
+                operands[1].type != ZYDIS_OPERAND_TYPE_IMMEDIATE ||
+                operands[0].reg.value != ZYDIS_REGISTER_EAX)
+                return false;
+
+            value = static_cast<std::uint32_t>(operands[1].imm.value.s);
+            return true;
+        }
+    };
+}
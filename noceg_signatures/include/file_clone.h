@@ -0,0 +1,112 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <winioctl.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace CEG
+{
+    /**
+    * @brief Clones a file by sharing its extents, only supported by block cloning file systems such as ReFS.
+    *
+    * @param source Path to the source file.
+    * @param destination Path to the new file, removed again if cloning fails.
+    * @return true if the file was cloned, false if it has to be copied instead.
+    */
+    [[nodiscard]] bool CloneFile(
+        const fs::path & source,
+        const fs::path & destination
+    ) noexcept
+    {
+        const auto source_file = CreateFileW( source.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+        if (source_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        bool cloned = false;
+        HANDLE target_file = INVALID_HANDLE_VALUE;
+
+        DWORD flags = 0;
+        BY_HANDLE_FILE_INFORMATION info {};
+        LARGE_INTEGER size {};
+
+        // Both files must be on the same volume with block reference counting and share the sparse state.
+        if (GetVolumeInformationByHandleW( source_file, nullptr, 0, nullptr, nullptr, &flags, nullptr, 0 ) &&
+            (flags & FILE_SUPPORTS_BLOCK_REFCOUNTING) && GetFileInformationByHandle( source_file, &info ) &&
+            GetFileSizeEx( source_file, &size ))
+        {
+            target_file = CreateFileW( destination.c_str(), GENERIC_READ | GENERIC_WRITE | DELETE, 0, nullptr,
+                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+        }
+
+        if (target_file != INVALID_HANDLE_VALUE)
+        {
+            DWORD returned = 0;
+            const bool sparse = (info.dwFileAttributes & FILE_ATTRIBUTE_SPARSE_FILE) != 0;
+
+            FILE_END_OF_FILE_INFO end_of_file {};
+            end_of_file.EndOfFile = size;
+
+            cloned = (!sparse || DeviceIoControl( target_file, FSCTL_SET_SPARSE, nullptr, 0, nullptr, 0, &returned, nullptr )) &&
+                SetFileInformationByHandle( target_file, FileEndOfFileInfo, &end_of_file, sizeof( end_of_file ) );
+
+            // The cloned ranges end at a cluster boundary, past the end of the file is allowed.
+            DWORD sectors_per_cluster = 0;
+            DWORD bytes_per_sector = 0;
+            DWORD free_clusters = 0;
+            DWORD total_clusters = 0;
+
+            cloned = cloned && GetDiskFreeSpaceW( destination.root_path().c_str(), &sectors_per_cluster, &bytes_per_sector,
+                &free_clusters, &total_clusters );
+
+            const std::int64_t cluster = static_cast<std::int64_t>(sectors_per_cluster) * bytes_per_sector;
+            const std::int64_t length = cluster ? (size.QuadPart + cluster - 1) / cluster * cluster : 0;
+
+            // A single request is limited to less than 4 GiB.
+            constexpr std::int64_t CHUNK_SIZE = 0x40000000;
+
+            for (std::int64_t offset = 0; cloned && offset < length; offset += CHUNK_SIZE)
+            {
+                DUPLICATE_EXTENTS_DATA extents {};
+                extents.FileHandle = source_file;
+                extents.SourceFileOffset.QuadPart = offset;
+                extents.TargetFileOffset.QuadPart = offset;
+                extents.ByteCount.QuadPart = std::min( CHUNK_SIZE, length - offset );
+
+                cloned = DeviceIoControl( target_file, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents, sizeof( extents ),
+                    nullptr, 0, &returned, nullptr );
+            }
+
+            // Remove the partial clone, the caller copies the file instead.
+            if (!cloned)
+            {
+                FILE_DISPOSITION_INFO disposition { TRUE };
+                SetFileInformationByHandle( target_file, FileDispositionInfo, &disposition, sizeof( disposition ) );
+            }
+
+            CloseHandle( target_file );
+        }
+
+        CloseHandle( source_file );
+        return cloned;
+    }
+}
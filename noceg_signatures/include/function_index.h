@@ -0,0 +1,133 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+namespace CEG
+{
+    // Sorted function start offsets of a code section, built once from a prologue sweep and the call targets.
+    class FunctionIndex
+    {
+    private:
+
+        // Function start offsets in ascending order.
+        std::vector<std::uint32_t> m_Starts {};
+
+    public:
+
+        /**
+        * @brief Checks if a 'push ebp; mov ebp, esp' prologue starts at the given pointer.
+        *
+        * Both 'mov ebp, esp' encodings ('8B EC' and '89 E5') are accepted.
+        *
+        * @param ptr Pointer to the candidate prologue, at least 3 bytes must be readable.
+        * @return true if the bytes form the prologue.
+        */
+        [[nodiscard]] static constexpr bool IsPrologue(
+            const mem::byte * ptr
+        ) noexcept
+        {
+            return ptr[0] == 0x55 &&
+                ((ptr[1] == 0x8B && ptr[2] == 0xEC) || (ptr[1] == 0x89 && ptr[2] == 0xE5));
+        }
+
+
+        /**
+        * @brief Builds the index from the prologues of the data and the given call targets.
+        *
+        * @param data Binary data of the code section.
+        * @param address Base address of the data in memory.
+        * @param call_targets Memory addresses of the direct call targets, targets outside the data are ignored.
+        */
+        void Build(
+            std::span<const std::byte> data,
+            const void * address,
+            std::span<const std::uint32_t> call_targets
+        )
+        {
+            m_Starts.clear();
+
+            const auto * bytes = reinterpret_cast<const mem::byte *>(data.data());
+            const auto size = data.size();
+
+            if (size >= 3)
+            {
+                const auto * ptr = bytes;
+                const auto * end = bytes + size - 2;
+
+                // 'memchr' is vectorized by the CRT, only the 'push ebp' hits are inspected.
+                while ((ptr = static_cast<const mem::byte *>(std::memchr( ptr, 0x55, end - ptr ))) != nullptr)
+                {
+                    if (IsPrologue( ptr ))
+                        m_Starts.push_back( static_cast<std::uint32_t>(ptr - bytes) );
+
+                    ++ptr;
+                }
+            }
+
+            const auto base = reinterpret_cast<std::uint32_t>(address);
+
+            for (const auto target : call_targets)
+            {
+                const auto offset = target - base;
+
+                if (offset < size)
+                    m_Starts.push_back( offset );
+            }
+
+            std::ranges::sort( m_Starts );
+            const auto [first, last] = std::ranges::unique( m_Starts );
+            m_Starts.erase( first, last );
+        }
+
+
+        /**
+        * @brief Finds the closest function start at or before an offset.
+        *
+        * @param offset Offset within the function.
+        * @param window Maximum distance to look back, the start must lie within '(offset - window, offset]'.
+        * @param start [out] The function start offset.
+        * @return true if a function start was found, false otherwise.
+        */
+        [[nodiscard]] bool FindStart(
+            std::uint32_t offset,
+            std::uint32_t window,
+            std::uint32_t & start
+        ) const noexcept
+        {
+            const auto it = std::ranges::upper_bound( m_Starts, offset );
+
+            if (it == m_Starts.begin())
+                return false;
+
+            const auto candidate = *std::prev( it );
+            const auto lower = (offset > window) ? offset - window : 0;
+
+            if (candidate <= lower)
+                return false;
+
+            start = candidate;
+            return true;
+        }
+
+
+        // Number of indexed function starts.
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_Starts.size();
+        }
+    };
+}
@@ -0,0 +1,264 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+// XXH64 content hash (https://github.com/Cyan4973/xxHash), used to key the analysis cache.
+namespace CEG::Hash
+{
+    inline constexpr std::uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ull;
+    inline constexpr std::uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+    inline constexpr std::uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ull;
+    inline constexpr std::uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+    inline constexpr std::uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+
+    // Reads an unaligned little-endian value.
+    template<typename T>
+    [[nodiscard]] inline T Read(
+        const std::byte * ptr
+    ) noexcept
+    {
+        T value {};
+        std::memcpy( &value, ptr, sizeof( value ) );
+        return value;
+    }
+
+
+    [[nodiscard]] constexpr std::uint64_t Round(
+        std::uint64_t acc,
+        std::uint64_t input
+    ) noexcept
+    {
+        acc += input * XXH_PRIME64_2;
+        acc = std::rotl( acc, 31 );
+        return acc * XXH_PRIME64_1;
+    }
+
+
+    [[nodiscard]] constexpr std::uint64_t MergeRound(
+        std::uint64_t acc,
+        std::uint64_t value
+    ) noexcept
+    {
+        acc ^= Round( 0, value );
+        return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+
+    // Incremental XXH64, the digest of the concatenated updates is the one of 'Xxh64'.
+    class Xxh64Stream
+    {
+    private:
+
+        std::array<std::uint64_t, 4> m_Lanes {};
+
+        // Bytes received since the last complete stripe.
+        std::array<std::byte, 32> m_Buffer {};
+        std::size_t m_Buffered { 0 };
+
+        std::uint64_t m_Total { 0 };
+        std::uint64_t m_Seed { 0 };
+
+
+        // Mixes a complete 32-byte stripe into the lanes.
+        void Consume(
+            const std::byte * ptr
+        ) noexcept
+        {
+            m_Lanes[0] = Round( m_Lanes[0], Read<std::uint64_t>( ptr ) );
+            m_Lanes[1] = Round( m_Lanes[1], Read<std::uint64_t>( ptr + 8 ) );
+            m_Lanes[2] = Round( m_Lanes[2], Read<std::uint64_t>( ptr + 16 ) );
+            m_Lanes[3] = Round( m_Lanes[3], Read<std::uint64_t>( ptr + 24 ) );
+        }
+
+    public:
+
+        explicit Xxh64Stream(
+            std::uint64_t seed = 0
+        ) noexcept : m_Lanes { seed + XXH_PRIME64_1 + XXH_PRIME64_2, seed + XXH_PRIME64_2, seed, seed - XXH_PRIME64_1 },
+            m_Seed( seed )
+        {
+        }
+
+
+        /**
+        * @brief Hashes the next bytes.
+        *
+        * @param data The bytes following the previous updates.
+        */
+        void Update(
+            std::span<const std::byte> data
+        ) noexcept
+        {
+            m_Total += data.size();
+
+            if (m_Buffered)
+            {
+                const auto take = std::min( m_Buffer.size() - m_Buffered, data.size() );
+
+                std::memcpy( m_Buffer.data() + m_Buffered, data.data(), take );
+                m_Buffered += take;
+                data = data.subspan( take );
+
+                if (m_Buffered < m_Buffer.size())
+                    return;
+
+                Consume( m_Buffer.data() );
+                m_Buffered = 0;
+            }
+
+            for (; data.size() >= m_Buffer.size(); data = data.subspan( m_Buffer.size() ))
+                Consume( data.data() );
+
+            if (!data.empty())
+            {
+                std::memcpy( m_Buffer.data(), data.data(), data.size() );
+                m_Buffered = data.size();
+            }
+        }
+
+
+        /**
+        * @brief Computes the hash of every byte received so far.
+        *
+        * @return The 64-bit hash.
+        */
+        [[nodiscard]] std::uint64_t Digest() const noexcept
+        {
+            const auto * ptr = m_Buffer.data();
+            const auto * const end = ptr + m_Buffered;
+            std::uint64_t hash = 0;
+
+            if (m_Total >= 32)
+            {
+                const auto [v1, v2, v3, v4] = m_Lanes;
+
+                hash = std::rotl( v1, 1 ) + std::rotl( v2, 7 ) + std::rotl( v3, 12 ) + std::rotl( v4, 18 );
+                hash = MergeRound( hash, v1 );
+                hash = MergeRound( hash, v2 );
+                hash = MergeRound( hash, v3 );
+                hash = MergeRound( hash, v4 );
+            }
+            else
+                hash = m_Seed + XXH_PRIME64_5;
+
+            hash += m_Total;
+
+            for (; end - ptr >= 8; ptr += 8)
+            {
+                hash ^= Round( 0, Read<std::uint64_t>( ptr ) );
+                hash = std::rotl( hash, 27 ) * XXH_PRIME64_1 + XXH_PRIME64_4;
+            }
+
+            if (end - ptr >= 4)
+            {
+                hash ^= static_cast<std::uint64_t>(Read<std::uint32_t>( ptr )) * XXH_PRIME64_1;
+                hash = std::rotl( hash, 23 ) * XXH_PRIME64_2 + XXH_PRIME64_3;
+                ptr += 4;
+            }
+
+            for (; ptr < end; ++ptr)
+            {
+                hash ^= static_cast<std::uint64_t>(*ptr) * XXH_PRIME64_5;
+                hash = std::rotl( hash, 11 ) * XXH_PRIME64_1;
+            }
+
+            hash ^= hash >> 33;
+            hash *= XXH_PRIME64_2;
+            hash ^= hash >> 29;
+            hash *= XXH_PRIME64_3;
+            hash ^= hash >> 32;
+
+            return hash;
+        }
+    };
+
+
+    /**
+    * @brief Computes the XXH64 hash of a memory region.
+    *
+    * @param data The memory region to hash.
+    * @param seed The hash seed.
+    * @return The 64-bit hash.
+    */
+    [[nodiscard]] inline std::uint64_t Xxh64(
+        std::span<const std::byte> data,
+        std::uint64_t seed = 0
+    ) noexcept
+    {
+        const auto * ptr = data.data();
+        const auto * const end = ptr + data.size();
+        std::uint64_t hash = 0;
+
+        if (data.size() >= 32)
+        {
+            std::uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+            std::uint64_t v2 = seed + XXH_PRIME64_2;
+            std::uint64_t v3 = seed;
+            std::uint64_t v4 = seed - XXH_PRIME64_1;
+
+            for (; end - ptr >= 32; ptr += 32)
+            {
+                v1 = Round( v1, Read<std::uint64_t>( ptr ) );
+                v2 = Round( v2, Read<std::uint64_t>( ptr + 8 ) );
+                v3 = Round( v3, Read<std::uint64_t>( ptr + 16 ) );
+                v4 = Round( v4, Read<std::uint64_t>( ptr + 24 ) );
+            }
+
+            hash = std::rotl( v1, 1 ) + std::rotl( v2, 7 ) + std::rotl( v3, 12 ) + std::rotl( v4, 18 );
+            hash = MergeRound( hash, v1 );
+            hash = MergeRound( hash, v2 );
+            hash = MergeRound( hash, v3 );
+            hash = MergeRound( hash, v4 );
+        }
+        else
+            hash = seed + XXH_PRIME64_5;
+
+        hash += static_cast<std::uint64_t>(data.size());
+
+        for (; end - ptr >= 8; ptr += 8)
+        {
+            hash ^= Round( 0, Read<std::uint64_t>( ptr ) );
+            hash = std::rotl( hash, 27 ) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        }
+
+        if (end - ptr >= 4)
+        {
+            hash ^= static_cast<std::uint64_t>(Read<std::uint32_t>( ptr )) * XXH_PRIME64_1;
+            hash = std::rotl( hash, 23 ) * XXH_PRIME64_2 + XXH_PRIME64_3;
+            ptr += 4;
+        }
+
+        for (; ptr < end; ++ptr)
+        {
+            hash ^= static_cast<std::uint64_t>(*ptr) * XXH_PRIME64_5;
+            hash = std::rotl( hash, 11 ) * XXH_PRIME64_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= XXH_PRIME64_2;
+        hash ^= hash >> 29;
+        hash *= XXH_PRIME64_3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+}
@@ -0,0 +1,554 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+#include "hash.h"
+#include "scanner.h"
+#include "xref.h"
+
+namespace CEG
+{
+    // Block hashes, pattern hits and references of an analyzed binary, so an updated binary
+    // with the same section layout only scans and indexes the blocks that changed.
+    class IncrementalState
+    {
+    public:
+
+        // Size of a hashed block.
+        static constexpr std::uint32_t BLOCK_SIZE = 0x10000;
+
+        // Bytes around a changed block that are analyzed again, longer than every pattern and instruction.
+        static constexpr std::uint32_t MARGIN = 0x100;
+
+    private:
+
+        static constexpr std::uint32_t MAGIC = 0x5349434E; // 'NCIS'
+        static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+        // Upper bound of the stored hits, larger counts are treated as a corrupted file.
+        static constexpr std::uint32_t MAX_HITS = 0x1000000;
+
+        // Executable section and the state captured from it.
+        struct Section
+        {
+            std::uint32_t m_VirtualAddress { 0 };
+            std::uint32_t m_RawDataPointer { 0 };
+            std::uint32_t m_Size { 0 };
+
+            // Hash of every 'BLOCK_SIZE' block, the last one may be shorter.
+            std::vector<std::uint64_t> m_Hashes {};
+
+            // References in ascending offset order, the targets are relative to the image in memory.
+            std::vector<Xref> m_Xrefs {};
+        };
+
+
+        // Pattern hit stored by file offset.
+        struct Hit
+        {
+            PatternGroup m_Group { PatternGroup::Count };
+            std::uint16_t m_Index { 0 };
+            std::uint32_t m_Offset { 0 };
+        };
+
+        std::uint32_t m_ImageBase { 0 };
+        std::vector<Section> m_Sections {};
+        std::vector<Hit> m_Hits {};
+
+        // Set once the references of every section were captured.
+        bool m_Complete { false };
+
+
+        template<typename T>
+        static void Write(
+            std::ofstream & out,
+            const T & value
+        )
+        {
+            out.write( reinterpret_cast<const char *>(&value), sizeof( value ) );
+        }
+
+
+        template<typename T>
+        [[nodiscard]] static bool Read(
+            std::ifstream & in,
+            T & value
+        )
+        {
+            return static_cast<bool>(in.read( reinterpret_cast<char *>(&value), sizeof( value ) ));
+        }
+
+
+        // Number of blocks of a section.
+        [[nodiscard]] static constexpr std::uint32_t BlockCount(
+            std::uint32_t size
+        ) noexcept
+        {
+            return (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        }
+
+    public:
+
+        /**
+        * @brief Hashes the blocks of every executable section.
+        *
+        * @param context The analysis context holding the executable sections.
+        * @return The state without hits and references.
+        */
+        [[nodiscard]] static IncrementalState Capture(
+            const AnalysisContext & context
+        )
+        {
+            IncrementalState state {};
+            state.m_ImageBase = context.m_ImageBaseRaw;
+
+            for (const auto & section : context.m_Sections)
+            {
+                auto & captured = state.m_Sections.emplace_back( Section { section.m_VirtualAddress,
+                    section.m_RawDataPointer, section.m_Size } );
+
+                const auto * data = static_cast<const std::byte *>(SectionAddress( context, section ));
+
+                for (std::uint32_t offset = 0; offset < section.m_Size; offset += BLOCK_SIZE)
+                    captured.m_Hashes.push_back( Hash::Xxh64( { data + offset, std::min( BLOCK_SIZE, section.m_Size - offset ) } ) );
+            }
+
+            return state;
+        }
+
+
+        /**
+        * @brief Counts the blocks that are unchanged since a previous state.
+        *
+        * @param previous The state of the previous analysis.
+        * @return Number of unchanged blocks, 0 if the image base or the section layout differ.
+        * The section sizes must match as well, they decide which 'mov' immediates and relative targets are translated.
+        */
+        [[nodiscard]] std::size_t UnchangedBlocks(
+            const IncrementalState & previous
+        ) const noexcept
+        {
+            if (m_ImageBase != previous.m_ImageBase || m_Sections.size() != previous.m_Sections.size())
+                return 0;
+
+            std::size_t unchanged = 0;
+
+            for (std::size_t i = 0; i < m_Sections.size(); ++i)
+            {
+                const auto & current = m_Sections[i];
+                const auto & before = previous.m_Sections[i];
+
+                if (current.m_VirtualAddress != before.m_VirtualAddress || current.m_RawDataPointer != before.m_RawDataPointer ||
+                    current.m_Size != before.m_Size)
+                    return 0;
+
+                for (std::size_t block = 0; block < current.m_Hashes.size(); ++block)
+                    unchanged += current.m_Hashes[block] == before.m_Hashes[block];
+            }
+
+            return unchanged;
+        }
+
+
+        // Number of hashed blocks.
+        [[nodiscard]] std::size_t Blocks() const noexcept
+        {
+            std::size_t blocks = 0;
+
+            for (const auto & section : m_Sections)
+                blocks += section.m_Hashes.size();
+
+            return blocks;
+        }
+
+
+        /**
+        * @brief Gets the ranges of a section that must be analyzed again.
+        *
+        * Every changed block is extended by 'MARGIN' bytes in front of it, so the pattern hits
+        * and references starting in front of the block but reaching into it are not reused.
+        *
+        * @param previous The state of the previous analysis, see 'UnchangedBlocks'.
+        * @param section Index of the executable section.
+        * @return Ascending, disjoint ranges of section offsets.
+        */
+        [[nodiscard]] std::vector<OffsetRange> DirtyRanges(
+            const IncrementalState & previous,
+            std::size_t section
+        ) const
+        {
+            const auto & current = m_Sections[section];
+            const auto & before = previous.m_Sections[section];
+
+            std::vector<OffsetRange> ranges {};
+
+            for (std::uint32_t block = 0; block < current.m_Hashes.size(); ++block)
+            {
+                if (current.m_Hashes[block] == before.m_Hashes[block])
+                    continue;
+
+                const auto begin = block * BLOCK_SIZE;
+                const auto end = std::min( current.m_Size, begin + BLOCK_SIZE );
+                const OffsetRange range { begin > MARGIN ? begin - MARGIN : 0, end };
+
+                if (!ranges.empty() && ranges.back().m_End >= range.m_Begin)
+                    ranges.back().m_End = range.m_End;
+                else
+                    ranges.push_back( range );
+            }
+
+            return ranges;
+        }
+
+
+        /**
+        * @brief Scans the changed ranges of every section and reuses the previous hits of the unchanged ones.
+        *
+        * @param context The analysis context holding the executable sections.
+        * @param scanner The compiled scanner.
+        * @param previous The state of the previous analysis, see 'UnchangedBlocks'.
+        * @return 'ScanResults' holding all matches, identical to 'MultiPatternScanner::Scan'.
+        */
+        [[nodiscard]] ScanResults Rescan(
+            const AnalysisContext & context,
+            const MultiPatternScanner & scanner,
+            const IncrementalState & previous
+        ) const
+        {
+            std::vector<PatternHit> hits {};
+
+            for (std::size_t i = 0; i < m_Sections.size(); ++i)
+            {
+                const auto & section = context.m_Sections[i];
+                const auto * data = static_cast<const mem::byte *>(SectionAddress( context, section ));
+                const auto ranges = DirtyRanges( previous, i );
+
+                // Lambda function to check if a section offset lies within a dirty range.
+                auto is_dirty = [&ranges]( std::uint32_t offset )
+                {
+                    const auto it = std::ranges::upper_bound( ranges, offset, {}, &OffsetRange::m_Begin );
+                    return it != ranges.begin() && offset < std::prev( it )->m_End;
+                };
+
+                for (const auto & hit : previous.m_Hits)
+                {
+                    const auto offset = hit.m_Offset - section.m_RawDataPointer;
+
+                    if (offset < section.m_Size && !is_dirty( offset ))
+                        hits.push_back( PatternHit { hit.m_Group, hit.m_Index, mem::pointer( data + offset ) } );
+                }
+
+                // A match starting in a range may end up to 'MARGIN' bytes past it.
+                for (const auto & range : ranges)
+                {
+                    const auto first = hits.size();
+                    scanner.ScanRegion( data + range.m_Begin, std::min( section.m_Size, range.m_End + MARGIN ) - range.m_Begin, hits );
+
+                    const auto [erase_first, erase_last] = std::ranges::remove_if( hits.begin() + first, hits.end(),
+                        [&]( const PatternHit & hit )
+                    {
+                        return hit.m_Address.as<const mem::byte *>() >= data + range.m_End;
+                    } );
+
+                    hits.erase( erase_first, erase_last );
+                }
+            }
+
+            return ScanResults { std::move( hits ) };
+        }
+
+
+        /**
+        * @brief Gets the previous references of a section for 'XrefIndex::Update'.
+        *
+        * @param context The analysis context.
+        * @param previous The state of the previous analysis, see 'UnchangedBlocks'.
+        * @param section Index of the executable section.
+        * @return The references and the dirty ranges of the section.
+        */
+        [[nodiscard]] XrefReuse Reuse(
+            const AnalysisContext & context,
+            const IncrementalState & previous,
+            std::size_t section
+        ) const
+        {
+            XrefReuse reuse {};
+            reuse.m_Xrefs = previous.m_Sections[section].m_Xrefs;
+            reuse.m_Dirty = DirtyRanges( previous, section );
+
+            for (auto & xref : reuse.m_Xrefs)
+                xref.m_Target += context.m_ImageBaseMemory;
+
+            return reuse;
+        }
+
+
+        /**
+        * @brief Stores the pattern hits of a full sweep.
+        *
+        * @param context The analysis context.
+        * @param results The matches of 'MultiPatternScanner::Scan' or 'Rescan'.
+        */
+        void SetHits(
+            const AnalysisContext & context,
+            const ScanResults & results
+        )
+        {
+            m_Hits.clear();
+
+            for (std::size_t group = 0; group < static_cast<std::size_t>(PatternGroup::Count); ++group)
+            {
+                for (const auto & hit : results.Group( static_cast<PatternGroup>(group) ))
+                    m_Hits.push_back( Hit { hit.m_Group, hit.m_Index, hit.m_Address.as<std::uint32_t>() - context.m_ImageBaseMemory } );
+            }
+        }
+
+
+        /**
+        * @brief Stores the references of a section, the state is complete once every section is set.
+        *
+        * @param context The analysis context.
+        * @param section Index of the executable section.
+        * @param xrefs The reference index built for the section.
+        */
+        void SetXrefs(
+            const AnalysisContext & context,
+            std::size_t section,
+            const XrefIndex & xrefs
+        )
+        {
+            auto & captured = m_Sections[section];
+            xrefs.ByOffset( captured.m_Xrefs );
+
+            for (auto & xref : captured.m_Xrefs)
+                xref.m_Target -= context.m_ImageBaseMemory;
+
+            m_Complete = section + 1 == m_Sections.size();
+        }
+
+
+        // Checks if the references of every section were captured.
+        [[nodiscard]] bool Complete() const noexcept
+        {
+            return m_Complete;
+        }
+
+
+        /**
+        * @brief Gets the state file path of a binary.
+        *
+        * @param directory The cache directory.
+        * @param hash Content hash of the binary, see 'Hash::Xxh64'.
+        * @return Path to the state file.
+        */
+        [[nodiscard]] static fs::path StatePath(
+            const fs::path & directory,
+            std::uint64_t hash
+        )
+        {
+            return directory / std::format( "{:016x}.blocks", hash );
+        }
+
+
+        /**
+        * @brief Loads a state file.
+        *
+        * @param path Path to the state file.
+        * @param state [out] The loaded state.
+        * @param hashes_only true to skip the hits and the references.
+        * @return true if the file exists and is valid, false otherwise.
+        */
+        [[nodiscard]] static bool Load(
+            const fs::path & path,
+            IncrementalState & state,
+            bool hashes_only = false
+        ) noexcept try
+        {
+            std::ifstream in( path, std::ios::binary );
+            if (!in.is_open())
+                return false;
+
+            std::uint32_t magic = 0, version = 0, sections = 0;
+
+            if (!Read( in, magic ) || !Read( in, version ) || !Read( in, state.m_ImageBase ) || !Read( in, sections ) ||
+                magic != MAGIC || version != FORMAT_VERSION || sections > 0xFFFF)
+                return false;
+
+            state.m_Sections.resize( sections );
+
+            for (auto & section : state.m_Sections)
+            {
+                std::uint32_t xrefs = 0;
+
+                if (!Read( in, section.m_VirtualAddress ) || !Read( in, section.m_RawDataPointer ) || !Read( in, section.m_Size ))
+                    return false;
+
+                section.m_Hashes.resize( BlockCount( section.m_Size ) );
+
+                if (!in.read( reinterpret_cast<char *>(section.m_Hashes.data()), section.m_Hashes.size() * sizeof( std::uint64_t ) ) ||
+                    !Read( in, xrefs ) || xrefs > section.m_Size)
+                    return false;
+
+                if (hashes_only)
+                {
+                    in.seekg( xrefs * sizeof( Xref ), std::ios::cur );
+                    continue;
+                }
+
+                section.m_Xrefs.resize( xrefs );
+
+                if (!in.read( reinterpret_cast<char *>(section.m_Xrefs.data()), section.m_Xrefs.size() * sizeof( Xref ) ))
+                    return false;
+            }
+
+            if (hashes_only)
+                return static_cast<bool>(in);
+
+            std::uint32_t hits = 0;
+
+            if (!Read( in, hits ) || hits > MAX_HITS)
+                return false;
+
+            state.m_Hits.resize( hits );
+
+            for (auto & hit : state.m_Hits)
+            {
+                std::uint8_t group = 0;
+
+                if (!Read( in, group ) || !Read( in, hit.m_Index ) || !Read( in, hit.m_Offset ) ||
+                    group >= static_cast<std::uint8_t>(PatternGroup::Count))
+                    return false;
+
+                hit.m_Group = static_cast<PatternGroup>(group);
+            }
+
+            state.m_Complete = true;
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+
+        /**
+        * @brief Saves a complete state to a state file.
+        *
+        * @param path Path to the state file, the directory is created if needed.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'OutputFileCreateError' if file cannot be created.
+        * @retval 'FileWriteError' if writing fails.
+        */
+        [[nodiscard]] std::expected<void, Error> Save(
+            const fs::path & path
+        ) const noexcept try
+        {
+            fs::create_directories( path.parent_path() );
+
+            std::ofstream out( path, std::ios::binary | std::ios::trunc );
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            Write( out, MAGIC );
+            Write( out, FORMAT_VERSION );
+            Write( out, m_ImageBase );
+            Write( out, static_cast<std::uint32_t>(m_Sections.size()) );
+
+            for (const auto & section : m_Sections)
+            {
+                Write( out, section.m_VirtualAddress );
+                Write( out, section.m_RawDataPointer );
+                Write( out, section.m_Size );
+                out.write( reinterpret_cast<const char *>(section.m_Hashes.data()), section.m_Hashes.size() * sizeof( std::uint64_t ) );
+                Write( out, static_cast<std::uint32_t>(section.m_Xrefs.size()) );
+                out.write( reinterpret_cast<const char *>(section.m_Xrefs.data()), section.m_Xrefs.size() * sizeof( Xref ) );
+            }
+
+            Write( out, static_cast<std::uint32_t>(m_Hits.size()) );
+
+            for (const auto & hit : m_Hits)
+            {
+                Write( out, static_cast<std::uint8_t>(hit.m_Group) );
+                Write( out, hit.m_Index );
+                Write( out, hit.m_Offset );
+            }
+
+            if (out.fail())
+                return std::unexpected( Error::FileWriteError );
+
+            return {};
+        }
+        catch (const fs::filesystem_error &)
+        {
+            return std::unexpected( Error::OutputFileCreateError );
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+
+
+        /**
+        * @brief Finds the previous state sharing the most unchanged blocks with the current one.
+        *
+        * @param directory The cache directory.
+        * @param current The state of the binary being analyzed.
+        * @param state [out] The loaded previous state.
+        * @param hash [out] Content hash of the previous binary.
+        * @return true if a state with at least one unchanged block was found, false otherwise.
+        */
+        [[nodiscard]] static bool FindPrevious(
+            const fs::path & directory,
+            const IncrementalState & current,
+            IncrementalState & state,
+            std::uint64_t & hash
+        ) noexcept try
+        {
+            std::error_code ec {};
+            fs::path best_path {};
+            std::size_t best = 0;
+
+            for (const auto & entry : fs::directory_iterator( directory, ec ))
+            {
+                if (entry.path().extension() != ".blocks")
+                    continue;
+
+                IncrementalState candidate {};
+
+                if (!Load( entry.path(), candidate, true ))
+                    continue;
+
+                if (const auto unchanged = current.UnchangedBlocks( candidate ); unchanged > best)
+                {
+                    best = unchanged;
+                    best_path = entry.path();
+                }
+            }
+
+            if (!best || !Load( best_path, state ))
+                return false;
+
+            const auto stem = best_path.stem().string();
+            const auto [ptr, parse_ec] = std::from_chars( stem.data(), stem.data() + stem.size(), hash, 16 );
+
+            return parse_ec == std::errc {};
+        }
+        catch (...)
+        {
+            return false;
+        }
+    };
+}
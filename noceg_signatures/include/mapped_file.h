@@ -0,0 +1,144 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+namespace CEG
+{
+    // Read-only file mapping with copy-on-write pages, so in-memory patches never reach the disk.
+    class MappedFile
+    {
+    private:
+
+        HANDLE m_File { INVALID_HANDLE_VALUE };
+        HANDLE m_Mapping { nullptr };
+        std::byte * m_View { nullptr };
+        std::size_t m_Size { 0 };
+
+
+        // Unmaps the view and closes all handles.
+        void Close() noexcept
+        {
+            if (m_View)
+                UnmapViewOfFile( m_View );
+
+            if (m_Mapping)
+                CloseHandle( m_Mapping );
+
+            if (m_File != INVALID_HANDLE_VALUE)
+                CloseHandle( m_File );
+
+            m_View = nullptr;
+            m_Mapping = nullptr;
+            m_File = INVALID_HANDLE_VALUE;
+            m_Size = 0;
+        }
+
+    public:
+
+        MappedFile() = default;
+
+        MappedFile( const MappedFile & ) = delete;
+        MappedFile & operator=( const MappedFile & ) = delete;
+
+        MappedFile(
+            MappedFile && other
+        ) noexcept : m_File( std::exchange( other.m_File, INVALID_HANDLE_VALUE ) ),
+            m_Mapping( std::exchange( other.m_Mapping, nullptr ) ),
+            m_View( std::exchange( other.m_View, nullptr ) ),
+            m_Size( std::exchange( other.m_Size, 0 ) )
+        {
+        }
+
+        MappedFile & operator=(
+            MappedFile && other
+        ) noexcept
+        {
+            if (this != &other)
+            {
+                Close();
+
+                m_File = std::exchange( other.m_File, INVALID_HANDLE_VALUE );
+                m_Mapping = std::exchange( other.m_Mapping, nullptr );
+                m_View = std::exchange( other.m_View, nullptr );
+                m_Size = std::exchange( other.m_Size, 0 );
+            }
+
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            Close();
+        }
+
+
+        /**
+        * @brief Maps the whole file into memory.
+        *
+        * @param path The path to the file to map.
+        * @return 'Result<MappedFile>' containing the mapping or an error.
+        * @retval 'FileNotFound' if the file cannot be opened.
+        * @retval 'EmptyContent' if the file is empty.
+        * @retval 'FileReadError' if the file cannot be mapped.
+        */
+        [[nodiscard]] static Result<MappedFile> Open(
+            const fs::path & path
+        ) noexcept
+        {
+            MappedFile file {};
+
+            // Writes are shared so the ASLR change can be patched into the original while it is mapped.
+            file.m_File = CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+
+            if (file.m_File == INVALID_HANDLE_VALUE)
+                return std::unexpected( Error::FileNotFound );
+
+            LARGE_INTEGER size {};
+            if (!GetFileSizeEx( file.m_File, &size ))
+                return std::unexpected( Error::FileReadError );
+
+            if (size.QuadPart == 0)
+                return std::unexpected( Error::EmptyContent );
+
+            file.m_Mapping = CreateFileMappingW( file.m_File, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+            if (!file.m_Mapping)
+                return std::unexpected( Error::FileReadError );
+
+            file.m_View = static_cast<std::byte *>(MapViewOfFile( file.m_Mapping, FILE_MAP_COPY, 0, 0, 0 ));
+            if (!file.m_View)
+                return std::unexpected( Error::FileReadError );
+
+            file.m_Size = static_cast<std::size_t>(size.QuadPart);
+            return file;
+        }
+
+
+        // View of the mapped file, writes only affect private copies of the pages.
+        [[nodiscard]] std::span<std::byte> bytes() const noexcept
+        {
+            return { m_View, m_Size };
+        }
+
+
+        // Size of the mapped file.
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_Size;
+        }
+    };
+}
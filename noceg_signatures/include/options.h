@@ -0,0 +1,184 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+namespace CEG
+{
+    // Command line options of the signatures finder.
+    struct Options
+    {
+        // Path to the CEG binary, empty if only the pattern hit statistics are printed.
+        fs::path m_Binary {};
+
+        // Directory or list file of the binaries to analyze in the batch mode, empty otherwise.
+        fs::path m_Batch {};
+
+        // Directory of the 'noceg_trace_<pid>_<tid>.bin' files to convert to a Chrome trace, empty otherwise.
+        fs::path m_Trace {};
+
+        // Number of binaries analyzed at once in the batch mode, zero picks one per hardware thread.
+        std::uint32_t m_Jobs { 0 };
+
+        // Analyze the reachable code via recursive descent instead of the linear sweep.
+        bool m_ControlFlow { false };
+
+        // Scan the signature groups on separate tasks instead of a single sweep.
+        bool m_Tasks { false };
+
+        // Number of analysis worker threads.
+        std::uint32_t m_Threads { 1 };
+
+        // Print the persistent pattern hit statistics.
+        bool m_Stats { false };
+
+        // Pick the pattern anchors from a byte histogram of the code section instead of the default frequencies.
+        bool m_Histogram { false };
+
+        // Benchmark the scan backends of every pattern instead of analyzing the binary.
+        bool m_Bench { false };
+
+        // Reuse the cached results of an identical binary and store the results of a new one.
+        bool m_Cache { true };
+
+        // Write 'noceg.json' without indentation and line breaks.
+        bool m_CompactJson { false };
+
+        // Print the wall time of every phase and save it to 'noceg_profile.json'.
+        bool m_Profile { false };
+
+        // Clear the ASLR flag of the original binary instead of writing '<name>_noaslr'.
+        bool m_AslrInPlace { false };
+
+        // Read the binary in overlapped chunks and scan each one as it arrives instead of mapping it.
+        bool m_Stream { false };
+    };
+
+
+    /**
+    * @brief Parses the command line options following the binary path, '--batch <dir|list>' or '--trace <dir>'.
+    *
+    * @param argc Number of command line arguments.
+    * @param argv Array of command line arguments.
+    * @return 'Result<Options>' containing the parsed options or an error.
+    * @retval 'UnknownOption' if an option is not recognized.
+    * @retval 'InvalidOptionValue' if an option value is missing or malformed.
+    */
+    [[nodiscard]] Result<Options> ParseOptions(
+        int argc,
+        char * argv[]
+    ) noexcept
+    {
+        Options options {};
+        int first = 2;
+
+        if (std::string_view( argv[1] ) == "--batch")
+        {
+            if (argc < 3)
+                return std::unexpected( Error::InvalidOptionValue );
+
+            options.m_Batch = argv[2];
+            first = 3;
+        }
+        else if (std::string_view( argv[1] ) == "--trace")
+        {
+            // The trace conversion takes no other option.
+            if (argc != 3)
+                return std::unexpected( Error::InvalidOptionValue );
+
+            options.m_Trace = argv[2];
+            return options;
+        }
+        else if (std::string_view( argv[1] ) == "--stats")
+        {
+            // Without a binary, the statistics are only printed.
+            if (argc != 2)
+                return std::unexpected( Error::InvalidOptionValue );
+
+            options.m_Stats = true;
+            return options;
+        }
+        else
+            options.m_Binary = argv[1];
+
+        // Lambda function to parse the unsigned value of an option.
+        auto parse_value = [&]( int & i, std::uint32_t & res ) -> bool
+        {
+            if (++i >= argc)
+                return false;
+
+            const std::string_view value = argv[i];
+            const auto [ptr, ec] = std::from_chars( value.data(), value.data() + value.size(), res );
+
+            return ec == std::errc {} && ptr == value.data() + value.size();
+        };
+
+        for (int i = first; i < argc; ++i)
+        {
+            const std::string_view option = argv[i];
+
+            if (option == "--cfg")
+                options.m_ControlFlow = true;
+            else if (option == "--tasks")
+                options.m_Tasks = true;
+            else if (option == "--stats")
+                options.m_Stats = true;
+            else if (option == "--bench")
+                options.m_Bench = true;
+            else if (option == "--histogram")
+                options.m_Histogram = true;
+            else if (option == "--no-cache")
+                options.m_Cache = false;
+            else if (option == "--compact-json")
+                options.m_CompactJson = true;
+            else if (option == "--profile")
+                options.m_Profile = true;
+            else if (option == "--aslr-in-place")
+                options.m_AslrInPlace = true;
+            else if (option == "--stream")
+                options.m_Stream = true;
+            else if (option == "--threads")
+            {
+                if (!parse_value( i, options.m_Threads ))
+                    return std::unexpected( Error::InvalidOptionValue );
+
+                // Zero picks one worker per hardware thread.
+                if (!options.m_Threads)
+                    options.m_Threads = std::max( 1u, std::thread::hardware_concurrency() );
+            }
+            else if (option == "--jobs" && !options.m_Batch.empty())
+            {
+                if (!parse_value( i, options.m_Jobs ))
+                    return std::unexpected( Error::InvalidOptionValue );
+            }
+            else
+                return std::unexpected( Error::UnknownOption );
+        }
+
+        // The batch mode never prompts, the backend benchmark only reports on a single binary.
+        if (!options.m_Batch.empty() && options.m_Bench)
+            return std::unexpected( Error::InvalidOptionValue );
+
+        // The streamed chunks feed the single sweep, its anchors cannot wait for the histogram of the whole code.
+        if (options.m_Stream && (options.m_Tasks || options.m_Histogram))
+            return std::unexpected( Error::InvalidOptionValue );
+
+        if (!options.m_Jobs)
+            options.m_Jobs = std::max( 1u, std::thread::hardware_concurrency() );
+
+        return options;
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+#include <chrono>
+
+namespace CEG
+{
+    // Number of timed repetitions per pattern and backend, the fastest one is reported.
+    inline constexpr std::uint32_t BENCH_REPETITIONS = 5;
+
+
+    /**
+    * @brief Gets the display name of a scan backend.
+    *
+    * @param backend The backend.
+    * @return The backend name.
+    */
+    [[nodiscard]] constexpr std::string_view ScanBackendName(
+        ScanBackend backend
+    ) noexcept
+    {
+        return backend == ScanBackend::Horspool ? "Horspool" : "Anchor";
+    }
+
+
+    /**
+    * @brief Measures the fastest full scan of a pattern with a backend.
+    *
+    * @param pattern The precompiled pattern.
+    * @param backend The backend to measure.
+    * @param range The memory region to search.
+    * @param matches [out] Number of matches found.
+    * @return The fastest scan time in microseconds.
+    */
+    [[nodiscard]] std::int64_t MeasureScan(
+        const StaticPattern & pattern,
+        ScanBackend backend,
+        mem::region range,
+        std::size_t & matches
+    )
+    {
+        std::int64_t best = INT64_MAX;
+        std::vector<mem::pointer> res {};
+
+        for (std::uint32_t i = 0; i < BENCH_REPETITIONS; ++i)
+        {
+            res.clear();
+
+            const auto start = std::chrono::steady_clock::now();
+            pattern.ScanAll( range, res, backend );
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            best = std::min<std::int64_t>( best, std::chrono::duration_cast<std::chrono::microseconds>( elapsed ).count() );
+        }
+
+        matches = res.size();
+        return best;
+    }
+
+
+    /**
+    * @brief Benchmarks both scan backends for every pattern of a group and reports the winners.
+    *
+    * @param name Name of the signature group.
+    * @param patterns Container of precompiled patterns.
+    * @param address Starting address of the memory region to search.
+    * @param size Size in bytes of the memory region to search.
+    * @return Number of patterns whose selected backend was not the fastest one.
+    */
+    std::size_t BenchmarkPatterns(
+        std::string_view name,
+        const auto & patterns,
+        const void * address,
+        std::size_t size
+    )
+    {
+        const mem::region range( address, size );
+        std::size_t mispicks = 0;
+        std::size_t index = 0;
+
+        for (const auto & pattern : patterns)
+        {
+            std::size_t anchor_matches = 0;
+            std::size_t horspool_matches = 0;
+
+            const auto anchor = MeasureScan( pattern, ScanBackend::Anchor, range, anchor_matches );
+            const auto horspool = MeasureScan( pattern, ScanBackend::Horspool, range, horspool_matches );
+            const auto winner = (horspool < anchor) ? ScanBackend::Horspool : ScanBackend::Anchor;
+
+            if (anchor_matches != horspool_matches)
+            {
+                std::cout << std::format( "[WARNING] {} pattern '{}': backends disagree ('{}' and '{}' matches).",
+                    name, index, anchor_matches, horspool_matches ) << std::endl;
+            }
+
+            if (winner != pattern.backend())
+                ++mispicks;
+
+            std::cout << std::format( "[BENCH] {} pattern '{}' (run '{}'): Anchor '{}' us, Horspool '{}' us, selected '{}', fastest '{}'.",
+                name, index, pattern.run_size(), anchor, horspool, ScanBackendName( pattern.backend() ),
+                ScanBackendName( winner ) ) << std::endl;
+
+            ++index;
+        }
+
+        return mispicks;
+    }
+}
@@ -0,0 +1,244 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "scanner.h"
+
+namespace CEG
+{
+    // Persistent per-pattern hit counts, used to try the most likely patterns of a group first.
+    class PatternStats
+    {
+    private:
+
+        // Number of tracked CEG versions (older and newer).
+        static constexpr std::size_t VERSIONS = 2;
+
+        static constexpr std::size_t GROUPS = static_cast<std::size_t>(PatternGroup::Count);
+
+        // Names of the signature groups inside the stats file.
+        static constexpr const auto & GROUP_NAMES = PATTERN_GROUP_NAMES;
+
+        // Names of the CEG versions inside the stats file.
+        static constexpr std::array<std::string_view, VERSIONS> VERSION_NAMES = { "Version2", "Version1" };
+
+        // Hit counts indexed by version, group and pattern index.
+        std::array<std::array<std::vector<std::uint32_t>, GROUPS>, VERSIONS> m_Hits {};
+
+
+        [[nodiscard]] const std::vector<std::uint32_t> & Hits(
+            PatternGroup group,
+            bool old_version
+        ) const noexcept
+        {
+            return m_Hits[old_version ? 1 : 0][static_cast<std::size_t>(group)];
+        }
+
+
+        [[nodiscard]] static std::uint32_t HitsAt(
+            const std::vector<std::uint32_t> & hits,
+            std::size_t index
+        ) noexcept
+        {
+            return index < hits.size() ? hits[index] : 0;
+        }
+
+    public:
+
+        /**
+        * @brief Gets the default stats file path, next to the executable.
+        *
+        * @return Path to the 'noceg_signatures.stats' file.
+        */
+        [[nodiscard]] static fs::path DefaultPath()
+        {
+            std::wstring module( MAX_PATH, L'\0' );
+            const auto length = GetModuleFileNameW( nullptr, module.data(), static_cast<DWORD>(module.size()) );
+
+            if (length == 0 || length >= module.size())
+                return fs::path( "noceg_signatures.stats" );
+
+            module.resize( length );
+            return fs::path( module ).parent_path() / "noceg_signatures.stats";
+        }
+
+
+        /**
+        * @brief Loads the hit counts from a stats file.
+        *
+        * @param path Path to the stats file.
+        * @return The loaded stats, or empty stats if the file is missing or malformed.
+        */
+        [[nodiscard]] static PatternStats Load(
+            const fs::path & path
+        ) noexcept try
+        {
+            PatternStats stats {};
+
+            std::ifstream in( path );
+            if (!in.is_open())
+                return stats;
+
+            const auto j_root = json::parse( in, nullptr, false );
+            if (!j_root.is_object())
+                return stats;
+
+            for (std::size_t version = 0; version < VERSIONS; ++version)
+            {
+                const auto j_version = j_root.find( VERSION_NAMES[version] );
+                if (j_version == j_root.end() || !j_version->is_object())
+                    continue;
+
+                for (std::size_t group = 0; group < GROUPS; ++group)
+                {
+                    const auto j_hits = j_version->find( GROUP_NAMES[group] );
+                    if (j_hits == j_version->end() || !j_hits->is_array())
+                        continue;
+
+                    for (const auto & j_count : *j_hits)
+                        stats.m_Hits[version][group].push_back( j_count.is_number_unsigned() ? j_count.get<std::uint32_t>() : 0 );
+                }
+            }
+
+            return stats;
+        }
+        catch (...)
+        {
+            return PatternStats {};
+        }
+
+
+        /**
+        * @brief Saves the hit counts to a stats file.
+        *
+        * @param path Path to the stats file.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'OutputFileCreateError' if file cannot be created.
+        * @retval 'FileWriteError' if writing fails.
+        */
+        [[nodiscard]] std::expected<void, Error> Save(
+            const fs::path & path
+        ) const noexcept try
+        {
+            json j_root = json::object();
+
+            for (std::size_t version = 0; version < VERSIONS; ++version)
+            {
+                json j_version = json::object();
+
+                for (std::size_t group = 0; group < GROUPS; ++group)
+                {
+                    if (!m_Hits[version][group].empty())
+                        j_version[GROUP_NAMES[group]] = m_Hits[version][group];
+                }
+
+                j_root[VERSION_NAMES[version]] = std::move( j_version );
+            }
+
+            std::ofstream out( path, std::ios::trunc );
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            out << j_root.dump( 4 );
+
+            if (out.fail())
+                return std::unexpected( Error::FileWriteError );
+
+            return {};
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+
+
+        /**
+        * @brief Orders the patterns of a group by their observed hit rate.
+        *
+        * Hits of the detected CEG version come first, hits of the other version break ties,
+        * then the declaration order.
+        *
+        * @param group The signature group.
+        * @param old_version true if an older CEG version was detected.
+        * @param count Number of patterns inside the group.
+        * @return Pattern indices in the order they should be tried.
+        */
+        [[nodiscard]] std::vector<std::uint16_t> Order(
+            PatternGroup group,
+            bool old_version,
+            std::size_t count
+        ) const
+        {
+            const auto & hits = Hits( group, old_version );
+            const auto & other = Hits( group, !old_version );
+
+            std::vector<std::uint16_t> order( count );
+            for (std::size_t i = 0; i < count; ++i)
+                order[i] = static_cast<std::uint16_t>(i);
+
+            std::ranges::stable_sort( order, [&]( std::uint16_t lhs, std::uint16_t rhs )
+            {
+                return std::make_pair( HitsAt( hits, lhs ), HitsAt( other, lhs ) ) >
+                    std::make_pair( HitsAt( hits, rhs ), HitsAt( other, rhs ) );
+            } );
+
+            return order;
+        }
+
+
+        /**
+        * @brief Records a hit of a pattern.
+        *
+        * @param group The signature group.
+        * @param old_version true if an older CEG version was detected.
+        * @param index Index of the matched pattern inside its group.
+        */
+        void Record(
+            PatternGroup group,
+            bool old_version,
+            std::uint16_t index
+        )
+        {
+            auto & hits = m_Hits[old_version ? 1 : 0][static_cast<std::size_t>(group)];
+
+            if (hits.size() <= index)
+                hits.resize( index + 1, 0 );
+
+            ++hits[index];
+        }
+
+
+        // Prints the recorded hit counts of every group and version.
+        void Print() const
+        {
+            for (std::size_t version = 0; version < VERSIONS; ++version)
+            {
+                for (std::size_t group = 0; group < GROUPS; ++group)
+                {
+                    const auto & hits = m_Hits[version][group];
+
+                    for (std::size_t index = 0; index < hits.size(); ++index)
+                    {
+                        if (hits[index])
+                        {
+                            std::cout << std::format( "[STATS] {} {} pattern '{}': '{}' hits.",
+                                VERSION_NAMES[version], GROUP_NAMES[group], index, hits[index] ) << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    };
+}
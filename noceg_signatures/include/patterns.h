@@ -14,8 +14,12 @@
 
 #pragma once
 
+// Pattern used to detect older CEG versions at the start of the code section.
+constexpr StaticPattern CEG_OLD_VERSION_PATTERN = "51 B8 ?? ?? ?? ?? FF D0 59 FF E0";
+
+
 // CEG protected function patterns. Includes both constant and stolen/masked functions.
-constexpr std::array<std::string_view, 12> CEG_PROTECT_PATTERNS =
+constexpr std::array<StaticPattern, 12> CEG_PROTECT_PATTERNS =
 {
     "55 8B EC ?? EC ?? 53 56 57 8D 4D ?? E8 ?? ?? ?? ?? 8B 3D",
     "55 8B EC ?? EC ?? ?? ?? ?? 53 56 57 8D 8D ?? ?? ?? ?? E8 ?? ?? ?? ?? 8B 3D",
@@ -33,7 +37,7 @@ constexpr std::array<std::string_view, 12> CEG_PROTECT_PATTERNS =
 
 
 // CEG integrity patterns.
-constexpr std::array<std::string_view, 5> CEG_INTEGRITY_PATTERNS =
+constexpr std::array<StaticPattern, 5> CEG_INTEGRITY_PATTERNS =
 {
     "53 56 57 8B 3D ?? ?? ?? ?? 6A ?? 6A ?? B3 01",
     "53 56 57 8B 3D ?? ?? ?? ?? B3 01 8D",
@@ -44,7 +48,7 @@ constexpr std::array<std::string_view, 5> CEG_INTEGRITY_PATTERNS =
 
 
 // CEG test secret patterns. Includes both file and registry.
-constexpr std::array<std::string_view, 31> CEG_TESTSECRET_PATTERNS =
+constexpr std::array<StaticPattern, 31> CEG_TESTSECRET_PATTERNS =
 {
     "55 8B EC 81 EC ?? ?? ?? ?? A1 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 8B 15 ?? ?? ?? ?? 89 ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? 89 ?? ?? ?? ?? ?? ?? 89 ?? ?? E8 ?? ?? ?? ?? 84 C0 75",
     "81 EC ?? ?? ?? ?? A1 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 8B 15 ?? ?? ?? ?? 89 ?? ?? ?? ?? ?? ?? ?? ?? ?? 89 ?? ?? ?? 89 ?? ?? ?? ?? ?? ?? ?? ?? E8 ?? ?? ?? ?? 84 C0 75",
@@ -81,7 +85,7 @@ constexpr std::array<std::string_view, 31> CEG_TESTSECRET_PATTERNS =
 
 
 // CEG initialization patterns.
-constexpr std::array<std::string_view, 11> CEG_INIT_LIBRARY_FUNC_PATTERNS =
+constexpr std::array<StaticPattern, 11> CEG_INIT_LIBRARY_FUNC_PATTERNS =
 {
     "E8 ?? ?? ?? ?? 85 C0 A3 ?? ?? ?? ?? 74 ?? E8 ?? ?? ?? ?? 35 ?? ?? ?? ?? 74 ?? B8 01 00 00 00 C3 33 C0 C3",
     "68 ?? ?? ?? ?? 6A 01 FF 15 ?? ?? ?? ?? A3 ?? ?? ?? ?? E8 ?? ?? ?? ?? E8 ?? ?? ?? ?? 85 C0 A3 ?? ?? ?? ?? 74 ?? E8 ?? ?? ?? ?? B9 ?? ?? ?? ?? 35 ?? ?? ?? ?? 81 F1 ?? ?? ?? ?? 0B C1 74 ?? B8 01 00 00 00 C3 33 C0 C3",
@@ -98,7 +102,7 @@ constexpr std::array<std::string_view, 11> CEG_INIT_LIBRARY_FUNC_PATTERNS =
 
 
 // CEG register thread patterns.
-constexpr std::array<std::string_view, 2> CEG_REGISTER_THREAD_FUNC_PATTERNS =
+constexpr std::array<StaticPattern, 2> CEG_REGISTER_THREAD_FUNC_PATTERNS =
 {
     "56 E8 ?? ?? ?? ?? 8B F0 E8 ?? ?? ?? ?? 50 56 E8 ?? ?? ?? ?? 83 C4 ?? E8 ?? ?? ?? ?? A3 ?? ?? ?? ?? E8 ?? ?? ?? ?? A3 ?? ?? ?? ?? B0 01",
     "56 E8 ?? ?? ?? ?? 8B F0 E8 ?? ?? ?? ?? 50 56 E8 ?? ?? ?? ?? E8 ?? ?? ?? ?? A3 ?? ?? ?? ?? E8 ?? ?? ?? ?? 6A ?? A3 ?? ?? ?? ?? E8 ?? ?? ?? ?? 83 C4 ?? B0 01"
@@ -106,7 +110,7 @@ constexpr std::array<std::string_view, 2> CEG_REGISTER_THREAD_FUNC_PATTERNS =
 
 
 // CEG terminate patterns.
-constexpr std::array<std::string_view, 5> CEG_TERM_LIBRARY_FUNC_PATTERNS =
+constexpr std::array<StaticPattern, 5> CEG_TERM_LIBRARY_FUNC_PATTERNS =
 {
     "A1 ?? ?? ?? ?? 50 E8 ?? ?? ?? ?? 8B 0D ?? ?? ?? ?? 83 C4 ?? 51 FF 15 ?? ?? ?? ?? A1 ?? ?? ?? ?? 85 C0 74 ?? 50 FF 15 ?? ?? ?? ?? B0 01 C7 05 ?? ?? ?? ?? ?? ?? ?? ?? C3",
     "A1 ?? ?? ?? ?? 85 C0 74 ?? 50 FF 15 ?? ?? ?? ?? B0 01 C7 05 ?? ?? ?? ?? ?? ?? ?? ?? C3",
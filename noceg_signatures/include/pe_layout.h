@@ -0,0 +1,244 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include <Windows.h>
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace CEG
+{
+    // A section of a PE binary which has raw data in the file.
+    struct PeSection
+    {
+        // Relative virtual address of the section.
+        std::uint32_t m_VirtualAddress { 0 };
+
+        // File offset to the raw data of the section.
+        std::uint32_t m_RawDataPointer { 0 };
+
+        // Number of bytes of the section present in the file.
+        std::uint32_t m_Size { 0 };
+    };
+
+
+    // Interval table of the sections of a PE binary, built once and used for every address translation.
+    class PeLayout
+    {
+    private:
+
+        // The sections ordered by virtual address.
+        std::vector<PeSection> m_Sections {};
+
+        // The same sections ordered by file offset.
+        std::vector<PeSection> m_ByOffset {};
+
+        // Raw 'ImageBase' value from the PE header.
+        std::uint32_t m_ImageBase { 0 };
+
+
+        /**
+        * @brief Finds the interval containing a value.
+        *
+        * @param sections The sections ordered by the start of the interval.
+        * @param value The value to look up.
+        * @param start Member holding the start of the interval.
+        * @return Pointer to the section, or nullptr if the value is outside of every section.
+        */
+        [[nodiscard]] static constexpr const PeSection * Find(
+            const std::vector<PeSection> & sections,
+            std::uint32_t value,
+            std::uint32_t PeSection::* start
+        ) noexcept
+        {
+            const auto it = std::ranges::upper_bound( sections, value, {}, start );
+            if (it == sections.begin())
+                return nullptr;
+
+            const auto & section = *std::prev( it );
+            return value - section.*start < section.m_Size ? &section : nullptr;
+        }
+
+    public:
+
+        PeLayout() = default;
+
+        /**
+        * @brief Builds the interval table of a set of sections.
+        *
+        * @param sections The sections, in any order.
+        * @param image_base Raw 'ImageBase' value from the PE header.
+        */
+        constexpr PeLayout(
+            std::vector<PeSection> sections,
+            std::uint32_t image_base = 0
+        ) : m_Sections( std::move( sections ) ), m_ImageBase( image_base )
+        {
+            std::ranges::sort( m_Sections, {}, &PeSection::m_VirtualAddress );
+
+            m_ByOffset = m_Sections;
+            std::ranges::sort( m_ByOffset, {}, &PeSection::m_RawDataPointer );
+        }
+
+
+        /**
+        * @brief Reads the section table of a PE binary.
+        *
+        * The size of a section is its virtual size limited to its raw data and to the file.
+        *
+        * @param content The binary file content, or only its headers.
+        * @param characteristics Only the sections having every one of these flags are recorded, '0' records all.
+        * @param file_size Size of the whole file if 'content' only holds its headers, '0' uses the size of 'content'.
+        * @return The layout, or 'std::nullopt' if the content is not a PE binary.
+        */
+        [[nodiscard]] static std::optional<PeLayout> FromImage(
+            std::span<const std::byte> content,
+            DWORD characteristics = 0,
+            std::uint64_t file_size = 0
+        )
+        {
+            if (!file_size)
+                file_size = content.size();
+
+            if (content.size() < sizeof( IMAGE_DOS_HEADER ))
+                return std::nullopt;
+
+            const auto * dos_header = reinterpret_cast<const IMAGE_DOS_HEADER *>(content.data());
+            if (dos_header->e_magic != IMAGE_DOS_SIGNATURE || dos_header->e_lfanew < 0 ||
+                content.size() < static_cast<std::size_t>(dos_header->e_lfanew) + sizeof( IMAGE_NT_HEADERS ))
+                return std::nullopt;
+
+            const auto * nt_headers = reinterpret_cast<const IMAGE_NT_HEADERS *>(content.data() + dos_header->e_lfanew);
+            if (nt_headers->Signature != IMAGE_NT_SIGNATURE)
+                return std::nullopt;
+
+            const auto * section_header = IMAGE_FIRST_SECTION( nt_headers );
+            const auto table_end = reinterpret_cast<const std::byte *>(section_header + nt_headers->FileHeader.NumberOfSections);
+
+            if (table_end > content.data() + content.size())
+                return std::nullopt;
+
+            std::vector<PeSection> sections {};
+
+            for (std::uint16_t i = 0; i < nt_headers->FileHeader.NumberOfSections; ++i, ++section_header)
+            {
+                if ((section_header->Characteristics & characteristics) != characteristics)
+                    continue;
+
+                const auto raw = section_header->PointerToRawData;
+                if (raw == 0 || raw >= file_size)
+                    continue;
+
+                auto size = static_cast<std::uint32_t>(section_header->Misc.VirtualSize);
+                size = size ? std::min<std::uint32_t>( size, section_header->SizeOfRawData ) : section_header->SizeOfRawData;
+                size = static_cast<std::uint32_t>(std::min<std::uint64_t>( size, file_size - raw ));
+
+                if (size)
+                    sections.push_back( PeSection { section_header->VirtualAddress, raw, size } );
+            }
+
+            return PeLayout { std::move( sections ), static_cast<std::uint32_t>(nt_headers->OptionalHeader.ImageBase) };
+        }
+
+
+        /**
+        * @brief Finds the section containing a relative virtual address.
+        *
+        * @param rva Relative virtual address.
+        * @return Pointer to the section, or nullptr if the address is outside of every section.
+        */
+        [[nodiscard]] constexpr const PeSection * FindByRva(
+            std::uint32_t rva
+        ) const noexcept
+        {
+            return Find( m_Sections, rva, &PeSection::m_VirtualAddress );
+        }
+
+
+        /**
+        * @brief Finds the section containing a file offset.
+        *
+        * @param offset File offset.
+        * @return Pointer to the section, or nullptr if the offset is outside of every section.
+        */
+        [[nodiscard]] constexpr const PeSection * FindByOffset(
+            std::uint32_t offset
+        ) const noexcept
+        {
+            return Find( m_ByOffset, offset, &PeSection::m_RawDataPointer );
+        }
+
+
+        /**
+        * @brief Converts a relative virtual address to its file offset.
+        *
+        * @param rva Relative virtual address.
+        * @return The file offset, or 0 if the address is outside of every section.
+        */
+        [[nodiscard]] constexpr std::uint32_t RvaToOffset(
+            std::uint32_t rva
+        ) const noexcept
+        {
+            const auto * section = FindByRva( rva );
+            return section ? rva - section->m_VirtualAddress + section->m_RawDataPointer : 0;
+        }
+
+
+        /**
+        * @brief Converts a virtual address to its file offset.
+        *
+        * @param va Virtual address.
+        * @return The file offset, or 0 if the address is outside of every section.
+        */
+        [[nodiscard]] constexpr std::uint32_t VaToOffset(
+            std::uint32_t va
+        ) const noexcept
+        {
+            return va >= m_ImageBase ? RvaToOffset( va - m_ImageBase ) : 0;
+        }
+
+
+        /**
+        * @brief Converts a file offset to its relative virtual address.
+        *
+        * @param offset File offset.
+        * @return The relative virtual address, or 0 if the offset is outside of every section.
+        */
+        [[nodiscard]] constexpr std::uint32_t OffsetToRva(
+            std::uint32_t offset
+        ) const noexcept
+        {
+            const auto * section = FindByOffset( offset );
+            return section ? offset - section->m_RawDataPointer + section->m_VirtualAddress : 0;
+        }
+
+
+        // The sections ordered by virtual address.
+        [[nodiscard]] constexpr std::span<const PeSection> sections() const noexcept
+        {
+            return m_Sections;
+        }
+
+
+        // Raw 'ImageBase' value from the PE header.
+        [[nodiscard]] constexpr std::uint32_t ImageBase() const noexcept
+        {
+            return m_ImageBase;
+        }
+    };
+}
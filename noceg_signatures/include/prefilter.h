@@ -0,0 +1,235 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+#if defined(MEM_SIMD_AVX2)
+#    include <immintrin.h>
+#elif defined(MEM_SIMD_SSE2)
+#    include <emmintrin.h>
+#endif
+
+namespace CEG
+{
+    // Vectorized candidate pass over the opcodes acted on by 'InstructionAnalyzer'.
+    class OpcodePrefilter
+    {
+    public:
+
+        /**
+        * @brief Checks if a byte is one of the opcodes acted on by the analyzer.
+        *
+        * 'E8' (call rel32), 'E9' (jmp rel32), 'EB' (jmp rel8), 'B8' (mov eax, imm32)
+        * and 'C7' (mov r/m32, imm32).
+        *
+        * @param value The byte to check.
+        * @return true if the byte is a candidate opcode.
+        */
+        [[nodiscard]] static constexpr bool IsOpcode(
+            mem::byte value
+        ) noexcept
+        {
+            return value == 0xE8 || value == 0xE9 || value == 0xEB || value == 0xB8 || value == 0xC7;
+        }
+
+
+        /**
+        * @brief Checks if a byte is a legacy instruction prefix.
+        *
+        * @param value The byte to check.
+        * @return true if the byte is a legacy prefix.
+        */
+        [[nodiscard]] static constexpr bool IsLegacyPrefix(
+            mem::byte value
+        ) noexcept
+        {
+            switch (value)
+            {
+                case 0xF0: case 0xF2: case 0xF3:
+                case 0x2E: case 0x36: case 0x3E: case 0x26: case 0x64: case 0x65:
+                case 0x66: case 0x67:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+
+        /**
+        * @brief Reads an unaligned 32-bit little-endian value.
+        *
+        * @param ptr Pointer to the value.
+        * @return The value read.
+        */
+        [[nodiscard]] static std::uint32_t ReadU32(
+            const mem::byte * ptr
+        ) noexcept
+        {
+            std::uint32_t value = 0;
+            std::memcpy( &value, ptr, sizeof( value ) );
+            return value;
+        }
+
+
+        /**
+        * @brief Computes the call/jump target of the instruction at the given offset.
+        *
+        * Mirrors the target calculation of 'InstructionAnalyzer::DecodeTarget'.
+        *
+        * @param context The analysis context.
+        * @param data Pointer to the binary data.
+        * @param address Base address of the data in memory.
+        * @param offset Offset of the candidate opcode.
+        * @param target [out] The computed target.
+        * @return true if the opcode encodes a target, false otherwise.
+        */
+        [[nodiscard]] static bool GetTarget(
+            const AnalysisContext & context,
+            const mem::byte * data,
+            const void * address,
+            std::uint32_t offset,
+            std::uint32_t & target
+        ) noexcept
+        {
+            const auto current_address = reinterpret_cast<std::uintptr_t>(address) + offset;
+            const auto * ptr = data + offset;
+
+            switch (*ptr)
+            {
+                case 0xE8:
+                case 0xE9:
+                    target = RelativeToOffset( context, static_cast<std::uint32_t>(current_address), 5 + static_cast<std::int32_t>(ReadU32( ptr + 1 )) );
+                    return target != 0;
+                case 0xEB:
+                    target = RelativeToOffset( context, static_cast<std::uint32_t>(current_address), 2 + static_cast<std::int8_t>(ptr[1]) );
+                    return target != 0;
+                case 0xB8:
+                    target = VaToOffset( context, ReadU32( ptr + 1 ) );
+                    return true;
+                case 0xC7:
+                    // Only 'mov eax, imm32' is of interest.
+                    if (ptr[1] != 0xC0)
+                        return false;
+
+                    target = VaToOffset( context, ReadU32( ptr + 2 ) );
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+
+        /**
+        * @brief Finds the offsets of all candidate opcodes within a memory region.
+        *
+        * @param data Pointer to the memory region.
+        * @param size Number of bytes to search.
+        * @param res [out] Reference to vector that will receive the opcode offsets in ascending order.
+        */
+        static void FindOpcodes(
+            const mem::byte * data,
+            std::size_t size,
+            std::vector<std::uint32_t> & res
+        )
+        {
+            std::size_t offset = 0;
+
+            if (Avx512::Supported())
+                offset = Avx512::FindOpcodes( data, size, res );
+
+#if defined(MEM_SIMD_AVX2) || defined(MEM_SIMD_SSE2)
+#    if defined(MEM_SIMD_AVX2)
+#        define l_SIMD_TYPE __m256i
+#        define l_SIMD_FILL(x) _mm256_set1_epi8(static_cast<char>(x))
+#        define l_SIMD_LOAD(x) _mm256_loadu_si256(x)
+#        define l_SIMD_CMPEQ(x, y) _mm256_cmpeq_epi8(x, y)
+#        define l_SIMD_AND(x, y) _mm256_and_si256(x, y)
+#        define l_SIMD_OR(x, y) _mm256_or_si256(x, y)
+#        define l_SIMD_MOVEMASK(x) static_cast<std::uint32_t>(_mm256_movemask_epi8(x))
+#    else
+#        define l_SIMD_TYPE __m128i
+#        define l_SIMD_FILL(x) _mm_set1_epi8(static_cast<char>(x))
+#        define l_SIMD_LOAD(x) _mm_loadu_si128(x)
+#        define l_SIMD_CMPEQ(x, y) _mm_cmpeq_epi8(x, y)
+#        define l_SIMD_AND(x, y) _mm_and_si128(x, y)
+#        define l_SIMD_OR(x, y) _mm_or_si128(x, y)
+#        define l_SIMD_MOVEMASK(x) static_cast<std::uint32_t>(_mm_movemask_epi8(x))
+#    endif
+
+            const l_SIMD_TYPE low_bit = l_SIMD_FILL( 0xFE );
+            const l_SIMD_TYPE rel32 = l_SIMD_FILL( 0xE8 );
+            const l_SIMD_TYPE rel8 = l_SIMD_FILL( 0xEB );
+            const l_SIMD_TYPE mov_eax = l_SIMD_FILL( 0xB8 );
+            const l_SIMD_TYPE mov_rm = l_SIMD_FILL( 0xC7 );
+
+            for (; offset + sizeof( l_SIMD_TYPE ) <= size; offset += sizeof( l_SIMD_TYPE ))
+            {
+                const l_SIMD_TYPE value = l_SIMD_LOAD( reinterpret_cast<const l_SIMD_TYPE *>(data + offset) );
+
+                // 'E8' and 'E9' only differ in the lowest bit.
+                const l_SIMD_TYPE match = l_SIMD_OR(
+                    l_SIMD_OR( l_SIMD_CMPEQ( l_SIMD_AND( value, low_bit ), rel32 ), l_SIMD_CMPEQ( value, rel8 ) ),
+                    l_SIMD_OR( l_SIMD_CMPEQ( value, mov_eax ), l_SIMD_CMPEQ( value, mov_rm ) ) );
+
+                auto mask = l_SIMD_MOVEMASK( match );
+
+                while (mask)
+                {
+                    res.push_back( static_cast<std::uint32_t>(offset + std::countr_zero( mask )) );
+                    mask &= mask - 1;
+                }
+            }
+
+#    undef l_SIMD_TYPE
+#    undef l_SIMD_FILL
+#    undef l_SIMD_LOAD
+#    undef l_SIMD_CMPEQ
+#    undef l_SIMD_AND
+#    undef l_SIMD_OR
+#    undef l_SIMD_MOVEMASK
+#endif
+
+            for (; offset < size; ++offset)
+            {
+                if (IsOpcode( data[offset] ))
+                    res.push_back( static_cast<std::uint32_t>(offset) );
+            }
+        }
+
+
+        /**
+        * @brief Finds the first offset of the legacy prefixes in front of an opcode.
+        *
+        * The full sweep decodes the prefixed instruction at each of these offsets as well.
+        *
+        * @param data Pointer to the binary data.
+        * @param offset Offset of the opcode.
+        * @return Offset of the first prefix, or the opcode offset if there is none.
+        */
+        [[nodiscard]] static std::uint32_t GetPrefixStart(
+            const mem::byte * data,
+            std::uint32_t offset
+        ) noexcept
+        {
+            std::uint32_t start = offset;
+
+            while (start > 0 && offset - start + 1 < ZYDIS_MAX_INSTRUCTION_LENGTH && IsLegacyPrefix( data[start - 1] ))
+                --start;
+
+            return start;
+        }
+    };
+}
@@ -0,0 +1,278 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+#include <Psapi.h>
+
+#include <chrono>
+#include <mutex>
+
+namespace CEG
+{
+    // Wall time and call counts of the processing phases, reported by '--profile'.
+    class Profiler
+    {
+    private:
+
+        struct Phase
+        {
+            std::string m_Name {};
+            std::chrono::nanoseconds m_Elapsed { 0 };
+            std::uint64_t m_Calls { 0 };
+        };
+
+
+        struct Counter
+        {
+            std::string m_Name {};
+            std::uint64_t m_Value { 0 };
+        };
+
+        // Phases and counters in the order they were first recorded.
+        std::vector<Phase> m_Phases {};
+        std::vector<Counter> m_Counters {};
+
+        // The scan tasks record their phases concurrently.
+        mutable std::mutex m_Mutex {};
+
+        bool m_Enabled { false };
+
+        // Start of the whole run.
+        std::chrono::steady_clock::time_point m_Created { std::chrono::steady_clock::now() };
+
+    public:
+
+        // Measures a phase from its construction to its destruction.
+        class Scope
+        {
+        private:
+
+            Profiler * m_Profiler { nullptr };
+            std::string_view m_Name {};
+            std::chrono::steady_clock::time_point m_Start {};
+
+        public:
+
+            Scope(
+                Profiler * profiler,
+                std::string_view name
+            ) : m_Profiler( profiler ), m_Name( name ), m_Start( std::chrono::steady_clock::now() )
+            {
+            }
+
+            ~Scope()
+            {
+                if (m_Profiler)
+                    m_Profiler->Record( m_Name, std::chrono::steady_clock::now() - m_Start );
+            }
+
+            Scope( const Scope & ) = delete;
+            Scope & operator=( const Scope & ) = delete;
+        };
+
+
+        explicit Profiler(
+            bool enabled
+        ) : m_Enabled( enabled )
+        {
+        }
+
+
+        // Checks if the profiling is enabled.
+        [[nodiscard]] bool Enabled() const noexcept
+        {
+            return m_Enabled;
+        }
+
+
+        /**
+        * @brief Starts measuring a phase.
+        *
+        * @param name Name of the phase, must outlive the returned scope.
+        * @return The scope recording the phase once destroyed, a no-op if the profiling is disabled.
+        */
+        [[nodiscard]] Scope Measure(
+            std::string_view name
+        ) noexcept
+        {
+            return Scope( m_Enabled ? this : nullptr, name );
+        }
+
+
+        /**
+        * @brief Measures a single call.
+        *
+        * @param name Name of the phase.
+        * @param callable The work to measure.
+        * @return The result of the callable.
+        */
+        template<typename F>
+        decltype(auto) Time(
+            std::string_view name,
+            F && callable
+        )
+        {
+            const auto phase = Measure( name );
+            return std::forward<F>( callable )();
+        }
+
+
+        // Wall time since the profiler was created.
+        [[nodiscard]] std::chrono::nanoseconds Elapsed() const noexcept
+        {
+            return std::chrono::steady_clock::now() - m_Created;
+        }
+
+
+        /**
+        * @brief Adds a single call of a phase.
+        *
+        * @param name Name of the phase.
+        * @param elapsed Wall time of the call.
+        */
+        void Record(
+            std::string_view name,
+            std::chrono::nanoseconds elapsed
+        )
+        {
+            if (!m_Enabled)
+                return;
+
+            std::scoped_lock lock( m_Mutex );
+
+            auto it = std::ranges::find( m_Phases, name, &Phase::m_Name );
+            if (it == m_Phases.end())
+                it = m_Phases.insert( it, Phase { std::string( name ) } );
+
+            it->m_Elapsed += elapsed;
+            ++it->m_Calls;
+        }
+
+
+        /**
+        * @brief Adds to a work counter.
+        *
+        * @param name Name of the counter.
+        * @param value Amount to add.
+        */
+        void Count(
+            std::string_view name,
+            std::uint64_t value
+        )
+        {
+            if (!m_Enabled)
+                return;
+
+            std::scoped_lock lock( m_Mutex );
+
+            auto it = std::ranges::find( m_Counters, name, &Counter::m_Name );
+            if (it == m_Counters.end())
+                it = m_Counters.insert( it, Counter { std::string( name ) } );
+
+            it->m_Value += value;
+        }
+
+
+        // Gets the peak working set of the process in bytes, 0 if it cannot be queried.
+        [[nodiscard]] static std::uint64_t PeakWorkingSet() noexcept
+        {
+            PROCESS_MEMORY_COUNTERS counters {};
+
+            if (!GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ))
+                return 0;
+
+            return counters.PeakWorkingSetSize;
+        }
+
+
+        // Prints the phases, the counters and the peak working set.
+        void Print() const
+        {
+            std::scoped_lock lock( m_Mutex );
+
+            std::cout << std::format( "[PROFILE] {:<32} {:>8} {:>12}", "Phase", "Calls", "Time (ms)" ) << std::endl;
+
+            for (const auto & phase : m_Phases)
+            {
+                std::cout << std::format( "[PROFILE] {:<32} {:>8} {:>12.3f}", phase.m_Name, phase.m_Calls,
+                    std::chrono::duration<double, std::milli>( phase.m_Elapsed ).count() ) << std::endl;
+            }
+
+            for (const auto & counter : m_Counters)
+                std::cout << std::format( "[PROFILE] {:<32} {:>8}", counter.m_Name, counter.m_Value ) << std::endl;
+
+            std::cout << std::format( "[PROFILE] {:<32} {:>8} KiB", "Peak working set", PeakWorkingSet() / 1024 ) << std::endl;
+        }
+
+
+        /**
+        * @brief Saves the phases, the counters and the peak working set to a JSON file.
+        *
+        * @param path Path to the profile file.
+        * @param binary Path to the analyzed binary.
+        * @param hash Content hash of the analyzed binary.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'OutputFileCreateError' if file cannot be created.
+        * @retval 'FileWriteError' if writing fails.
+        */
+        [[nodiscard]] std::expected<void, Error> Save(
+            const fs::path & path,
+            const fs::path & binary,
+            std::uint64_t hash
+        ) const noexcept try
+        {
+            std::scoped_lock lock( m_Mutex );
+
+            json j_root = json::object();
+            json j_phases = json::array();
+            json j_counters = json::object();
+
+            for (const auto & phase : m_Phases)
+            {
+                j_phases.push_back( {
+                    { "Name", phase.m_Name },
+                    { "Calls", phase.m_Calls },
+                    { "Milliseconds", std::chrono::duration<double, std::milli>( phase.m_Elapsed ).count() }
+                    } );
+            }
+
+            for (const auto & counter : m_Counters)
+                j_counters[counter.m_Name] = counter.m_Value;
+
+            j_root["Binary"] = binary.filename().string();
+            j_root["Hash"] = std::format( "{:016x}", hash );
+            j_root["Phases"] = std::move( j_phases );
+            j_root["Counters"] = std::move( j_counters );
+            j_root["PeakWorkingSet"] = PeakWorkingSet();
+
+            std::ofstream out( path, std::ios::trunc );
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            out << j_root.dump( 4 );
+
+            if (out.fail())
+                return std::unexpected( Error::FileWriteError );
+
+            return {};
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+    };
+}
@@ -0,0 +1,234 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+namespace CEG
+{
+    // Types of CEG protected functions, the values match the 'Type' of the JSON output.
+    enum class ProtectedType : std::uint8_t
+    {
+        Constant = 1,
+        StolenV1 = 2,
+        StolenV2 = 3,
+        StolenV3 = 4
+    };
+
+
+    // A single row of the protected function table.
+    struct ProtectedEntry
+    {
+        // Protected function the row is keyed by.
+        std::uint32_t m_Func { 0 };
+
+        // Function prologue (or the function itself), EIP and breakpoint addresses.
+        std::uint32_t m_Prologue { 0 };
+        std::uint32_t m_Eip { 0 };
+        std::uint32_t m_Bp { 0 };
+
+        ProtectedType m_Type { ProtectedType::Constant };
+
+        bool operator==( const ProtectedEntry & ) const = default;
+    };
+
+
+    // Struct-of-arrays table of the CEG protected functions.
+    // Rows are appended during the analysis, then sorted and deduplicated once by 'Finalize'.
+    class ResultTable
+    {
+    private:
+
+        std::vector<std::uint32_t> m_Funcs {};
+        std::vector<std::uint32_t> m_Prologues {};
+        std::vector<std::uint32_t> m_Eips {};
+        std::vector<std::uint32_t> m_Bps {};
+        std::vector<ProtectedType> m_Types {};
+
+
+        // Keeps only the rows flagged in 'keep', preserving their order.
+        void Compact(
+            const std::vector<bool> & keep
+        ) noexcept
+        {
+            std::size_t count = 0;
+
+            for (std::size_t i = 0; i < m_Funcs.size(); ++i)
+            {
+                if (!keep[i])
+                    continue;
+
+                m_Funcs[count] = m_Funcs[i];
+                m_Prologues[count] = m_Prologues[i];
+                m_Eips[count] = m_Eips[i];
+                m_Bps[count] = m_Bps[i];
+                m_Types[count] = m_Types[i];
+                ++count;
+            }
+
+            m_Funcs.resize( count );
+            m_Prologues.resize( count );
+            m_Eips.resize( count );
+            m_Bps.resize( count );
+            m_Types.resize( count );
+        }
+
+    public:
+
+        /**
+        * @brief Appends a protected function to the table.
+        *
+        * @param entry The row to append.
+        */
+        void Append(
+            const ProtectedEntry & entry
+        )
+        {
+            m_Funcs.push_back( entry.m_Func );
+            m_Prologues.push_back( entry.m_Prologue );
+            m_Eips.push_back( entry.m_Eip );
+            m_Bps.push_back( entry.m_Bp );
+            m_Types.push_back( entry.m_Type );
+        }
+
+
+        /**
+        * @brief Sorts the rows by type, function, EIP, breakpoint and prologue, then drops duplicate rows.
+        */
+        void Finalize()
+        {
+            const auto count = m_Funcs.size();
+
+            std::vector<std::uint32_t> order( count );
+            for (std::uint32_t i = 0; i < count; ++i)
+                order[i] = i;
+
+            std::ranges::sort( order, [this]( std::uint32_t lhs, std::uint32_t rhs )
+            {
+                return std::tie( m_Types[lhs], m_Funcs[lhs], m_Eips[lhs], m_Bps[lhs], m_Prologues[lhs] ) <
+                    std::tie( m_Types[rhs], m_Funcs[rhs], m_Eips[rhs], m_Bps[rhs], m_Prologues[rhs] );
+            } );
+
+            ResultTable sorted {};
+            sorted.Reserve( count );
+
+            for (const auto i : order)
+            {
+                const auto entry = Row( i );
+
+                if (!sorted.empty() && sorted.Row( sorted.size() - 1 ) == entry)
+                    continue;
+
+                sorted.Append( entry );
+            }
+
+            *this = std::move( sorted );
+        }
+
+
+        /**
+        * @brief Removes the rows of a type whose function also appears with any of the owner types.
+        *
+        * @param type The type to remove the shadowed rows from.
+        * @param owners The types taking precedence.
+        */
+        void RemoveShadowed(
+            ProtectedType type,
+            std::initializer_list<ProtectedType> owners
+        )
+        {
+            std::vector<std::uint32_t> owned {};
+
+            for (std::size_t i = 0; i < size(); ++i)
+            {
+                if (std::ranges::find( owners, m_Types[i] ) != owners.end())
+                    owned.push_back( m_Funcs[i] );
+            }
+
+            std::ranges::sort( owned );
+
+            std::vector<bool> keep( size(), true );
+
+            for (std::size_t i = 0; i < size(); ++i)
+                keep[i] = m_Types[i] != type || !std::ranges::binary_search( owned, m_Funcs[i] );
+
+            Compact( keep );
+        }
+
+
+        /**
+        * @brief Counts the distinct functions of a type.
+        *
+        * @param type The type to count.
+        * @return Number of distinct functions, requires a finalized table.
+        */
+        [[nodiscard]] std::size_t UniqueFuncs(
+            ProtectedType type
+        ) const noexcept
+        {
+            std::size_t count = 0;
+
+            for (std::size_t i = 0; i < size(); ++i)
+            {
+                if (m_Types[i] == type && (i == 0 || m_Types[i - 1] != type || m_Funcs[i - 1] != m_Funcs[i]))
+                    ++count;
+            }
+
+            return count;
+        }
+
+
+        // Gets a single row of the table.
+        [[nodiscard]] ProtectedEntry Row(
+            std::size_t index
+        ) const noexcept
+        {
+            return { m_Funcs[index], m_Prologues[index], m_Eips[index], m_Bps[index], m_Types[index] };
+        }
+
+
+        // Reserves space for the given number of rows.
+        void Reserve(
+            std::size_t count
+        )
+        {
+            m_Funcs.reserve( count );
+            m_Prologues.reserve( count );
+            m_Eips.reserve( count );
+            m_Bps.reserve( count );
+            m_Types.reserve( count );
+        }
+
+
+        // Column views of the table.
+        [[nodiscard]] std::span<const std::uint32_t> Funcs() const noexcept { return m_Funcs; }
+        [[nodiscard]] std::span<const std::uint32_t> Prologues() const noexcept { return m_Prologues; }
+        [[nodiscard]] std::span<const std::uint32_t> Eips() const noexcept { return m_Eips; }
+        [[nodiscard]] std::span<const std::uint32_t> Bps() const noexcept { return m_Bps; }
+        [[nodiscard]] std::span<const ProtectedType> Types() const noexcept { return m_Types; }
+
+
+        // Number of rows.
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_Funcs.size();
+        }
+
+
+        // Checks if the table has no rows.
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return m_Funcs.empty();
+        }
+    };
+}
@@ -0,0 +1,633 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+#include "hash.h"
+#include "profiler.h"
+
+namespace CEG
+{
+    // Groups of CEG signatures defined inside 'patterns.h'.
+    enum class PatternGroup : std::uint8_t
+    {
+        Init,
+        Terminate,
+        RegisterThread,
+        Protect,
+        Integrity,
+        TestSecret,
+        Count
+    };
+
+
+    // Names of the signature groups, used by the stats file and the profiler.
+    inline constexpr std::array<std::string_view, static_cast<std::size_t>(PatternGroup::Count)> PATTERN_GROUP_NAMES =
+    {
+        "Init", "Terminate", "RegisterThread", "Protect", "Integrity", "TestSecret"
+    };
+
+
+    // A single pattern match reported by the multi-pattern scanner.
+    struct PatternHit
+    {
+        // Signature group the matched pattern belongs to.
+        PatternGroup m_Group { PatternGroup::Count };
+
+        // Index of the matched pattern inside its group.
+        std::uint16_t m_Index { 0 };
+
+        // Address of the match.
+        mem::pointer m_Address { nullptr };
+    };
+
+
+    // All pattern matches of a single sweep, ordered by group, pattern index and address.
+    class ScanResults
+    {
+    private:
+
+        std::vector<PatternHit> m_Hits {};
+
+    public:
+
+        ScanResults() = default;
+
+        explicit ScanResults(
+            std::vector<PatternHit> hits
+        ) : m_Hits( std::move( hits ) )
+        {
+            std::ranges::sort( m_Hits, []( const PatternHit & lhs, const PatternHit & rhs )
+            {
+                if (lhs.m_Group != rhs.m_Group)
+                    return lhs.m_Group < rhs.m_Group;
+
+                if (lhs.m_Index != rhs.m_Index)
+                    return lhs.m_Index < rhs.m_Index;
+
+                return lhs.m_Address.as<std::uintptr_t>() < rhs.m_Address.as<std::uintptr_t>();
+            } );
+        }
+
+
+        /**
+        * @brief Gets all matches of a single signature group.
+        *
+        * @param group The signature group.
+        * @return View of the group matches ordered by pattern index and address.
+        */
+        [[nodiscard]] std::span<const PatternHit> Group(
+            PatternGroup group
+        ) const noexcept
+        {
+            const auto range = std::ranges::equal_range( m_Hits, group, {}, &PatternHit::m_Group );
+            return { range.begin(), range.end() };
+        }
+
+
+        /**
+        * @brief Gets the first match of a group, preferring the patterns declared first.
+        *
+        * Mirrors the behaviour of 'FindPatternMatch'.
+        *
+        * @param group The signature group.
+        * @return 'mem::pointer' to the first match, or nullptr if no pattern matched.
+        */
+        [[nodiscard]] mem::pointer First(
+            PatternGroup group
+        ) const noexcept
+        {
+            const auto hits = Group( group );
+            return hits.empty() ? mem::pointer { nullptr } : hits.front().m_Address;
+        }
+
+
+        /**
+        * @brief Gets the first match of a group, trying the patterns in the given order.
+        *
+        * @param group The signature group.
+        * @param order Pattern indices in the order they should be tried.
+        * @return Pointer to the first match, or nullptr if no pattern matched.
+        */
+        [[nodiscard]] const PatternHit * First(
+            PatternGroup group,
+            std::span<const std::uint16_t> order
+        ) const noexcept
+        {
+            const auto hits = Group( group );
+
+            for (const auto index : order)
+            {
+                const auto it = std::ranges::lower_bound( hits, index, {}, &PatternHit::m_Index );
+
+                if (it != hits.end() && it->m_Index == index)
+                    return &*it;
+            }
+
+            return nullptr;
+        }
+
+
+        /**
+        * @brief Appends all matches of a group to a vector.
+        *
+        * Mirrors the behaviour of calling 'FindFunctions' for each pattern of the group.
+        *
+        * @param group The signature group.
+        * @param res [out] Reference to vector that will receive all found addresses.
+        */
+        void All(
+            PatternGroup group,
+            std::vector<mem::pointer> & res
+        ) const
+        {
+            for (const auto & hit : Group( group ))
+                res.push_back( hit.m_Address );
+        }
+
+
+        /**
+        * @brief Appends all matches of a group to an unordered set.
+        *
+        * @param group The signature group.
+        * @param res [out] Reference to unordered set that will receive all found addresses.
+        */
+        void All(
+            PatternGroup group,
+            std::unordered_set<mem::pointer> & res
+        ) const
+        {
+            for (const auto & hit : Group( group ))
+                res.insert( hit.m_Address );
+        }
+    };
+
+
+    // Shared anchor bucket scanner matching every registered pattern in a single sweep.
+    class MultiPatternScanner
+    {
+    private:
+
+        // A compiled pattern and its anchor position.
+        struct Entry
+        {
+            const StaticPattern * m_Pattern;
+            PatternGroup m_Group;
+            std::uint16_t m_Index;
+            std::size_t m_AnchorPos;
+        };
+
+        // Number of distinct two byte anchor keys.
+        static constexpr std::size_t ANCHOR_KEYS = 0x10000;
+
+        std::vector<Entry> m_Entries {};
+
+        // Bitset of the anchor keys used by at least one pattern.
+        std::array<std::uint64_t, ANCHOR_KEYS / 64> m_KeyFilter {};
+
+        // Nibble lookup tables of the first anchor key bytes, see 'Avx512::MatchByteClass'.
+        std::array<mem::byte, 16> m_FirstLow {};
+        std::array<mem::byte, 16> m_FirstHigh {};
+
+        // Bucket offsets into 'm_Buckets' for every anchor key.
+        std::vector<std::uint32_t> m_BucketStart {};
+
+        // Pattern entry indices grouped by their anchor key.
+        std::vector<std::uint32_t> m_Buckets {};
+
+
+        /**
+        * @brief Picks the rarest pair of adjacent solid bytes inside a pattern.
+        *
+        * @param pattern The precompiled pattern.
+        * @param frequencies A byte frequency table (lower values are rarer).
+        * @param pair [out] true if the anchor is a byte pair, false if only a single byte was found.
+        * @return The anchor position, or 'SIZE_MAX' if the pattern has no solid bytes.
+        */
+        [[nodiscard]] static std::size_t GetAnchorPos(
+            const StaticPattern & pattern,
+            const mem::byte * frequencies,
+            bool & pair
+        ) noexcept
+        {
+            const auto * bytes = pattern.bytes();
+            const auto * masks = pattern.masks();
+            const auto size = pattern.trimmed_size();
+
+            std::size_t result = SIZE_MAX;
+            std::size_t min = SIZE_MAX;
+
+            for (std::size_t i = 0; i + 1 < size; ++i)
+            {
+                if (masks[i] != 0xFF || masks[i + 1] != 0xFF)
+                    continue;
+
+                const std::size_t f = frequencies[bytes[i]] + frequencies[bytes[i + 1]];
+                if (f < min)
+                {
+                    min = f;
+                    result = i;
+                }
+            }
+
+            pair = (result != SIZE_MAX);
+            if (pair)
+                return result;
+
+            // Fall back to the rarest single solid byte.
+            return pattern.GetSkipPos( frequencies );
+        }
+
+    public:
+
+        /**
+        * @brief Registers a whole group of patterns.
+        *
+        * @param group The signature group the patterns belong to.
+        * @param patterns Container of precompiled patterns.
+        */
+        void AddGroup(
+            PatternGroup group,
+            const auto & patterns
+        )
+        {
+            std::uint16_t index = 0;
+
+            for (const auto & pattern : patterns)
+                m_Entries.push_back( Entry { &pattern, group, index++, SIZE_MAX } );
+        }
+
+
+        /**
+        * @brief Builds the anchor buckets for all registered patterns.
+        *
+        * @param frequencies A byte frequency table used to choose the anchors.
+        */
+        void Compile(
+            const mem::byte * frequencies = mem::simd_scanner::default_frequencies()
+        )
+        {
+            std::vector<std::vector<std::uint32_t>> buckets( ANCHOR_KEYS );
+            m_KeyFilter.fill( 0 );
+            m_FirstLow.fill( 0 );
+            m_FirstHigh.fill( 0 );
+
+            auto add_key = [&]( std::size_t key, std::uint32_t entry )
+            {
+                buckets[key].push_back( entry );
+                m_KeyFilter[key / 64] |= (std::uint64_t { 1 } << (key % 64));
+
+                // High nibbles share 8 buckets, a collision only adds candidates for the key filter.
+                const auto first = key & 0xFF;
+                const auto bucket = static_cast<mem::byte>(1 << ((first >> 4) % 8));
+
+                m_FirstLow[first & 0x0F] |= bucket;
+                m_FirstHigh[first >> 4] |= bucket;
+            };
+
+            for (std::uint32_t i = 0; i < m_Entries.size(); ++i)
+            {
+                auto & entry = m_Entries[i];
+
+                bool pair = false;
+                entry.m_AnchorPos = GetAnchorPos( *entry.m_Pattern, frequencies, pair );
+
+                if (entry.m_AnchorPos == SIZE_MAX)
+                    continue;
+
+                const auto * bytes = entry.m_Pattern->bytes();
+
+                if (pair)
+                    add_key( bytes[entry.m_AnchorPos] | (bytes[entry.m_AnchorPos + 1] << 8), i );
+                else
+                {
+                    // A single byte anchor matches any following byte.
+                    for (std::size_t next = 0; next < 0x100; ++next)
+                        add_key( bytes[entry.m_AnchorPos] | (next << 8), i );
+                }
+            }
+
+            // Flatten the buckets for a cache friendly lookup.
+            m_BucketStart.assign( ANCHOR_KEYS + 1, 0 );
+            m_Buckets.clear();
+
+            for (std::size_t key = 0; key < ANCHOR_KEYS; ++key)
+            {
+                m_BucketStart[key] = static_cast<std::uint32_t>(m_Buckets.size());
+                m_Buckets.insert( m_Buckets.end(), buckets[key].begin(), buckets[key].end() );
+            }
+
+            m_BucketStart[ANCHOR_KEYS] = static_cast<std::uint32_t>(m_Buckets.size());
+        }
+
+
+        /**
+        * @brief Hashes every registered pattern along with its group and index.
+        *
+        * @return XXH64 hash of the pattern set, see 'AnalysisCache::Directory'.
+        */
+        [[nodiscard]] std::uint64_t Fingerprint() const noexcept
+        {
+            Hash::Xxh64Stream stream {};
+
+            for (const auto & entry : m_Entries)
+            {
+                const std::array<std::uint64_t, 3> header { static_cast<std::uint64_t>(entry.m_Group), entry.m_Index, entry.m_Pattern->size() };
+
+                stream.Update( std::as_bytes( std::span( header ) ) );
+                stream.Update( std::as_bytes( std::span( entry.m_Pattern->bytes(), entry.m_Pattern->size() ) ) );
+                stream.Update( std::as_bytes( std::span( entry.m_Pattern->masks(), entry.m_Pattern->size() ) ) );
+            }
+
+            return stream.Digest();
+        }
+
+
+        // Gets the size of the longest registered pattern.
+        [[nodiscard]] std::size_t MaxPatternSize() const noexcept
+        {
+            std::size_t res = 0;
+
+            for (const auto & entry : m_Entries)
+                res = std::max( res, entry.m_Pattern->size() );
+
+            return res;
+        }
+
+
+        /**
+        * @brief Scans a memory region once and appends every match of every registered pattern.
+        *
+        * @param address Starting address of the memory region to search.
+        * @param size Size in bytes of the memory region to search.
+        * @param hits [out] Reference to vector that will receive the matches.
+        */
+        void ScanRegion(
+            const void * address,
+            std::size_t size,
+            std::vector<PatternHit> & hits
+        ) const
+        {
+            if (!address || size < 2 || m_BucketStart.empty())
+                return;
+
+            const auto * const base = static_cast<const mem::byte *>(address);
+
+            auto match_at = [&]( std::size_t pos )
+            {
+                const std::size_t key = base[pos] | (base[pos + 1] << 8);
+
+                if (MEM_LIKELY( !(m_KeyFilter[key / 64] & (std::uint64_t { 1 } << (key % 64))) ))
+                    return;
+
+                for (auto i = m_BucketStart[key]; i < m_BucketStart[key + 1]; ++i)
+                {
+                    const auto & entry = m_Entries[m_Buckets[i]];
+
+                    if (pos < entry.m_AnchorPos)
+                        continue;
+
+                    const std::size_t start = pos - entry.m_AnchorPos;
+                    if (entry.m_Pattern->size() > size - start)
+                        continue;
+
+                    if (entry.m_Pattern->Match( base + start ))
+                        hits.push_back( PatternHit { entry.m_Group, entry.m_Index, mem::pointer( base + start ) } );
+                }
+            };
+
+            std::size_t pos = 0;
+
+            // Only positions whose byte can start an anchor key reach the key filter.
+            if (Avx512::Supported())
+            {
+                for (; pos + 64 < size; pos += 64)
+                {
+                    auto mask = Avx512::MatchByteClass( base + pos, m_FirstLow, m_FirstHigh );
+
+                    while (mask)
+                    {
+                        match_at( pos + std::countr_zero( mask ) );
+                        mask &= mask - 1;
+                    }
+                }
+            }
+
+            for (; pos + 1 < size; ++pos)
+                match_at( pos );
+        }
+
+
+        /**
+        * @brief Scans a memory region once and reports every match of every registered pattern.
+        *
+        * @param address Starting address of the memory region to search.
+        * @param size Size in bytes of the memory region to search.
+        * @return 'ScanResults' holding all matches.
+        */
+        [[nodiscard]] ScanResults Scan(
+            const void * address,
+            std::size_t size
+        ) const
+        {
+            std::vector<PatternHit> hits {};
+            ScanRegion( address, size, hits );
+
+            return ScanResults { std::move( hits ) };
+        }
+
+
+        /**
+        * @brief Scans every executable section concurrently and reports every match of every registered pattern.
+        *
+        * @param context The analysis context holding the executable sections.
+        * @return 'ScanResults' holding all matches.
+        */
+        [[nodiscard]] ScanResults Scan(
+            const AnalysisContext & context
+        ) const
+        {
+            std::vector<std::future<std::vector<PatternHit>>> sections {};
+
+            // The first section is scanned on the calling thread.
+            for (std::size_t i = 1; i < context.m_Sections.size(); ++i)
+            {
+                sections.push_back( std::async( std::launch::async, [this, address = SectionAddress( context, context.m_Sections[i] ),
+                    size = context.m_Sections[i].m_Size]()
+                {
+                    std::vector<PatternHit> hits {};
+                    ScanRegion( address, size, hits );
+                    return hits;
+                } ) );
+            }
+
+            std::vector<PatternHit> hits {};
+
+            if (!context.m_Sections.empty())
+                ScanRegion( SectionAddress( context, context.m_Sections.front() ), context.m_Sections.front().m_Size, hits );
+
+            for (auto & section : sections)
+            {
+                auto section_hits = section.get();
+                hits.insert( hits.end(), section_hits.begin(), section_hits.end() );
+            }
+
+            return ScanResults { std::move( hits ) };
+        }
+    };
+
+
+    // Scans every signature group on its own task, as an alternative to the single sweep.
+    class GroupScanTasks
+    {
+    private:
+
+        std::array<std::shared_future<ScanResults>, static_cast<std::size_t>(PatternGroup::Count)> m_Results {};
+
+        // Receives the wall time of every group scan, must outlive the tasks.
+        Profiler & m_Profiler;
+
+
+        // Memory regions of the executable sections, copied so the tasks do not depend on the context.
+        [[nodiscard]] static std::vector<mem::region> SectionRegions(
+            const AnalysisContext & context
+        )
+        {
+            std::vector<mem::region> regions {};
+
+            for (const auto & section : context.m_Sections)
+                regions.emplace_back( SectionAddress( context, section ), section.m_Size );
+
+            return regions;
+        }
+
+    public:
+
+        explicit GroupScanTasks(
+            Profiler & profiler
+        ) : m_Profiler( profiler )
+        {
+        }
+
+
+        /**
+        * @brief Starts scanning a whole group of patterns on a separate task.
+        *
+        * @param group The signature group the patterns belong to.
+        * @param patterns Container of precompiled patterns, must outlive the task.
+        * @param context The analysis context holding the executable sections to search.
+        * @param frequencies A byte frequency table used to choose the anchors, must outlive the task.
+        */
+        void Launch(
+            PatternGroup group,
+            const auto & patterns,
+            const AnalysisContext & context,
+            const mem::byte * frequencies = mem::simd_default_frequencies
+        )
+        {
+            m_Results[static_cast<std::size_t>(group)] = std::async( std::launch::async,
+                [&profiler = m_Profiler, group, &patterns, regions = SectionRegions( context ), frequencies]()
+            {
+                const auto name = std::format( "Scan {}", PATTERN_GROUP_NAMES[static_cast<std::size_t>(group)] );
+                const auto phase = profiler.Measure( name );
+
+                std::vector<PatternHit> hits {};
+                std::vector<mem::pointer> matches {};
+                std::uint16_t index = 0;
+
+                for (const auto & pattern : patterns)
+                {
+                    const auto anchors = pattern.GetAnchors( frequencies );
+
+                    matches.clear();
+                    for (const auto & region : regions)
+                        pattern.ScanAll( region, matches, anchors );
+
+                    for (const auto & match : matches)
+                        hits.push_back( PatternHit { group, index, match } );
+
+                    ++index;
+                }
+
+                return ScanResults { std::move( hits ) };
+            } ).share();
+        }
+
+
+        /**
+        * @brief Starts searching a group of patterns for its first match on a separate task.
+        *
+        * The patterns are tried in the given order and the task stops at the first one that matches.
+        *
+        * @param group The signature group the patterns belong to.
+        * @param patterns Container of precompiled patterns, must outlive the task.
+        * @param order Pattern indices in the order they should be tried.
+        * @param context The analysis context holding the executable sections to search.
+        * @param frequencies A byte frequency table used to choose the anchors, must outlive the task.
+        */
+        void LaunchFirst(
+            PatternGroup group,
+            const auto & patterns,
+            std::vector<std::uint16_t> order,
+            const AnalysisContext & context,
+            const mem::byte * frequencies = mem::simd_default_frequencies
+        )
+        {
+            m_Results[static_cast<std::size_t>(group)] = std::async( std::launch::async,
+                [&profiler = m_Profiler, group, &patterns, order = std::move( order ), regions = SectionRegions( context ), frequencies]()
+            {
+                const auto name = std::format( "Scan {}", PATTERN_GROUP_NAMES[static_cast<std::size_t>(group)] );
+                const auto phase = profiler.Measure( name );
+
+                std::vector<PatternHit> hits {};
+
+                // A pattern is tried on every section before the next one.
+                for (const auto index : order)
+                {
+                    if (index >= std::size( patterns ))
+                        continue;
+
+                    const auto & pattern = patterns[index];
+                    const auto anchors = pattern.GetAnchors( frequencies );
+
+                    for (const auto & region : regions)
+                    {
+                        if (auto match = pattern.Scan( region, anchors ))
+                        {
+                            hits.push_back( PatternHit { group, index, match } );
+                            return ScanResults { std::move( hits ) };
+                        }
+                    }
+                }
+
+                return ScanResults { std::move( hits ) };
+            } ).share();
+        }
+
+
+        /**
+        * @brief Waits for a group scan to finish.
+        *
+        * @param group The signature group.
+        * @return Reference to the 'ScanResults' of the group.
+        */
+        [[nodiscard]] const ScanResults & Results(
+            PatternGroup group
+        ) const
+        {
+            return m_Results[static_cast<std::size_t>(group)].get();
+        }
+    };
+}
@@ -0,0 +1,586 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+namespace CEG
+{
+    // Maximum number of bytes a compile time pattern can hold.
+    inline constexpr std::size_t MAX_PATTERN_SIZE = 160;
+
+    // Minimum length of the longest solid run for the Horspool backend.
+    inline constexpr std::size_t HORSPOOL_MIN_RUN = 10;
+
+    // Anchor frequency from which the anchor is considered too common for 'mem::find_byte'.
+    inline constexpr mem::byte HORSPOOL_COMMON_ANCHOR = 0xC0;
+
+
+    // Search algorithms a pattern can be scanned with.
+    enum class ScanBackend : std::uint8_t
+    {
+        Anchor,     // 'mem::find_byte' on the rarest solid byte (a byte pair with AVX-512), then a full match
+        Horspool    // Boyer-Moore-Horspool over the longest solid run, then a full match
+    };
+
+    // Anchor byte positions of a pattern for a given frequency table.
+    struct ScanAnchors
+    {
+        // Position of the rarest solid byte.
+        std::size_t m_SkipPos { SIZE_MAX };
+
+        // Position of the second rarest solid byte.
+        std::size_t m_PairPos { SIZE_MAX };
+    };
+
+    // A byte pattern parsed at compile time, with no heap allocation at scan time.
+    class StaticPattern
+    {
+    private:
+
+        // Pattern bytes, already masked.
+        std::array<mem::byte, MAX_PATTERN_SIZE> m_Bytes {};
+
+        // Pattern masks ('0x00' for wildcards, '0xFF' for solid bytes).
+        std::array<mem::byte, MAX_PATTERN_SIZE> m_Masks {};
+
+        // Length of the pattern including trailing wildcards.
+        std::size_t m_Size { 0 };
+
+        // Length of the pattern without trailing wildcards.
+        std::size_t m_TrimmedSize { 0 };
+
+        // Position of the rarest solid byte according to the default frequencies.
+        std::size_t m_SkipPos { SIZE_MAX };
+
+        // Position of the second rarest solid byte, paired with 'm_SkipPos' by the AVX-512 search.
+        std::size_t m_PairPos { SIZE_MAX };
+
+        // Start and length of the longest run of solid bytes.
+        std::size_t m_RunStart { 0 };
+        std::size_t m_RunSize { 0 };
+
+        // Horspool bad character shifts of the longest solid run.
+        std::array<mem::byte, 0x100> m_Shifts {};
+
+        // Backend picked by 'SelectBackend'.
+        ScanBackend m_Backend { ScanBackend::Anchor };
+
+
+        /**
+        * @brief Picks the scan backend from the pattern shape.
+        *
+        * The vectorized anchor search is faster as long as the rarest solid byte is actually rare.
+        * 'Horspool' only wins for long solid runs when even the rarest byte is common, so the
+        * anchor search keeps stopping on false candidates.
+        *
+        * @param frequencies A byte frequency table (lower values are rarer).
+        * @return The selected backend.
+        */
+        [[nodiscard]] constexpr ScanBackend SelectBackend(
+            const mem::byte * frequencies
+        ) const noexcept
+        {
+            if (m_RunSize < HORSPOOL_MIN_RUN || m_SkipPos == SIZE_MAX)
+                return ScanBackend::Anchor;
+
+            return frequencies[m_Bytes[m_SkipPos]] >= HORSPOOL_COMMON_ANCHOR ?
+                ScanBackend::Horspool : ScanBackend::Anchor;
+        }
+
+    public:
+
+        /**
+        * @brief Parses a pattern string such as "55 8B EC ?? ??" at compile time.
+        *
+        * Malformed patterns are rejected during compilation.
+        *
+        * @param text The pattern string literal.
+        */
+        template<std::size_t N>
+        consteval StaticPattern(
+            const char( &text )[N]
+        )
+        {
+            std::size_t i = 0;
+
+            while (i < N - 1)
+            {
+                if (text[i] == ' ')
+                {
+                    ++i;
+                    continue;
+                }
+
+                if (m_Size >= MAX_PATTERN_SIZE)
+                    throw "Pattern exceeds 'MAX_PATTERN_SIZE'.";
+
+                if (text[i] == '?')
+                {
+                    ++i;
+                    if (i < N - 1 && text[i] == '?')
+                        ++i;
+
+                    m_Bytes[m_Size] = 0x00;
+                    m_Masks[m_Size] = 0x00;
+                }
+                else
+                {
+                    const int high = mem::xctoi( text[i] );
+                    const int low = (i + 1 < N - 1) ? mem::xctoi( text[i + 1] ) : -1;
+
+                    if (high == -1 || low == -1)
+                        throw "Invalid pattern byte.";
+
+                    i += 2;
+
+                    m_Bytes[m_Size] = static_cast<mem::byte>((high << 4) | low);
+                    m_Masks[m_Size] = 0xFF;
+                }
+
+                ++m_Size;
+            }
+
+            m_TrimmedSize = m_Size;
+            while (m_TrimmedSize && m_Masks[m_TrimmedSize - 1] == 0x00)
+                --m_TrimmedSize;
+
+            if (!m_TrimmedSize)
+                throw "Pattern has no solid bytes.";
+
+            m_SkipPos = GetSkipPos( mem::simd_default_frequencies );
+            m_PairPos = GetPairPos( mem::simd_default_frequencies, m_SkipPos );
+
+            // Find the longest solid run.
+            for (std::size_t start = 0; start < m_TrimmedSize;)
+            {
+                if (m_Masks[start] != 0xFF)
+                {
+                    ++start;
+                    continue;
+                }
+
+                std::size_t end = start;
+                while (end < m_TrimmedSize && m_Masks[end] == 0xFF)
+                    ++end;
+
+                if (end - start > m_RunSize)
+                {
+                    m_RunStart = start;
+                    m_RunSize = end - start;
+                }
+
+                start = end;
+            }
+
+            m_Shifts.fill( static_cast<mem::byte>(m_RunSize) );
+            for (std::size_t i = 0; i + 1 < m_RunSize; ++i)
+                m_Shifts[m_Bytes[m_RunStart + i]] = static_cast<mem::byte>(m_RunSize - 1 - i);
+
+            m_Backend = SelectBackend( mem::simd_default_frequencies );
+        }
+
+
+        // Pointer to the pattern bytes.
+        [[nodiscard]] constexpr const mem::byte * bytes() const noexcept
+        {
+            return m_Bytes.data();
+        }
+
+
+        // Pointer to the pattern masks.
+        [[nodiscard]] constexpr const mem::byte * masks() const noexcept
+        {
+            return m_Masks.data();
+        }
+
+
+        // Length of the pattern including trailing wildcards.
+        [[nodiscard]] constexpr std::size_t size() const noexcept
+        {
+            return m_Size;
+        }
+
+
+        // Length of the pattern without trailing wildcards.
+        [[nodiscard]] constexpr std::size_t trimmed_size() const noexcept
+        {
+            return m_TrimmedSize;
+        }
+
+
+        // Precomputed position of the rarest solid byte.
+        [[nodiscard]] constexpr std::size_t skip_pos() const noexcept
+        {
+            return m_SkipPos;
+        }
+
+
+        // Length of the longest solid run.
+        [[nodiscard]] constexpr std::size_t run_size() const noexcept
+        {
+            return m_RunSize;
+        }
+
+
+        // Backend used by the default 'Scan'.
+        [[nodiscard]] constexpr ScanBackend backend() const noexcept
+        {
+            return m_Backend;
+        }
+
+
+        /**
+        * @brief Finds the rarest solid byte of the pattern.
+        *
+        * @param frequencies A byte frequency table (lower values are rarer).
+        * @return The position of the rarest solid byte, or 'SIZE_MAX' if there is none.
+        */
+        [[nodiscard]] constexpr std::size_t GetSkipPos(
+            const mem::byte * frequencies
+        ) const noexcept
+        {
+            std::size_t min = SIZE_MAX;
+            std::size_t result = SIZE_MAX;
+
+            for (std::size_t i = 0; i < m_Size; ++i)
+            {
+                if (m_Masks[i] != 0xFF)
+                    continue;
+
+                const std::size_t f = frequencies[m_Bytes[i]];
+                if (f <= min)
+                {
+                    result = i;
+                    min = f;
+                }
+            }
+
+            return result;
+        }
+
+
+        /**
+        * @brief Finds the rarest solid byte of the pattern apart from a given position.
+        *
+        * @param frequencies A byte frequency table (lower values are rarer).
+        * @param skip_pos Position to exclude.
+        * @return The position of the rarest remaining solid byte, or 'SIZE_MAX' if there is none.
+        */
+        [[nodiscard]] constexpr std::size_t GetPairPos(
+            const mem::byte * frequencies,
+            std::size_t skip_pos
+        ) const noexcept
+        {
+            std::size_t min = SIZE_MAX;
+            std::size_t result = SIZE_MAX;
+
+            for (std::size_t i = 0; i < m_Size; ++i)
+            {
+                if (m_Masks[i] != 0xFF || i == skip_pos)
+                    continue;
+
+                const std::size_t f = frequencies[m_Bytes[i]];
+                if (f <= min)
+                {
+                    result = i;
+                    min = f;
+                }
+            }
+
+            return result;
+        }
+
+
+        /**
+        * @brief Picks the anchor bytes of the pattern for a frequency table.
+        *
+        * @param frequencies A byte frequency table (lower values are rarer).
+        * @return The anchor positions.
+        */
+        [[nodiscard]] constexpr ScanAnchors GetAnchors(
+            const mem::byte * frequencies
+        ) const noexcept
+        {
+            const auto skip_pos = GetSkipPos( frequencies );
+            return ScanAnchors { skip_pos, GetPairPos( frequencies, skip_pos ) };
+        }
+
+
+        /**
+        * @brief Checks the pattern against the given memory.
+        *
+        * @param current Pointer to the candidate match.
+        * @return true if all solid bytes match.
+        */
+        [[nodiscard]] bool Match(
+            const mem::byte * current
+        ) const noexcept
+        {
+            for (std::size_t i = m_TrimmedSize; i--;)
+            {
+                if ((current[i] & m_Masks[i]) != m_Bytes[i])
+                    return false;
+            }
+
+            return true;
+        }
+
+
+        /**
+        * @brief Searches for the first occurrence of the pattern within a memory region.
+        *
+        * @param range The memory region to search.
+        * @param skip_pos Position of the anchor byte searched with 'mem::find_byte'.
+        * @return 'mem::pointer' pointing to the match, or nullptr if not found.
+        */
+        [[nodiscard]] mem::pointer Scan(
+            mem::region range,
+            std::size_t skip_pos
+        ) const noexcept
+        {
+            if (!m_TrimmedSize || m_Size > range.size)
+                return nullptr;
+
+            const auto * current = range.start.as<const mem::byte *>();
+            const auto * const end = current + range.size - m_Size + 1;
+
+            if (skip_pos == SIZE_MAX)
+            {
+                for (; current < end; ++current)
+                {
+                    if (Match( current ))
+                        return current;
+                }
+
+                return nullptr;
+            }
+
+            const auto anchor = m_Bytes[skip_pos];
+
+            while (MEM_LIKELY( current < end ))
+            {
+                if (Match( current ))
+                    return current;
+
+                ++current;
+                current = mem::find_byte( current + skip_pos, anchor, static_cast<std::size_t>(end - current) ) - skip_pos;
+            }
+
+            return nullptr;
+        }
+
+
+        /**
+        * @brief Searches for the first occurrence with the AVX-512 byte pair search.
+        *
+        * Candidates must hold both the rarest and the second rarest solid byte, which drops
+        * most of the false candidates a single anchor stops on.
+        *
+        * @param range The memory region to search.
+        * @param anchors Positions of the two solid bytes to search for.
+        * @return 'mem::pointer' pointing to the match, or nullptr if not found.
+        */
+        [[nodiscard]] mem::pointer ScanPair(
+            mem::region range,
+            const ScanAnchors & anchors
+        ) const noexcept
+        {
+            if (anchors.m_SkipPos == SIZE_MAX || anchors.m_PairPos == SIZE_MAX || m_Size > range.size)
+                return nullptr;
+
+            const auto * current = range.start.as<const mem::byte *>();
+            const auto * const end = current + range.size - m_Size + 1;
+
+            const auto first = std::min( anchors.m_SkipPos, anchors.m_PairPos );
+            const auto second = std::max( anchors.m_SkipPos, anchors.m_PairPos );
+
+            while (MEM_LIKELY( current < end ))
+            {
+                current = Avx512::FindBytePair( current + first, static_cast<std::size_t>(end - current),
+                    m_Bytes[first], m_Bytes[second], second - first ) - first;
+
+                if (current >= end)
+                    return nullptr;
+
+                if (Match( current ))
+                    return current;
+
+                ++current;
+            }
+
+            return nullptr;
+        }
+
+
+        /**
+        * @brief Searches for the first occurrence with Boyer-Moore-Horspool over the longest solid run.
+        *
+        * @param range The memory region to search.
+        * @return 'mem::pointer' pointing to the match, or nullptr if not found.
+        */
+        [[nodiscard]] mem::pointer ScanHorspool(
+            mem::region range
+        ) const noexcept
+        {
+            if (!m_RunSize || m_Size > range.size)
+                return nullptr;
+
+            const auto * current = range.start.as<const mem::byte *>();
+            const auto * const last = current + range.size - m_Size;
+
+            const auto * const run = m_Bytes.data() + m_RunStart;
+            const auto run_last = m_RunSize - 1;
+
+            while (current <= last)
+            {
+                const auto value = current[m_RunStart + run_last];
+
+                if (value == run[run_last] && !std::memcmp( current + m_RunStart, run, run_last ) && Match( current ))
+                    return current;
+
+                current += m_Shifts[value];
+            }
+
+            return nullptr;
+        }
+
+
+        /**
+        * @brief Searches for the first occurrence with the anchor search on the given anchors.
+        *
+        * @param range The memory region to search.
+        * @param anchors The anchor positions, the byte pair search is used if AVX-512 is available.
+        * @return 'mem::pointer' pointing to the match, or nullptr if not found.
+        */
+        [[nodiscard]] mem::pointer ScanAnchored(
+            mem::region range,
+            const ScanAnchors & anchors
+        ) const noexcept
+        {
+            if (anchors.m_PairPos != SIZE_MAX && Avx512::Supported())
+                return ScanPair( range, anchors );
+
+            return Scan( range, anchors.m_SkipPos );
+        }
+
+
+        /**
+        * @brief Searches for the first occurrence with the given backend.
+        *
+        * @param range The memory region to search.
+        * @param backend The backend to use.
+        * @return 'mem::pointer' pointing to the match, or nullptr if not found.
+        */
+        [[nodiscard]] mem::pointer Scan(
+            mem::region range,
+            ScanBackend backend
+        ) const noexcept
+        {
+            if (backend == ScanBackend::Horspool)
+                return ScanHorspool( range );
+
+            return ScanAnchored( range, ScanAnchors { m_SkipPos, m_PairPos } );
+        }
+
+
+        /**
+        * @brief Searches for the first occurrence using the selected backend, with anchors from 'GetAnchors'.
+        *
+        * @param range The memory region to search.
+        * @param anchors The anchor positions used if the anchor backend is selected.
+        * @return 'mem::pointer' pointing to the match, or nullptr if not found.
+        */
+        [[nodiscard]] mem::pointer Scan(
+            mem::region range,
+            const ScanAnchors & anchors
+        ) const noexcept
+        {
+            if (m_Backend == ScanBackend::Horspool)
+                return ScanHorspool( range );
+
+            return ScanAnchored( range, anchors );
+        }
+
+
+        /**
+        * @brief Searches for the first occurrence using the selected backend.
+        *
+        * @param range The memory region to search.
+        * @return 'mem::pointer' pointing to the match, or nullptr if not found.
+        */
+        [[nodiscard]] mem::pointer Scan(
+            mem::region range
+        ) const noexcept
+        {
+            return Scan( range, m_Backend );
+        }
+
+
+        /**
+        * @brief Searches for all occurrences of the pattern and appends them to a vector.
+        *
+        * @param range The memory region to search.
+        * @param res [out] Reference to vector that will receive all found addresses.
+        * @param backend The backend to use.
+        */
+        void ScanAll(
+            mem::region range,
+            std::vector<mem::pointer> & res,
+            ScanBackend backend
+        ) const
+        {
+            while (auto result = Scan( range, backend ))
+            {
+                res.push_back( result );
+                range = range.sub_region( result + 1 );
+            }
+        }
+
+
+        /**
+        * @brief Searches for all occurrences of the pattern using the selected backend and the given anchors.
+        *
+        * @param range The memory region to search.
+        * @param res [out] Reference to vector that will receive all found addresses.
+        * @param anchors The anchor positions used if the anchor backend is selected.
+        */
+        void ScanAll(
+            mem::region range,
+            std::vector<mem::pointer> & res,
+            const ScanAnchors & anchors
+        ) const
+        {
+            while (auto result = Scan( range, anchors ))
+            {
+                res.push_back( result );
+                range = range.sub_region( result + 1 );
+            }
+        }
+
+
+        /**
+        * @brief Searches for all occurrences of the pattern using the selected backend.
+        *
+        * @param range The memory region to search.
+        * @param res [out] Reference to vector that will receive all found addresses.
+        */
+        void ScanAll(
+            mem::region range,
+            std::vector<mem::pointer> & res
+        ) const
+        {
+            ScanAll( range, res, m_Backend );
+        }
+    };
+}
@@ -0,0 +1,362 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "scanner.h"
+#include "hash.h"
+
+namespace CEG
+{
+    // File read into memory with overlapped chunked reads, as an alternative to 'MappedFile'.
+    class StreamedFile
+    {
+    private:
+
+        // Size of a single read request.
+        static constexpr std::size_t CHUNK_SIZE = 0x400000;
+
+        // Number of read requests kept in flight, the next chunk is read while the previous one is processed.
+        static constexpr std::size_t IN_FLIGHT = 2;
+
+        HANDLE m_File { INVALID_HANDLE_VALUE };
+        std::byte * m_View { nullptr };
+        std::size_t m_Size { 0 };
+
+
+        // Releases the buffer and closes the file.
+        void Close() noexcept
+        {
+            if (m_View)
+                VirtualFree( m_View, 0, MEM_RELEASE );
+
+            if (m_File != INVALID_HANDLE_VALUE)
+                CloseHandle( m_File );
+
+            m_View = nullptr;
+            m_File = INVALID_HANDLE_VALUE;
+            m_Size = 0;
+        }
+
+    public:
+
+        StreamedFile() = default;
+
+        StreamedFile( const StreamedFile & ) = delete;
+        StreamedFile & operator=( const StreamedFile & ) = delete;
+
+        StreamedFile(
+            StreamedFile && other
+        ) noexcept : m_File( std::exchange( other.m_File, INVALID_HANDLE_VALUE ) ),
+            m_View( std::exchange( other.m_View, nullptr ) ),
+            m_Size( std::exchange( other.m_Size, 0 ) )
+        {
+        }
+
+        StreamedFile & operator=(
+            StreamedFile && other
+        ) noexcept
+        {
+            if (this != &other)
+            {
+                Close();
+
+                m_File = std::exchange( other.m_File, INVALID_HANDLE_VALUE );
+                m_View = std::exchange( other.m_View, nullptr );
+                m_Size = std::exchange( other.m_Size, 0 );
+            }
+
+            return *this;
+        }
+
+        ~StreamedFile()
+        {
+            Close();
+        }
+
+
+        /**
+        * @brief Opens a file and allocates the buffer receiving its content, nothing is read yet.
+        *
+        * @param path The path to the file to read.
+        * @return 'Result<StreamedFile>' containing the opened file or an error.
+        * @retval 'FileNotFound' if the file cannot be opened.
+        * @retval 'EmptyContent' if the file is empty.
+        * @retval 'FileReadError' if the buffer cannot be allocated.
+        */
+        [[nodiscard]] static Result<StreamedFile> Open(
+            const fs::path & path
+        ) noexcept
+        {
+            StreamedFile file {};
+
+            file.m_File = CreateFileW( path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED, nullptr );
+
+            if (file.m_File == INVALID_HANDLE_VALUE)
+                return std::unexpected( Error::FileNotFound );
+
+            LARGE_INTEGER size {};
+            if (!GetFileSizeEx( file.m_File, &size ))
+                return std::unexpected( Error::FileReadError );
+
+            if (size.QuadPart == 0)
+                return std::unexpected( Error::EmptyContent );
+
+            // Committed pages are zeroed on first touch, so the buffer is not cleared up front.
+            file.m_Size = static_cast<std::size_t>(size.QuadPart);
+            file.m_View = static_cast<std::byte *>(VirtualAlloc( nullptr, file.m_Size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE ));
+
+            if (!file.m_View)
+                return std::unexpected( Error::FileReadError );
+
+            return file;
+        }
+
+
+        /**
+        * @brief Reads the whole file, handing out every chunk in order as soon as it arrives.
+        *
+        * The following chunks are read while a chunk is processed.
+        *
+        * @param on_chunk Called with the number of leading bytes read so far, 'bool( std::size_t )'.
+        * Returning false stops the read.
+        * @return 'std::expected<void, Error>' Either success or specific error.
+        * @retval 'FileReadError' if a read fails or the callback throws.
+        */
+        template<typename F>
+        [[nodiscard]] std::expected<void, Error> Read(
+            F && on_chunk
+        ) noexcept
+        {
+            std::array<OVERLAPPED, IN_FLIGHT> requests {};
+            std::array<HANDLE, IN_FLIGHT> events {};
+
+            for (auto & event : events)
+            {
+                event = CreateEventW( nullptr, TRUE, FALSE, nullptr );
+
+                if (!event)
+                {
+                    for (const auto created : events)
+                    {
+                        if (created)
+                            CloseHandle( created );
+                    }
+
+                    return std::unexpected( Error::FileReadError );
+                }
+            }
+
+            const auto chunks = (m_Size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            std::size_t issued = 0;
+            std::size_t completed = 0;
+
+            // Lambda function to get the length of a chunk.
+            auto chunk_length = [this]( std::size_t chunk )
+            {
+                return static_cast<DWORD>(std::min( CHUNK_SIZE, m_Size - chunk * CHUNK_SIZE ));
+            };
+
+            // Lambda function to start the read of the next chunk.
+            auto issue = [&]() -> bool
+            {
+                const auto offset = static_cast<std::uint64_t>(issued) * CHUNK_SIZE;
+                auto & request = requests[issued % IN_FLIGHT];
+
+                request = OVERLAPPED {};
+                request.Offset = static_cast<DWORD>(offset);
+                request.OffsetHigh = static_cast<DWORD>(offset >> 32);
+                request.hEvent = events[issued % IN_FLIGHT];
+
+                if (!ReadFile( m_File, m_View + offset, chunk_length( issued ), nullptr, &request ) && GetLastError() != ERROR_IO_PENDING)
+                    return false;
+
+                ++issued;
+                return true;
+            };
+
+            bool success = true;
+
+            while (success && issued < std::min( chunks, IN_FLIGHT ))
+                success = issue();
+
+            while (success && completed < chunks)
+            {
+                DWORD read = 0;
+                success = GetOverlappedResult( m_File, &requests[completed % IN_FLIGHT], &read, TRUE ) && read == chunk_length( completed );
+
+                if (!success)
+                    break;
+
+                ++completed;
+
+                // The slot of the finished request takes the next chunk before this one is processed.
+                if (issued < chunks)
+                    success = issue();
+
+                try
+                {
+                    if (success && !on_chunk( std::min( m_Size, completed * CHUNK_SIZE ) ))
+                        break;
+                }
+                catch (...)
+                {
+                    success = false;
+                }
+            }
+
+            // The requests still in flight have to finish before their 'OVERLAPPED' goes out of scope.
+            if (completed < issued)
+            {
+                CancelIoEx( m_File, nullptr );
+
+                for (; completed < issued; ++completed)
+                {
+                    DWORD read = 0;
+                    GetOverlappedResult( m_File, &requests[completed % IN_FLIGHT], &read, TRUE );
+                }
+            }
+
+            for (const auto event : events)
+                CloseHandle( event );
+
+            if (!success)
+                return std::unexpected( Error::FileReadError );
+
+            return {};
+        }
+
+
+        // View of the buffer, only the bytes reported by 'Read' hold the file content.
+        [[nodiscard]] std::span<std::byte> bytes() const noexcept
+        {
+            return { m_View, m_Size };
+        }
+
+
+        // Size of the file.
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_Size;
+        }
+    };
+
+
+    /**
+    * @brief Streams a binary, loads its image once the headers arrive and scans every executable section
+    * while the rest of the file is still being read.
+    *
+    * A match is only reported once every byte it may cover has arrived, so consecutive chunks overlap
+    * by the longest pattern and the results are identical to 'MultiPatternScanner::Scan'.
+    *
+    * @param file The opened binary.
+    * @param context [out] The analysis context receiving the PE geometry, see 'LoadBinaryImage'.
+    * @param scanner The compiled scanner.
+    * @param address [out] Reference to pointer that will receive the first executable section address.
+    * @param size [out] The first executable section size.
+    * @param hash [out] XXH64 hash of the binary before the ASLR header change.
+    * @return 'Result<ScanResults>' holding all matches or an error.
+    */
+    [[nodiscard]] Result<ScanResults> StreamBinaryImage(
+        StreamedFile & file,
+        AnalysisContext & context,
+        const MultiPatternScanner & scanner,
+        void *& address,
+        std::uint32_t & size,
+        std::uint64_t & hash
+    ) noexcept try
+    {
+        const auto content = file.bytes();
+        const auto overlap = std::max<std::size_t>( scanner.MaxPatternSize(), 1 ) - 1;
+
+        std::optional<Error> load_error {};
+        bool loaded = false;
+
+        // Every chunk is hashed as it arrives, so the hash is ready along with the last one.
+        Hash::Xxh64Stream stream {};
+        std::size_t hashed = 0;
+
+        // Section offsets up to which every match was reported.
+        std::vector<std::uint32_t> scanned {};
+        std::vector<PatternHit> hits {};
+
+        auto read_res = file.Read( [&]( std::size_t available ) -> bool
+        {
+            // Hashed before 'LoadBinaryImage' clears the ASLR flag, the hash covers the original bytes.
+            stream.Update( content.subspan( hashed, available - hashed ) );
+            hashed = available;
+
+            if (!loaded)
+            {
+                if (auto load_res = LoadBinaryImage( context, content, address, size ); !load_res)
+                {
+                    load_error = load_res.error();
+                    return false;
+                }
+
+                loaded = true;
+                scanned.assign( context.m_Sections.size(), 0 );
+            }
+
+            for (std::size_t i = 0; i < context.m_Sections.size(); ++i)
+            {
+                const auto & section = context.m_Sections[i];
+
+                if (available <= section.m_RawDataPointer)
+                    continue;
+
+                const auto arrived = available - section.m_RawDataPointer;
+
+                // Matches starting in front of the limit cannot reach the bytes still being read.
+                const auto limit = arrived >= section.m_Size ? section.m_Size :
+                    static_cast<std::uint32_t>(arrived > overlap ? arrived - overlap : 0);
+
+                if (limit <= scanned[i])
+                    continue;
+
+                const auto * data = static_cast<const mem::byte *>(SectionAddress( context, section ));
+                const auto first = hits.size();
+
+                scanner.ScanRegion( data + scanned[i], std::min<std::size_t>( section.m_Size, limit + overlap ) - scanned[i], hits );
+
+                // Matches starting past the limit are reported again by the next chunk.
+                const auto [erase_first, erase_last] = std::ranges::remove_if( hits.begin() + first, hits.end(),
+                    [&]( const PatternHit & hit )
+                {
+                    return hit.m_Address.as<const mem::byte *>() >= data + limit;
+                } );
+
+                hits.erase( erase_first, erase_last );
+                scanned[i] = limit;
+            }
+
+            return true;
+        } );
+
+        if (load_error)
+            return std::unexpected( *load_error );
+
+        if (!read_res)
+            return std::unexpected( read_res.error() );
+
+        hash = stream.Digest();
+
+        return ScanResults { std::move( hits ) };
+    }
+    catch (...)
+    {
+        return std::unexpected( Error::FileReadError );
+    }
+}
@@ -0,0 +1,243 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "utils.h"
+
+#include <fstream>
+
+namespace CEG
+{
+    // Converts the 'noceg_trace_<pid>_<tid>.bin' files written by the runtime library to the Chrome trace JSON,
+    // which both 'chrome://tracing' and Perfetto open.
+    class TraceExport
+    {
+    private:
+
+        // Magic value of the trace header, 'NCT1'.
+        static constexpr std::uint32_t TRACE_MAGIC = 0x3154434E;
+
+        // Flag of an event which resolved the entry.
+        static constexpr std::uint32_t TRACE_RESOLVED = 1 << 0;
+
+        // Flag of a single-step which reached the targeted CEG function.
+        static constexpr std::uint32_t TRACE_TARGET = 1 << 1;
+
+        // Layout of the runtime library, see 'EventTracer'.
+        struct Header
+        {
+            std::uint32_t m_Magic { 0 };
+            std::uint32_t m_RecordSize { 0 };
+            std::uint32_t m_ProcessId { 0 };
+            std::uint32_t m_ThreadId { 0 };
+            std::int64_t m_Frequency { 0 };
+            std::uint32_t m_Capacity { 0 };
+            std::uint32_t m_Count { 0 };
+            std::uint32_t m_Dropped { 0 };
+            std::array<std::uint32_t, 7> m_Reserved {};
+        };
+
+        struct Record
+        {
+            std::int64_t m_Time { 0 };
+            std::uint32_t m_ThreadId { 0 };
+            std::uint32_t m_Code { 0 };
+            std::uint32_t m_Eip { 0 };
+            std::uint32_t m_Eax { 0 };
+            std::uint32_t m_Index { 0 };
+            std::uint32_t m_Flags { 0 };
+        };
+
+        static_assert(sizeof( Header ) == 64 && sizeof( Record ) == 32);
+
+        // The records of a single thread.
+        struct ThreadTrace
+        {
+            Header m_Header {};
+            std::vector<Record> m_Records {};
+        };
+
+
+        // Names the exception codes raised during the resolution.
+        [[nodiscard]] static std::string EventName(
+            std::uint32_t code
+        )
+        {
+            switch (code)
+            {
+                case 0xCEADDEAD:
+                    return "Redirect";
+
+                case 0x80000003:
+                    return "Breakpoint";
+
+                case 0x80000004:
+                    return "SingleStep";
+
+                case 0xC000001D:
+                    return "IllegalInstruction";
+            }
+
+            return std::format( "0x{:08X}", code );
+        }
+
+
+        /**
+        * @brief Reads a single trace file.
+        *
+        * @param path Path to the trace file.
+        * @return The trace, or 'std::nullopt' if the file is not a trace.
+        */
+        [[nodiscard]] static std::optional<ThreadTrace> ReadTrace(
+            const fs::path & path
+        )
+        {
+            std::ifstream in { path, std::ios::binary };
+            ThreadTrace trace {};
+
+            if (!in.read( reinterpret_cast<char *>(&trace.m_Header), sizeof( Header ) ) ||
+                trace.m_Header.m_Magic != TRACE_MAGIC || trace.m_Header.m_RecordSize != sizeof( Record ) || trace.m_Header.m_Frequency <= 0)
+                return std::nullopt;
+
+            // A file of a crashed process holds the records published before the crash.
+            trace.m_Records.resize( std::min( trace.m_Header.m_Count, trace.m_Header.m_Capacity ) );
+            in.read( reinterpret_cast<char *>(trace.m_Records.data()), static_cast<std::streamsize>(trace.m_Records.size() * sizeof( Record )) );
+            trace.m_Records.resize( static_cast<std::size_t>(in.gcount()) / sizeof( Record ) );
+
+            return trace;
+        }
+
+    public:
+
+        /**
+        * @brief Converts every trace file of a directory to a single Chrome trace.
+        *
+        * Every exception becomes an instant event of its thread, and the time between the custom exception
+        * and the breakpoint hit of an entry becomes a slice named after the entry.
+        *
+        * @param directory Directory holding the trace files.
+        * @param output Path to the written JSON.
+        * @return 'Result<std::size_t>' containing the number of the converted events or an error.
+        * @retval 'NoTraceFiles' if the directory holds no trace file.
+        * @retval 'OutputFileCreateError' if the output cannot be created.
+        * @retval 'FileWriteError' if the output cannot be written.
+        */
+        [[nodiscard]] static Result<std::size_t> Convert(
+            const fs::path & directory,
+            const fs::path & output
+        ) noexcept try
+        {
+            std::vector<ThreadTrace> traces {};
+            std::error_code ec {};
+
+            for (fs::directory_iterator it( directory, ec ), end; !ec && it != end; it.increment( ec ))
+            {
+                const auto name = it->path().filename().string();
+
+                if (!it->is_regular_file( ec ) || !name.starts_with( "noceg_trace_" ) || it->path().extension() != ".bin")
+                    continue;
+
+                if (auto trace = ReadTrace( it->path() ))
+                    traces.push_back( std::move( *trace ) );
+            }
+
+            if (traces.empty())
+                return std::unexpected( Error::NoTraceFiles );
+
+            // QPC is shared by every process, the first event of all traces is the origin.
+            auto origin = std::numeric_limits<std::int64_t>::max();
+
+            for (const auto & trace : traces)
+            {
+                if (!trace.m_Records.empty())
+                    origin = std::min( origin, trace.m_Records.front().m_Time );
+            }
+
+            std::ofstream out { output, std::ios::binary };
+            if (!out.is_open())
+                return std::unexpected( Error::OutputFileCreateError );
+
+            std::string buffer = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            std::size_t events = 0;
+
+            // Lambda function to append an event object.
+            auto append = [&]( std::string_view event )
+            {
+                if (events++)
+                    buffer += ",\n";
+
+                buffer += event;
+
+                if (buffer.size() >= 0x100000)
+                {
+                    out.write( buffer.data(), static_cast<std::streamsize>(buffer.size()) );
+                    buffer.clear();
+                }
+            };
+
+            for (const auto & trace : traces)
+            {
+                const auto & header = trace.m_Header;
+
+                // Lambda function to convert a timestamp to microseconds since the origin.
+                auto micros = [&]( std::int64_t time )
+                {
+                    return static_cast<double>(time - origin) * 1000000.0 / static_cast<double>(header.m_Frequency);
+                };
+
+                append( std::format( "{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":\"Thread {} ({} dropped)\"}}}}",
+                    header.m_ProcessId, header.m_ThreadId, header.m_ThreadId, header.m_Dropped ) );
+
+                // Custom exception starting the slice of the entry being resolved.
+                std::optional<Record> redirect {};
+
+                for (const auto & record : trace.m_Records)
+                {
+                    const auto ts = micros( record.m_Time );
+
+                    append( std::format( "{{\"ph\":\"i\",\"s\":\"t\",\"cat\":\"exception\",\"name\":\"{}\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},"
+                        "\"args\":{{\"EIP\":\"0x{:08X}\",\"EAX\":\"0x{:08X}\",\"Index\":{},\"Target\":{}}}}}",
+                        EventName( record.m_Code ), header.m_ProcessId, record.m_ThreadId, ts, record.m_Eip, record.m_Eax,
+                        record.m_Index, (record.m_Flags & TRACE_TARGET) != 0 ) );
+
+                    if (record.m_Code == 0xCEADDEAD)
+                        redirect = record;
+                    else if ((record.m_Flags & TRACE_RESOLVED) && redirect && redirect->m_Index == record.m_Index)
+                    {
+                        const auto begin = micros( redirect->m_Time );
+
+                        append( std::format( "{{\"ph\":\"X\",\"cat\":\"entry\",\"name\":\"Entry {}\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},"
+                            "\"args\":{{\"Value\":\"0x{:08X}\"}}}}",
+                            record.m_Index, header.m_ProcessId, record.m_ThreadId, begin, ts - begin, record.m_Eax ) );
+
+                        redirect.reset();
+                    }
+                }
+            }
+
+            buffer += "]}\n";
+            out.write( buffer.data(), static_cast<std::streamsize>(buffer.size()) );
+
+            if (!out)
+                return std::unexpected( Error::FileWriteError );
+
+            return events;
+        }
+        catch (...)
+        {
+            return std::unexpected( Error::FileWriteError );
+        }
+    };
+}
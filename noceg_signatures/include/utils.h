@@ -15,18 +15,35 @@
 #pragma once
 
 #include <Windows.h>
+#include <winioctl.h>
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <span>
+#include <ranges>
 #include <string>
+#include <thread>
 #include <vector>
 #include <map>
 #include <set>
 #include <unordered_set>
+#include <unordered_map>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <format>
 #include <expected>
 
 namespace fs = std::filesystem;
 
+#include "avx512.h"
+#include "pe_layout.h"
+#include "file_clone.h"
+#include "static_pattern.h"
+#include "result_table.h"
+
 namespace CEG
 {
     // Enumeration representing possible error states in the application.
@@ -45,8 +62,15 @@ namespace CEG
         EmptyNtHeader,
         NullRawPointer,
         NullVirtualSize,
+        NoExecutableSection,
         FileWriteError,
-        OutputFileCreateError
+        OutputFileCreateError,
+        UnknownOption,
+        InvalidOptionValue,
+        InitFuncNotFound,
+        TermFuncNotFound,
+        NoBatchCandidates,
+        NoTraceFiles
     };
     
     
@@ -101,68 +125,97 @@ namespace CEG
             case Error::NullVirtualSize:
                 return "Section virtual size is null.";
 
+            case Error::NoExecutableSection:
+                return "No executable section found.";
+
             case Error::FileWriteError:
                 return "An error has occured while writing to the file.";
 
             case Error::OutputFileCreateError:
                 return "An error has occured while trying to open the output file.";
+
+            case Error::UnknownOption:
+                return "Unknown command line option.";
+
+            case Error::InvalidOptionValue:
+                return "Invalid command line option value.";
+
+            case Error::InitFuncNotFound:
+                return "CEG init function not found.";
+
+            case Error::TermFuncNotFound:
+                return "CEG terminate function not found.";
+
+            case Error::NoBatchCandidates:
+                return "No executables found to analyze.";
+
+            case Error::NoTraceFiles:
+                return "No trace files found to convert.";
         }
 
         return {};
     }
 
-    namespace Data
-    {
-        // Maximum number of bytes to scan when searching for CEG patterns.
-        inline constexpr std::uint32_t CEG_SCAN_SIZE = 300;
+    // Maximum number of bytes to scan when searching for CEG patterns.
+    inline constexpr std::uint32_t CEG_SCAN_SIZE = 300;
 
-        // Base address of the code section.
-        inline std::uint32_t CEG_CODE_BASE = 0;
+    // An executable section of the analyzed binary.
+    using CodeSection = PeSection;
+
+    // PE geometry and scan results of a single analyzed binary.
+    struct AnalysisContext
+    {
+        // Base address of the first executable section.
+        std::uint32_t m_CodeBase { 0 };
 
         // Raw 'ImageBase' value from the PE header.
-        inline std::uint32_t CEG_IMAGEBASE_RAW = 0;
+        std::uint32_t m_ImageBaseRaw { 0 };
 
         // Memory address where the binary content is loaded.
-        inline std::uint32_t CEG_IMAGEBASE_MEMORY = 0;
+        std::uint32_t m_ImageBaseMemory { 0 };
 
-        // Virtual address of the first section.
-        inline std::uint32_t CEG_VIRTUAL_ADDRESS = 0;
+        // Virtual address of the PE entry point.
+        std::uint32_t m_EntryPoint { 0 };
 
-        // File offset to the raw data of the first section.
-        inline std::uint32_t CEG_RAW_DATA_POINTER = 0;
+        // Virtual address of the first executable section.
+        std::uint32_t m_VirtualAddress { 0 };
 
-        // A map of CEG protected stolen/masked functions.
-        inline std::multimap<mem::pointer, std::tuple<mem::pointer, mem::pointer, mem::pointer>> CEG_PROTECTED_STOLEN_FUNCS_v1 {}; // v1
-        inline std::multimap<mem::pointer, std::tuple<mem::pointer, mem::pointer, mem::pointer>> CEG_PROTECTED_STOLEN_FUNCS_v2 {}; // v2
-        inline std::multimap<mem::pointer, std::tuple<mem::pointer, mem::pointer, mem::pointer>> CEG_PROTECTED_STOLEN_FUNCS_v3 {}; // v3
+        // File offset to the raw data of the first executable section.
+        std::uint32_t m_RawDataPointer { 0 };
 
-        // A map of CEG protected constant functions.
-        inline std::multimap<mem::pointer, std::tuple<mem::pointer, mem::pointer, mem::pointer>> CEG_PROTECTED_CONSTANT_FUNCS {};
+        // Executable sections ordered by virtual address, used for the VA and file offset translation.
+        std::vector<CodeSection> m_Sections {};
+
+        // Interval table of the executable sections, looked up by virtual address and by file offset.
+        PeLayout m_Layout {};
+
+        // CEG protected constant and stolen/masked functions.
+        ResultTable m_ProtectedFuncs {};
 
         // Functions related to CEG thread registration.
-        inline std::unordered_set<mem::pointer> CEG_REGISTER_THREAD_FUNC_FUNCS {};
+        std::unordered_set<mem::pointer> m_RegisterThreadFuncs {};
 
         // Vector of CEG integrity functions.
-        inline std::vector<mem::pointer> CEG_INTEGRITY_FUNCS {};
+        std::vector<mem::pointer> m_IntegrityFuncs {};
 
         // Vector of CEG test secret functions.
-        inline std::vector<mem::pointer> CEG_TESTSECRET_FUNCS {};
+        std::vector<mem::pointer> m_TestSecretFuncs {};
 
         // Address of the CEG library initialization function.
-        inline mem::pointer CEG_INIT_LIBRARY_FUNC = nullptr;
+        mem::pointer m_InitLibraryFunc { nullptr };
 
         // Address of the CEG terminate function.
-        inline mem::pointer CEG_TERM_LIBRARY_FUNC = nullptr;
+        mem::pointer m_TermLibraryFunc { nullptr };
 
         // Address of the CEG register thread function.
-        inline mem::pointer CEG_REGISTER_THREAD_FUNC = nullptr;
+        mem::pointer m_RegisterThreadFunc { nullptr };
 
         // Pointer indicating if this is an older version of CEG.
-        inline mem::pointer CEG_OLD_VERSION = nullptr;
+        mem::pointer m_OldVersion { nullptr };
 
         // Flag indicating whether ASLR is enabled.
-        inline std::atomic_bool CEG_ASLR_ENABLED = false;
-    }
+        bool m_AslrEnabled { false };
+    };
     
     template<typename T>
     using Result = std::expected<T, Error>;
@@ -197,33 +250,37 @@ namespace CEG
 
 
     /**
-    * @brief Checks if ASLR is enabled in the PE header and updates global state.
+    * @brief Checks if ASLR is enabled in the PE header and updates the analysis context.
     *
+    * @param context The analysis context.
     * @param nt_headers Pointer to the NT headers structure.
     * @return true if ASLR is enabled, false otherwise.
     */
     [[nodiscard]] bool IsASLREnabled(
+        AnalysisContext & context,
         const IMAGE_NT_HEADERS * nt_headers
     ) noexcept
     {
         if (!nt_headers)
             return false;
 
-        Data::CEG_ASLR_ENABLED = (nt_headers->OptionalHeader.DllCharacteristics &
+        context.m_AslrEnabled = (nt_headers->OptionalHeader.DllCharacteristics &
             IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE) != 0;
 
-        return Data::CEG_ASLR_ENABLED.load();
+        return context.m_AslrEnabled;
     }
 
 
     /**
     * @brief Disables ASLR by modifying the PE header's 'DllCharacteristics' field.
     *
+    * @param context The analysis context.
     * @param nt_headers Pointer to the NT headers structure to modify.
     * @return 'std::expected<void, Error>' Either success or failure.
     * @retval 'InvalidPEHeader' if nt_headers is null.
     */
     [[nodiscard]] std::expected<void, Error> DisableASLR(
+        const AnalysisContext & context,
         IMAGE_NT_HEADERS * nt_headers
     ) noexcept
     {
@@ -231,7 +288,7 @@ namespace CEG
             return std::unexpected( Error::InvalidPEHeader );
 
         // Disable ASLR by clearing the dynamic base flag.
-        if (Data::CEG_ASLR_ENABLED.load())
+        if (context.m_AslrEnabled)
             nt_headers->OptionalHeader.DllCharacteristics &= ~IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE;
 
         return {};
@@ -241,13 +298,18 @@ namespace CEG
     /**
     * @brief Loads and analyzes a PE binary image, extracting the required addresses.
     *
-    * @param content The binary file content.
-    * @param address [out] Reference to pointer that will receive the code section address.
-    * @param size [out] The code section size.
+    * Every section with 'IMAGE_SCN_MEM_EXECUTE' and raw data is recorded in 'AnalysisContext::m_Sections', limited to its raw data,
+    * the others are skipped.
+    *
+    * @param context [out] The analysis context receiving the PE geometry.
+    * @param content View of the binary file content, the PE header is patched in place.
+    * @param address [out] Reference to pointer that will receive the first executable section address.
+    * @param size [out] The first executable section size.
     * @return 'std::expected<void, Error>' Either success or specific error.
     */
     [[nodiscard]] std::expected<void, Error> LoadBinaryImage( 
-        std::string_view content,
+        AnalysisContext & context,
+        std::span<std::byte> content,
         void *& address,
         std::uint32_t & size
     ) noexcept
@@ -255,46 +317,52 @@ namespace CEG
         if (content.empty())
             return std::unexpected( Error::EmptyContent );
 
-        Data::CEG_IMAGEBASE_MEMORY = reinterpret_cast<std::uint32_t>(content.data());
-        if (Data::CEG_IMAGEBASE_MEMORY == 0)
+        context.m_ImageBaseMemory = reinterpret_cast<std::uint32_t>(content.data());
+        if (context.m_ImageBaseMemory == 0)
             return std::unexpected( Error::NullBaseAddress );
 
-        const auto * dos_header = reinterpret_cast<const IMAGE_DOS_HEADER *>(Data::CEG_IMAGEBASE_MEMORY);
+        const auto * dos_header = reinterpret_cast<const IMAGE_DOS_HEADER *>(context.m_ImageBaseMemory);
         if (dos_header->e_magic != IMAGE_DOS_SIGNATURE)
             return std::unexpected( Error::InvalidDOSHeader );
 
         auto * nt_headers = reinterpret_cast<IMAGE_NT_HEADERS *>(
-            reinterpret_cast<std::uint8_t *>(Data::CEG_IMAGEBASE_MEMORY) + dos_header->e_lfanew);
+            reinterpret_cast<std::uint8_t *>(context.m_ImageBaseMemory) + dos_header->e_lfanew);
         if (nt_headers->Signature != IMAGE_NT_SIGNATURE)
             return std::unexpected( Error::InvalidPEHeader );
 
         if (nt_headers->OptionalHeader.ImageBase == 0)
             return std::unexpected( Error::NullImageBase );
 
-        Data::CEG_IMAGEBASE_RAW = nt_headers->OptionalHeader.ImageBase;
+        context.m_ImageBaseRaw = nt_headers->OptionalHeader.ImageBase;
 
-        const auto * section_header = IMAGE_FIRST_SECTION( nt_headers );
-        if (!section_header)
-            return std::unexpected( Error::EmptyNtHeader );
+        if (nt_headers->OptionalHeader.AddressOfEntryPoint)
+            context.m_EntryPoint = context.m_ImageBaseRaw + nt_headers->OptionalHeader.AddressOfEntryPoint;
 
-        if (section_header->PointerToRawData == 0)
-            return std::unexpected( Error::NullRawPointer );
+        // The same section table as the patcher, see 'PeLayout::FromImage'.
+        auto layout = PeLayout::FromImage( content, IMAGE_SCN_MEM_EXECUTE );
+        if (!layout)
+            return std::unexpected( Error::InvalidPEHeader );
 
-        Data::CEG_RAW_DATA_POINTER = section_header->PointerToRawData;
+        if (layout->sections().empty())
+            return std::unexpected( Error::NoExecutableSection );
 
-        address = reinterpret_cast<void *>(
-            Data::CEG_IMAGEBASE_MEMORY + Data::CEG_RAW_DATA_POINTER);
+        context.m_Sections.assign( layout->sections().begin(), layout->sections().end() );
+        context.m_Layout = std::move( *layout );
+
+        const auto & code = context.m_Sections.front();
 
-        size = static_cast<std::uint32_t>(section_header->Misc.VirtualSize);
-        if (size == 0)
-            return std::unexpected( Error::NullVirtualSize );
+        context.m_RawDataPointer = code.m_RawDataPointer;
+        context.m_VirtualAddress = code.m_VirtualAddress;
+        context.m_CodeBase = context.m_ImageBaseRaw + context.m_VirtualAddress;
+
+        address = reinterpret_cast<void *>(
+            context.m_ImageBaseMemory + context.m_RawDataPointer);
 
-        Data::CEG_VIRTUAL_ADDRESS = section_header->VirtualAddress;
-        Data::CEG_CODE_BASE = Data::CEG_IMAGEBASE_RAW + Data::CEG_VIRTUAL_ADDRESS;
+        size = code.m_Size;
 
-        if (IsASLREnabled( nt_headers ))
+        if (IsASLREnabled( context, nt_headers ))
         {
-            auto res = DisableASLR( nt_headers );
+            auto res = DisableASLR( context, nt_headers );
 
             if (res)
                 std::cout << "[SUCCESS] Successfully disabled ASLR." << std::endl;
@@ -310,19 +378,145 @@ namespace CEG
 
 
     /**
-    * @brief Saves a modified binary with ASLR disabled to a new file.
+    * @brief Collects the virtual addresses of all functions exported by the binary.
+    *
+    * Forwarded exports are skipped.
+    *
+    * @param context The analysis context.
+    * @param content The binary file content.
+    * @param res [out] Reference to vector that will receive the exported function addresses.
+    */
+    void GetExportedFunctions(
+        const AnalysisContext & context,
+        std::span<const std::byte> content,
+        std::vector<std::uint32_t> & res
+    )
+    {
+        const auto * base = reinterpret_cast<const std::uint8_t *>(content.data());
+
+        const auto * dos_header = reinterpret_cast<const IMAGE_DOS_HEADER *>(base);
+        const auto * nt_headers = reinterpret_cast<const IMAGE_NT_HEADERS *>(base + dos_header->e_lfanew);
+
+        const auto & directory = nt_headers->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+        if (!directory.VirtualAddress || !directory.Size)
+            return;
+
+        const auto layout = PeLayout::FromImage( content );
+        if (!layout)
+            return;
+
+        const auto directory_offset = layout->RvaToOffset( directory.VirtualAddress );
+        if (!directory_offset || directory_offset + sizeof( IMAGE_EXPORT_DIRECTORY ) > content.size())
+            return;
+
+        const auto * exports = reinterpret_cast<const IMAGE_EXPORT_DIRECTORY *>(base + directory_offset);
+
+        const auto functions_offset = layout->RvaToOffset( exports->AddressOfFunctions );
+        if (!functions_offset || functions_offset + exports->NumberOfFunctions * sizeof( DWORD ) > content.size())
+            return;
+
+        const auto * functions = reinterpret_cast<const DWORD *>(base + functions_offset);
+
+        for (DWORD i = 0; i < exports->NumberOfFunctions; ++i)
+        {
+            const auto rva = functions[i];
+
+            // Forwarded exports point inside the export directory.
+            if (!rva || (rva >= directory.VirtualAddress && rva < directory.VirtualAddress + directory.Size))
+                continue;
+
+            res.push_back( context.m_ImageBaseRaw + rva );
+        }
+    }
+
+
+    /**
+    * @brief Gets the file offset of the 'DllCharacteristics' field, the only header field changed by 'DisableASLR'.
+    *
+    * @param content View of the binary file content.
+    * @return The file offset, or 0 if the headers are invalid.
+    */
+    [[nodiscard]] std::uint32_t DllCharacteristicsOffset(
+        std::span<const std::byte> content
+    ) noexcept
+    {
+        if (content.size() < sizeof( IMAGE_DOS_HEADER ))
+            return 0;
+
+        const auto * dos_header = reinterpret_cast<const IMAGE_DOS_HEADER *>(content.data());
+        if (dos_header->e_magic != IMAGE_DOS_SIGNATURE || dos_header->e_lfanew <= 0)
+            return 0;
+
+        const auto offset = static_cast<std::uint32_t>(dos_header->e_lfanew) +
+            offsetof( IMAGE_NT_HEADERS, OptionalHeader ) + offsetof( IMAGE_OPTIONAL_HEADER, DllCharacteristics );
+
+        if (offset + sizeof( WORD ) > content.size())
+            return 0;
+
+        return offset;
+    }
+
+
+    /**
+    * @brief Overwrites a few bytes of an existing file.
+    *
+    * @param path Path to the file.
+    * @param offset File offset of the bytes.
+    * @param bytes The new bytes.
+    * @return 'std::expected<void, Error>' Either success or specific error.
+    * @retval 'OutputFileCreateError' if the file cannot be opened for writing.
+    * @retval 'FileWriteError' if writing fails.
+    */
+    [[nodiscard]] std::expected<void, Error> PatchFileBytes(
+        const fs::path & path,
+        std::uint64_t offset,
+        std::span<const std::byte> bytes
+    ) noexcept
+    {
+        // The source binary stays mapped during the analysis.
+        const auto file = CreateFileW( path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+
+        if (file == INVALID_HANDLE_VALUE)
+            return std::unexpected( Error::OutputFileCreateError );
+
+        LARGE_INTEGER position {};
+        position.QuadPart = static_cast<LONGLONG>(offset);
+
+        DWORD written = 0;
+        const bool success = SetFilePointerEx( file, position, nullptr, FILE_BEGIN ) &&
+            WriteFile( file, bytes.data(), static_cast<DWORD>(bytes.size()), &written, nullptr ) && written == bytes.size();
+
+        CloseHandle( file );
+
+        if (!success)
+            return std::unexpected( Error::FileWriteError );
+
+        return {};
+    }
+
+
+    /**
+    * @brief Saves the binary with ASLR disabled without rewriting it.
     *
-    * @param content The modified binary content to save.
+    * The original file is block cloned where the file system supports it, or copied otherwise,
+    * then only the 'DllCharacteristics' field changed in memory is written to the copy.
+    * In place, the original file is patched instead and the headers of the original are kept in '<name>.aslr.bak'.
+    *
+    * @param content The modified binary content, only its header is written.
     * @param filename Original filename path.
+    * @param in_place Patch the original file instead of writing '<name>_noaslr'.
     * @return 'std::expected<void, Error>' Either success or specific error.
     * @retval 'EmptyContent' if content is empty.
     * @retval 'FileNotFound' if filename is empty.
+    * @retval 'InvalidPEHeader' if the headers of the content are invalid.
     * @retval 'OutputFileCreateError' if file cannot be created.
     * @retval 'FileWriteError' if writing fails.
     */
     [[nodiscard]] std::expected<void, Error> SaveBinaryNoASLR(
-        std::string_view content,
-        fs::path filename
+        std::span<const std::byte> content,
+        fs::path filename,
+        bool in_place = false
     ) noexcept try
     {
         if (content.empty())
@@ -331,21 +525,49 @@ namespace CEG
         if (filename.empty())
             return std::unexpected( Error::FileNotFound );
 
+        const auto offset = DllCharacteristicsOffset( content );
+        if (!offset)
+            return std::unexpected( Error::InvalidPEHeader );
+
+        const auto patch = content.subspan( offset, sizeof( WORD ) );
+
+        if (in_place)
+        {
+            // The original headers up to the patched field, restored by writing them back at the start of the file.
+            fs::path backup = filename;
+            backup += ".aslr.bak";
+
+            // An existing backup holds the headers from before the first patch.
+            if (!fs::exists( backup ))
+            {
+                std::string original( offset + sizeof( WORD ), '\0' );
+
+                std::ifstream in( filename, std::ios::binary );
+                if (!in.read( original.data(), static_cast<std::streamsize>(original.size()) ))
+                    return std::unexpected( Error::FileReadError );
+
+                std::ofstream out( backup, std::ios::binary | std::ios::trunc );
+                if (!out.is_open())
+                    return std::unexpected( Error::OutputFileCreateError );
+
+                out.write( original.data(), static_cast<std::streamsize>(original.size()) );
+                out.close();
+
+                if (out.fail())
+                    return std::unexpected( Error::FileWriteError );
+            }
+
+            return PatchFileBytes( filename, offset, patch );
+        }
+
         // Full path to the output binary file with no ASLR.
         const fs::path path = filename.parent_path() /
             (filename.stem() += "_noaslr" + filename.extension().string());
 
-        std::ofstream out( path, std::ios::binary | std::ios::trunc );
-        if (!out.is_open())
+        if (!CloneFile( filename, path ) && !CopyFileExW( filename.c_str(), path.c_str(), nullptr, nullptr, nullptr, 0 ))
             return std::unexpected( Error::OutputFileCreateError );
 
-        out.write( reinterpret_cast<const char *>(content.data()), content.size() );
-
-        if (out.fail())
-            return std::unexpected( Error::FileWriteError );
-
-        out.close();
-        return {};
+        return PatchFileBytes( path, offset, patch );
     }
     catch (const fs::filesystem_error &)
     {
@@ -365,31 +587,19 @@ namespace CEG
     * @brief Searches for a single occurrence of a byte pattern within a memory region.
     *
     * @tparam The address type.
-    * @param pattern The byte pattern to search for.
+    * @param pattern The precompiled byte pattern to search for.
     * @param address Starting address of the memory region to search.
     * @param size Size in bytes of the memory region to search.
     * @return 'mem::pointer' pointing to the match, or nullptr if not found.
     */
     template<AddressType T>
     [[nodiscard]] mem::pointer FindFunction(
-        std::string_view pattern,
+        const StaticPattern & pattern,
         T address,
         const std::uint32_t size
     ) noexcept
     {
-        try
-        {
-            mem::pattern needle( pattern.data() );
-            mem::default_scanner scanner( needle );
-
-            mem::region region( address, size );
-
-            return scanner.scan( region );
-        }
-        catch (...)
-        {
-            return mem::pointer { nullptr };
-        }
+        return pattern.Scan( mem::region( address, size ) );
     }
 
 
@@ -397,31 +607,20 @@ namespace CEG
     * @brief Searches for a single occurrence of a byte pattern within a memory region.
     *
     * @tparam The address type.
-    * @param pattern The byte pattern to search for.
+    * @param pattern The precompiled byte pattern to search for.
     * @param address Starting address of the memory region to search.
     * @param size Size in bytes of the memory region to search.
     * @param res [out] Reference to 'mem::pointer' that will receive the search result.
     */
     template<AddressType T>
-    [[nodiscard]] void FindFunction(
-        std::string_view pattern,
+    void FindFunction(
+        const StaticPattern & pattern,
         T address,
         const std::uint32_t size,
         mem::pointer & res
-    )
+    ) noexcept
     {
-        try
-        {
-            mem::pattern needle( pattern.data() );
-            mem::default_scanner scanner( needle );
-
-            mem::region region( address, size );
-            res = scanner.scan( region );
-        }
-        catch (...)
-        {
-            res = mem::pointer { nullptr };
-        }
+        res = pattern.Scan( mem::region( address, size ) );
     }
     
     
@@ -429,70 +628,54 @@ namespace CEG
     * @brief Searches for all occurrences of a byte pattern and appends results to a vector.
     *
     * @tparam The address type.
-    * @param pattern The byte pattern to search for.
+    * @param pattern The precompiled byte pattern to search for.
     * @param address Starting address of the memory region to search.
     * @param size Size in bytes of the memory region to search.
     * @param res [out] Reference to vector that will receive all found addresses.
     */
     template<AddressType T>
-    [[nodiscard]] void FindFunctions(
-        std::string_view pattern,
+    void FindFunctions(
+        const StaticPattern & pattern,
         T address,
         const std::uint32_t size,
         std::vector<mem::pointer> & res
     )
     {
-        try
-        {
-            mem::pattern needle( pattern.data() );
-            mem::default_scanner scanner( needle );
-
-            mem::region region( address, size );
-
-            auto found = scanner.scan_all( region );
-            res.insert( res.end(), found.begin(), found.end() );
-        }
-        catch (...)
-        {}
+        pattern.ScanAll( mem::region( address, size ), res );
     }
     
     
     /**
-    * @brief Searches for all occurrences of a byte pattern and appends results to a vector.
+    * @brief Searches for all occurrences of a byte pattern and appends results to an unordered set.
     *
     * @tparam The address type.
-    * @param pattern The byte pattern to search for.
+    * @param pattern The precompiled byte pattern to search for.
     * @param address Starting address of the memory region to search.
     * @param size Size in bytes of the memory region to search.
     * @param res [out] Reference to unordered set that will receive all found addresses.
     */
     template<AddressType T>
-    [[nodiscard]] void FindFunctions(
-        std::string_view pattern,
+    void FindFunctions(
+        const StaticPattern & pattern,
         T address,
         const std::uint32_t size,
         std::unordered_set<mem::pointer> & res
     )
     {
-        try
-        {
-            mem::pattern needle( pattern.data() );
-            mem::default_scanner scanner( needle );
+        mem::region region( address, size );
 
-            mem::region region( address, size );
-
-            auto found = scanner.scan_all( region );
-            res.insert( found.begin(), found.end() );
+        while (auto result = pattern.Scan( region ))
+        {
+            res.insert( result );
+            region = region.sub_region( result + 1 );
         }
-        catch (...)
-        {}
     }
 
 
     /**
     * @brief Attempts to find a match using multiple patterns, returning the first successful match.
     *
-    * @param patterns Container of pattern strings to search for.
+    * @param patterns Container of precompiled patterns to search for.
     * @param address Starting address of the memory region to search.
     * @param size Size in bytes of the memory region to search.
     * @return 'mem::pointer' to the first matching pattern, or nullptr if no patterns match.
@@ -511,39 +694,137 @@ namespace CEG
 
         return nullptr;
     }
+
+
+    /**
+    * @brief Attempts to find a match trying the patterns in the given order, returning the first successful match.
+    *
+    * @param patterns Container of precompiled patterns to search for.
+    * @param address Starting address of the memory region to search.
+    * @param size Size in bytes of the memory region to search.
+    * @param order Indices of the patterns in the order they should be tried.
+    * @param index [out] Index of the matching pattern.
+    * @param frequencies A byte frequency table used to choose the anchors.
+    * @return 'mem::pointer' to the first matching pattern, or nullptr if no patterns match.
+    */
+    [[nodiscard]] mem::pointer FindPatternMatch(
+        const auto & patterns,
+        void * address,
+        DWORD size,
+        std::span<const std::uint16_t> order,
+        std::uint16_t & index,
+        const mem::byte * frequencies = mem::simd_default_frequencies
+    ) noexcept
+    {
+        for (const auto i : order)
+        {
+            if (i >= std::size( patterns ))
+                continue;
+
+            const auto & pattern = patterns[i];
+
+            if (auto result = pattern.Scan( mem::region( address, size ), pattern.GetAnchors( frequencies ) ))
+            {
+                index = i;
+                return result;
+            }
+        }
+
+        return nullptr;
+    }
     
     
+    /**
+    * @brief Gets the memory address of an executable section.
+    *
+    * @param context The analysis context.
+    * @param section The executable section.
+    * @return Pointer to the section data.
+    */
+    [[nodiscard]] void * SectionAddress(
+        const AnalysisContext & context,
+        const CodeSection & section
+    ) noexcept
+    {
+        return reinterpret_cast<void *>(context.m_ImageBaseMemory + section.m_RawDataPointer);
+    }
+
+
+    /**
+    * @brief Finds the executable section containing a relative virtual address.
+    *
+    * @param context The analysis context.
+    * @param rva Relative virtual address.
+    * @return Pointer to the section, or nullptr if the address is outside of every executable section.
+    */
+    [[nodiscard]] constexpr const CodeSection * FindSectionByRva(
+        const AnalysisContext & context,
+        std::uint32_t rva
+    ) noexcept
+    {
+        return context.m_Layout.FindByRva( rva );
+    }
+
+
+    /**
+    * @brief Finds the executable section containing a file offset.
+    *
+    * @param context The analysis context.
+    * @param offset File offset.
+    * @return Pointer to the section, or nullptr if the offset is outside of every executable section.
+    */
+    [[nodiscard]] constexpr const CodeSection * FindSectionByOffset(
+        const AnalysisContext & context,
+        std::uint32_t offset
+    ) noexcept
+    {
+        return context.m_Layout.FindByOffset( offset );
+    }
+
+
     /**
     * @brief Calculates the real virtual address for the target binary.
     *
+    * The address is translated with the executable section it belongs to, addresses outside
+    * of every section are taken relative to the given memory region.
+    *
+    * @param context The analysis context.
     * @param address_start Pointer to the beginning of the memory region.
     * @param address_current The current address in memory.
     * @return 'mem::pointer' containing the calculated real virtual address.
     */
     [[nodiscard]] constexpr mem::pointer CalculateRealAddress(
+        const AnalysisContext & context,
         const void * address_start,
         const std::uint32_t address_current
     ) noexcept
     {
-        return Data::CEG_CODE_BASE + (address_current - reinterpret_cast<std::uint32_t>(address_start));
+        const auto offset = address_current - context.m_ImageBaseMemory;
+
+        if (const auto * section = FindSectionByOffset( context, offset ))
+            return context.m_ImageBaseRaw + section->m_VirtualAddress + (offset - section->m_RawDataPointer);
+
+        return context.m_CodeBase + (address_current - reinterpret_cast<std::uint32_t>(address_start));
     }
     
     
     /**
     * @brief Transforms a range of memory addresses to their corresponding real addresses.
     *
+    * @param context The analysis context.
     * @param start Pointer to the beginning of the original memory region.
     * @param addresses Range of addresses to transform.
     */
     void TransformToRealAddress(
+        const AnalysisContext & context,
         const void * start,
         std::ranges::range auto & addresses
     ) noexcept
     {
         std::transform( addresses.begin(), addresses.end(), addresses.begin(),
-            [start]( mem::pointer addr )
+            [&context, start]( mem::pointer addr )
         {
-            return CalculateRealAddress( start, addr.as<std::uint32_t>() );
+            return CalculateRealAddress( context, start, addr.as<std::uint32_t>() );
         } );
     }
     
@@ -551,35 +832,70 @@ namespace CEG
     /**
     * @brief Transforms a single memory address to its corresponding real address.
     *
+    * @param context The analysis context.
     * @param start Pointer to the beginning of the original memory region.
     * @param address Reference to the address to transform.
     * @return 'mem::pointer' containing the transformed real address.
     */
     mem::pointer TransformToRealAddress(
+        const AnalysisContext & context,
         const void * start,
         mem::pointer & address
     ) noexcept
     {
-        return CalculateRealAddress( start, address.as<std::uint32_t>() );
+        return CalculateRealAddress( context, start, address.as<std::uint32_t>() );
     }
 
 
     /**
     * @brief Converts a virtual address to its corresponding file offset.
     *
+    * Addresses outside of every executable section keep the translation of the first one.
+    *
+    * @param context The analysis context.
     * @param va Virtual address to convert.
     * @return The calculated file offset.
     */
     [[nodiscard]] constexpr std::uint32_t VaToOffset(
+        const AnalysisContext & context,
         std::uint32_t va
     ) noexcept
     {
-        std::uint32_t rva = va - Data::CEG_IMAGEBASE_RAW;
+        std::uint32_t rva = va - context.m_ImageBaseRaw;
+
+        if (const auto * section = FindSectionByRva( context, rva ))
+            return context.m_ImageBaseMemory + (rva - section->m_VirtualAddress) + section->m_RawDataPointer;
 
-        rva -= Data::CEG_VIRTUAL_ADDRESS;
-        rva += Data::CEG_RAW_DATA_POINTER;
+        rva -= context.m_VirtualAddress;
+        rva += context.m_RawDataPointer;
+
+        return context.m_ImageBaseMemory + rva;
+    }
+
+
+    /**
+    * @brief Computes the memory address targeted by a relative call/jump.
+    *
+    * The displacement is relative to the virtual address of the next instruction, which only matches
+    * the file layout within a single section, so both ends are translated with the section they belong to.
+    *
+    * @param context The analysis context.
+    * @param current_address Memory address of the instruction.
+    * @param displacement Length of the instruction plus its relative immediate.
+    * @return The memory address of the target, or 0 if the instruction or its target is outside of every executable section.
+    */
+    [[nodiscard]] constexpr std::uint32_t RelativeToOffset(
+        const AnalysisContext & context,
+        std::uint32_t current_address,
+        std::int32_t displacement
+    ) noexcept
+    {
+        const auto rva = context.m_Layout.OffsetToRva( current_address - context.m_ImageBaseMemory );
+        if (!rva)
+            return 0;
 
-        return Data::CEG_IMAGEBASE_MEMORY + rva;
+        const auto offset = context.m_Layout.VaToOffset( context.m_ImageBaseRaw + rva + static_cast<std::uint32_t>(displacement) );
+        return offset ? context.m_ImageBaseMemory + offset : 0;
     }
     
     
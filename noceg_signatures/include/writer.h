@@ -16,7 +16,8 @@
 
 using namespace CEG;
 
-// JSON data writer.
+// JSON data writer, streams the document straight to a buffered file without building a DOM.
+// The output matches 'nlohmann::json::dump( 4 )', or 'dump()' in the compact mode.
 class JsonWriter
 {
 private:
@@ -24,20 +25,156 @@ private:
     // Output file stream for writing JSON data to disk.
     std::ofstream m_JsonFileOut;
 
+    // Pending output, written to the file once it grows past 'FLUSH_SIZE'.
+    std::string m_Buffer {};
+
+    // Write the document without indentation and line breaks.
+    bool m_Compact { false };
+
+    // Nesting depth of the current value.
+    std::uint32_t m_Depth { 0 };
+
+    // Set until the first value of the current object or array is written.
+    bool m_First { true };
+
+    static constexpr std::size_t FLUSH_SIZE = 0x10000;
+
+    static constexpr std::uint32_t INDENT = 4;
+
+
+    // Writes the pending output to the file.
+    void Flush()
+    {
+        m_JsonFileOut.write( m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()) );
+        m_Buffer.clear();
+    }
+
+
+    // Starts a new line at the current depth.
+    void NewLine()
+    {
+        if (m_Compact)
+            return;
+
+        m_Buffer += '\n';
+        m_Buffer.append( m_Depth * INDENT, ' ' );
+    }
+
+
+    // Separates the next value from the previous one of the same object or array.
+    void Next()
+    {
+        if (!m_First)
+            m_Buffer += ',';
+
+        m_First = false;
+        NewLine();
+    }
+
+
+    // Starts the next value of an object.
+    void Key(
+        std::string_view key
+    )
+    {
+        Next();
+
+        m_Buffer += '"';
+        m_Buffer += key;
+        m_Buffer += m_Compact ? "\":" : "\": ";
+    }
+
+
+    // Starts the next value of an object keyed by an address.
+    void AddressKey(
+        std::uint32_t address
+    )
+    {
+        Next();
+        Address( address );
+        m_Buffer += m_Compact ? ":" : ": ";
+    }
+
+
+    // Opens an object or an array.
+    void Open(
+        char bracket
+    )
+    {
+        m_Buffer += bracket;
+        ++m_Depth;
+        m_First = true;
+    }
+
+
+    // Closes an object or an array, empty ones stay on a single line.
+    void Close(
+        char bracket
+    )
+    {
+        --m_Depth;
+
+        if (!m_First)
+            NewLine();
+
+        m_Buffer += bracket;
+        m_First = false;
+
+        if (m_Buffer.size() >= FLUSH_SIZE)
+            Flush();
+    }
+
+
+    // Writes an address as a quoted hex string.
+    void Address(
+        std::uint32_t address
+    )
+    {
+        std::format_to( std::back_inserter( m_Buffer ), "\"0x{:08x}\"", address );
+    }
+
+
+    /**
+    * @brief Writes an array of addresses.
+    *
+    * @param name The JSON key name under which to store the array.
+    * @param container The container holding function addresses.
+    */
+    void AddressArray(
+        std::string_view name,
+        const auto & container
+    )
+    {
+        Key( name );
+        Open( '[' );
+
+        for (const auto & address : container)
+        {
+            Next();
+            Address( address.template as<std::uint32_t>() );
+        }
+
+        Close( ']' );
+    }
+
 public:
     
     /**
     * @brief Constructs the class and opens the specified file for writing.
     *
     * @param path The filesystem path where the JSON file will be created/saved.
+    * @param compact true to write the document without indentation and line breaks.
     * @throws 'std::runtime_error' if the file cannot be opened for writing.
     */
     explicit JsonWriter(
-        const fs::path & path
-    ) : m_JsonFileOut( path )
+        const fs::path & path,
+        bool compact = false
+    ) : m_JsonFileOut( path ), m_Compact( compact )
     {
         if (!m_JsonFileOut)
             throw std::runtime_error( std::format( "Cannot open '{}' for writing.", path.string() ) );
+
+        m_Buffer.reserve( FLUSH_SIZE + 0x1000 );
     }
 
     ~JsonWriter() = default;
@@ -58,82 +195,172 @@ public:
     * - CEG test secret functions.
     * - Crucial CEG information including the version.
     *
-     * @throws 'std::runtime_error' if there's an error writing to the file.
-     */
-    void WriteJSON()
+    * The keys are written in the sorted order of the former 'nlohmann::json' object.
+    *
+    * @param context The analysis context holding the results.
+    * @throws 'std::runtime_error' if there's an error writing to the file.
+    */
+    void WriteJSON(
+        const AnalysisContext & context
+    )
     {
-        json j_root;
-        json j_array_protected = json::array();
-        
-        /**
-        * @brief Lambda function to add CEG protected functions to the JSON array.
-        *
-        * @param container The container holding function information.
-        * @param type Identifier for the CEG function type (constant and stolen).
-        */
-        auto add_protected_funcs = [&j_array_protected]( const auto & container, const int type )
-        {
-            for (const auto& [func, eip_bp] : container)
-            {
-                // Unpack the tuple of the prologue, EIP and BP.
-                auto [prologue, eip, bp] = eip_bp;
-
-                j_array_protected.push_back( {
-                    {
-                        std::format( "0x{:08x}", func.as<std::uint32_t>() ),
-                        {
-                            { "Prologue", std::format( "0x{:08x}", prologue.as<std::uint32_t>() ) }, // Function prologue address.
-                            { "EIP", std::format( "0x{:08x}", eip.as<std::uint32_t>() ) }, // Current entry point address.
-                            { "BP", std::format( "0x{:08x}", bp.as<std::uint32_t>() ) }, // Software breakpoint address.
-                            { "Value", "0x00000000" }, // Default CEG value.
-                            { "Type", type }, // CEG function type.
-                        }
-                    }
-                    } );
-            }
-        };
-        
-        /**
-        * @brief Lambda function to add miscellaneous CEG functions to the root JSON.
-        *
-        * @param container The container holding function addresses.
-        * @param name The JSON key name under which to store the function array.
-        */
-        auto add_funcs = [&j_root]( const auto & container, std::string_view name )
+        m_Depth = 0;
+        m_First = true;
+
+        Open( '{' );
+
+        // Add the asynchronous log mode (messages written by a background thread).
+        // Written by the logging thread by default.
+        Key( "AsyncLog" );
+        m_Buffer += "\"Off\"";
+
+        // Add cache flag (shares the resolved values of identical functions between titles).
+        // No cache by default.
+        Key( "Cache" );
+        m_Buffer += "false";
+
+        // Add an array of CEG protected functions (constant and stolen), ordered by type.
+        const auto & table = context.m_ProtectedFuncs;
+        const auto funcs = table.Funcs();
+        const auto prologues = table.Prologues();
+        const auto eips = table.Eips();
+        const auto bps = table.Bps();
+        const auto types = table.Types();
+
+        Key( "ConstantOrStolen" );
+        Open( '[' );
+
+        for (std::size_t i = 0; i < table.size(); ++i)
         {
-            json j_array = json::array();
+            Next();
+            Open( '{' );
+            AddressKey( funcs[i] );
+            Open( '{' );
 
-            for (const auto & address : container)
-                j_array.push_back( std::format( "0x{:08x}", address.as<std::uint32_t>() ) );
+            Key( "BP" ); // Software breakpoint address.
+            Address( bps[i] );
+            Key( "EIP" ); // Current entry point address.
+            Address( eips[i] );
+            Key( "Prologue" ); // Function prologue address.
+            Address( prologues[i] );
+            Key( "Type" ); // CEG function type.
+            std::format_to( std::back_inserter( m_Buffer ), "{}", static_cast<int>(types[i]) );
+            Key( "Value" ); // Default CEG value.
+            m_Buffer += "\"0x00000000\"";
 
-            j_root[name] = std::move( j_array );
-        };
+            Close( '}' );
+            Close( '}' );
+        }
+
+        Close( ']' );
 
-        add_protected_funcs( Data::CEG_PROTECTED_CONSTANT_FUNCS, 1 ); // CEG protected constant functions.
-        add_protected_funcs( Data::CEG_PROTECTED_STOLEN_FUNCS_v1, 2 ); // CEG protected stolen functions (v1).
-        add_protected_funcs( Data::CEG_PROTECTED_STOLEN_FUNCS_v2, 3 ); // CEG protected stolen functions (v2).
-        add_protected_funcs( Data::CEG_PROTECTED_STOLEN_FUNCS_v3, 4 ); // CEG protected stolen functions (v3).
+        // Add hardware breakpoints flag (debug registers instead of patching the code).
+        // Software breakpoints by default.
+        Key( "HardwareBreakpoints" );
+        m_Buffer += "false";
 
         // Add core CEG system function addresses.
-        j_root["Init"] = std::format( "0x{:08x}", Data::CEG_INIT_LIBRARY_FUNC.as<std::uint32_t>() ); // CEG initialization function.
-        j_root["RegisterThread"] = std::format( "0x{:08x}", Data::CEG_REGISTER_THREAD_FUNC.as<std::uint32_t>() ); // CEG thread registration function.
-        j_root["Terminate"] = std::format( "0x{:08x}", Data::CEG_TERM_LIBRARY_FUNC.as<std::uint32_t>() ); // CEG terminate function.
-        j_root["Version"] = Data::CEG_OLD_VERSION ? 1 : 2; // CEG version.
+        Key( "Init" ); // CEG initialization function.
+        Address( context.m_InitLibraryFunc.as<std::uint32_t>() );
+
+        AddressArray( "Integrity", context.m_IntegrityFuncs );
 
-        // Add an array of CEG protected functions (constant and stolen).
-        j_root["ConstantOrStolen"] = j_array_protected;
+        // Add metrics flag (writes the resolution timings to 'noceg_metrics.json').
+        // No metrics by default.
+        Key( "Metrics" );
+        m_Buffer += "false";
+
+        Key( "RegisterThread" ); // CEG thread registration function.
+        Address( context.m_RegisterThreadFunc.as<std::uint32_t>() );
+
+        // Add the restart strategy used together with the restart flag.
+        // Restart after every resolved entry by default.
+        Key( "RestartStrategy" );
+        m_Buffer += "\"Always\"";
 
         // Add restart flag (indicates whether the application should be restarted).
         // No restart required by default.
-        j_root["ShouldRestart"] = false;
+        Key( "ShouldRestart" );
+        m_Buffer += "false";
+
+        Key( "Terminate" ); // CEG terminate function.
+        Address( context.m_TermLibraryFunc.as<std::uint32_t>() );
 
-        add_funcs( Data::CEG_INTEGRITY_FUNCS, "Integrity" );
-        add_funcs( Data::CEG_TESTSECRET_FUNCS, "TestSecret" );
+        AddressArray( "TestSecret", context.m_TestSecretFuncs );
 
-        m_JsonFileOut << j_root.dump( 4 );
+        // Add the number of threads resolving the entries at once.
+        // Resolved on the loader thread by default.
+        Key( "Threads" );
+        m_Buffer += '1';
+
+        // Add the time an entry may take before it is skipped, in milliseconds.
+        // No timeout by default.
+        Key( "Timeout" );
+        m_Buffer += '0';
+
+        // Add the number of the exceptions traced per thread to 'noceg_trace_<pid>_<tid>.bin'.
+        // No trace by default.
+        Key( "Trace" );
+        m_Buffer += '0';
+
+        Key( "Version" ); // CEG version.
+        m_Buffer += context.m_OldVersion ? '1' : '2';
+
+        Close( '}' );
+
+        Flush();
         m_JsonFileOut.flush();
 
         if (m_JsonFileOut.bad())
             throw std::runtime_error( "Error writing to JSON file." );
     }
-};
\ No newline at end of file
+
+
+    /**
+    * @brief Writes the tables of the CEG data to a binary configuration, see 'BinaryConfig'.
+    *
+    * The records keep the order of the JSON arrays, so the indices of both stay the same.
+    *
+    * @param path Path to the binary configuration, next to the JSON output.
+    * @param context The analysis context holding the results.
+    * @throws 'std::runtime_error' if there's an error writing to the file.
+    */
+    static void WriteBinary(
+        const fs::path & path,
+        const AnalysisContext & context
+    )
+    {
+        const auto & table = context.m_ProtectedFuncs;
+        const auto funcs = table.Funcs();
+        const auto prologues = table.Prologues();
+        const auto eips = table.Eips();
+        const auto bps = table.Bps();
+        const auto types = table.Types();
+
+        std::vector<BinaryConfigEntry> entries( table.size() );
+
+        for (std::size_t i = 0; i < table.size(); ++i)
+            entries[i] = BinaryConfigEntry { funcs[i], prologues[i], eips[i], bps[i], 0, static_cast<std::uint32_t>(types[i]) };
+
+        // Lambda function to convert an address array.
+        const auto addresses = []( const auto & container )
+        {
+            std::vector<std::uint32_t> res {};
+            res.reserve( container.size() );
+
+            for (const auto & address : container)
+                res.push_back( address.template as<std::uint32_t>() );
+
+            return res;
+        };
+
+        BinaryConfigHeader header {};
+        header.m_CegVersion = context.m_OldVersion ? 1 : 2;
+        header.m_Init = context.m_InitLibraryFunc.as<std::uint32_t>();
+        header.m_Terminate = context.m_TermLibraryFunc.as<std::uint32_t>();
+        header.m_RegisterThread = context.m_RegisterThreadFunc.as<std::uint32_t>();
+
+        if (!BinaryConfig::Write( path, header, entries, addresses( context.m_IntegrityFuncs ), addresses( context.m_TestSecretFuncs ) ))
+            throw std::runtime_error( std::format( "Cannot write '{}'.", path.string() ) );
+    }
+};
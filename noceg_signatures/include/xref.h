@@ -0,0 +1,278 @@
+/*
+ * This software is licensed under the NoCEG Non-Commercial Copyleft License.
+ *
+ * Copyright (C) 2025 iArtorias <iartorias.re@gmail.com>
+ *
+ * You may use, copy, modify, and distribute this software non-commercially only.
+ * If you distribute binaries or run it as a service, you must also provide
+ * the full source code under the same license.
+ *
+ * This software is provided "as is", without warranty of any kind.
+ *
+ * Full license text available in LICENSE.md
+ */
+
+#pragma once
+
+#include "prefilter.h"
+
+namespace CEG
+{
+    // A single reference from a call/jmp/mov instruction to its target.
+    struct Xref
+    {
+        // Address referenced by the instruction.
+        std::uint32_t m_Target { 0 };
+
+        // Offset of the referencing opcode within the analyzed data.
+        std::uint32_t m_Offset { 0 };
+    };
+
+
+    // Range of offsets '[m_Begin, m_End)' within a code section.
+    struct OffsetRange
+    {
+        std::uint32_t m_Begin { 0 };
+        std::uint32_t m_End { 0 };
+    };
+
+
+    // References of a previous analysis of the same section layout, see 'XrefIndex::Update'.
+    struct XrefReuse
+    {
+        // Previous references in ascending offset order.
+        std::vector<Xref> m_Xrefs {};
+
+        // Ascending, disjoint ranges whose references must be indexed again.
+        std::vector<OffsetRange> m_Dirty {};
+    };
+
+
+    // Sorted target to reference site index of a code section, filled in a single pass.
+    class XrefIndex
+    {
+    private:
+
+        // All references, ordered by target and offset.
+        std::vector<Xref> m_Xrefs {};
+
+
+        /**
+        * @brief Indexes the references whose opcode lies within a range of offsets.
+        *
+        * @param context The analysis context.
+        * @param bytes Pointer to the binary data.
+        * @param address Base address of the data in memory.
+        * @param begin First offset of the range.
+        * @param end Offset right past the range.
+        * @param res [out] Reference to vector that will receive the references in ascending offset order.
+        */
+        static void IndexRange(
+            const AnalysisContext & context,
+            const mem::byte * bytes,
+            const void * address,
+            std::uint32_t begin,
+            std::uint32_t end,
+            std::vector<Xref> & res
+        )
+        {
+            std::vector<std::uint32_t> opcodes {};
+            OpcodePrefilter::FindOpcodes( bytes + begin, end - begin, opcodes );
+
+            res.reserve( res.size() + opcodes.size() );
+
+            for (const auto opcode : opcodes)
+            {
+                const auto offset = begin + opcode;
+                std::uint32_t target = 0;
+
+                if (OpcodePrefilter::GetTarget( context, bytes, address, offset, target ))
+                    res.push_back( Xref { target, offset } );
+            }
+        }
+
+    public:
+
+        /**
+        * @brief Indexes every call/jmp/mov reference of the binary data.
+        *
+        * Only offsets decoded by the full sweep are indexed, i.e. the ones followed by at least
+        * 'ZYDIS_MAX_INSTRUCTION_LENGTH' bytes. Sites are raw opcodes and should be confirmed
+        * with the decoder before use.
+        *
+        * @param context The analysis context.
+        * @param data Binary data to index.
+        * @param address Base address of the data in memory.
+        * @param threads Number of worker threads, each indexing its own chunk of the data.
+        */
+        void Build(
+            const AnalysisContext & context,
+            std::span<const std::byte> data,
+            const void * address,
+            std::uint32_t threads = 1
+        )
+        {
+            m_Xrefs.clear();
+
+            if (data.size() < ZYDIS_MAX_INSTRUCTION_LENGTH)
+                return;
+
+            const auto * bytes = reinterpret_cast<const mem::byte *>(data.data());
+            const auto limit = static_cast<std::uint32_t>(data.size() - ZYDIS_MAX_INSTRUCTION_LENGTH + 1);
+
+            if (threads <= 1)
+                IndexRange( context, bytes, address, 0, limit, m_Xrefs );
+            else
+            {
+                // Every chunk reads up to 'ZYDIS_MAX_INSTRUCTION_LENGTH' bytes into the next one.
+                const auto chunk_size = (limit + threads - 1) / threads;
+
+                std::vector<std::vector<Xref>> chunks( threads );
+
+                // A future waits for its task when destroyed, so a failed launch or worker never leaves one running.
+                std::vector<std::future<void>> workers {};
+
+                for (std::uint32_t i = 0; i < threads; ++i)
+                {
+                    const auto begin = std::min( limit, i * chunk_size );
+                    const auto end = std::min( limit, begin + chunk_size );
+
+                    workers.push_back( std::async( std::launch::async, [&, i, begin, end]()
+                    {
+                        IndexRange( context, bytes, address, begin, end, chunks[i] );
+                    } ) );
+                }
+
+                // Rethrows the exception of a failed worker.
+                for (auto & worker : workers)
+                    worker.get();
+
+                for (const auto & chunk : chunks)
+                    m_Xrefs.insert( m_Xrefs.end(), chunk.begin(), chunk.end() );
+            }
+
+            // Offsets are already ascending, so ordering by target keeps them sorted per target.
+            std::ranges::stable_sort( m_Xrefs, {}, &Xref::m_Target );
+        }
+
+
+        /**
+        * @brief Indexes the references of the binary data, reusing the previous ones outside of the dirty ranges.
+        *
+        * The result matches 'Build' as long as the bytes a reused reference was decoded from are unchanged.
+        *
+        * @param context The analysis context.
+        * @param data Binary data to index.
+        * @param address Base address of the data in memory.
+        * @param reuse The previous references and the ranges to index again.
+        */
+        void Update(
+            const AnalysisContext & context,
+            std::span<const std::byte> data,
+            const void * address,
+            const XrefReuse & reuse
+        )
+        {
+            m_Xrefs.clear();
+
+            if (data.size() < ZYDIS_MAX_INSTRUCTION_LENGTH)
+                return;
+
+            const auto * bytes = reinterpret_cast<const mem::byte *>(data.data());
+            const auto limit = static_cast<std::uint32_t>(data.size() - ZYDIS_MAX_INSTRUCTION_LENGTH + 1);
+
+            auto previous = reuse.m_Xrefs.begin();
+
+            // Lambda function to keep the previous references up to an offset.
+            auto keep_until = [&]( std::uint32_t offset )
+            {
+                for (; previous != reuse.m_Xrefs.end() && previous->m_Offset < offset; ++previous)
+                {
+                    if (previous->m_Offset < limit)
+                        m_Xrefs.push_back( *previous );
+                }
+            };
+
+            for (const auto & range : reuse.m_Dirty)
+            {
+                keep_until( range.m_Begin );
+
+                while (previous != reuse.m_Xrefs.end() && previous->m_Offset < range.m_End)
+                    ++previous;
+
+                const auto begin = std::min( limit, range.m_Begin );
+                IndexRange( context, bytes, address, begin, std::max( begin, std::min( limit, range.m_End ) ), m_Xrefs );
+            }
+
+            keep_until( UINT32_MAX );
+
+            std::ranges::stable_sort( m_Xrefs, {}, &Xref::m_Target );
+        }
+
+
+        /**
+        * @brief Gets all reference sites of a single target.
+        *
+        * @param target The referenced address.
+        * @return View of the references ordered by offset.
+        */
+        [[nodiscard]] std::span<const Xref> CallersOf(
+            std::uint32_t target
+        ) const noexcept
+        {
+            const auto range = std::ranges::equal_range( m_Xrefs, target, {}, &Xref::m_Target );
+            return { range.begin(), range.end() };
+        }
+
+
+        /**
+        * @brief Collects the reference sites of several targets.
+        *
+        * @param targets The referenced addresses.
+        * @param res [out] Reference to vector that will receive the offsets in ascending order.
+        */
+        void CallersOf(
+            std::span<const std::uint32_t> targets,
+            std::vector<std::uint32_t> & res
+        ) const
+        {
+            for (const auto target : targets)
+            {
+                for (const auto & xref : CallersOf( target ))
+                    res.push_back( xref.m_Offset );
+            }
+
+            std::ranges::sort( res );
+            const auto [first, last] = std::ranges::unique( res );
+            res.erase( first, last );
+        }
+
+
+        /**
+        * @brief Gets all references ordered by offset, the input of a later 'Update'.
+        *
+        * @param res [out] Reference to vector that will receive the references.
+        */
+        void ByOffset(
+            std::vector<Xref> & res
+        ) const
+        {
+            res.assign( m_Xrefs.begin(), m_Xrefs.end() );
+            std::ranges::sort( res, {}, &Xref::m_Offset );
+        }
+
+
+        // All references, ordered by target and offset.
+        [[nodiscard]] std::span<const Xref> All() const noexcept
+        {
+            return m_Xrefs;
+        }
+
+
+        // Number of indexed references.
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return m_Xrefs.size();
+        }
+    };
+}
@@ -39,196 +39,738 @@ namespace std
 }
 
 #include <analyzer.h>
+#include <analysis_cache.h>
+#include <batch.h>
+#include <binary_config.h>
+#include <byte_frequencies.h>
+#include <hash.h>
+#include <incremental.h>
+#include <mapped_file.h>
+#include <options.h>
+#include <pattern_bench.h>
+#include <pattern_stats.h>
+#include <profiler.h>
+#include <scanner.h>
+#include <streamed_file.h>
+#include <trace_export.h>
 #include <writer.h>
 #include <patterns.h>
 
 using namespace CEG;
 
-int main( 
-    int argc,
-    char * argv[] 
+/**
+* @brief Benchmarks the scan backends of every signature on a binary.
+*
+* @param options The command line options.
+* @return The process exit code.
+*/
+int BenchmarkBinary(
+    const Options & options
 )
 {
-    std::cout << "CEG signatures finder by iArtorias (https://github.com/iArtorias)" << std::endl << std::endl;
+    auto map_res = MappedFile::Open( options.m_Binary );
 
-    try
+    if (!map_res)
     {
-        if (argc < 2)
+        std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( map_res.error() ) ) << std::endl;
+        return 1;
+    }
+
+    AnalysisContext context {};
+
+    void * address = nullptr;
+    std::uint32_t size = 0;
+
+    if (auto load_res = LoadBinaryImage( context, map_res->bytes(), address, size ); !load_res)
+    {
+        std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( load_res.error() ) ) << std::endl;
+        return 1;
+    }
+
+    std::size_t mispicks = 0;
+
+    mispicks += BenchmarkPatterns( "Init", CEG_INIT_LIBRARY_FUNC_PATTERNS, address, size );
+    mispicks += BenchmarkPatterns( "Terminate", CEG_TERM_LIBRARY_FUNC_PATTERNS, address, size );
+    mispicks += BenchmarkPatterns( "RegisterThread", CEG_REGISTER_THREAD_FUNC_PATTERNS, address, size );
+    mispicks += BenchmarkPatterns( "Protect", CEG_PROTECT_PATTERNS, address, size );
+    mispicks += BenchmarkPatterns( "Integrity", CEG_INTEGRITY_PATTERNS, address, size );
+    mispicks += BenchmarkPatterns( "TestSecret", CEG_TESTSECRET_PATTERNS, address, size );
+
+    std::cout << std::format( "[SUCCESS] Benchmark finished, '{}' patterns did not select the fastest backend.", mispicks ) << std::endl;
+    return 0;
+}
+
+
+/**
+* @brief Scans and analyzes a single CEG binary and writes its JSON output.
+*
+* Every call works on its own context, so binaries can be analyzed concurrently.
+* The pattern statistics are only read, the matched init and terminate patterns are reported instead.
+*
+* @param options The command line options.
+* @param binary Path to the CEG binary.
+* @param output Path to the JSON output.
+* @param profile_output Path to the profile, if requested.
+* @param stats The pattern statistics ordering the init and terminate patterns.
+* @param out Stream receiving the progress.
+* @param err Stream receiving the errors.
+* @return The outcome of the analysis.
+*/
+BinaryReport AnalyzeBinary(
+    const Options & options,
+    const fs::path & binary,
+    const fs::path & output,
+    const fs::path & profile_output,
+    const PatternStats & stats,
+    std::ostream & out,
+    std::ostream & err
+)
+{
+    BinaryReport report { binary, output };
+    Profiler profiler( options.m_Profile );
+
+    // Compile all CEG signature groups into a single sweep, the groups are registered up front for the cache key.
+    MultiPatternScanner scanner;
+
+    scanner.AddGroup( PatternGroup::Init, CEG_INIT_LIBRARY_FUNC_PATTERNS );
+    scanner.AddGroup( PatternGroup::Terminate, CEG_TERM_LIBRARY_FUNC_PATTERNS );
+    scanner.AddGroup( PatternGroup::RegisterThread, CEG_REGISTER_THREAD_FUNC_PATTERNS );
+    scanner.AddGroup( PatternGroup::Protect, CEG_PROTECT_PATTERNS );
+    scanner.AddGroup( PatternGroup::Integrity, CEG_INTEGRITY_PATTERNS );
+    scanner.AddGroup( PatternGroup::TestSecret, CEG_TESTSECRET_PATTERNS );
+
+    auto compile_scanner = [&]( const mem::byte * frequencies )
+    {
+        profiler.Time( "Compile", [&]() { scanner.Compile( frequencies ); } );
+    };
+
+    // Either the mapping or the streamed buffer holds the binary.
+    MappedFile mapped {};
+    StreamedFile streamed {};
+    std::span<std::byte> content {};
+    std::uint64_t image_hash = 0;
+
+    AnalysisContext context {};
+    ScanResults hits {};
+
+    void * address = nullptr;
+    std::uint32_t size = 0;
+
+    if (options.m_Stream)
+    {
+        auto open_res = profiler.Time( "Open", [&]() { return StreamedFile::Open( binary ); } );
+
+        if (!open_res)
         {
-            std::cerr << std::format( "Usage: '{}' <ceg_binary>.", argv[0] ) << std::endl;
-            std::cin.get();
-            return 1;
+            err << std::format( "[ERROR] '{}'.", ErrorToString( open_res.error() ) ) << std::endl;
+            report.m_Error = open_res.error();
+            return report;
         }
 
-        auto read_res = BinaryRead( argv[1] );
+        streamed = std::move( open_res.value() );
+        content = streamed.bytes();
 
-        if (!read_res)
+        // The sections are scanned while the file is read, so the reads and the scan overlap.
+        // The hits are dropped if the cache has the results already, the hash is only known once the file is read.
+        compile_scanner( mem::simd_default_frequencies );
+
+        auto stream_res = profiler.Time( "Read and scan (streamed)", [&]()
         {
-            std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( read_res.error() ) ) << std::endl;
-            return 1;
+            return StreamBinaryImage( streamed, context, scanner, address, size, image_hash );
+        } );
+
+        if (!stream_res)
+        {
+            err << std::format( "[ERROR] '{}'.", ErrorToString( stream_res.error() ) ) << std::endl;
+            report.m_Error = stream_res.error();
+            return report;
         }
 
-        std::string content = read_res.value();
+        hits = std::move( stream_res.value() );
+    }
+    else
+    {
+        // Map the binary, the ASLR header change only touches a private copy of the page.
+        auto map_res = profiler.Time( "Read", [&]() { return MappedFile::Open( binary ); } );
 
-        if (content.empty())
+        if (!map_res)
         {
-            std::cerr << "[ERROR] Binary content is empty." << std::endl;
-            std::cin.get();
-            return 1;
+            err << std::format( "[ERROR] '{}'.", ErrorToString( map_res.error() ) ) << std::endl;
+            report.m_Error = map_res.error();
+            return report;
         }
 
-        void * address = nullptr;
-        std::uint32_t size = 0;
-        auto load_res = LoadBinaryImage( content, address, size );
+        mapped = std::move( map_res.value() );
+        content = mapped.bytes();
+
+        // Hash the binary before the ASLR header change.
+        image_hash = profiler.Time( "Hash", [&]() { return Hash::Xxh64( content ); } );
+
+        auto load_res = profiler.Time( "LoadBinaryImage", [&]() { return LoadBinaryImage( context, content, address, size ); } );
 
         if (!load_res)
         {
-            std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( load_res.error() ) ) << std::endl;
-            std::cin.get();
-            return 1;
+            err << std::format( "[ERROR] '{}'.", ErrorToString( load_res.error() ) ) << std::endl;
+            report.m_Error = load_res.error();
+            return report;
         }
+    }
+
+    // Find out if this is an odler CEG.
+    FindFunction( CEG_OLD_VERSION_PATTERN, address, 0x20, context.m_OldVersion );
+
+    if (context.m_OldVersion)
+        out << "[WARNING] Older CEG version found." << std::endl;
+
+    report.m_OldVersion = static_cast<bool>(context.m_OldVersion);
 
-        // Find out if this is an odler CEG.
-        FindFunction( "51 B8 ?? ?? ?? ?? FF D0 59 FF E0", address, 0x20, Data::CEG_OLD_VERSION );
+    // Lambda function to print and save the profile, if requested.
+    auto report_profile = [&]()
+    {
+        if (!profiler.Enabled())
+            return;
+
+        profiler.Record( "Total", profiler.Elapsed() );
 
-        if (Data::CEG_OLD_VERSION)
-            std::cout << "[WARNING] Older CEG version found." << std::endl;
+        // The batch only saves the profiles, the table of every binary would interleave.
+        if (options.m_Batch.empty())
+            profiler.Print();
 
-        // Find CEG init function.
-        Data::CEG_INIT_LIBRARY_FUNC = FindPatternMatch( CEG_INIT_LIBRARY_FUNC_PATTERNS, address, size );
+        if (auto profile_res = profiler.Save( profile_output, binary, image_hash ); !profile_res)
+            out << std::format( "[WARNING] Cannot save the profile: '{}'.", ErrorToString( profile_res.error() ) ) << std::endl;
+    };
 
-        if (!Data::CEG_INIT_LIBRARY_FUNC)
+    // Lambda function to write the JSON output and the binary with disabled ASLR.
+    auto write_output = [&]() -> bool
+    {
+        profiler.Time( "WriteJSON", [&]()
         {
-            std::cout << "[ERROR] CEG init function not found." << std::endl;
-            std::cin.get();
-            return 1;
+            auto writer = std::make_unique<JsonWriter>( output, options.m_CompactJson );
+            writer->WriteJSON( context );
+        } );
+
+        // The same tables in the binary form, which the runtime library and the patcher map instead of parsing.
+        profiler.Time( "WriteBinary", [&]()
+        {
+            JsonWriter::WriteBinary( fs::path( output ).replace_extension( ".bin" ), context );
+        } );
+
+        report.m_ProtectedEntries = context.m_ProtectedFuncs.size();
+        report.m_IntegrityFuncs = context.m_IntegrityFuncs.size();
+        report.m_TestSecretFuncs = context.m_TestSecretFuncs.size();
+
+        if (context.m_AslrEnabled)
+        {
+            auto save_res = profiler.Time( "SaveBinaryNoASLR", [&]() { return SaveBinaryNoASLR( content, binary, options.m_AslrInPlace ); } );
+
+            if (!save_res)
+            {
+                err << std::format( "[ERROR] '{}'.", ErrorToString( save_res.error() ) ) << std::endl;
+                report.m_Error = save_res.error();
+                return false;
+            }
+
+            report.m_NoAslr = true;
+
+            if (options.m_AslrInPlace)
+                out << std::format( "[SUCCESS] Successfully disabled ASLR of the original binary, its headers are kept in '{}.aslr.bak'.",
+                    binary.filename().string() ) << std::endl;
+            else
+                out << "[SUCCESS] Successfully saved the binary with disabled ASLR." << std::endl;
         }
 
-        Data::CEG_INIT_LIBRARY_FUNC = TransformToRealAddress( address, Data::CEG_INIT_LIBRARY_FUNC );
-        std::cout << std::format( "[SUCCESS] Found CEG init function: '0x{:08x}'.",
-            Data::CEG_INIT_LIBRARY_FUNC.as<std::uint32_t>() ) << std::endl;
+        return true;
+    };
+
+    // An identical binary was analyzed before by this build with the same patterns, skip the scan and the analysis.
+    const auto cache_directory = AnalysisCache::Directory( scanner.Fingerprint() );
+    const auto cache_path = AnalysisCache::EntryPath( cache_directory, image_hash, options.m_ControlFlow );
+
+    if (options.m_Cache && profiler.Time( "Cache", [&]() { return AnalysisCache::Load( cache_path, context ); } ))
+    {
+        out << std::format( "[SUCCESS] Loaded cached analysis results: '{:016x}'.", image_hash ) << std::endl;
+        report.m_Cached = true;
+
+        if (!write_output())
+            return report;
+
+        report_profile();
+        return report;
+    }
+
+    // Try the init and terminate patterns that matched most often first.
+    const bool old_version = static_cast<bool>(context.m_OldVersion);
+
+    const auto init_order = stats.Order( PatternGroup::Init, old_version, CEG_INIT_LIBRARY_FUNC_PATTERNS.size() );
+    const auto term_order = stats.Order( PatternGroup::Terminate, old_version, CEG_TERM_LIBRARY_FUNC_PATTERNS.size() );
+
+    // Pick the anchors from the byte histogram of this code section, if requested.
+    ByteFrequencies histogram {};
+    const mem::byte * frequencies = mem::simd_default_frequencies;
 
-        // Find CEG terminate function.
-        Data::CEG_TERM_LIBRARY_FUNC = FindPatternMatch( CEG_TERM_LIBRARY_FUNC_PATTERNS, address, size );
+    if (options.m_Histogram)
+    {
+        histogram = profiler.Time( "Histogram", [&]() { return ByteFrequencies::Build( context ); } );
+        frequencies = histogram.data();
+    }
+
+    // An update of a previously analyzed binary only scans and indexes the changed blocks again.
+    const bool incremental = options.m_Cache && !options.m_Tasks && !options.m_ControlFlow;
+    IncrementalState blocks {};
+    IncrementalState previous_blocks {};
+    bool reuse = false;
+
+    if (incremental)
+    {
+        const auto phase = profiler.Measure( "Block hashes" );
+
+        blocks = IncrementalState::Capture( context );
+        std::uint64_t previous_hash = 0;
 
-        if (!Data::CEG_TERM_LIBRARY_FUNC)
+        if (IncrementalState::FindPrevious( cache_directory, blocks, previous_blocks, previous_hash ))
         {
-            std::cout << "[ERROR] CEG terminate function not found." << std::endl;
-            std::cin.get();
-            return 1;
+            reuse = true;
+            out << std::format( "[SUCCESS] Reusing the analysis of '{:016x}': '{}' of '{}' blocks unchanged.",
+                previous_hash, blocks.UnchangedBlocks( previous_blocks ), blocks.Blocks() ) << std::endl;
         }
+    }
+
+    GroupScanTasks tasks( profiler );
 
-        Data::CEG_TERM_LIBRARY_FUNC = TransformToRealAddress( address, Data::CEG_TERM_LIBRARY_FUNC );
-        std::cout << std::format( "[SUCCESS] Found CEG terminate function: '0x{:08x}'.",
-            Data::CEG_TERM_LIBRARY_FUNC.as<std::uint32_t>() ) << std::endl;
+    if (options.m_Tasks)
+    {
+        // Scan every CEG signature group on its own task.
+        tasks.LaunchFirst( PatternGroup::Init, CEG_INIT_LIBRARY_FUNC_PATTERNS, init_order, context, frequencies );
+        tasks.LaunchFirst( PatternGroup::Terminate, CEG_TERM_LIBRARY_FUNC_PATTERNS, term_order, context, frequencies );
+        tasks.Launch( PatternGroup::RegisterThread, CEG_REGISTER_THREAD_FUNC_PATTERNS, context, frequencies );
+        tasks.Launch( PatternGroup::Protect, CEG_PROTECT_PATTERNS, context, frequencies );
+        tasks.Launch( PatternGroup::Integrity, CEG_INTEGRITY_PATTERNS, context, frequencies );
+        tasks.Launch( PatternGroup::TestSecret, CEG_TESTSECRET_PATTERNS, context, frequencies );
+    }
+    else
+    {
+        // Scan every executable section once, unless it was already scanned while streaming.
+        if (!options.m_Stream)
+        {
+            compile_scanner( frequencies );
 
+            // A single sweep reports every group at once, so the groups are not timed separately.
+            hits = profiler.Time( "Scan (all groups)", [&]()
+            {
+                return reuse ? blocks.Rescan( context, scanner, previous_blocks ) : scanner.Scan( context );
+            } );
+        }
+
+        if (incremental)
+            blocks.SetHits( context, hits );
+    }
+
+    // Lambda function to get the matches of a group, waiting for its task if needed.
+    auto results = [&]( PatternGroup group ) -> const ScanResults &
+    {
+        return options.m_Tasks ? tasks.Results( group ) : hits;
+    };
+
+    // Statistics of the control flow graph, if built.
+    std::size_t cfg_blocks = 0;
+    std::size_t cfg_instructions = 0;
+
+    // Lambda function to report the work done by the analyzer.
+    auto report_counters = [&profiler]( const InstructionAnalyzer & analyzer )
+    {
+        const auto & counters = analyzer.GetCounters();
+
+        profiler.Count( "Decoded instructions", counters.m_Decoded );
+        profiler.Count( "Target hits", counters.m_TargetHits );
+        profiler.Count( "Finalize CRC scans", counters.m_FinalizeCrcScans );
+        profiler.Count( "References", counters.m_References );
+    };
+
+    // Lambda function to find and analyze all CEG protected functions.
+    auto analyze_protected = [&]() -> bool
+    {
         // Find CEG register thread functions.
-        for (auto & pattern : CEG_REGISTER_THREAD_FUNC_PATTERNS)
-            FindFunctions( pattern, address, size, Data::CEG_REGISTER_THREAD_FUNC_FUNCS );
+        results( PatternGroup::RegisterThread ).All( PatternGroup::RegisterThread, context.m_RegisterThreadFuncs );
 
         // Find all CEG protected functions for the further analysis.
         std::vector<mem::pointer> ceg_protect;
-        for (auto & pattern : CEG_PROTECT_PATTERNS)
-            FindFunctions( pattern, address, size, ceg_protect);
+        results( PatternGroup::Protect ).All( PatternGroup::Protect, ceg_protect );
 
-        if (!ceg_protect.empty())
-        {
-            auto analyzer = std::make_unique<InstructionAnalyzer>();
+        if (ceg_protect.empty())
+            return false;
+
+        auto analyzer = std::make_unique<InstructionAnalyzer>( context );
 
-            auto start = content.substr( Data::CEG_RAW_DATA_POINTER );
-            auto data = std::span<const std::byte>(
-                reinterpret_cast<const std::byte *>(start.data()),
-                start.size()
-            );
+        // Lambda function to get the raw data of an executable section.
+        auto section_data = [&content]( const CodeSection & section ) -> std::span<const std::byte>
+        {
+            return content.subspan( section.m_RawDataPointer, section.m_Size );
+        };
 
-            bool success = analyzer->AnalyzeCEGProtectedFunctions( data, address, ceg_protect );
+        bool analyzed = true;
 
-            if (success)
+        if (!options.m_ControlFlow)
+        {
+            for (std::size_t i = 0; i < context.m_Sections.size(); ++i)
             {
-                // Lambda function to remove duplicate references from CEG protected function maps.
-                auto remove_ref = []( const auto & container )
-                {
-                    for (const auto & [key, _] : container)
-                    {
-                        auto range = Data::CEG_PROTECTED_STOLEN_FUNCS_v2.equal_range( key );
-
-                        if (range.first != range.second)
-                            Data::CEG_PROTECTED_STOLEN_FUNCS_v2.erase( range.first, range.second );
-                    }
-                };
-
-                // Remove duplicates based on CEG version.
-                if(Data::CEG_OLD_VERSION)
-                    remove_ref( Data::CEG_PROTECTED_STOLEN_FUNCS_v1 );
-                else
-                {
-                    remove_ref( Data::CEG_PROTECTED_CONSTANT_FUNCS );
-                    remove_ref( Data::CEG_PROTECTED_STOLEN_FUNCS_v3 );
-                }
+                const auto & section = context.m_Sections[i];
+                const auto xrefs = reuse ? blocks.Reuse( context, previous_blocks, i ) : XrefReuse {};
 
-                // Print statistics about found CEG protected functions.
-                auto print_protected_funcs = []( const auto & map, std::string_view label )
+                analyzed &= profiler.Time( "AnalyzeCEGProtectedFunctions", [&]()
                 {
-                    if (map.empty())
-                        return;
+                    return analyzer->AnalyzeCEGProtectedFunctions( section_data( section ),
+                        SectionAddress( context, section ), ceg_protect, options.m_Threads, reuse ? &xrefs : nullptr );
+                } );
+
+                if (incremental)
+                    blocks.SetXrefs( context, i, analyzer->GetXrefs() );
+            }
 
-                    auto keys_view = map | std::views::keys;
-                    std::set<mem::pointer> unique_keys( keys_view.begin(), keys_view.end() );
+            report_counters( *analyzer );
+            return analyzed;
+        }
 
-                    std::cout << std::format( "[SUCCESS] Found CEG protected {} functions: '{}'.", label, unique_keys.size() ) << std::endl;
-                };
+        // Descend from the entry point, the exports and the CEG init function.
+        std::vector<std::uint32_t> roots {};
 
-                print_protected_funcs( Data::CEG_PROTECTED_STOLEN_FUNCS_v1, "(stolen) (v1)" );
-                print_protected_funcs( Data::CEG_PROTECTED_STOLEN_FUNCS_v2, "(stolen) (v2)" );
-                print_protected_funcs( Data::CEG_PROTECTED_STOLEN_FUNCS_v3, "(stolen) (v3)" );
-                print_protected_funcs( Data::CEG_PROTECTED_CONSTANT_FUNCS, "(constant)" );
+        if (context.m_EntryPoint)
+            roots.push_back( VaToOffset( context, context.m_EntryPoint ) );
 
-                if (Data::CEG_REGISTER_THREAD_FUNC)
-                {
-                    Data::CEG_REGISTER_THREAD_FUNC = TransformToRealAddress( address, Data::CEG_REGISTER_THREAD_FUNC );
-                    std::cout << std::format( "[SUCCESS] Found CEG register thread function: '0x{:08x}'.",
-                        Data::CEG_REGISTER_THREAD_FUNC.as<std::uint32_t>() ) << std::endl;
-                }
-            }
+        std::vector<std::uint32_t> exports {};
+        GetExportedFunctions( context, content, exports );
+
+        for (const auto va : exports)
+            roots.push_back( VaToOffset( context, va ) );
+
+        if (const auto * init = results( PatternGroup::Init ).First( PatternGroup::Init, init_order ))
+            roots.push_back( init->m_Address.as<std::uint32_t>() );
+
+        // Roots outside of a section are ignored by its graph.
+        for (const auto & section : context.m_Sections)
+        {
+            const auto data = section_data( section );
+            const auto * section_address = SectionAddress( context, section );
+
+            auto cfg = std::make_unique<ControlFlowGraph>();
+            profiler.Time( "ControlFlowGraph", [&]() { cfg->Build( context, data, section_address, section.m_Size, roots ); } );
+
+            cfg_blocks += cfg->Blocks().size();
+            cfg_instructions += cfg->Instructions().size();
+
+            analyzed &= profiler.Time( "AnalyzeCEGProtectedFunctions", [&]()
+            {
+                return analyzer->AnalyzeCEGProtectedFunctions( data, *cfg, section_address, ceg_protect );
+            } );
         }
 
-        // Find CEG integrity functions.
-        for (auto & pattern : CEG_INTEGRITY_PATTERNS)
-            FindFunctions( pattern, address, size, Data::CEG_INTEGRITY_FUNCS );
+        profiler.Count( "Reachable instructions", cfg_instructions );
+        report_counters( *analyzer );
+        return analyzed;
+    };
+
+    // With tasks, the analysis starts as soon as the protect and register thread scans finish.
+    std::future<bool> analysis {};
+
+    if (options.m_Tasks)
+        analysis = std::async( std::launch::async, analyze_protected );
+
+    // Find CEG init function.
+    const auto * init_hit = results( PatternGroup::Init ).First( PatternGroup::Init, init_order );
+
+    if (!init_hit)
+    {
+        out << "[ERROR] CEG init function not found." << std::endl;
+        report.m_Error = Error::InitFuncNotFound;
+        return report;
+    }
+
+    context.m_InitLibraryFunc = init_hit->m_Address;
+    report.m_InitPattern = init_hit->m_Index;
+
+    context.m_InitLibraryFunc = TransformToRealAddress( context, address, context.m_InitLibraryFunc );
+    out << std::format( "[SUCCESS] Found CEG init function: '0x{:08x}'.",
+        context.m_InitLibraryFunc.as<std::uint32_t>() ) << std::endl;
+
+    // Find CEG terminate function.
+    const auto * term_hit = results( PatternGroup::Terminate ).First( PatternGroup::Terminate, term_order );
+
+    if (!term_hit)
+    {
+        out << "[ERROR] CEG terminate function not found." << std::endl;
+        report.m_Error = Error::TermFuncNotFound;
+        return report;
+    }
+
+    context.m_TermLibraryFunc = term_hit->m_Address;
+    report.m_TermPattern = term_hit->m_Index;
+
+    context.m_TermLibraryFunc = TransformToRealAddress( context, address, context.m_TermLibraryFunc );
+    out << std::format( "[SUCCESS] Found CEG terminate function: '0x{:08x}'.",
+        context.m_TermLibraryFunc.as<std::uint32_t>() ) << std::endl;
+
+    const bool success = options.m_Tasks ? analysis.get() : analyze_protected();
 
-        if (!Data::CEG_INTEGRITY_FUNCS.empty())
+    if (cfg_blocks)
+    {
+        out << std::format( "[SUCCESS] Built control flow graph: '{}' basic blocks, '{}' instructions.",
+            cfg_blocks, cfg_instructions ) << std::endl;
+    }
+
+    if (success)
+    {
+        auto & protected_funcs = context.m_ProtectedFuncs;
+
+        // Remove duplicate references based on CEG version.
+        profiler.Time( "Dedup", [&]()
+        {
+            if (context.m_OldVersion)
+                protected_funcs.RemoveShadowed( ProtectedType::StolenV2, { ProtectedType::StolenV1 } );
+            else
+                protected_funcs.RemoveShadowed( ProtectedType::StolenV2, { ProtectedType::Constant, ProtectedType::StolenV3 } );
+        } );
+
+        profiler.Count( "Protected entries", protected_funcs.size() );
+
+        // Print statistics about found CEG protected functions.
+        auto print_protected_funcs = [&protected_funcs, &out]( ProtectedType type, std::string_view label )
         {
-            std::cout << std::format( "[SUCCESS] Found CEG integrity functions: '{}'.", Data::CEG_INTEGRITY_FUNCS.size() ) << std::endl;
-            TransformToRealAddress( address, Data::CEG_INTEGRITY_FUNCS );
+            const auto count = protected_funcs.UniqueFuncs( type );
+
+            if (count)
+                out << std::format( "[SUCCESS] Found CEG protected {} functions: '{}'.", label, count ) << std::endl;
+        };
+
+        print_protected_funcs( ProtectedType::StolenV1, "(stolen) (v1)" );
+        print_protected_funcs( ProtectedType::StolenV2, "(stolen) (v2)" );
+        print_protected_funcs( ProtectedType::StolenV3, "(stolen) (v3)" );
+        print_protected_funcs( ProtectedType::Constant, "(constant)" );
+
+        if (context.m_RegisterThreadFunc)
+        {
+            context.m_RegisterThreadFunc = TransformToRealAddress( context, address, context.m_RegisterThreadFunc );
+            out << std::format( "[SUCCESS] Found CEG register thread function: '0x{:08x}'.",
+                context.m_RegisterThreadFunc.as<std::uint32_t>() ) << std::endl;
         }
+    }
+
+    // Find CEG integrity functions.
+    results( PatternGroup::Integrity ).All( PatternGroup::Integrity, context.m_IntegrityFuncs );
 
-        // Find CEG test secret functions.
-        for (auto & pattern : CEG_TESTSECRET_PATTERNS)
-            FindFunctions( pattern, address, size, Data::CEG_TESTSECRET_FUNCS );
+    if (!context.m_IntegrityFuncs.empty())
+    {
+        out << std::format( "[SUCCESS] Found CEG integrity functions: '{}'.", context.m_IntegrityFuncs.size() ) << std::endl;
+        TransformToRealAddress( context, address, context.m_IntegrityFuncs );
+    }
 
-        if (!Data::CEG_TESTSECRET_FUNCS.empty())
+    // Find CEG test secret functions.
+    results( PatternGroup::TestSecret ).All( PatternGroup::TestSecret, context.m_TestSecretFuncs );
+
+    if (!context.m_TestSecretFuncs.empty())
+    {
+        out << std::format( "[SUCCESS] Found CEG test secret functions: '{}'.", context.m_TestSecretFuncs.size() ) << std::endl;
+        TransformToRealAddress( context, address, context.m_TestSecretFuncs );
+    }
+
+    if (!write_output())
+        return report;
+
+    // The cache only saves time on the next run, failing to save it is not fatal.
+    if (options.m_Cache)
+    {
+        if (auto cache_res = AnalysisCache::Save( cache_path, context ); !cache_res)
+            out << std::format( "[WARNING] Cannot save the analysis cache: '{}'.", ErrorToString( cache_res.error() ) ) << std::endl;
+
+        if (incremental && success && blocks.Complete())
         {
-            std::cout << std::format( "[SUCCESS] Found CEG test secret functions: '{}'.", Data::CEG_TESTSECRET_FUNCS.size() ) << std::endl;
-            TransformToRealAddress( address, Data::CEG_TESTSECRET_FUNCS );
+            if (auto blocks_res = blocks.Save( IncrementalState::StatePath( cache_directory, image_hash ) ); !blocks_res)
+                out << std::format( "[WARNING] Cannot save the block hashes: '{}'.", ErrorToString( blocks_res.error() ) ) << std::endl;
         }
+    }
 
-        auto writer = std::make_unique<JsonWriter>( fs::path( argv[0] ).parent_path() / "noceg.json" );
-        writer->WriteJSON();
+    report_profile();
+    return report;
+}
+
+
+/**
+* @brief Analyzes every binary of a batch and writes one JSON per binary plus a summary.
+*
+* @param options The command line options.
+* @param tool_directory Directory of the signatures finder.
+* @return The process exit code, non-zero if any binary failed.
+*/
+int AnalyzeBatch(
+    const Options & options,
+    const fs::path & tool_directory
+)
+{
+    const auto output_directory = tool_directory / "noceg_batch";
+    auto jobs_res = Batch::Collect( options.m_Batch, output_directory );
 
-        if (Data::CEG_ASLR_ENABLED)
+    if (!jobs_res)
+    {
+        std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( jobs_res.error() ) ) << std::endl;
+        return 1;
+    }
+
+    std::error_code ec {};
+    fs::create_directories( output_directory, ec );
+
+    if (ec)
+    {
+        std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( Error::OutputFileCreateError ) ) << std::endl;
+        return 1;
+    }
+
+    const auto & jobs = jobs_res.value();
+    const auto workers = std::min<std::uint32_t>( options.m_Jobs, static_cast<std::uint32_t>(jobs.size()) );
+
+    std::cout << std::format( "[SUCCESS] Queued '{}' binaries, analyzing '{}' at once.", jobs.size(), workers ) << std::endl << std::endl;
+
+    // Every binary orders its patterns by the statistics of the previous runs, the new hits are recorded afterwards.
+    const auto stats_path = PatternStats::DefaultPath();
+    auto stats = PatternStats::Load( stats_path );
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto reports = Batch::Run( jobs, workers, [&]( const BatchJob & job, std::ostream & log )
+    {
+        const auto profile_output = job.m_Output.parent_path() / std::format( "{}_profile.json", job.m_Output.stem().string() );
+        return AnalyzeBinary( options, job.m_Binary, job.m_Output, profile_output, stats, log, log );
+    } );
+
+    const auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    std::size_t failed = 0;
+
+    for (const auto & report : reports)
+    {
+        if (report.m_Error)
         {
-            auto save_res = SaveBinaryNoASLR( content, argv[1] );
+            ++failed;
+            continue;
+        }
 
-            if (!save_res)
-            {
-                std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( save_res.error() ) ) << std::endl;
+        if (report.m_InitPattern)
+            stats.Record( PatternGroup::Init, report.m_OldVersion, *report.m_InitPattern );
+
+        if (report.m_TermPattern)
+            stats.Record( PatternGroup::Terminate, report.m_OldVersion, *report.m_TermPattern );
+    }
+
+    // The statistics only steer the pattern order, failing to save them is not fatal.
+    if (auto stats_res = stats.Save( stats_path ); !stats_res)
+        std::cout << std::format( "[WARNING] Cannot save the pattern statistics: '{}'.", ErrorToString( stats_res.error() ) ) << std::endl;
+
+    if (options.m_Stats)
+        stats.Print();
+
+    const auto summary_path = output_directory / "noceg_batch.json";
+
+    if (auto summary_res = Batch::SaveSummary( summary_path, options.m_Batch, reports, workers, seconds ); !summary_res)
+    {
+        std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( summary_res.error() ) ) << std::endl;
+        return 1;
+    }
+
+    std::cout << std::format( "[SUCCESS] Analyzed '{}' of '{}' binaries in '{:.2f}' s, summary saved to '{}'.",
+        reports.size() - failed, reports.size(), seconds, summary_path.string() ) << std::endl;
+
+    return failed ? 1 : 0;
+}
+
+
+int main( 
+    int argc,
+    char * argv[] 
+)
+{
+    std::cout << "CEG signatures finder by iArtorias (https://github.com/iArtorias)" << std::endl << std::endl;
+
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << std::format( "Usage: '{}' <ceg_binary> [--cfg] [--tasks] [--threads <count>] [--stats] [--bench] [--histogram] [--no-cache] [--compact-json] [--profile] [--aslr-in-place] [--stream].", argv[0] ) << std::endl;
+            std::cerr << std::format( "       '{}' --batch <directory_or_list> [--jobs <count>] [options].", argv[0] ) << std::endl;
+            std::cerr << std::format( "       '{}' --trace <directory>.", argv[0] ) << std::endl;
+            std::cerr << std::format( "       '{}' --stats.", argv[0] ) << std::endl;
+            std::cin.get();
+            return 1;
+        }
+
+        auto options_res = ParseOptions( argc, argv );
+
+        if (!options_res)
+        {
+            std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( options_res.error() ) ) << std::endl;
+
+            // The batch mode, the trace conversion and the statistics run unattended.
+            if (std::string_view( argv[1] ) != "--batch" && std::string_view( argv[1] ) != "--trace" && std::string_view( argv[1] ) != "--stats")
                 std::cin.get();
+
+            return 1;
+        }
+
+        const auto & options = options_res.value();
+        const auto tool_directory = fs::path( argv[0] ).parent_path();
+
+        if (!options.m_Batch.empty())
+            return AnalyzeBatch( options, tool_directory );
+
+        if (!options.m_Trace.empty())
+        {
+            const auto trace_path = options.m_Trace / "noceg_trace.json";
+
+            if (auto trace_res = TraceExport::Convert( options.m_Trace, trace_path ); !trace_res)
+            {
+                std::cerr << std::format( "[ERROR] '{}'.", ErrorToString( trace_res.error() ) ) << std::endl;
                 return 1;
             }
+            else
+                std::cout << std::format( "[SUCCESS] Converted '{}' events to '{}'.", *trace_res, trace_path.string() ) << std::endl;
 
-            std::cout << "[SUCCESS] Successfully saved the binary with disabled ASLR." << std::endl;
+            return 0;
+        }
+
+        const auto stats_path = PatternStats::DefaultPath();
+        auto stats = PatternStats::Load( stats_path );
+
+        // Print the statistics of the previous runs without analyzing anything.
+        if (options.m_Binary.empty())
+        {
+            stats.Print();
+            return 0;
         }
 
+        if (options.m_Bench)
+        {
+            const auto bench_res = BenchmarkBinary( options );
+            std::cin.get();
+            return bench_res;
+        }
+
+        const auto report = AnalyzeBinary( options, options.m_Binary, tool_directory / "noceg.json",
+            tool_directory / "noceg_profile.json", stats, std::cout, std::cerr );
+
+        if (report.m_Error)
+        {
+            std::cin.get();
+            return 1;
+        }
+
+        if (report.m_InitPattern)
+            stats.Record( PatternGroup::Init, report.m_OldVersion, *report.m_InitPattern );
+
+        if (report.m_TermPattern)
+            stats.Record( PatternGroup::Terminate, report.m_OldVersion, *report.m_TermPattern );
+
+        // The statistics only steer the pattern order, failing to save them is not fatal.
+        if (auto stats_res = stats.Save( stats_path ); !stats_res)
+            std::cout << std::format( "[WARNING] Cannot save the pattern statistics: '{}'.", ErrorToString( stats_res.error() ) ) << std::endl;
+
+        if (options.m_Stats)
+            stats.Print();
+
         std::cout << std::endl << "Press 'ENTER' key to exit application." << std::endl;
         std::cin.get();
         return 0;
@@ -241,4 +783,4 @@ int main(
     }
 
     return 0;
-}
\ No newline at end of file
+}